@@ -182,11 +182,13 @@ endif()
 check_include_file(sys/ioctl.h SC_HAVE_SYS_IOCTL_H)
 check_include_file(sys/select.h SC_HAVE_SYS_SELECT_H)
 check_include_file(sys/stat.h SC_HAVE_SYS_STAT_H)
+check_include_file(sys/mman.h SC_HAVE_SYS_MMAN_H)
 check_include_file(fcntl.h SC_HAVE_FCNTL_H)
 
 if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
   check_include_file(linux/videodev2.h SC_HAVE_LINUX_VIDEODEV2_H)
   check_include_file(linux/version.h SC_HAVE_LINUX_VERSION_H)
+  check_include_file(linux/perf_event.h SC_HAVE_LINUX_PERF_EVENT_H)
 
   if(SC_HAVE_LINUX_VIDEODEV2_H AND SC_HAVE_LINUX_VERSION_H)
     file(READ ${CMAKE_CURRENT_LIST_DIR}/check_v4l2.c check_v4l2_src)
@@ -0,0 +1,171 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Compare the throughput of the libsc base 64 codec with libb64. */
+
+#include <sc_base64.h>
+#include <sc_options.h>
+#include <libb64.h>
+
+static double
+bench_encode_libb64 (const char *in, size_t n, char *out, int reps)
+{
+  int                 r;
+  size_t              len = 0;
+  double              t;
+  base64_encodestate  state;
+
+  t = sc_MPI_Wtime ();
+  for (r = 0; r < reps; ++r) {
+    base64_init_encodestate (&state);
+    len = base64_encode_block (in, n, out, &state);
+    len += base64_encode_blockend (out + len, &state);
+  }
+  t = sc_MPI_Wtime () - t;
+  SC_CHECK_ABORT (len > 0, "libb64 encode");
+  return t;
+}
+
+static double
+bench_decode_libb64 (const char *in, size_t n, char *out, int reps)
+{
+  int                 r;
+  size_t              len = 0;
+  double              t;
+  base64_decodestate  state;
+
+  t = sc_MPI_Wtime ();
+  for (r = 0; r < reps; ++r) {
+    base64_init_decodestate (&state);
+    len = base64_decode_block (in, n, out, &state);
+  }
+  t = sc_MPI_Wtime () - t;
+  SC_CHECK_ABORT (len > 0, "libb64 decode");
+  return t;
+}
+
+static double
+bench_encode_sc (const char *in, size_t n, char *out, int reps)
+{
+  int                 r;
+  size_t              len = 0;
+  double              t;
+
+  t = sc_MPI_Wtime ();
+  for (r = 0; r < reps; ++r) {
+    len = sc_base64_encode (in, n, out);
+  }
+  t = sc_MPI_Wtime () - t;
+  SC_CHECK_ABORT (len == SC_BASE64_ENCODED_LENGTH (n), "sc encode");
+  return t;
+}
+
+static double
+bench_decode_sc (const char *in, size_t n, char *out, int reps)
+{
+  int                 r, retval = 0;
+  size_t              len = 0;
+  double              t;
+
+  t = sc_MPI_Wtime ();
+  for (r = 0; r < reps; ++r) {
+    retval |= sc_base64_decode (in, n, out, &len);
+  }
+  t = sc_MPI_Wtime () - t;
+  SC_CHECK_ABORT (!retval && len > 0, "sc decode");
+  return t;
+}
+
+static void
+report (const char *what, size_t bytes, int reps, double t)
+{
+  SC_GLOBAL_PRODUCTIONF ("%-16s %10.3f ms %10.1f MB/s\n", what,
+                         1.e3 * t / reps, bytes * (double) reps / t * 1.e-6);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 first_arg;
+  int                 kilobytes, reps;
+  size_t              zz, n, elen;
+  char               *data, *enc, *dec, *ref;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'k', "kilobytes", &kilobytes, 4096,
+                      "Size of the data to encode");
+  sc_options_add_int (opt, 'r', "repetitions", &reps, 10,
+                      "Number of repetitions");
+
+  first_arg = sc_options_parse (sc_package_id, SC_LP_ERROR, opt, argc, argv);
+  if (first_arg != argc || kilobytes <= 0 || reps <= 0) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+    sc_abort_collective ("Option parsing failed");
+  }
+  else {
+    sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+  }
+
+  /* libb64 writes at most 3 bytes beyond the decoded data */
+  n = (size_t) kilobytes << 10;
+  data = SC_ALLOC (char, n);
+  enc = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n));
+  dec = SC_ALLOC (char, n + 3);
+  for (zz = 0; zz < n; ++zz) {
+    data[zz] = (char) rand ();
+  }
+
+  /* both codecs produce the same code */
+  report ("libb64 encode", n, reps,
+          bench_encode_libb64 (data, n, enc, reps));
+  ref = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n));
+  memcpy (ref, enc, SC_BASE64_ENCODED_LENGTH (n));
+  report ("sc_base64 encode", n, reps, bench_encode_sc (data, n, enc, reps));
+  elen = SC_BASE64_ENCODED_LENGTH (n);
+  SC_CHECK_ABORT (!memcmp (ref, enc, elen), "Encoders differ");
+  SC_FREE (ref);
+  report ("libb64 decode", n, reps, bench_decode_libb64 (enc, elen, dec, reps));
+  SC_CHECK_ABORT (!memcmp (data, dec, n), "libb64 round trip");
+  memset (dec, 0, n);
+  report ("sc_base64 decode", n, reps, bench_decode_sc (enc, elen, dec, reps));
+  SC_CHECK_ABORT (!memcmp (data, dec, n), "sc_base64 round trip");
+
+  SC_FREE (dec);
+  SC_FREE (enc);
+  SC_FREE (data);
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -1326,6 +1326,9 @@ sc_init (sc_MPI_Comm mpicomm,
     sc_mpicomm = mpicomm;
     mpiret = sc_MPI_Comm_rank (sc_mpicomm, &sc_identifier);
     SC_CHECK_MPI (mpiret);
+
+    /* cache the objects reused by every statistics computation */
+    sc_stats_init_mpi ();
   }
 
   sc_set_signal_handler (catch_signals);
@@ -1397,6 +1400,9 @@ sc_finalize_noabort (void)
   int                 i;
   int                 num_errors = 0;
 
+  /* release objects cached for statistics before checking memory */
+  sc_stats_finalize_mpi ();
+
   /* sc_packages is static and thus initialized to all zeros */
   for (i = sc_num_packages_alloc - 1; i >= 0; --i)
     if (sc_packages[i].is_registered)
@@ -23,15 +23,55 @@
 
 #include <sc_amr.h>
 
-void
-sc_amr_error_stats (sc_MPI_Comm mpicomm, long num_elements,
-                    const double *errors, sc_amr_control_t * amr)
+/* number of bins of the error histogram between minimum and maximum */
+#define SC_AMR_HISTOGRAM_BINS 1024
+
+/** Map an error to its relative position between the global extremes.
+ * The scale is logarithmic if all errors are positive and linear otherwise.
+ */
+static double
+sc_amr_histogram_position (const sc_amr_control_t * amr, double error)
+{
+  const double        emin = amr->estats.min;
+  const double        emax = amr->estats.max;
+
+  if (!(emin < emax)) {
+    return 0.;
+  }
+  if (emin > 0.) {
+    return (log (error) - log (emin)) / (log (emax) - log (emin));
+  }
+  return (error - emin) / (emax - emin);
+}
+
+/** Map a relative position between the global extremes to an error. */
+static double
+sc_amr_histogram_value (const sc_amr_control_t * amr, double position)
+{
+  const double        emin = amr->estats.min;
+  const double        emax = amr->estats.max;
+
+  if (!(emin < emax)) {
+    return emin;
+  }
+  if (emin > 0.) {
+    return exp (log (emin) + position * (log (emax) - log (emin)));
+  }
+  return emin + position * (emax - emin);
+}
+
+static void
+sc_amr_error_stats_ext (sc_MPI_Comm mpicomm, long num_elements,
+                        const double *errors, sc_amr_control_t * amr,
+                        int histogram)
 {
   sc_statinfo_t      *si = &amr->estats;
   int                 mpiret;
   int                 mpisize;
+  int                 b;
   long                i;
   double              sum, squares, emin, emax;
+  double             *local;
 
   mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
   SC_CHECK_MPI (mpiret);
@@ -47,15 +87,30 @@ sc_amr_error_stats (sc_MPI_Comm mpicomm, long num_elements,
     emin = SC_MIN (emin, errors[i]);
     emax = SC_MAX (emax, errors[i]);
   }
-  si->dirty = 1;
+  sc_stats_init (si, NULL);
   si->count = num_elements;
   si->sum_values = sum;
   si->sum_squares = squares;
   si->min = emin;
   si->max = emax;
-  si->variable = NULL;
   sc_stats_compute (mpicomm, 1, si);
 
+  amr->histogram = NULL;
+  if (histogram) {
+    /* the bins span the global range of the errors */
+    local = SC_ALLOC_ZERO (double, SC_AMR_HISTOGRAM_BINS);
+    for (i = 0; i < num_elements; ++i) {
+      b = (int) (SC_AMR_HISTOGRAM_BINS *
+                 sc_amr_histogram_position (amr, errors[i]));
+      ++local[SC_MAX (0, SC_MIN (b, SC_AMR_HISTOGRAM_BINS - 1))];
+    }
+    amr->histogram = SC_ALLOC (double, SC_AMR_HISTOGRAM_BINS);
+    mpiret = sc_MPI_Allreduce (local, amr->histogram, SC_AMR_HISTOGRAM_BINS,
+                               sc_MPI_DOUBLE, sc_MPI_SUM, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (local);
+  }
+
   amr->mpicomm = mpicomm;
   amr->num_procs_long = (long) mpisize;
   amr->num_total_estimated = amr->num_total_elements = si->count;
@@ -64,6 +119,69 @@ sc_amr_error_stats (sc_MPI_Comm mpicomm, long num_elements,
   amr->num_total_coarsen = amr->num_total_refine = 0;
 }
 
+void
+sc_amr_error_stats (sc_MPI_Comm mpicomm, long num_elements,
+                    const double *errors, sc_amr_control_t * amr)
+{
+  sc_amr_error_stats_ext (mpicomm, num_elements, errors, amr, 0);
+}
+
+void
+sc_amr_error_histogram (sc_MPI_Comm mpicomm, long num_elements,
+                        const double *errors, sc_amr_control_t * amr)
+{
+  sc_amr_error_stats_ext (mpicomm, num_elements, errors, amr, 1);
+}
+
+void
+sc_amr_reset (sc_amr_control_t * amr)
+{
+  if (amr->histogram != NULL) {
+    SC_FREE (amr->histogram);
+    amr->histogram = NULL;
+  }
+}
+
+/** Call back to count local changes and sum them over all processes. */
+static long
+sc_amr_count_global (sc_amr_control_t * amr,
+                     long (*count_fn) (sc_amr_control_t *, void *),
+                     void *user_data)
+{
+  int                 mpiret;
+  long                local_count, global_count;
+
+  local_count = count_fn (amr, user_data);
+  mpiret = sc_MPI_Allreduce (&local_count, &global_count, 1,
+                             sc_MPI_LONG, sc_MPI_SUM, amr->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  return global_count;
+}
+
+/** Estimate the error below which a number of elements lie. */
+static double
+sc_amr_histogram_threshold (sc_amr_control_t * amr, double num_below)
+{
+  int                 b;
+  double              sum, frac;
+
+  SC_ASSERT (amr->histogram != NULL);
+  SC_ASSERT (amr->estats.count > 0);
+
+  /* find the bin containing the threshold and interpolate inside */
+  num_below = SC_MAX (0., SC_MIN (num_below, (double) amr->estats.count));
+  for (sum = 0., b = 0; b < SC_AMR_HISTOGRAM_BINS - 1 &&
+       sum + amr->histogram[b] < num_below; ++b) {
+    sum += amr->histogram[b];
+  }
+  frac = 0.;
+  if (amr->histogram[b] > 0.) {
+    frac = SC_MIN ((num_below - sum) / amr->histogram[b], 1.);
+  }
+  return sc_amr_histogram_value (amr, (b + frac) / SC_AMR_HISTOGRAM_BINS);
+}
+
 void
 sc_amr_coarsen_specify (int package_id,
                         sc_amr_control_t * amr, double coarsen_threshold,
@@ -292,3 +410,147 @@ sc_amr_refine_search (int package_id, sc_amr_control_t * amr,
                "Estimated global number of elements = %ld\n",
                amr->num_total_estimated);
 }
+
+void
+sc_amr_coarsen_histogram (int package_id, sc_amr_control_t * amr,
+                          long num_total_low, double target_window,
+                          sc_amr_count_coarsen_fn cfn, void *user_data)
+{
+  const long          num_total_elements = amr->num_total_elements;
+  const long          num_total_refine = amr->num_total_refine;
+  int                 round;
+  long                num_total_high, num_total_estimated;
+  long                global_coarsen;
+  double              loss, num_below, per_element;
+
+  SC_ASSERT (amr->histogram != NULL);
+
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Histogram search for coarsen threshold assuming"
+               " %ld refinements\n", num_total_refine);
+
+  if (cfn == NULL || amr->estats.count <= 0 ||
+      num_total_elements + num_total_refine <= num_total_low) {
+    SC_GEN_LOG (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+                "Histogram search for coarsening skipped\n");
+    amr->coarsen_threshold = amr->estats.min;
+    amr->num_total_coarsen = 0;
+    amr->num_total_estimated = num_total_elements + num_total_refine;
+    return;
+  }
+
+  /* aim at the middle of the range of acceptable total element counts */
+  num_total_high = (long) (num_total_low / target_window);
+  loss = num_total_elements + num_total_refine -
+    .5 * ((double) num_total_low + (double) num_total_high);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_INFO,
+               "Range of acceptable total element counts %ld %ld\n",
+               num_total_low, num_total_high);
+
+  /* the first round assumes that each element below threshold is lost */
+  per_element = 1.;
+  for (round = 0;; ++round) {
+    num_below = loss / per_element;
+    amr->coarsen_threshold = sc_amr_histogram_threshold (amr, num_below);
+    global_coarsen = sc_amr_count_global (amr, cfn, user_data);
+    num_total_estimated =
+      num_total_elements + num_total_refine - global_coarsen;
+    SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+                 "At %g total %ld estimated %ld coarsen %ld\n",
+                 amr->coarsen_threshold, num_total_elements,
+                 num_total_estimated, global_coarsen);
+
+    /* a second round corrects by the observed loss per element */
+    if (round == 1 || global_coarsen <= 0 || num_below <= 0. ||
+        (num_total_low <= num_total_estimated &&
+         num_total_estimated <= num_total_high)) {
+      break;
+    }
+    per_element = global_coarsen / SC_MIN (num_below,
+                                           (double) amr->estats.count);
+  }
+  amr->num_total_coarsen = global_coarsen;
+  amr->num_total_estimated = num_total_estimated;
+
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Histogram search for coarsen stopped after %d rounds"
+               " with threshold %g\n", round + 1, amr->coarsen_threshold);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Global number of coarsenings = %ld\n",
+               amr->num_total_coarsen);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_INFO,
+               "Estimated global number of elements = %ld\n",
+               amr->num_total_estimated);
+}
+
+void
+sc_amr_refine_histogram (int package_id, sc_amr_control_t * amr,
+                         long num_total_high, double target_window,
+                         sc_amr_count_refine_fn rfn, void *user_data)
+{
+  const long          num_total_elements = amr->num_total_elements;
+  const long          num_total_coarsen = amr->num_total_coarsen;
+  int                 round;
+  long                num_total_low, num_total_estimated;
+  long                global_refine;
+  double              gain, num_above, per_element;
+
+  SC_ASSERT (amr->histogram != NULL);
+
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Histogram search for refine threshold assuming"
+               " %ld coarsenings\n", num_total_coarsen);
+
+  if (rfn == NULL || amr->estats.count <= 0 ||
+      num_total_elements - num_total_coarsen >= num_total_high) {
+    SC_GEN_LOG (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+                "Histogram search for refinement skipped\n");
+    amr->refine_threshold = amr->estats.max;
+    amr->num_total_refine = 0;
+    amr->num_total_estimated = num_total_elements - num_total_coarsen;
+    return;
+  }
+
+  /* aim at the middle of the range of acceptable total element counts */
+  num_total_low = (long) (num_total_high * target_window);
+  gain = .5 * ((double) num_total_low + (double) num_total_high) -
+    (num_total_elements - num_total_coarsen);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_INFO,
+               "Range of acceptable total element counts %ld %ld\n",
+               num_total_low, num_total_high);
+
+  /* the first round assumes that each element above threshold adds one */
+  per_element = 1.;
+  for (round = 0;; ++round) {
+    num_above = gain / per_element;
+    amr->refine_threshold = sc_amr_histogram_threshold
+      (amr, amr->estats.count - num_above);
+    global_refine = sc_amr_count_global (amr, rfn, user_data);
+    num_total_estimated =
+      num_total_elements + global_refine - num_total_coarsen;
+    SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+                 "At %g total %ld estimated %ld refine %ld\n",
+                 amr->refine_threshold, num_total_elements,
+                 num_total_estimated, global_refine);
+
+    /* a second round corrects by the observed gain per element */
+    if (round == 1 || global_refine <= 0 || num_above <= 0. ||
+        (num_total_low <= num_total_estimated &&
+         num_total_estimated <= num_total_high)) {
+      break;
+    }
+    per_element = global_refine / SC_MIN (num_above,
+                                          (double) amr->estats.count);
+  }
+  amr->num_total_refine = global_refine;
+  amr->num_total_estimated = num_total_estimated;
+
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Histogram search for refine stopped after %d rounds"
+               " with threshold %g\n", round + 1, amr->refine_threshold);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_STATISTICS,
+               "Global number of refinements = %ld\n", amr->num_total_refine);
+  SC_GEN_LOGF (package_id, SC_LC_GLOBAL, SC_LP_INFO,
+               "Estimated global number of elements = %ld\n",
+               amr->num_total_estimated);
+}
@@ -40,6 +40,8 @@ typedef struct sc_amr_control
   long                num_total_coarsen;
   long                num_total_refine;
   long                num_total_estimated;
+  double             *histogram;        /**< NULL or global error counts
+                                             between estats.min and max. */
 }
 sc_amr_control_t;
 
@@ -55,6 +57,32 @@ void                sc_amr_error_stats (sc_MPI_Comm mpicomm,
                                         const double *errors,
                                         sc_amr_control_t * amr);
 
+/** Compute global error statistics and a histogram of the errors.
+ * The histogram is reduced after the statistics, such that its bins span
+ * the global minimum to maximum error.  The bins are logarithmic if all
+ * errors are positive and linear otherwise.
+ * It allows \ref sc_amr_coarsen_histogram and \ref sc_amr_refine_histogram
+ * to pick thresholds without a binary search.
+ * The histogram must be freed with \ref sc_amr_reset before the
+ * structure is passed to this function or \ref sc_amr_error_stats again,
+ * since both treat it as uninitialized.
+ * \param [in] mpicomm        MPI communicator to use.
+ * \param [in] num_local_elements   Number of local elements.
+ * \param [in] errors         The error values, one per local element.
+ * \param [out] amr           Structure will be initialized and estats filled.
+ */
+void                sc_amr_error_histogram (sc_MPI_Comm mpicomm,
+                                            long num_local_elements,
+                                            const double *errors,
+                                            sc_amr_control_t * amr);
+
+/** Free memory allocated in the AMR control structure, if any.
+ * \param [in,out] amr        Control structure initialized by
+ *                            \ref sc_amr_error_stats or
+ *                            \ref sc_amr_error_histogram.
+ */
+void                sc_amr_reset (sc_amr_control_t * amr);
+
 /** Count the local number of elements that will be coarsened.
  *
  * This is all elements whose error is below threshold
@@ -131,6 +159,47 @@ void                sc_amr_refine_search (int package_id,
                                           sc_amr_count_refine_fn rfn,
                                           void *user_data);
 
+/** Histogram-based search for coarsening threshold without refinement.
+ * The threshold is read off the error histogram, assuming first that
+ * each element below the threshold removes one element.  If the resulting
+ * count misses the target window, a second and final round corrects the
+ * threshold by the net loss per element observed in the first round.
+ * Thus the callback and its reduction run at most twice.
+ *
+ * \param [in] package_id               Registered package id or -1.
+ * \param [in,out] amr                  AMR control structure with histogram
+ *                                      from \ref sc_amr_error_histogram.
+ * \param [in] num_total_ideal          Target number of global elements.
+ * \param [in] target_window            Relative target window (< 1).
+ * \param [in] cfn                      Callback to count local coarsenings.
+ * \param [in] user_data                Will be passed to the cfn callback.
+ */
+void                sc_amr_coarsen_histogram (int package_id,
+                                              sc_amr_control_t * amr,
+                                              long num_total_ideal,
+                                              double target_window,
+                                              sc_amr_count_coarsen_fn cfn,
+                                              void *user_data);
+
+/** Histogram-based search for refinement threshold without coarsening.
+ * Works like \ref sc_amr_coarsen_histogram, assuming first that each
+ * element above the threshold adds one element.
+ *
+ * \param [in] package_id               Registered package id or -1.
+ * \param [in,out] amr                  AMR control structure with histogram
+ *                                      from \ref sc_amr_error_histogram.
+ * \param [in] num_total_ideal          Target number of global elements.
+ * \param [in] target_window            Relative target window (< 1).
+ * \param [in] rfn                      Callback to count local refinements.
+ * \param [in] user_data                Will be passed to the rfn callback.
+ */
+void                sc_amr_refine_histogram (int package_id,
+                                             sc_amr_control_t * amr,
+                                             long num_total_ideal,
+                                             double target_window,
+                                             sc_amr_count_refine_fn rfn,
+                                             void *user_data);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_AMR_H */
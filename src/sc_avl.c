@@ -35,6 +35,19 @@
 
 static void avl_rebalance(avl_tree_t *, avl_node_t *);
 
+static avl_node_t *avl_new_node(avl_tree_t *avltree) {
+	return avltree->allocator
+		? (avl_node_t *) sc_mempool_alloc(avltree->allocator)
+		: SC_ALLOC(avl_node_t, 1);
+}
+
+static void avl_free_node(avl_tree_t *avltree, avl_node_t *avlnode) {
+	if(avltree->allocator)
+		sc_mempool_free(avltree->allocator, avlnode);
+	else
+		SC_FREE(avlnode);
+}
+
 #ifdef AVL_COUNT
 #define NODE_COUNT(n)  ((n) ? (n)->count : 0)
 #define L_COUNT(n)     (NODE_COUNT((n)->left))
@@ -184,6 +197,7 @@ avl_tree_t *avl_init_tree(avl_tree_t *rc, avl_compare_t cmp, avl_freeitem_t free
 		rc->top = NULL;
 		rc->cmp = cmp;
 		rc->freeitem = freeitem;
+		rc->allocator = NULL;
 	}
 	return rc;
 }
@@ -206,7 +220,7 @@ void avl_free_nodes(avl_tree_t *avltree) {
 		next = node->next;
 		if(freeitem)
 			freeitem(node->item);
-		SC_FREE(node);
+		avl_free_node(avltree, node);
 	}
 
 	avl_clear_tree(avltree);
@@ -324,11 +338,11 @@ avl_node_t *avl_insert_node(avl_tree_t *avltree, avl_node_t *newnode) {
 avl_node_t *avl_insert(avl_tree_t *avltree, void *item) {
 	avl_node_t *newnode;
 
-	newnode = avl_init_node(SC_ALLOC(avl_node_t, 1), item);
+	newnode = avl_init_node(avl_new_node(avltree), item);
 	if(newnode) {
 		if(avl_insert_node(avltree, newnode))
 			return newnode;
-		SC_FREE(newnode);
+		avl_free_node(avltree, newnode);
 		/* errno = EEXIST; */
                 return NULL;
 	}
@@ -403,7 +417,7 @@ void *avl_delete_node(avl_tree_t *avltree, avl_node_t *avlnode) {
 		avl_unlink_node(avltree, avlnode);
 		if(avltree->freeitem)
 			avltree->freeitem(item);
-		SC_FREE(avlnode);
+		avl_free_node(avltree, avlnode);
 	}
 	return item;
 }
@@ -600,13 +614,6 @@ void avl_rebalance(avl_tree_t *avltree, avl_node_t *avlnode) {
 
 /* *INDENT-ON* */
 
-typedef struct avl_to_array_data
-{
-  size_t              iz;
-  sc_array_t         *array;
-}
-avl_to_array_data_t;
-
 typedef struct avl_foreach_recursion_data
 {
   avl_foreach_t       callback;
@@ -614,18 +621,6 @@ typedef struct avl_foreach_recursion_data
 }
 avl_foreach_recursion_data_t;
 
-static void
-avl_to_array_foreach (void *item, void *data)
-{
-  void              **pp;
-  avl_to_array_data_t *adata = (avl_to_array_data_t *) data;
-
-  pp = (void **) sc_array_index (adata->array, adata->iz);
-  *pp = item;
-
-  ++adata->iz;
-}
-
 static void
 avl_foreach_recursion (avl_node_t * node, avl_foreach_recursion_data_t * rec)
 {
@@ -650,21 +645,148 @@ avl_foreach (avl_tree_t * avltree, avl_foreach_t callback, void *data)
     avl_foreach_recursion (avltree->top, &rec);
 }
 
+void
+avl_set_allocator (avl_tree_t * avltree, sc_mempool_t * allocator)
+{
+  SC_ASSERT (avltree->top == NULL);
+  SC_ASSERT (allocator == NULL || allocator->elem_size == sizeof (avl_node_t));
+
+  avltree->allocator = allocator;
+}
+
+typedef struct avl_build_data
+{
+  avl_tree_t         *avltree;
+  sc_array_t         *items;
+  avl_node_t         *last;
+}
+avl_build_data_t;
+
+/* build the subtree of items [lo, hi) and link it in order */
+static avl_node_t  *
+avl_build_recursion (avl_build_data_t * bd, size_t lo, size_t hi,
+                     avl_node_t * parent)
+{
+  size_t              mid;
+  avl_node_t         *node;
+
+  if (lo == hi) {
+    return NULL;
+  }
+  mid = lo + (hi - lo) / 2;
+
+  /* the nodes are allocated in order for locality of traversals */
+  node = avl_new_node (bd->avltree);
+  node->parent = parent;
+  node->left = avl_build_recursion (bd, lo, mid, node);
+  node->item = *(void **) sc_array_index (bd->items, mid);
+  node->prev = bd->last;
+  if (bd->last != NULL) {
+    bd->last->next = node;
+  }
+  else {
+    bd->avltree->head = node;
+  }
+  bd->last = node;
+  node->right = avl_build_recursion (bd, mid + 1, hi, node);
+#ifdef AVL_COUNT
+  node->count = (unsigned int) (hi - lo);
+#endif
+#ifdef AVL_DEPTH
+  node->depth = CALC_DEPTH (node);
+#endif
+  return node;
+}
+
+void
+avl_from_array (avl_tree_t * avltree, sc_array_t * items)
+{
+  avl_build_data_t    bd;
+#ifdef SC_ENABLE_DEBUG
+  size_t              zz;
+#endif
+
+  SC_ASSERT (avltree->top == NULL);
+  SC_ASSERT (items->elem_size == sizeof (void *));
+  SC_ASSERT (items->elem_count <= (size_t) UINT_MAX);
+#ifdef SC_ENABLE_DEBUG
+  for (zz = 1; zz < items->elem_count; ++zz) {
+    SC_ASSERT (avltree->cmp (*(void **) sc_array_index (items, zz - 1),
+                             *(void **) sc_array_index (items, zz)) < 0);
+  }
+#endif
+
+  bd.avltree = avltree;
+  bd.items = items;
+  bd.last = NULL;
+  avltree->top = avl_build_recursion (&bd, 0, items->elem_count, NULL);
+  if (bd.last != NULL) {
+    bd.last->next = NULL;
+  }
+  avltree->tail = bd.last;
+}
+
 #ifdef AVL_COUNT
 
 void
 avl_to_array (avl_tree_t * avltree, sc_array_t * array)
 {
-  avl_to_array_data_t adata;
+  size_t              iz;
+  avl_node_t         *node;
 
   SC_ASSERT (array->elem_size == sizeof (void *));
 
   sc_array_resize (array, avl_count (avltree));
 
-  adata.iz = 0;
-  adata.array = array;
-  avl_foreach (avltree, avl_to_array_foreach, &adata);
-  SC_ASSERT (adata.iz == adata.array->elem_count);
+  /* the nodes are threaded in order */
+  iz = 0;
+  for (node = avltree->head; node != NULL; node = node->next) {
+    ((void **) array->array)[iz++] = node->item;
+  }
+  SC_ASSERT (iz == array->elem_count);
+}
+
+void
+avl_extract_array (avl_tree_t * avltree, sc_array_t * array)
+{
+  size_t              iz;
+  avl_node_t         *node, *next;
+
+  SC_ASSERT (array->elem_size == sizeof (void *));
+
+  sc_array_resize (array, avl_count (avltree));
+
+  iz = 0;
+  for (node = avltree->head; node != NULL; node = next) {
+    next = node->next;
+    ((void **) array->array)[iz++] = node->item;
+    avl_free_node (avltree, node);
+  }
+  SC_ASSERT (iz == array->elem_count);
+
+  avl_clear_tree (avltree);
+}
+
+unsigned int
+avl_rank (const avl_tree_t * avltree, const void *item)
+{
+  int                 c;
+  unsigned int        r;
+  avl_node_t         *node;
+
+  r = 0;
+  node = avltree->top;
+  while (node != NULL) {
+    c = avltree->cmp (item, node->item);
+    if (c <= 0) {
+      node = node->left;
+    }
+    else {
+      r += L_COUNT (node) + 1;
+      node = node->right;
+    }
+  }
+  return r;
 }
 
 #endif /* AVL_COUNT */
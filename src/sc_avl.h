@@ -87,6 +87,7 @@ typedef struct avl_tree_t {
 	avl_node_t *top;
 	avl_compare_t cmp;
 	avl_freeitem_t freeitem;
+	sc_mempool_t *allocator;
 } avl_tree_t;
 
 /* Initializes a new tree for elements that will be ordered using
@@ -101,6 +102,13 @@ extern avl_tree_t *avl_init_tree(avl_tree_t *avltree, avl_compare_t, avl_freeite
  * O(1) */
 extern avl_tree_t *avl_alloc_tree(avl_compare_t, avl_freeitem_t);
 
+/* Allocate the nodes of the tree from a memory pool created with
+ * sc_mempool_new (sizeof (avl_node_t)) or similar.  The pool is not owned
+ * by the tree and may be shared between trees.  The tree must be empty.
+ * If allocator is NULL, every node is allocated separately (the default).
+ * O(1) */
+extern void avl_set_allocator(avl_tree_t *, sc_mempool_t *allocator);
+
 /* Frees the entire tree efficiently. Nodes will be free()d.
  * If the tree's freeitem is not NULL it will be invoked on every item.
  * O(n) */
@@ -189,6 +197,12 @@ extern avl_node_t *avl_search(const avl_tree_t *, const void *item);
  * O(n) */
 extern void avl_foreach(avl_tree_t *, avl_foreach_t, void *);
 
+/* Builds a perfectly balanced tree from an array of void * items that
+ * are strictly increasing with respect to the tree's compare function.
+ * The tree must be empty.  The nodes are allocated in order.
+ * O(n) */
+extern void avl_from_array(avl_tree_t *, sc_array_t *items);
+
 #ifdef AVL_COUNT
 /* Returns the number of nodes in the tree.
  * O(1) */
@@ -203,10 +217,21 @@ extern avl_node_t *avl_at(const avl_tree_t *, unsigned int);
  * O(lg n) */
 extern unsigned int avl_index(const avl_node_t *);
 
+/* Returns the number of items in the tree that are smaller than item.
+ * The item need not be in the tree.  Together with avl_at, which
+ * selects an item by rank, this provides order statistics.
+ * O(lg n) */
+extern unsigned int avl_rank(const avl_tree_t *, const void *item);
+
 /* Copies all items into an array of void *.
 * O(n) */
 extern void avl_to_array (avl_tree_t *, sc_array_t *);
 
+/* Moves all items in order into an array of void * and frees all nodes.
+ * The tree's freeitem is not invoked.  On output the tree is empty.
+ * O(n) */
+extern void avl_extract_array (avl_tree_t *, sc_array_t *);
+
 #endif /* AVL_COUNT */
 
 SC_EXTERN_C_END;
@@ -0,0 +1,460 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_base64.h>
+
+#if defined (__x86_64__) && \
+  ((defined (__GNUC__) && __GNUC__ >= 5) || defined (__clang__))
+#define SC_BASE64_X86
+#include <immintrin.h>
+#endif
+
+static const char   sc_base64_alphabet[65] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* value of every code character and -1 for characters not in the alphabet */
+static const signed char sc_base64_values[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+  -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+  -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/** Encode a number of complete triples of bytes. */
+static void
+sc_base64_encode_scalar (const unsigned char *in, size_t num_triples,
+                         char *out)
+{
+  uint32_t            v;
+
+  for (; num_triples > 0; --num_triples) {
+    v = ((uint32_t) in[0] << 16) | ((uint32_t) in[1] << 8) | in[2];
+    out[0] = sc_base64_alphabet[v >> 18];
+    out[1] = sc_base64_alphabet[(v >> 12) & 0x3F];
+    out[2] = sc_base64_alphabet[(v >> 6) & 0x3F];
+    out[3] = sc_base64_alphabet[v & 0x3F];
+    in += 3;
+    out += 4;
+  }
+}
+
+/** Decode a number of complete groups of four code characters.
+ * \return              0 on success, -1 on an invalid character.
+ */
+static int
+sc_base64_decode_scalar (const unsigned char *in, size_t num_groups,
+                         unsigned char *out)
+{
+  int32_t             a, b, c, d;
+
+  for (; num_groups > 0; --num_groups) {
+    a = sc_base64_values[in[0]];
+    b = sc_base64_values[in[1]];
+    c = sc_base64_values[in[2]];
+    d = sc_base64_values[in[3]];
+    if ((a | b | c | d) < 0) {
+      return -1;
+    }
+    out[0] = (unsigned char) ((a << 2) | (b >> 4));
+    out[1] = (unsigned char) ((b << 4) | (c >> 2));
+    out[2] = (unsigned char) ((c << 6) | d);
+    in += 4;
+    out += 3;
+  }
+  return 0;
+}
+
+#ifdef SC_BASE64_X86
+
+/* The vector kernels follow the well-known approach by W. Mula and
+   D. Lemire: the input bytes are shuffled such that multiplications
+   move each 6-bit field into its own byte, and the translation between
+   6-bit values and characters adds an offset chosen per character range. */
+
+__attribute__ ((target ("ssse3")))
+static              __m128i
+sc_base64_encode_sse_lane (__m128i in)
+{
+  __m128i             t0, t1, t2, t3, idx, res, less;
+  const __m128i       lut = _mm_setr_epi8 ('a' - 26, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0);
+
+  in = _mm_shuffle_epi8 (in, _mm_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+  t0 = _mm_and_si128 (in, _mm_set1_epi32 (0x0fc0fc00));
+  t1 = _mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040));
+  t2 = _mm_and_si128 (in, _mm_set1_epi32 (0x003f03f0));
+  t3 = _mm_mullo_epi16 (t2, _mm_set1_epi32 (0x01000010));
+  idx = _mm_or_si128 (t1, t3);
+
+  res = _mm_subs_epu8 (idx, _mm_set1_epi8 (51));
+  less = _mm_cmpgt_epi8 (_mm_set1_epi8 (26), idx);
+  res = _mm_or_si128 (res, _mm_and_si128 (less, _mm_set1_epi8 (13)));
+  return _mm_add_epi8 (_mm_shuffle_epi8 (lut, res), idx);
+}
+
+/** Encode blocks of 12 bytes while 16 bytes may be loaded.
+ * \return              Number of bytes encoded.
+ */
+__attribute__ ((target ("ssse3")))
+static size_t
+sc_base64_encode_ssse3 (const unsigned char *in, size_t in_bytes, char *out)
+{
+  size_t              done = 0;
+
+  for (; done + 16 <= in_bytes; done += 12) {
+    _mm_storeu_si128 ((__m128i *) out, sc_base64_encode_sse_lane
+                      (_mm_loadu_si128 ((const __m128i *) (in + done))));
+    out += 16;
+  }
+  return done;
+}
+
+/** Translate 16 code characters to their values.
+ * \return              Nonzero if all characters are valid.
+ */
+__attribute__ ((target ("ssse3")))
+static int
+sc_base64_decode_sse_lane (__m128i in, __m128i * values)
+{
+  __m128i             az, lo, dg, pl, sl, shift;
+
+  az = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('A' - 1)),
+                      _mm_cmpgt_epi8 (_mm_set1_epi8 ('Z' + 1), in));
+  lo = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('a' - 1)),
+                      _mm_cmpgt_epi8 (_mm_set1_epi8 ('z' + 1), in));
+  dg = _mm_and_si128 (_mm_cmpgt_epi8 (in, _mm_set1_epi8 ('0' - 1)),
+                      _mm_cmpgt_epi8 (_mm_set1_epi8 ('9' + 1), in));
+  pl = _mm_cmpeq_epi8 (in, _mm_set1_epi8 ('+'));
+  sl = _mm_cmpeq_epi8 (in, _mm_set1_epi8 ('/'));
+  if (_mm_movemask_epi8 (_mm_or_si128 (_mm_or_si128 (az, lo),
+                                       _mm_or_si128 (_mm_or_si128 (dg, pl),
+                                                     sl))) != 0xFFFF) {
+    return 0;
+  }
+  shift = _mm_or_si128 (_mm_and_si128 (az, _mm_set1_epi8 (-'A')),
+                        _mm_and_si128 (lo, _mm_set1_epi8 (26 - 'a')));
+  shift = _mm_or_si128 (shift, _mm_and_si128 (dg, _mm_set1_epi8 (52 - '0')));
+  shift = _mm_or_si128 (shift, _mm_and_si128 (pl, _mm_set1_epi8 (62 - '+')));
+  shift = _mm_or_si128 (shift, _mm_and_si128 (sl, _mm_set1_epi8 (63 - '/')));
+  *values = _mm_add_epi8 (in, shift);
+  return 1;
+}
+
+/** Decode blocks of 4 groups while at least 2 more groups follow,
+ * since every block stores 4 bytes beyond its output.
+ * \return              Number of groups decoded, or -1 on error.
+ */
+__attribute__ ((target ("ssse3")))
+static long
+sc_base64_decode_ssse3 (const unsigned char *in, size_t in_groups,
+                        unsigned char *out)
+{
+  size_t              done = 0;
+  __m128i             v;
+
+  for (; done + 6 <= in_groups; done += 4) {
+    if (!sc_base64_decode_sse_lane
+        (_mm_loadu_si128 ((const __m128i *) (in + 4 * done)), &v)) {
+      return -1;
+    }
+    v = _mm_maddubs_epi16 (v, _mm_set1_epi32 (0x01400140));
+    v = _mm_madd_epi16 (v, _mm_set1_epi32 (0x00011000));
+    v = _mm_shuffle_epi8 (v, _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                            14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128 ((__m128i *) (out + 3 * done), v);
+  }
+  return (long) done;
+}
+
+__attribute__ ((target ("avx2")))
+static size_t
+sc_base64_encode_avx2 (const unsigned char *in, size_t in_bytes, char *out)
+{
+  size_t              done = 0;
+  __m256i             v, t0, t1, t2, t3, idx, res, less;
+  const __m256i       lut = _mm256_setr_epi8 ('a' - 26, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '+' - 62,
+                                              '/' - 63, 'A', 0, 0,
+                                              'a' - 26, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '+' - 62,
+                                              '/' - 63, 'A', 0, 0);
+  const __m256i       shuf = _mm256_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                              4, 5, 3, 4, 1, 2, 0, 1,
+                                              10, 11, 9, 10, 7, 8, 6, 7,
+                                              4, 5, 3, 4, 1, 2, 0, 1);
+
+  /* each 128-bit lane holds 12 input bytes */
+  for (; done + 28 <= in_bytes; done += 24) {
+    v = _mm256_inserti128_si256 (_mm256_castsi128_si256
+                                 (_mm_loadu_si128
+                                  ((const __m128i *) (in + done))),
+                                 _mm_loadu_si128
+                                 ((const __m128i *) (in + done + 12)), 1);
+    v = _mm256_shuffle_epi8 (v, shuf);
+    t0 = _mm256_and_si256 (v, _mm256_set1_epi32 (0x0fc0fc00));
+    t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+    t2 = _mm256_and_si256 (v, _mm256_set1_epi32 (0x003f03f0));
+    t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+    idx = _mm256_or_si256 (t1, t3);
+    res = _mm256_subs_epu8 (idx, _mm256_set1_epi8 (51));
+    less = _mm256_cmpgt_epi8 (_mm256_set1_epi8 (26), idx);
+    res = _mm256_or_si256 (res, _mm256_and_si256 (less,
+                                                  _mm256_set1_epi8 (13)));
+    _mm256_storeu_si256 ((__m256i *) out,
+                         _mm256_add_epi8 (_mm256_shuffle_epi8 (lut, res),
+                                          idx));
+    out += 32;
+  }
+  return done;
+}
+
+__attribute__ ((target ("avx2")))
+static long
+sc_base64_decode_avx2 (const unsigned char *in, size_t in_groups,
+                       unsigned char *out)
+{
+  size_t              done = 0;
+  __m256i             v, az, lo, dg, pl, sl, shift;
+
+  for (; done + 12 <= in_groups; done += 8) {
+    v = _mm256_loadu_si256 ((const __m256i *) (in + 4 * done));
+    az = _mm256_and_si256 (_mm256_cmpgt_epi8 (v, _mm256_set1_epi8 ('A' - 1)),
+                           _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('Z' + 1), v));
+    lo = _mm256_and_si256 (_mm256_cmpgt_epi8 (v, _mm256_set1_epi8 ('a' - 1)),
+                           _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('z' + 1), v));
+    dg = _mm256_and_si256 (_mm256_cmpgt_epi8 (v, _mm256_set1_epi8 ('0' - 1)),
+                           _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('9' + 1), v));
+    pl = _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('+'));
+    sl = _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('/'));
+    if (_mm256_movemask_epi8
+        (_mm256_or_si256 (_mm256_or_si256 (az, lo),
+                          _mm256_or_si256 (_mm256_or_si256 (dg, pl), sl)))
+        != -1) {
+      return -1;
+    }
+    shift = _mm256_or_si256
+      (_mm256_and_si256 (az, _mm256_set1_epi8 (-'A')),
+       _mm256_and_si256 (lo, _mm256_set1_epi8 (26 - 'a')));
+    shift = _mm256_or_si256
+      (shift, _mm256_and_si256 (dg, _mm256_set1_epi8 (52 - '0')));
+    shift = _mm256_or_si256
+      (shift, _mm256_and_si256 (pl, _mm256_set1_epi8 (62 - '+')));
+    shift = _mm256_or_si256
+      (shift, _mm256_and_si256 (sl, _mm256_set1_epi8 (63 - '/')));
+    v = _mm256_add_epi8 (v, shift);
+
+    /* pack 32 values into 24 bytes */
+    v = _mm256_maddubs_epi16 (v, _mm256_set1_epi32 (0x01400140));
+    v = _mm256_madd_epi16 (v, _mm256_set1_epi32 (0x00011000));
+    v = _mm256_shuffle_epi8 (v, _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                  14, 13, 12, -1, -1, -1, -1,
+                                                  2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                  14, 13, 12, -1, -1, -1,
+                                                  -1));
+    v = _mm256_permutevar8x32_epi32 (v, _mm256_setr_epi32 (0, 1, 2, 4, 5, 6,
+                                                           3, 7));
+    _mm256_storeu_si256 ((__m256i *) (out + 3 * done), v);
+  }
+  return (long) done;
+}
+
+#endif /* SC_BASE64_X86 */
+
+/** Encode the largest number of complete triples of the input.
+ * \return              Number of bytes encoded, a multiple of 3.
+ */
+static size_t
+sc_base64_encode_triples (const unsigned char *in, size_t in_bytes,
+                          char *out)
+{
+  size_t              done = 0;
+
+#ifdef SC_BASE64_X86
+  if (in_bytes >= 28 && __builtin_cpu_supports ("avx2")) {
+    done = sc_base64_encode_avx2 (in, in_bytes, out);
+  }
+  else if (in_bytes >= 16 && __builtin_cpu_supports ("ssse3")) {
+    done = sc_base64_encode_ssse3 (in, in_bytes, out);
+  }
+#endif
+  sc_base64_encode_scalar (in + done, (in_bytes - done) / 3,
+                           out + done / 3 * 4);
+  return in_bytes - (in_bytes - done) % 3;
+}
+
+void
+sc_base64_encode_init (sc_base64_state_t * state)
+{
+  SC_ASSERT (state != NULL);
+  state->num_carry = 0;
+}
+
+size_t
+sc_base64_encode_block (sc_base64_state_t * state,
+                        const void *in, size_t in_bytes, char *out)
+{
+  size_t              done, out_bytes = 0;
+  unsigned char       triple[3];
+  const unsigned char *pin = (const unsigned char *) in;
+
+  SC_ASSERT (state != NULL);
+  SC_ASSERT (0 <= state->num_carry && state->num_carry < 3);
+  SC_ASSERT (in != NULL || in_bytes == 0);
+
+  /* complete a triple from the bytes left over by the previous call */
+  if (state->num_carry > 0) {
+    if ((size_t) state->num_carry + in_bytes < 3) {
+      memcpy (state->carry + state->num_carry, pin, in_bytes);
+      state->num_carry += (int) in_bytes;
+      return 0;
+    }
+    memcpy (triple, state->carry, (size_t) state->num_carry);
+    memcpy (triple + state->num_carry, pin, (size_t) (3 - state->num_carry));
+    sc_base64_encode_scalar (triple, 1, out);
+    pin += 3 - state->num_carry;
+    in_bytes -= (size_t) (3 - state->num_carry);
+    out_bytes = 4;
+  }
+
+  /* encode the bulk and keep the rest */
+  done = sc_base64_encode_triples (pin, in_bytes, out + out_bytes);
+  out_bytes += done / 3 * 4;
+  state->num_carry = (int) (in_bytes - done);
+  memcpy (state->carry, pin + done, (size_t) state->num_carry);
+  return out_bytes;
+}
+
+size_t
+sc_base64_encode_blockend (sc_base64_state_t * state, char *out)
+{
+  unsigned char       triple[3];
+
+  SC_ASSERT (state != NULL);
+  SC_ASSERT (0 <= state->num_carry && state->num_carry < 3);
+
+  if (state->num_carry == 0) {
+    return 0;
+  }
+  triple[0] = state->carry[0];
+  triple[1] = state->num_carry > 1 ? state->carry[1] : 0;
+  triple[2] = 0;
+  sc_base64_encode_scalar (triple, 1, out);
+  memset (out + state->num_carry + 1, '=', (size_t) (3 - state->num_carry));
+  state->num_carry = 0;
+  return 4;
+}
+
+size_t
+sc_base64_encode (const void *in, size_t in_bytes, char *out)
+{
+  size_t              out_bytes;
+  sc_base64_state_t   state;
+
+  sc_base64_encode_init (&state);
+  out_bytes = sc_base64_encode_block (&state, in, in_bytes, out);
+  return out_bytes + sc_base64_encode_blockend (&state, out + out_bytes);
+}
+
+int
+sc_base64_decode (const char *in, size_t in_bytes, void *out,
+                  size_t *out_bytes)
+{
+  int32_t             a, b, c;
+  size_t              groups, done = 0;
+#ifdef SC_BASE64_X86
+  long                simd = 0;
+#endif
+  const unsigned char *pin = (const unsigned char *) in;
+  unsigned char      *pout = (unsigned char *) out;
+
+  SC_ASSERT (in != NULL || in_bytes == 0);
+  SC_ASSERT (out_bytes != NULL);
+  *out_bytes = 0;
+
+  /* remove the padding and check the length of the last group */
+  if (in_bytes > 0 && in_bytes % 4 == 0 && in[in_bytes - 1] == '=') {
+    in_bytes -= (in[in_bytes - 2] == '=') ? 2 : 1;
+  }
+  if (in_bytes % 4 == 1) {
+    return -1;
+  }
+  groups = in_bytes / 4;
+
+  /* decode complete groups */
+#ifdef SC_BASE64_X86
+  if (groups >= 12 && __builtin_cpu_supports ("avx2")) {
+    simd = sc_base64_decode_avx2 (pin, groups, pout);
+  }
+  else if (groups >= 6 && __builtin_cpu_supports ("ssse3")) {
+    simd = sc_base64_decode_ssse3 (pin, groups, pout);
+  }
+  if (simd < 0) {
+    return -1;
+  }
+  done = (size_t) simd;
+#endif
+  if (sc_base64_decode_scalar (pin + 4 * done, groups - done,
+                               pout + 3 * done)) {
+    return -1;
+  }
+
+  /* decode a final group of two or three characters */
+  pin += 4 * groups;
+  pout += 3 * groups;
+  *out_bytes = 3 * groups;
+  if (in_bytes % 4 >= 2) {
+    a = sc_base64_values[pin[0]];
+    b = sc_base64_values[pin[1]];
+    c = in_bytes % 4 == 3 ? sc_base64_values[pin[2]] : 0;
+    if ((a | b | c) < 0) {
+      return -1;
+    }
+    pout[0] = (unsigned char) ((a << 2) | (b >> 4));
+    *out_bytes += 1;
+    if (in_bytes % 4 == 3) {
+      pout[1] = (unsigned char) ((b << 4) | (c >> 2));
+      *out_bytes += 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#ifndef SC_BASE64_H
+#define SC_BASE64_H
+
+/** \file sc_base64.h
+ * Base 64 encoding and decoding (RFC 4648) for the I/O routines of libsc.
+ *
+ * The codec processes blocks of input with SSSE3 or AVX2 instructions
+ * where the processor supports them, which is determined at run time,
+ * and falls back to a table-driven scalar implementation otherwise.
+ * The output is the standard alphabet with '=' padding and no line breaks.
+ * It is identical to the output of the libb64 encoder used previously.
+ *
+ * This module is internal to libsc and its interface may change.
+ */
+
+#include <sc.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Number of code characters for a given number of bytes, with padding. */
+#define SC_BASE64_ENCODED_LENGTH(n) (4 * (((size_t) (n) + 2) / 3))
+
+/** State of a streaming base 64 encoder. */
+typedef struct sc_base64_state
+{
+  unsigned char       carry[2]; /**< bytes not yet encoded */
+  int                 num_carry;        /**< number of bytes in \a carry */
+}
+sc_base64_state_t;
+
+/** Initialize the state of a streaming base 64 encoder.
+ * \param [out] state       The state is ready to encode a new stream.
+ */
+void                sc_base64_encode_init (sc_base64_state_t * state);
+
+/** Encode a piece of a stream, keeping up to two bytes for later.
+ * \param [in,out] state    State initialized by \ref sc_base64_encode_init.
+ * \param [in] in           Bytes to encode.
+ * \param [in] in_bytes     Number of bytes to encode.
+ * \param [out] out         Room for \ref SC_BASE64_ENCODED_LENGTH
+ *                          of \a in_bytes characters.  Not terminated.
+ * \return                  Number of characters written.
+ */
+size_t              sc_base64_encode_block (sc_base64_state_t * state,
+                                            const void *in, size_t in_bytes,
+                                            char *out);
+
+/** Encode the bytes kept by the state and pad to a multiple of 4.
+ * The state is initialized for a new stream afterwards.
+ * \param [in,out] state    State of a streaming encoder.
+ * \param [out] out         Room for 4 characters.  Not terminated.
+ * \return                  Number of characters written.
+ */
+size_t              sc_base64_encode_blockend (sc_base64_state_t * state,
+                                               char *out);
+
+/** Encode a buffer with padding.
+ * \param [in] in           Bytes to encode.
+ * \param [in] in_bytes     Number of bytes to encode.
+ * \param [out] out         Room for \ref SC_BASE64_ENCODED_LENGTH
+ *                          of \a in_bytes characters.  Not terminated.
+ * \return                  Number of characters written.
+ */
+size_t              sc_base64_encode (const void *in, size_t in_bytes,
+                                      char *out);
+
+/** Decode a buffer of base 64 code with optional padding.
+ * The input must not contain line breaks or other characters outside
+ * the alphabet, except for up to two padding characters at the end.
+ * \param [in] in           Code characters.
+ * \param [in] in_bytes     Number of code characters.  If it is not a
+ *                          multiple of 4, the last group is taken as
+ *                          unpadded, which must not be a single character.
+ * \param [out] out         Room for 3 * ((\a in_bytes + 3) / 4) bytes.
+ * \param [out] out_bytes   Number of bytes decoded.  Must not be NULL.
+ * \return                  0 on success, -1 if the input is invalid.
+ */
+int                 sc_base64_decode (const char *in, size_t in_bytes,
+                                      void *out, size_t *out_bytes);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_BASE64_H */
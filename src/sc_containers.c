@@ -22,9 +22,20 @@
 */
 
 #include <sc_containers.h>
+#include <sc_uint128.h>
+#include <sc_io.h>
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef SC_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef SC_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 /* array routines */
 
@@ -434,18 +445,67 @@ sc_array_bsearch (sc_array_t * array, const void *key,
   return is;
 }
 
-void
-sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
-                sc_array_type_t type_fn, void *data)
+/* the type of an element is computed by a callback */
+#define SC_ARRAY_SPLIT_FN (-1)
+
+typedef struct sc_array_split_info
+{
+  sc_array_t         *array;    /**< Array to split. */
+  size_t              num_types;        /**< Number of types. */
+  int                 key_type; /**< SC_ARRAY_SPLIT_FN or a sc_array_key_t */
+  sc_array_type_t     type_fn;  /**< Callback for SC_ARRAY_SPLIT_FN. */
+  void               *data;     /**< User data for the callback. */
+  size_t              key_offset;       /**< Byte offset of integer keys. */
+  int                 shift;    /**< Right shift of integer keys. */
+}
+sc_array_split_info_t;
+
+static inline       size_t
+sc_array_split_type (const sc_array_split_info_t * si, size_t index)
+{
+  const size_t        mask = si->num_types - 1;
+  const char         *key;
+  uint32_t            u32;
+  uint64_t            u64;
+  sc_uint128_t        u128;
+
+  if (si->key_type == SC_ARRAY_SPLIT_FN) {
+    return si->type_fn (si->array, index, si->data);
+  }
+
+  /* the keys may be unaligned within the elements */
+  key = si->array->array + index * si->array->elem_size + si->key_offset;
+  switch (si->key_type) {
+  case SC_ARRAY_KEY_UINT32:
+    memcpy (&u32, key, sizeof (uint32_t));
+    return (size_t) (u32 >> si->shift) & mask;
+  case SC_ARRAY_KEY_UINT64:
+    memcpy (&u64, key, sizeof (uint64_t));
+    return (size_t) (u64 >> si->shift) & mask;
+  default:
+    SC_ASSERT (si->key_type == SC_ARRAY_KEY_UINT128);
+    memcpy (&u128, key, sizeof (sc_uint128_t));
+    if (si->shift >= 64) {
+      return (size_t) (u128.high_bits >> (si->shift - 64)) & mask;
+    }
+    u64 = u128.low_bits >> si->shift;
+    if (si->shift > 0) {
+      u64 |= u128.high_bits << (64 - si->shift);
+    }
+    return (size_t) u64 & mask;
+  }
+}
+
+/* Split the elements [first, first + count) and write num_types + 1
+ * offsets relative to first. */
+static inline void
+sc_array_split_core (const sc_array_split_info_t * si, size_t first,
+                     size_t count, size_t * offsets)
 {
-  const size_t        count = array->elem_count;
-  size_t              zi, *zp;
+  const size_t        num_types = si->num_types;
+  size_t              zi;
   size_t              guess, low, high, type, step;
 
-  SC_ASSERT (offsets->elem_size == sizeof (size_t));
-
-  sc_array_resize (offsets, num_types + 1);
-
   /** The point of this algorithm is to put offsets[i] into its final position
    * for i = 0,...,num_types, where the final position of offsets[i] is the
    * unique index k such that type_fn (array, j, data) < i for all j < k
@@ -467,11 +527,9 @@ sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
    * Initializing offsets[0] = 0, offsets[i] = count for i > 0,
    * low = 0, and step = 1, the invariants are trivially satisfied.
    */
-  zp = (size_t *) sc_array_index (offsets, 0);
-  *zp = 0;
+  offsets[0] = 0;
   for (zi = 1; zi <= num_types; zi++) {
-    zp = (size_t *) sc_array_index (offsets, zi);
-    *zp = count;
+    offsets[zi] = count;
   }
 
   if (count == 0 || num_types <= 1) {
@@ -487,7 +545,7 @@ sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
   step = 1;
   for (;;) {
     guess = low + (high - low) / 2;     /* By (7) low <= guess < high. */
-    type = type_fn (array, guess, data);
+    type = sc_array_split_type (si, first + guess);
     SC_ASSERT (type < num_types);
     /** If type < step, then we can set low = guess + 1 and still satisfy
      * invariant (4).  Also, because guess < high, we are assured low <= high.
@@ -501,8 +559,7 @@ sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
      */
     else {
       for (zi = step; zi <= type; zi++) {
-        zp = (size_t *) sc_array_index (offsets, zi);
-        *zp = guess;
+        offsets[zi] = guess;
       }
       high = guess;             /* high = offsets[step] */
     }
@@ -512,8 +569,8 @@ sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
      */
     while (low == high) {
       /* By invariant (6), high cannot decrease here */
-      ++step;                   /* sc_array_index might be a macro */
-      high = *((size_t *) sc_array_index (offsets, step));
+      ++step;
+      high = offsets[step];
       /** If step = num_types, then by invariant (1) we have found the final
        * positions for offsets[i] for i < num_types, and offsets[num_types] =
        * count in all situations, so we are done.
@@ -528,6 +585,140 @@ sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
   }
 }
 
+void
+sc_array_split (sc_array_t * array, sc_array_t * offsets, size_t num_types,
+                sc_array_type_t type_fn, void *data)
+{
+  sc_array_split_info_t si;
+
+  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+
+  sc_array_resize (offsets, num_types + 1);
+
+  si.array = array;
+  si.num_types = num_types;
+  si.key_type = SC_ARRAY_SPLIT_FN;
+  si.type_fn = type_fn;
+  si.data = data;
+  sc_array_split_core (&si, 0, array->elem_count, (size_t *) offsets->array);
+}
+
+static void
+sc_array_split_key_info (sc_array_split_info_t * si, sc_array_t * array,
+                         size_t num_types, sc_array_key_t key_type,
+                         size_t key_offset, int shift)
+{
+  SC_ASSERT (num_types > 0 && (num_types & (num_types - 1)) == 0);
+  SC_ASSERT (shift >= 0);
+  SC_ASSERT (key_type != SC_ARRAY_KEY_UINT32 ||
+             (shift < 32 && key_offset + sizeof (uint32_t) <=
+              array->elem_size));
+  SC_ASSERT (key_type != SC_ARRAY_KEY_UINT64 ||
+             (shift < 64 && key_offset + sizeof (uint64_t) <=
+              array->elem_size));
+  SC_ASSERT (key_type != SC_ARRAY_KEY_UINT128 ||
+             (shift < 128 && key_offset + sizeof (sc_uint128_t) <=
+              array->elem_size));
+
+  si->array = array;
+  si->num_types = num_types;
+  si->key_type = (int) key_type;
+  si->type_fn = NULL;
+  si->data = NULL;
+  si->key_offset = key_offset;
+  si->shift = shift;
+}
+
+/* instantiate the split for one key type to evaluate it inline */
+#define SC_ARRAY_SPLIT_KEY_CASE(kt,si,first,count,offsets)     \
+  case kt:                                                      \
+    local = *(si);                                              \
+    local.key_type = kt;                                        \
+    sc_array_split_core (&local, first, count, offsets);        \
+    break
+
+static void
+sc_array_split_key_range (const sc_array_split_info_t * si, size_t first,
+                          size_t count, size_t * offsets)
+{
+  sc_array_split_info_t local;
+
+  switch (si->key_type) {
+    SC_ARRAY_SPLIT_KEY_CASE (SC_ARRAY_KEY_UINT32, si, first, count, offsets);
+    SC_ARRAY_SPLIT_KEY_CASE (SC_ARRAY_KEY_UINT64, si, first, count, offsets);
+    SC_ARRAY_SPLIT_KEY_CASE (SC_ARRAY_KEY_UINT128, si, first, count, offsets);
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+void
+sc_array_split_key (sc_array_t * array, sc_array_t * offsets,
+                    size_t num_types, sc_array_key_t key_type,
+                    size_t key_offset, int shift)
+{
+  sc_array_split_info_t si;
+
+  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+
+  sc_array_resize (offsets, num_types + 1);
+
+  sc_array_split_key_info (&si, array, num_types, key_type, key_offset,
+                           shift);
+  sc_array_split_key_range (&si, 0, array->elem_count,
+                            (size_t *) offsets->array);
+}
+
+void
+sc_array_split_key_multi (sc_array_t * array, sc_array_t * bounds,
+                          sc_array_t * offsets, size_t num_types,
+                          sc_array_key_t key_type, size_t key_offset,
+                          int shift)
+{
+  size_t              num_sub;
+  long                ls;
+  const size_t       *bnd;
+  size_t             *off;
+  sc_array_split_info_t si;
+
+  SC_ASSERT (bounds->elem_size == sizeof (size_t));
+  SC_ASSERT (bounds->elem_count > 0);
+  SC_ASSERT (offsets->elem_size == sizeof (size_t));
+
+  /* the offsets of each subarray are computed on the stack */
+  SC_CHECK_ABORT (num_types <= SC_ARRAY_SPLIT_MAX_TYPES,
+                  "Too many types for sc_array_split_key_multi");
+
+  num_sub = bounds->elem_count - 1;
+  sc_array_resize (offsets, num_sub * num_types + 1);
+  bnd = (const size_t *) bounds->array;
+  off = (size_t *) offsets->array;
+  SC_ASSERT (bnd[num_sub] <= array->elem_count);
+
+  sc_array_split_key_info (&si, array, num_types, key_type, key_offset,
+                           shift);
+
+  /* The subarrays are independent: each writes num_types + 1 offsets,
+   * of which the last one overlaps with the first of the next subarray
+   * and is equal to it.  We write it only for the last subarray. */
+  off[num_sub * num_types] = bnd[num_sub];
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+  for (ls = 0; ls < (long) num_sub; ++ls) {
+    size_t              zi;
+    size_t              first = bnd[ls];
+    size_t              sub[SC_ARRAY_SPLIT_MAX_TYPES + 1];
+    size_t             *o = off + (size_t) ls * num_types;
+
+    SC_ASSERT (first <= bnd[ls + 1]);
+    sc_array_split_key_range (&si, first, bnd[ls + 1] - first, sub);
+    for (zi = 0; zi < num_types; ++zi) {
+      o[zi] = first + sub[zi];
+    }
+  }
+}
+
 int
 sc_array_is_permutation (sc_array_t * newindices)
 {
@@ -628,6 +819,142 @@ sc_array_permute (sc_array_t * array, sc_array_t * newindices, int keepperm)
   SC_FREE (temp);
 }
 
+/** Number of elements copied per block by gather and scatter. */
+#define SC_ARRAY_GATHER_BLOCK 1024
+
+void
+sc_array_permute_multi (sc_array_t ** arrays, size_t num_arrays,
+                        sc_array_t * newindices)
+{
+  const size_t        count = newindices->elem_count;
+  const size_t        nblocks =
+    (count + SC_ARRAY_GATHER_BLOCK - 1) / SC_ARRAY_GATHER_BLOCK;
+  long                lb;
+  size_t              za, zi;
+  size_t             *newind, *oldind;
+  char              **buffers;
+  sc_array_t         *a;
+
+  SC_ASSERT (newindices->elem_size == sizeof (size_t));
+  SC_ASSERT (sc_array_is_permutation (newindices));
+  if (!count || !num_arrays) {
+    return;
+  }
+
+  /* invert the permutation to write the destination in order */
+  newind = (size_t *) newindices->array;
+  oldind = SC_ALLOC (size_t, count);
+  for (zi = 0; zi < count; ++zi) {
+    oldind[newind[zi]] = zi;
+  }
+  buffers = SC_ALLOC (char *, num_arrays);
+  for (za = 0; za < num_arrays; ++za) {
+    SC_ASSERT (arrays[za]->elem_count == count);
+    buffers[za] = SC_ALLOC (char, count * arrays[za]->elem_size);
+  }
+
+  /* a block of inverse indices is reused for all arrays */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (lb = 0; lb < (long) nblocks; ++lb) {
+    size_t              zb, zj, esize;
+    const size_t        first = (size_t) lb * SC_ARRAY_GATHER_BLOCK;
+    const size_t        last = SC_MIN (first + SC_ARRAY_GATHER_BLOCK, count);
+    const char         *src;
+    char               *dest;
+
+    for (zb = 0; zb < num_arrays; ++zb) {
+      esize = arrays[zb]->elem_size;
+      src = arrays[zb]->array;
+      dest = buffers[zb];
+      for (zj = first; zj < last; ++zj) {
+        memcpy (dest + zj * esize, src + oldind[zj] * esize, esize);
+      }
+    }
+  }
+
+  /* arrays that own their memory take over the buffer */
+  for (za = 0; za < num_arrays; ++za) {
+    a = arrays[za];
+    if (SC_ARRAY_IS_OWNER (a)) {
+      SC_FREE (a->array);
+      a->array = buffers[za];
+      a->byte_alloc = (ssize_t) (count * a->elem_size);
+    }
+    else {
+      memcpy (a->array, buffers[za], count * a->elem_size);
+      SC_FREE (buffers[za]);
+    }
+  }
+  SC_FREE (buffers);
+  SC_FREE (oldind);
+}
+
+void
+sc_array_gather (sc_array_t * dest, sc_array_t * src, sc_array_t * indices)
+{
+  const size_t        esize = src->elem_size;
+  const size_t        count = indices->elem_count;
+  const size_t        nblocks =
+    (count + SC_ARRAY_GATHER_BLOCK - 1) / SC_ARRAY_GATHER_BLOCK;
+  const size_t       *ind = (const size_t *) indices->array;
+  long                lb;
+
+  SC_ASSERT (dest != src);
+  SC_ASSERT (dest->elem_size == esize);
+  SC_ASSERT (indices->elem_size == sizeof (size_t));
+
+  if (SC_ARRAY_IS_OWNER (dest)) {
+    sc_array_resize (dest, count);
+  }
+  SC_ASSERT (dest->elem_count == count);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (lb = 0; lb < (long) nblocks; ++lb) {
+    size_t              zj;
+    const size_t        first = (size_t) lb * SC_ARRAY_GATHER_BLOCK;
+    const size_t        last = SC_MIN (first + SC_ARRAY_GATHER_BLOCK, count);
+
+    for (zj = first; zj < last; ++zj) {
+      SC_ASSERT (ind[zj] < src->elem_count);
+      memcpy (dest->array + zj * esize, src->array + ind[zj] * esize, esize);
+    }
+  }
+}
+
+void
+sc_array_scatter (sc_array_t * dest, sc_array_t * src, sc_array_t * indices)
+{
+  const size_t        esize = src->elem_size;
+  const size_t        count = indices->elem_count;
+  const size_t        nblocks =
+    (count + SC_ARRAY_GATHER_BLOCK - 1) / SC_ARRAY_GATHER_BLOCK;
+  const size_t       *ind = (const size_t *) indices->array;
+  long                lb;
+
+  SC_ASSERT (dest != src);
+  SC_ASSERT (dest->elem_size == esize);
+  SC_ASSERT (indices->elem_size == sizeof (size_t));
+  SC_ASSERT (src->elem_count == count);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (lb = 0; lb < (long) nblocks; ++lb) {
+    size_t              zj;
+    const size_t        first = (size_t) lb * SC_ARRAY_GATHER_BLOCK;
+    const size_t        last = SC_MIN (first + SC_ARRAY_GATHER_BLOCK, count);
+
+    for (zj = first; zj < last; ++zj) {
+      SC_ASSERT (ind[zj] < dest->elem_count);
+      memcpy (dest->array + ind[zj] * esize, src->array + zj * esize, esize);
+    }
+  }
+}
+
 unsigned int
 sc_array_checksum (sc_array_t * array)
 {
@@ -652,6 +979,17 @@ sc_array_checksum (sc_array_t * array)
 #endif
 }
 
+uint32_t
+sc_array_checksum_ext (sc_array_t * array, sc_array_checksum_type_t type)
+{
+  if (type == SC_ARRAY_CHECKSUM_CRC32C) {
+    return sc_io_crc32c (0, array->array,
+                         array->elem_count * array->elem_size);
+  }
+  SC_ASSERT (type == SC_ARRAY_CHECKSUM_ADLER32);
+  return (uint32_t) sc_array_checksum (array);
+}
+
 size_t
 sc_array_pqueue_add (sc_array_t * array, void *temp,
                      int (*compar) (const void *, const void *))
@@ -766,29 +1104,111 @@ sc_array_pqueue_pop (sc_array_t * array, void *result,
 
 /* memory stamp routines */
 
+#if defined SC_HAVE_SYS_MMAN_H && defined MAP_ANONYMOUS
+#define SC_MSTAMP_MMAP
+#endif
+
+/* alignment and granularity of stamps backed by huge pages */
+#define SC_MSTAMP_HUGE_BYTES ((size_t) 1 << 21)
+
+/* stride for touching the pages of a fresh stamp */
+#define SC_MSTAMP_TOUCH_BYTES ((size_t) 4096)
+
+static void
+sc_mstamp_touch (sc_mstamp_t * mst, char *stamp)
+{
+  size_t              zz;
+
+  for (zz = 0; zz < mst->map_size; zz += SC_MSTAMP_TOUCH_BYTES) {
+    stamp[zz] = 0;
+  }
+}
+
 static void
 sc_mstamp_stamp (sc_mstamp_t * mst)
 {
+  char               *stamp;
+#ifdef SC_MSTAMP_MMAP
+  size_t              align, lead;
+#endif
+
   SC_ASSERT (mst != NULL);
   SC_ASSERT (mst->elem_size > 0);
   SC_ASSERT (mst->stamp_size > 0);
 
-  /* make new stamp; the pointer is aligned to any builtin type */
+#ifdef SC_MSTAMP_MMAP
+  if (mst->map_size > 0) {
+    /* map anonymous memory, over-allocating to align huge pages */
+    align = (mst->flags & SC_MSTAMP_HUGEPAGE) ? SC_MSTAMP_HUGE_BYTES : 0;
+    stamp = (char *) mmap (NULL, mst->map_size + align,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    SC_CHECK_ABORT (stamp != (char *) MAP_FAILED, "Memory stamp mmap");
+    if (align > 0) {
+      lead = (align - (size_t) ((uintptr_t) stamp % align)) % align;
+      if (lead > 0) {
+        munmap (stamp, lead);
+      }
+      if (align - lead > 0) {
+        munmap (stamp + lead + mst->map_size, align - lead);
+      }
+      stamp += lead;
+#ifdef MADV_HUGEPAGE
+      (void) madvise (stamp, mst->map_size, MADV_HUGEPAGE);
+#endif
+    }
+    if (mst->flags & SC_MSTAMP_FIRST_TOUCH) {
+      sc_mstamp_touch (mst, stamp);
+    }
+  }
+  else
+#endif
+  {
+    /* the pointer is aligned to any builtin type */
+    stamp = SC_ALLOC (char, mst->stamp_size);
+  }
+
+  /* make new stamp */
   mst->cur_snext = 0;
-  *(void **) sc_array_push (&mst->remember) =
-    mst->current = SC_ALLOC (char, mst->stamp_size);
+  *(void **) sc_array_push (&mst->remember) = mst->current = stamp;
+}
+
+static void
+sc_mstamp_release (sc_mstamp_t * mst, void *stamp)
+{
+#ifdef SC_MSTAMP_MMAP
+  if (mst->map_size > 0) {
+    munmap (stamp, mst->map_size);
+    return;
+  }
+#endif
+  SC_FREE (stamp);
 }
 
 void
 sc_mstamp_init (sc_mstamp_t * mst, size_t stamp_unit, size_t elem_size)
+{
+  sc_mstamp_init_flags (mst, stamp_unit, elem_size, 0);
+}
+
+void
+sc_mstamp_init_flags (sc_mstamp_t * mst, size_t stamp_unit,
+                      size_t elem_size, int flags)
 {
   SC_ASSERT (mst != NULL);
 
   /* basic initialization */
   memset (mst, 0, sizeof (sc_mstamp_t));
   mst->elem_size = elem_size;
+  mst->flags = flags;
   sc_array_init (&mst->remember, sizeof (void *));
 
+  /* huge page stamps span a whole number of huge pages */
+  if (flags & SC_MSTAMP_HUGEPAGE) {
+    stamp_unit = SC_MAX (stamp_unit, SC_MSTAMP_HUGE_BYTES);
+    stamp_unit -= stamp_unit % SC_MSTAMP_HUGE_BYTES;
+  }
+
   /* how many items per stamp we use */
   if (elem_size > 0) {
     mst->per_stamp = stamp_unit / elem_size;
@@ -797,6 +1217,15 @@ sc_mstamp_init (sc_mstamp_t * mst, size_t stamp_unit, size_t elem_size)
       mst->per_stamp = 1;
     }
     mst->stamp_size = mst->per_stamp * elem_size;
+#ifdef SC_MSTAMP_MMAP
+    if (flags & SC_MSTAMP_HUGEPAGE) {
+      mst->map_size = SC_MSTAMP_HUGE_BYTES *
+        ((mst->stamp_size + SC_MSTAMP_HUGE_BYTES - 1) / SC_MSTAMP_HUGE_BYTES);
+    }
+    else if (flags & SC_MSTAMP_FIRST_TOUCH) {
+      mst->map_size = mst->stamp_size;
+    }
+#endif
     sc_mstamp_stamp (mst);
   }
 }
@@ -811,7 +1240,7 @@ sc_mstamp_reset (sc_mstamp_t * mst)
   /* free all memory stamps we have created */
   znum = mst->remember.elem_count;
   for (zz = 0; zz < znum; zz++) {
-    SC_FREE (*(void **) sc_array_index (&mst->remember, zz));
+    sc_mstamp_release (mst, *(void **) sc_array_index (&mst->remember, zz));
   }
   sc_array_reset (&mst->remember);
 }
@@ -819,6 +1248,29 @@ sc_mstamp_reset (sc_mstamp_t * mst)
 void
 sc_mstamp_truncate (sc_mstamp_t * mst)
 {
+#ifdef SC_MSTAMP_MMAP
+  size_t              znum, zz;
+
+  if (mst->map_size > 0 && mst->remember.elem_count > 0) {
+    /* unmap all but the first stamp and return its pages to the OS */
+    znum = mst->remember.elem_count;
+    for (zz = 1; zz < znum; zz++) {
+      sc_mstamp_release (mst, *(void **)
+                         sc_array_index (&mst->remember, zz));
+    }
+    sc_array_resize (&mst->remember, 1);
+    mst->current = *(char **) sc_array_index (&mst->remember, 0);
+    mst->cur_snext = 0;
+#ifdef MADV_DONTNEED
+    (void) madvise (mst->current, mst->map_size, MADV_DONTNEED);
+#endif
+    if (mst->flags & SC_MSTAMP_FIRST_TOUCH) {
+      sc_mstamp_touch (mst, mst->current);
+    }
+    return;
+  }
+#endif
+
   /* free all memory in structure; the array mst->remember will be legal */
   sc_mstamp_reset (mst);
 
@@ -860,43 +1312,141 @@ sc_mstamp_memory_used (sc_mstamp_t * mst)
   SC_ASSERT (mst != NULL);
 
   s = sizeof (sc_mstamp_t);
-  s += mst->remember.elem_count * mst->stamp_size;
+  s += mst->remember.elem_count *
+    (mst->map_size > 0 ? mst->map_size : mst->stamp_size);
   s += sc_array_memory_used (&mst->remember, 0);
   return s;
 }
 
+size_t
+sc_mstamp_memory_resident (sc_mstamp_t * mst)
+{
+#if defined SC_MSTAMP_MMAP && defined SC_HAVE_UNISTD_H
+  size_t              s, zz, iz;
+  size_t              page, npages;
+  unsigned char      *vec;
+
+  SC_ASSERT (mst != NULL);
+
+  if (mst->map_size == 0 || mst->remember.elem_count == 0) {
+    return sc_mstamp_memory_used (mst);
+  }
+
+  /* query which pages of the mapped stamps are in core */
+  page = (size_t) sysconf (_SC_PAGESIZE);
+  npages = (mst->map_size + page - 1) / page;
+  vec = SC_ALLOC (unsigned char, npages);
+  s = sizeof (sc_mstamp_t) + sc_array_memory_used (&mst->remember, 0);
+  for (zz = 0; zz < mst->remember.elem_count; zz++) {
+    if (mincore (*(void **) sc_array_index (&mst->remember, zz),
+                 mst->map_size, (void *) vec) != 0) {
+      s += mst->map_size;
+      continue;
+    }
+    for (iz = 0; iz < npages; iz++) {
+      if (vec[iz] & 1) {
+        s += page;
+      }
+    }
+  }
+  SC_FREE (vec);
+  return s;
+#else
+  return sc_mstamp_memory_used (mst);
+#endif
+}
+
 /* mempool routines */
 
+/* default size in bytes of the memory stamps of a mempool */
+#define SC_MEMPOOL_STAMP_UNIT 4096
+
+/* number of element pointers cached per thread */
+#define SC_MEMPOOL_MAGAZINE 64
+
+/* a thread exchanges this many elements with the depot at a time */
+#define SC_MEMPOOL_BATCH (SC_MEMPOOL_MAGAZINE / 2)
+
+typedef struct sc_mempool_magazine
+{
+  size_t              count;    /**< Number of cached elements. */
+  void               *elems[SC_MEMPOOL_MAGAZINE];       /**< The elements. */
+}
+sc_mempool_magazine_t;
+
+/* The depot shared by all threads is the freed array of the mempool. */
+struct sc_mempool_threads
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_key_t       key;      /**< Maps a thread to its magazine. */
+  pthread_mutex_t     mutex;    /**< Protects depot, stamps and magazines. */
+#endif
+  sc_array_t          magazines;        /**< Array of magazine pointers. */
+};
+
+static size_t
+sc_mempool_memory_ext (sc_mempool_t * mempool, int resident)
+{
+  size_t              used;
+
+  used = sizeof (sc_mempool_t) +
+    (resident ? sc_mstamp_memory_resident (&mempool->mstamp) :
+     sc_mstamp_memory_used (&mempool->mstamp)) +
+    sc_array_memory_used (&mempool->freed, 0);
+  if (mempool->threads != NULL) {
+    used += sizeof (struct sc_mempool_threads) +
+      sc_array_memory_used (&mempool->threads->magazines, 0) +
+      mempool->threads->magazines.elem_count *
+      sizeof (sc_mempool_magazine_t);
+  }
+  return used;
+}
+
 size_t
 sc_mempool_memory_used (sc_mempool_t * mempool)
 {
-  return sizeof (sc_mempool_t) +
-    sc_mstamp_memory_used (&mempool->mstamp) +
-    sc_array_memory_used (&mempool->freed, 0);
+  return sc_mempool_memory_ext (mempool, 0);
+}
+
+size_t
+sc_mempool_memory_resident (sc_mempool_t * mempool)
+{
+  return sc_mempool_memory_ext (mempool, 1);
 }
 
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static void
 sc_mempool_init_ext (sc_mempool_t * mempool, size_t elem_size,
-                     int zero_and_persist)
+                     int zero_and_persist, size_t stamp_unit,
+                     int mstamp_flags)
 {
+  size_t              item_size = elem_size;
+
   mempool->elem_size = elem_size;
   mempool->elem_count = 0;
   mempool->zero_and_persist = zero_and_persist;
 
-  sc_mstamp_init (&mempool->mstamp, 4096, elem_size);
+  /* freed elements must be able to hold the free list link */
+  if (!zero_and_persist && item_size > 0 && item_size < sizeof (void *)) {
+    item_size = sizeof (void *);
+  }
+  sc_mstamp_init_flags (&mempool->mstamp, stamp_unit, item_size,
+                        mstamp_flags);
   sc_array_init (&mempool->freed, sizeof (void *));
+  mempool->free_list = NULL;
+  mempool->threads = NULL;
 }
 
 void
 sc_mempool_init (sc_mempool_t * mempool, size_t elem_size)
 {
-  sc_mempool_init_ext (mempool, elem_size, 0);
+  sc_mempool_init_ext (mempool, elem_size, 0, SC_MEMPOOL_STAMP_UNIT, 0);
 }
 
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static sc_mempool_t *
-sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
+sc_mempool_new_ext (size_t elem_size, int zero_and_persist,
+                    size_t stamp_unit, int mstamp_flags)
 {
   sc_mempool_t       *mempool;
 
@@ -904,7 +1454,8 @@ sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
 
   mempool = SC_ALLOC (sc_mempool_t, 1);
 
-  sc_mempool_init_ext (mempool, elem_size, zero_and_persist);
+  sc_mempool_init_ext (mempool, elem_size, zero_and_persist,
+                       stamp_unit, mstamp_flags);
 
   return mempool;
 }
@@ -912,20 +1463,195 @@ sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
 sc_mempool_t       *
 sc_mempool_new (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 0);
+  return sc_mempool_new_ext (elem_size, 0, SC_MEMPOOL_STAMP_UNIT, 0);
 }
 
 sc_mempool_t       *
 sc_mempool_new_zero_and_persist (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 1);
+  return sc_mempool_new_ext (elem_size, 1, SC_MEMPOOL_STAMP_UNIT, 0);
+}
+
+sc_mempool_t       *
+sc_mempool_new_stamp (size_t elem_size, int zero_and_persist,
+                      size_t stamp_unit, int mstamp_flags)
+{
+  return sc_mempool_new_ext (elem_size, zero_and_persist,
+                             stamp_unit, mstamp_flags);
+}
+
+sc_mempool_t       *
+sc_mempool_new_threadsafe (size_t elem_size)
+{
+  sc_mempool_t       *mempool;
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+  struct sc_mempool_threads *mt;
+#endif
+
+  mempool = sc_mempool_new_ext (elem_size, 0, SC_MEMPOOL_STAMP_UNIT, 0);
+
+#ifdef SC_ENABLE_PTHREAD
+  mt = mempool->threads = SC_ALLOC (struct sc_mempool_threads, 1);
+  pth = pthread_key_create (&mt->key, NULL);
+  SC_CHECK_ABORT (pth == 0, "Mempool thread key");
+  pth = pthread_mutex_init (&mt->mutex, NULL);
+  SC_CHECK_ABORT (pth == 0, "Mempool thread mutex");
+  sc_array_init (&mt->magazines, sizeof (sc_mempool_magazine_t *));
+#endif
+
+  return mempool;
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+static sc_mempool_magazine_t *
+sc_mempool_magazine (sc_mempool_t * mempool)
+{
+  struct sc_mempool_threads *mt = mempool->threads;
+  sc_mempool_magazine_t *mag;
+
+  mag = (sc_mempool_magazine_t *) pthread_getspecific (mt->key);
+  if (mag == NULL) {
+    mag = SC_ALLOC (sc_mempool_magazine_t, 1);
+    mag->count = 0;
+    pthread_mutex_lock (&mt->mutex);
+    *(sc_mempool_magazine_t **) sc_array_push (&mt->magazines) = mag;
+    pthread_mutex_unlock (&mt->mutex);
+    pthread_setspecific (mt->key, mag);
+  }
+  return mag;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+void               *
+sc_mempool_alloc_threadsafe (sc_mempool_t * mempool)
+{
+#ifdef SC_ENABLE_PTHREAD
+  size_t              zz, take;
+  void               *ret;
+  sc_array_t         *freed = &mempool->freed;
+  sc_mempool_magazine_t *mag;
+
+  SC_ASSERT (mempool->threads != NULL);
+
+  mag = sc_mempool_magazine (mempool);
+  if (mag->count == 0) {
+    /* refill half of the magazine from the depot and then from stamps */
+    pthread_mutex_lock (&mempool->threads->mutex);
+    take = SC_MIN (freed->elem_count, (size_t) SC_MEMPOOL_BATCH);
+    freed->elem_count -= take;
+    memcpy (mag->elems, freed->array + freed->elem_count * sizeof (void *),
+            take * sizeof (void *));
+    for (zz = take; zz < SC_MEMPOOL_BATCH; ++zz) {
+      mag->elems[zz] = sc_mstamp_alloc (&mempool->mstamp);
+    }
+    mempool->elem_count += SC_MEMPOOL_BATCH;
+    pthread_mutex_unlock (&mempool->threads->mutex);
+    mag->count = SC_MEMPOOL_BATCH;
+  }
+  ret = mag->elems[--mag->count];
+
+#ifdef SC_ENABLE_DEBUG
+  memset (ret, -1, mempool->elem_size);
+#endif
+
+  return ret;
+#else
+  SC_ABORT_NOT_REACHED ();
+#endif
+}
+
+void
+sc_mempool_free_threadsafe (sc_mempool_t * mempool, void *elem)
+{
+#ifdef SC_ENABLE_PTHREAD
+  sc_array_t         *freed = &mempool->freed;
+  sc_mempool_magazine_t *mag;
+
+  SC_ASSERT (mempool->threads != NULL);
+
+#ifdef SC_ENABLE_DEBUG
+  memset (elem, -1, mempool->elem_size);
+#endif
+
+  mag = sc_mempool_magazine (mempool);
+  if (mag->count == SC_MEMPOOL_MAGAZINE) {
+    /* drain the older half of the magazine into the depot */
+    pthread_mutex_lock (&mempool->threads->mutex);
+    SC_ASSERT (mempool->elem_count >= SC_MEMPOOL_BATCH);
+    memcpy (sc_array_push_count (freed, SC_MEMPOOL_BATCH), mag->elems,
+            SC_MEMPOOL_BATCH * sizeof (void *));
+    mempool->elem_count -= SC_MEMPOOL_BATCH;
+    pthread_mutex_unlock (&mempool->threads->mutex);
+    memmove (mag->elems, mag->elems + SC_MEMPOOL_BATCH,
+             (SC_MEMPOOL_MAGAZINE - SC_MEMPOOL_BATCH) * sizeof (void *));
+    mag->count -= SC_MEMPOOL_BATCH;
+  }
+  mag->elems[mag->count++] = elem;
+#else
+  SC_ABORT_NOT_REACHED ();
+#endif
+}
+
+void
+sc_mempool_flush (sc_mempool_t * mempool)
+{
+  size_t              zz;
+  sc_mempool_magazine_t *mag;
+
+  if (mempool->threads == NULL) {
+    return;
+  }
+  for (zz = 0; zz < mempool->threads->magazines.elem_count; ++zz) {
+    mag = *(sc_mempool_magazine_t **)
+      sc_array_index (&mempool->threads->magazines, zz);
+    SC_ASSERT (mempool->elem_count >= mag->count);
+    memcpy (sc_array_push_count (&mempool->freed, mag->count), mag->elems,
+            mag->count * sizeof (void *));
+    mempool->elem_count -= mag->count;
+    mag->count = 0;
+  }
+}
+
+/* empty all magazines without returning their elements */
+static void
+sc_mempool_threads_clear (sc_mempool_t * mempool)
+{
+  size_t              zz;
+
+  if (mempool->threads == NULL) {
+    return;
+  }
+  for (zz = 0; zz < mempool->threads->magazines.elem_count; ++zz) {
+    (*(sc_mempool_magazine_t **)
+     sc_array_index (&mempool->threads->magazines, zz))->count = 0;
+  }
 }
 
 void
 sc_mempool_reset (sc_mempool_t * mempool)
 {
+  size_t              zz;
+  struct sc_mempool_threads *mt = mempool->threads;
+
+  if (mt != NULL) {
+#ifdef SC_ENABLE_PTHREAD
+    pthread_key_delete (mt->key);
+    pthread_mutex_destroy (&mt->mutex);
+#endif
+    for (zz = 0; zz < mt->magazines.elem_count; ++zz) {
+      SC_FREE (*(sc_mempool_magazine_t **)
+               sc_array_index (&mt->magazines, zz));
+    }
+    sc_array_reset (&mt->magazines);
+    SC_FREE (mt);
+    mempool->threads = NULL;
+  }
   sc_array_reset (&mempool->freed);
   sc_mstamp_reset (&mempool->mstamp);
+  mempool->free_list = NULL;
 }
 
 void
@@ -948,8 +1674,10 @@ sc_mempool_destroy_null (sc_mempool_t ** pmempool)
 void
 sc_mempool_truncate (sc_mempool_t * mempool)
 {
+  sc_mempool_threads_clear (mempool);
   sc_array_reset (&mempool->freed);
   sc_mstamp_truncate (&mempool->mstamp);
+  mempool->free_list = NULL;
   mempool->elem_count = 0;
 }
 
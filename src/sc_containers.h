@@ -424,6 +424,68 @@ void                sc_array_split (sc_array_t * array, sc_array_t * offsets,
                                     size_t num_types, sc_array_type_t type_fn,
                                     void *data);
 
+/** The integer key types understood by \ref sc_array_split_key. */
+typedef enum sc_array_key
+{
+  SC_ARRAY_KEY_UINT32,          /**< Key is a uint32_t. */
+  SC_ARRAY_KEY_UINT64,          /**< Key is a uint64_t. */
+  SC_ARRAY_KEY_UINT128          /**< Key is a sc_uint128_t, such as a
+                                     Morton index of more than 64 bits. */
+}
+sc_array_key_t;
+
+/** The maximum number of types for \ref sc_array_split_key_multi. */
+#define SC_ARRAY_SPLIT_MAX_TYPES 256
+
+/** Compute the offsets of groups of types given by bits of integer keys.
+ * This is \ref sc_array_split with the type of an element computed inline:
+ * the type is (key >> shift) & (num_types - 1), where the key is stored
+ * at a byte offset within each element.  For example, the children of an
+ * octant at level l in a Morton-sorted array with maximum level L have
+ * 3-bit types at shift = 3 * (L - l - 1).
+ * \param [in] array         Array that is sorted in ascending order by type.
+ * \param [in,out] offsets   An initialized array of type size_t that is
+ *                           resized to \a num_types + 1 entries.
+ *                           See \ref sc_array_split.
+ * \param [in] num_types     The number of types, a power of two.
+ * \param [in] key_type      The type of the integer key.
+ * \param [in] key_offset    Byte offset of the key within an element.
+ *                           The key need not be aligned.
+ * \param [in] shift         Number of bits to shift the key to the right,
+ *                           less than the number of bits of the key.
+ */
+void                sc_array_split_key (sc_array_t * array,
+                                        sc_array_t * offsets,
+                                        size_t num_types,
+                                        sc_array_key_t key_type,
+                                        size_t key_offset, int shift);
+
+/** Split many consecutive subarrays of an array by integer keys.
+ * Each subarray is split as in \ref sc_array_split_key.
+ * The subarrays are processed in parallel if libsc is compiled with OpenMP.
+ * \param [in] array         Array whose subarrays are sorted by type.
+ * \param [in] bounds        Array of num_sub + 1 ascending size_t entries.
+ *                           Subarray s contains the elements of \a array
+ *                           with indices bounds[s] <= j < bounds[s + 1].
+ * \param [in,out] offsets   An initialized array of type size_t that is
+ *                           resized to num_sub * \a num_types + 1 entries.
+ *                           The elements of type k in subarray s have
+ *                           indices offsets[s * num_types + k] <= j <
+ *                           offsets[s * num_types + k + 1] into \a array.
+ * \param [in] num_types     The number of types, a power of two
+ *                           not larger than \ref SC_ARRAY_SPLIT_MAX_TYPES.
+ *                           We abort if it is larger.
+ * \param [in] key_type      The type of the integer key.
+ * \param [in] key_offset    Byte offset of the key within an element.
+ * \param [in] shift         Number of bits to shift the key to the right.
+ */
+void                sc_array_split_key_multi (sc_array_t * array,
+                                              sc_array_t * bounds,
+                                              sc_array_t * offsets,
+                                              size_t num_types,
+                                              sc_array_key_t key_type,
+                                              size_t key_offset, int shift);
+
 /** Determine whether \a array is an array of size_t's whose entries include
  * every integer 0 <= i < array->elem_count.
  * \param [in] array         An array.
@@ -447,11 +509,75 @@ int                 sc_array_is_permutation (sc_array_t * array);
 void                sc_array_permute (sc_array_t * array,
                                       sc_array_t * newindices, int keepperm);
 
+/** Apply one permutation to several arrays of equal length.
+ * The data that on input is contained in \a arrays[k][i] will be contained
+ * in \a arrays[k][newindices[i]] on output, as with \ref sc_array_permute.
+ * The arrays are permuted out of place: the destination is written in
+ * order, blockwise for all arrays at once, while the sources are read
+ * through the inverse permutation.  The blocks are processed in parallel
+ * if libsc is compiled with OpenMP.  Temporary memory of the size of each
+ * array and of the permutation is used.
+ * \param [in,out] arrays     Array of \a num_arrays distinct arrays, each
+ *                            with as many elements as \a newindices.
+ *                            Arrays that own their memory receive new
+ *                            memory; views are copied into.
+ * \param [in] num_arrays     Number of arrays to permute.
+ * \param [in] newindices     Permutation array (see sc_array_is_permutation).
+ *                            It is not changed.
+ */
+void                sc_array_permute_multi (sc_array_t ** arrays,
+                                            size_t num_arrays,
+                                            sc_array_t * newindices);
+
+/** Copy the elements of an array at a list of indices into another array.
+ * On output, \a dest[i] contains \a src[indices[i]].
+ * The copy is done in parallel if libsc is compiled with OpenMP.
+ * \param [in,out] dest       Array of the same element size as \a src.
+ *                            If it owns its memory, it is resized to the
+ *                            count of \a indices.  Otherwise it must have
+ *                            that count already.  Must not overlap \a src.
+ * \param [in] src            Array of elements to copy.
+ * \param [in] indices        Array of size_t indices into \a src.
+ */
+void                sc_array_gather (sc_array_t * dest, sc_array_t * src,
+                                     sc_array_t * indices);
+
+/** Copy the elements of an array to a list of indices of another array.
+ * On output, \a dest[indices[i]] contains \a src[i].
+ * The copy is done in parallel if libsc is compiled with OpenMP.
+ * \param [in,out] dest       Array of the same element size as \a src
+ *                            with larger count than every index.
+ *                            Must not overlap \a src.
+ * \param [in] src            Array of elements to copy.
+ * \param [in] indices        Array of unique size_t indices into \a dest,
+ *                            of the same count as \a src.
+ */
+void                sc_array_scatter (sc_array_t * dest, sc_array_t * src,
+                                      sc_array_t * indices);
+
 /** Computes the adler32 checksum of array data (see zlib documentation).
  * This is a faster checksum than crc32, and it works with zeros as data.
  */
 unsigned int        sc_array_checksum (sc_array_t * array);
 
+/** The checksum algorithms of \ref sc_array_checksum_ext. */
+typedef enum sc_array_checksum_type
+{
+  SC_ARRAY_CHECKSUM_ADLER32,    /**< zlib's adler32, requires zlib. */
+  SC_ARRAY_CHECKSUM_CRC32C      /**< CRC32C by \ref sc_io_crc32c. */
+}
+sc_array_checksum_type_t;
+
+/** Computes a checksum of array data with a choice of algorithms.
+ * CRC32C is available without zlib and is faster and stronger than
+ * adler32 on processors with hardware support.
+ * \param [in] array        Array of arbitrary element size and count.
+ * \param [in] type         The checksum algorithm to use.
+ * \return                  The checksum over all bytes of the array.
+ */
+uint32_t            sc_array_checksum_ext (sc_array_t * array,
+                                           sc_array_checksum_type_t type);
+
 /** Adds an element to a priority queue.
  * \note PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED.
  * This function is not allowed for views.
@@ -641,9 +767,27 @@ typedef struct sc_mstamp
   size_t              cur_snext;   /**< Next number within a stamp */
   char               *current;     /**< Memory of current stamp */
   sc_array_t          remember;    /**< Collects all stamps */
+  int                 flags;       /**< Bitwise or of SC_MSTAMP_* flags */
+  size_t              map_size;    /**< Bytes mapped per stamp, or 0
+                                        if stamps are allocated by SC_ALLOC */
 }
 sc_mstamp_t;
 
+/** Back the stamps of an \ref sc_mstamp_t by 2 MB transparent huge pages.
+ * The stamp unit is rounded to a multiple of 2 MB and each stamp is mapped
+ * with mmap, aligned and advised as huge page memory where supported.
+ * This reduces the number of allocations and the TLB pressure for pools
+ * of many millions of small items.
+ */
+#define SC_MSTAMP_HUGEPAGE      0x1
+
+/** Touch the pages of a new stamp in the thread that creates it.
+ * The stamps are mapped with mmap, so with a first-touch NUMA policy their
+ * pages are placed on the memory node of the allocating thread.
+ * Without this flag, mapped pages become resident when items are written.
+ */
+#define SC_MSTAMP_FIRST_TOUCH   0x2
+
 /** Initialize a memory stamp container.
  * We provide allocation of fixed-size memory items
  * without allocating new memory in every request.
@@ -664,6 +808,22 @@ sc_mstamp_t;
 void                sc_mstamp_init (sc_mstamp_t * mst,
                                     size_t stamp_unit, size_t elem_size);
 
+/** Initialize a memory stamp container with special stamp allocation.
+ * If the system does not provide anonymous mmap,
+ * the flags are ignored except for rounding the stamp unit.
+ * Otherwise the stamps are mapped directly from the operating system
+ * and \ref sc_mstamp_truncate returns the pages of all stamps to it.
+ * \param [in,out] mst          Legal pointer to a stamp structure.
+ * \param [in] stamp_unit       Size of each memory block that we allocate.
+ * \param [in] elem_size        Size of each item.
+ * \param [in] flags            Bitwise or of \ref SC_MSTAMP_HUGEPAGE and
+ *                              \ref SC_MSTAMP_FIRST_TOUCH, or 0 to behave
+ *                              exactly like \ref sc_mstamp_init.
+ */
+void                sc_mstamp_init_flags (sc_mstamp_t * mst,
+                                          size_t stamp_unit,
+                                          size_t elem_size, int flags);
+
 /** Free all memory in a stamp structure and all items previously returned.
  * \param [in,out] mst          Properly initialized stamp container.
  *                              On output, the structure is undefined.
@@ -697,6 +857,14 @@ void               *sc_mstamp_alloc (sc_mstamp_t * mst);
  */
 size_t              sc_mstamp_memory_used (sc_mstamp_t * mst);
 
+/** Return memory size in bytes of the container that is resident in RAM.
+ * For mapped stamps we query the operating system for pages in core.
+ * Otherwise, this is the same as \ref sc_mstamp_memory_used.
+ * \param [in] mst              Properly initialized stamp container.
+ * \return                      Resident container memory size in bytes.
+ */
+size_t              sc_mstamp_memory_resident (sc_mstamp_t * mst);
+
 /** The sc_mempool object provides a large pool of equal-size elements.
  * The pool grows dynamically for element allocation.
  * Elements are referenced by their address which never changes.
@@ -705,6 +873,12 @@ size_t              sc_mstamp_memory_used (sc_mstamp_t * mst);
  * If the zero_and_persist option is selected, new elements are initialized to
  * all zeros on creation, and the contents of an element are not touched
  * between freeing and re-returning it.
+ * Otherwise, freed elements are chained into a singly linked list that is
+ * stored inside the elements themselves, so freeing never allocates.
+ *
+ * A pool created by \ref sc_mempool_new_threadsafe may be used by several
+ * threads concurrently.  Each thread then keeps a small magazine of elements
+ * and exchanges them in batches with a shared depot under a mutex.
  */
 typedef struct sc_mempool
 {
@@ -716,6 +890,8 @@ typedef struct sc_mempool
   /* implementation variables */
   sc_mstamp_t         mstamp;   /**< fixed-size chunk allocator */
   sc_array_t          freed;    /**< buffers the freed elements */
+  void               *free_list;        /**< freed elements linked in place */
+  struct sc_mempool_threads *threads;   /**< per-thread magazines or NULL */
 }
 sc_mempool_t;
 
@@ -725,6 +901,14 @@ sc_mempool_t;
  */
 size_t              sc_mempool_memory_used (sc_mempool_t * mempool);
 
+/** Calculate the memory used by a memory pool that is resident in RAM.
+ * This differs from \ref sc_mempool_memory_used, which reports the
+ * reserved memory, only for pools created with mapped stamps.
+ * \param [in] mempool     The memory pool.
+ * \return                 Resident memory used in bytes.
+ */
+size_t              sc_mempool_memory_resident (sc_mempool_t * mempool);
+
 /** Creates a new mempool structure with the zero_and_persist option off.
  * The contents of any elements returned by sc_mempool_alloc are undefined.
  * \param [in] elem_size  Size of one element in bytes.
@@ -740,6 +924,31 @@ sc_mempool_t       *sc_mempool_new (size_t elem_size);
  */
 sc_mempool_t       *sc_mempool_new_zero_and_persist (size_t elem_size);
 
+/** Creates a new mempool structure with configurable memory stamps.
+ * \param [in] elem_size        Size of one element in bytes.
+ * \param [in] zero_and_persist Boolean to select the zero_and_persist option.
+ * \param [in] stamp_unit       Bytes per stamp; the default pools use 4096.
+ *                              Large stamps reduce the allocation count.
+ * \param [in] mstamp_flags     Flags for \ref sc_mstamp_init_flags.
+ * \return Returns an allocated and initialized memory pool.
+ */
+sc_mempool_t       *sc_mempool_new_stamp (size_t elem_size,
+                                          int zero_and_persist,
+                                          size_t stamp_unit,
+                                          int mstamp_flags);
+
+/** Creates a new mempool structure that is safe to use from multiple threads.
+ * The zero_and_persist option is off.
+ * Each thread allocates from and frees into its own magazine of elements,
+ * which is refilled from or drained into a shared depot in batches.
+ * Without pthread support in the build this is equivalent to sc_mempool_new.
+ * The elem_count member counts the elements held in magazines as valid;
+ * it is exact after calling \ref sc_mempool_flush.
+ * \param [in] elem_size  Size of one element in bytes.
+ * \return Returns an allocated and initialized memory pool.
+ */
+sc_mempool_t       *sc_mempool_new_threadsafe (size_t elem_size);
+
 /** Same as sc_mempool_new, but for an already allocated object.
  * \param [out] mempool   Allocated memory is overwritten and initialized.
  * \param [in] elem_size  Size of one element in bytes.
@@ -771,6 +980,25 @@ void                sc_mempool_reset (sc_mempool_t * mempool);
  */
 void                sc_mempool_truncate (sc_mempool_t * mempool);
 
+/** Return the elements cached in all per-thread magazines to the pool.
+ * Must not be called while other threads use the pool.
+ * Has no effect on a pool not created by \ref sc_mempool_new_threadsafe.
+ * \param [in,out] mempool      Valid mempool.  On output, its elem_count
+ *                              is the exact number of valid elements.
+ */
+void                sc_mempool_flush (sc_mempool_t * mempool);
+
+/** Allocate an element from a pool created by sc_mempool_new_threadsafe.
+ * Called by \ref sc_mempool_alloc; there is no need to call it directly.
+ */
+void               *sc_mempool_alloc_threadsafe (sc_mempool_t * mempool);
+
+/** Free an element into a pool created by sc_mempool_new_threadsafe.
+ * Called by \ref sc_mempool_free; there is no need to call it directly.
+ */
+void                sc_mempool_free_threadsafe (sc_mempool_t * mempool,
+                                                void *elem);
+
 /** Allocate a single element.
  * Elements previously returned to the pool are recycled.
  * \return Returns a new or recycled element pointer.
@@ -781,9 +1009,17 @@ sc_mempool_alloc (sc_mempool_t * mempool)
   void               *ret;
   sc_array_t         *freed = &mempool->freed;
 
+  if (mempool->threads != NULL) {
+    return sc_mempool_alloc_threadsafe (mempool);
+  }
+
   ++mempool->elem_count;
 
-  if (freed->elem_count > 0) {
+  if (mempool->free_list != NULL) {
+    ret = mempool->free_list;
+    memcpy (&mempool->free_list, ret, sizeof (void *));
+  }
+  else if (freed->elem_count > 0) {
     ret = *(void **) sc_array_pop (freed);
   }
   else {
@@ -811,6 +1047,11 @@ sc_mempool_free (sc_mempool_t * mempool, void *elem)
 {
   sc_array_t         *freed = &mempool->freed;
 
+  if (mempool->threads != NULL) {
+    sc_mempool_free_threadsafe (mempool, elem);
+    return;
+  }
+
   SC_ASSERT (mempool->elem_count > 0);
 
 #ifdef SC_ENABLE_DEBUG
@@ -821,7 +1062,14 @@ sc_mempool_free (sc_mempool_t * mempool, void *elem)
 
   --mempool->elem_count;
 
-  *(void **) sc_array_push (freed) = elem;
+  if (!mempool->zero_and_persist && elem != NULL) {
+    /* the element's memory holds the link to the next free element */
+    memcpy (elem, &mempool->free_list, sizeof (void *));
+    mempool->free_list = elem;
+  }
+  else {
+    *(void **) sc_array_push (freed) = elem;
+  }
 }
 
 /** The sc_link structure is one link of a linked list.
@@ -0,0 +1,957 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_deflate.h>
+
+/* see RFC 1951 for the deflate format */
+#define SC_DEFLATE_WINDOW 32768         /**< maximum match distance */
+#define SC_DEFLATE_HASH_BITS 15         /**< log2 of hash table size */
+#define SC_DEFLATE_MIN_MATCH 3          /**< shortest match encoded */
+#define SC_DEFLATE_MAX_MATCH 258        /**< longest match encoded */
+#define SC_DEFLATE_MAX_CHAIN 8          /**< candidates tried per match */
+#define SC_DEFLATE_NICE_MATCH 32        /**< match long enough to stop */
+
+#define SC_DEFLATE_HASH(p)                                              \
+  (((((uint32_t) (p)[0] << 16) | ((uint32_t) (p)[1] << 8) | (p)[2])    \
+    * 2654435761u) >> (32 - SC_DEFLATE_HASH_BITS))
+
+/* the decode tables are indexed by this many bits of input, and longer
+   codes continue in subtables of up to 15 - root bits */
+#define SC_INFLATE_LIT_ROOT 10
+#define SC_INFLATE_DIST_ROOT 8
+#define SC_INFLATE_CODES_ROOT 7
+#define SC_INFLATE_LIT_ENOUGH \
+  ((1 << SC_INFLATE_LIT_ROOT) + 288 * (1 << (15 - SC_INFLATE_LIT_ROOT)))
+#define SC_INFLATE_DIST_ENOUGH \
+  ((1 << SC_INFLATE_DIST_ROOT) + 32 * (1 << (15 - SC_INFLATE_DIST_ROOT)))
+
+/* a decode table entry holds the number of bits of its code in bits 0-4,
+   its kind in bits 5-7, a 16-bit value and a number of extra bits */
+#define SC_INFLATE_ENTRY(kind,value,extra) \
+  (((uint32_t) (kind) << 5) | ((uint32_t) (value) << 8) | \
+   ((uint32_t) (extra) << 24))
+#define SC_INFLATE_BITS(e) ((int) ((e) & 31))
+#define SC_INFLATE_KIND(e) ((int) (((e) >> 5) & 7))
+#define SC_INFLATE_VALUE(e) ((uint32_t) (((e) >> 8) & 0xFFFF))
+#define SC_INFLATE_EXTRA(e) ((int) ((e) >> 24))
+
+/* add input bytes to the bit buffer, or zeros beyond the input */
+#define SC_INFLATE_REFILL(in,end,bitbuf,bitcount,pad) do {      \
+  while ((bitcount) <= 56) {                                    \
+    if ((in) < (end)) {                                         \
+      (bitbuf) |= (uint64_t) *(in)++ << (bitcount);             \
+    }                                                           \
+    else {                                                      \
+      ++(pad);                                                  \
+    }                                                           \
+    (bitcount) += 8;                                            \
+  }} while (0)
+
+/** Kinds of decode table entries. */
+typedef enum
+{
+  SC_INFLATE_LIT,               /**< one literal or code length */
+  SC_INFLATE_LIT2,              /**< two literals, the first in the low byte */
+  SC_INFLATE_BASE,              /**< length or distance with extra bits */
+  SC_INFLATE_END,               /**< end of block */
+  SC_INFLATE_SUB,               /**< offset and index bits of a subtable */
+  SC_INFLATE_BAD                /**< invalid code */
+}
+sc_inflate_kind_t;
+
+/** Alphabets of the decode tables. */
+typedef enum
+{
+  SC_INFLATE_LITLENS,           /**< literals, end of block and lengths */
+  SC_INFLATE_DISTS,             /**< distances */
+  SC_INFLATE_CODELENS           /**< code lengths of a dynamic block */
+}
+sc_inflate_alphabet_t;
+
+static const uint16_t sc_deflate_length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const unsigned char sc_deflate_length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t sc_deflate_dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+
+static const unsigned char sc_deflate_dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/** Output bits, which deflate fills from the least significant end. */
+typedef struct sc_deflate_bits
+{
+  unsigned char      *out;      /**< output buffer */
+  size_t              pos;      /**< bytes written to the output */
+  uint64_t            bitbuf;   /**< bits not yet written */
+  int                 bitcount; /**< number of bits in the buffer */
+}
+sc_deflate_bits_t;
+
+/** The fixed Huffman codes with their bits in reverse order. */
+typedef struct sc_deflate_codes
+{
+  uint16_t            lit[288]; /**< literal and length codes */
+  unsigned char       litlen[288];      /**< their number of bits */
+  uint16_t            dist[30]; /**< distance codes of 5 bits */
+}
+sc_deflate_codes_t;
+
+/** State of decompressing one deflate stream. */
+typedef struct sc_inflate
+{
+  const unsigned char *in;      /**< next input byte */
+  const unsigned char *in_end;  /**< end of the input */
+  uint64_t            bitbuf;   /**< input bits not yet consumed */
+  int                 bitcount; /**< number of bits in the buffer */
+  int                 pad;      /**< zero bytes added beyond the input */
+  unsigned char      *out_start;        /**< beginning of the output */
+  unsigned char      *out;      /**< next output byte */
+  unsigned char      *out_end;  /**< end of the room for output */
+  sc_array_t         *grow;     /**< if not NULL, resized for more room */
+  size_t              grow_offset;      /**< array count before output */
+  int                 fixed;    /**< tables hold the fixed codes */
+  uint32_t            lit[SC_INFLATE_LIT_ENOUGH];       /**< lit/len table */
+  uint32_t            dist[SC_INFLATE_DIST_ENOUGH];     /**< distance table */
+}
+sc_inflate_t;
+
+static              uint32_t
+sc_deflate_reverse (uint32_t code, int len)
+{
+  uint32_t            r = 0;
+
+  for (; len > 0; --len) {
+    r = (r << 1) | (code & 1);
+    code >>= 1;
+  }
+  return r;
+}
+
+static void
+sc_deflate_codes_init (sc_deflate_codes_t * codes)
+{
+  int                 i, len;
+  uint32_t            code;
+
+  for (i = 0; i < 288; ++i) {
+    if (i < 144) {
+      code = 0x30 + i;
+      len = 8;
+    }
+    else if (i < 256) {
+      code = 0x190 + (i - 144);
+      len = 9;
+    }
+    else if (i < 280) {
+      code = i - 256;
+      len = 7;
+    }
+    else {
+      code = 0xC0 + (i - 280);
+      len = 8;
+    }
+    codes->lit[i] = (uint16_t) sc_deflate_reverse (code, len);
+    codes->litlen[i] = (unsigned char) len;
+  }
+  for (i = 0; i < 30; ++i) {
+    codes->dist[i] = (uint16_t) sc_deflate_reverse ((uint32_t) i, 5);
+  }
+}
+
+/** Index of the length code for a match length of 3 to 258. */
+static int
+sc_deflate_length_code (int len)
+{
+  int                 v = len - 3, n;
+
+  if (v < 8) {
+    return v;
+  }
+  if (len == SC_DEFLATE_MAX_MATCH) {
+    return 28;
+  }
+  n = SC_LOG2_32 (v);
+  return 4 * (n - 1) + ((v >> (n - 2)) & 3);
+}
+
+/** Index of the distance code for a distance of 1 to 32768. */
+static int
+sc_deflate_dist_code (int dist)
+{
+  int                 v = dist - 1, n;
+
+  if (v < 4) {
+    return v;
+  }
+  n = SC_LOG2_32 (v);
+  return 2 * n + ((v >> (n - 1)) & 1);
+}
+
+static void
+sc_deflate_put (sc_deflate_bits_t * w, uint32_t bits, int n)
+{
+  w->bitbuf |= (uint64_t) bits << w->bitcount;
+  w->bitcount += n;
+  while (w->bitcount >= 8) {
+    w->out[w->pos++] = (unsigned char) w->bitbuf;
+    w->bitbuf >>= 8;
+    w->bitcount -= 8;
+  }
+}
+
+static void
+sc_deflate_align (sc_deflate_bits_t * w)
+{
+  if (w->bitcount > 0) {
+    w->out[w->pos++] = (unsigned char) w->bitbuf;
+    w->bitbuf = 0;
+    w->bitcount = 0;
+  }
+}
+
+/** Find greedy matches for the input from start to end.
+ * Literals are stored as tokens below 256, matches as distance times
+ * 65536 plus length.  Matches reach back into earlier input.
+ * \return              Number of tokens.
+ */
+static size_t
+sc_deflate_match (const unsigned char *src, size_t n, size_t start,
+                  size_t end, size_t *head, size_t *prev, uint32_t *tokens)
+{
+  int                 chain;
+  size_t              pos, k, num_tokens = 0;
+  size_t              cand, c, last, limit, len, best_len, best_dist;
+  uint32_t            h;
+
+  for (pos = start; pos < end;) {
+    best_len = best_dist = 0;
+    if (pos + SC_DEFLATE_MIN_MATCH <= n) {
+      /* walk the chain of earlier positions with the same hash,
+         which stores positions plus one and must strictly decrease */
+      h = SC_DEFLATE_HASH (src + pos);
+      limit = SC_MIN (end - pos, SC_DEFLATE_MAX_MATCH);
+      last = pos;
+      cand = head[h];
+      for (chain = SC_DEFLATE_MAX_CHAIN; cand > 0 && chain > 0; --chain) {
+        c = cand - 1;
+        if (c >= last || pos - c > SC_DEFLATE_WINDOW) {
+          break;
+        }
+        last = c;
+        if (src[c + best_len] == src[pos + best_len]) {
+          for (len = 0; len < limit && src[c + len] == src[pos + len];
+               ++len) {
+          }
+          if (len > best_len) {
+            best_len = len;
+            best_dist = pos - c;
+            if (len == limit || len >= SC_DEFLATE_NICE_MATCH) {
+              break;
+            }
+          }
+        }
+        cand = prev[c & (SC_DEFLATE_WINDOW - 1)];
+      }
+      prev[pos & (SC_DEFLATE_WINDOW - 1)] = head[h];
+      head[h] = pos + 1;
+    }
+
+    if (best_len >= SC_DEFLATE_MIN_MATCH) {
+      tokens[num_tokens++] = (uint32_t) ((best_dist << 16) | best_len);
+      for (k = pos + 1; k < pos + best_len && k + SC_DEFLATE_MIN_MATCH <= n;
+           ++k) {
+        h = SC_DEFLATE_HASH (src + k);
+        prev[k & (SC_DEFLATE_WINDOW - 1)] = head[h];
+        head[h] = k + 1;
+      }
+      pos += best_len;
+    }
+    else {
+      tokens[num_tokens++] = src[pos++];
+    }
+  }
+  return num_tokens;
+}
+
+/** Write the tokens with fixed codes or the input as a stored block.
+ * The fixed codes are used only if they are shorter, such that the
+ * output never exceeds 5 bytes more than the input of the block.
+ */
+static void
+sc_deflate_block (sc_deflate_bits_t * w, const sc_deflate_codes_t * codes,
+                  const unsigned char *data, size_t bytes,
+                  const uint32_t *tokens, size_t num_tokens, int final)
+{
+  int                 len, dist, lc, dc;
+  size_t              zz, bits, stored;
+  uint32_t            t;
+
+  /* count the bits of the header, codes and end of block */
+  bits = 3 + codes->litlen[256];
+  for (zz = 0; zz < num_tokens; ++zz) {
+    t = tokens[zz];
+    if (t < 256) {
+      bits += codes->litlen[t];
+    }
+    else {
+      lc = sc_deflate_length_code ((int) (t & 0xFFFF));
+      dc = sc_deflate_dist_code ((int) (t >> 16));
+      bits += codes->litlen[257 + lc] + sc_deflate_length_extra[lc] +
+        5 + sc_deflate_dist_extra[dc];
+    }
+  }
+  stored = ((w->bitcount + 3 + 7) & ~7) - w->bitcount + 32 + 8 * bytes;
+
+  if (bits >= stored) {
+    sc_deflate_put (w, final ? 1 : 0, 3);
+    sc_deflate_align (w);
+    w->out[w->pos++] = (unsigned char) (bytes & 0xFF);
+    w->out[w->pos++] = (unsigned char) (bytes >> 8);
+    w->out[w->pos++] = (unsigned char) (~bytes & 0xFF);
+    w->out[w->pos++] = (unsigned char) ((~bytes >> 8) & 0xFF);
+    memcpy (w->out + w->pos, data, bytes);
+    w->pos += bytes;
+    return;
+  }
+
+  sc_deflate_put (w, (final ? 1 : 0) | (1 << 1), 3);
+  for (zz = 0; zz < num_tokens; ++zz) {
+    t = tokens[zz];
+    if (t < 256) {
+      sc_deflate_put (w, codes->lit[t], codes->litlen[t]);
+    }
+    else {
+      len = (int) (t & 0xFFFF);
+      dist = (int) (t >> 16);
+      lc = sc_deflate_length_code (len);
+      dc = sc_deflate_dist_code (dist);
+      sc_deflate_put (w, codes->lit[257 + lc], codes->litlen[257 + lc]);
+      sc_deflate_put (w, (uint32_t) (len - sc_deflate_length_base[lc]),
+                      sc_deflate_length_extra[lc]);
+      sc_deflate_put (w, codes->dist[dc], 5);
+      sc_deflate_put (w, (uint32_t) (dist - sc_deflate_dist_base[dc]),
+                      sc_deflate_dist_extra[dc]);
+    }
+  }
+  sc_deflate_put (w, codes->lit[256], codes->litlen[256]);
+}
+
+size_t
+sc_deflate (const void *in, size_t in_bytes, int final, void *out)
+{
+  const unsigned char *src = (const unsigned char *) in;
+  size_t              start, end, num_tokens;
+  size_t             *head, *prev;
+  uint32_t           *tokens;
+  sc_deflate_bits_t   w;
+  sc_deflate_codes_t  codes;
+
+  SC_ASSERT (in != NULL || in_bytes == 0);
+  SC_ASSERT (out != NULL);
+
+  if (in_bytes == 0 && !final) {
+    return 0;
+  }
+  w.out = (unsigned char *) out;
+  w.pos = 0;
+  w.bitbuf = 0;
+  w.bitcount = 0;
+  sc_deflate_codes_init (&codes);
+
+  /* the hash chains store positions plus one and zero for none */
+  head = SC_ALLOC_ZERO (size_t, 1 << SC_DEFLATE_HASH_BITS);
+  prev = SC_ALLOC (size_t, SC_DEFLATE_WINDOW);
+  tokens = SC_ALLOC (uint32_t, SC_MAX (SC_MIN (in_bytes, SC_DEFLATE_BLOCK),
+                                       1));
+
+  start = 0;
+  do {
+    end = start + SC_MIN (in_bytes - start, SC_DEFLATE_BLOCK);
+    num_tokens = sc_deflate_match (src, in_bytes, start, end,
+                                   head, prev, tokens);
+    sc_deflate_block (&w, &codes, src + start, end - start,
+                      tokens, num_tokens, final && end == in_bytes);
+    start = end;
+  }
+  while (start < in_bytes);
+
+  if (!final) {
+    /* an empty stored block ends the output on a byte boundary */
+    sc_deflate_put (&w, 0, 3);
+    sc_deflate_align (&w);
+    w.out[w.pos++] = 0;
+    w.out[w.pos++] = 0;
+    w.out[w.pos++] = 0xFF;
+    w.out[w.pos++] = 0xFF;
+  }
+  sc_deflate_align (&w);
+
+  SC_FREE (tokens);
+  SC_FREE (prev);
+  SC_FREE (head);
+  SC_ASSERT (w.pos <= SC_DEFLATE_BOUND (in_bytes));
+  return w.pos;
+}
+
+/** Decode table entry without its number of bits for a symbol. */
+static              uint32_t
+sc_inflate_symbol (sc_inflate_alphabet_t alphabet, int sym)
+{
+  if (alphabet == SC_INFLATE_CODELENS) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_LIT, sym, 0);
+  }
+  if (alphabet == SC_INFLATE_DISTS) {
+    return sym < 30 ? SC_INFLATE_ENTRY (SC_INFLATE_BASE,
+                                        sc_deflate_dist_base[sym],
+                                        sc_deflate_dist_extra[sym]) :
+      SC_INFLATE_ENTRY (SC_INFLATE_BAD, 0, 0);
+  }
+  if (sym < 256) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_LIT, sym, 0);
+  }
+  if (sym == 256) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_END, 0, 0);
+  }
+  if (sym < 286) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_BASE,
+                             sc_deflate_length_base[sym - 257],
+                             sc_deflate_length_extra[sym - 257]);
+  }
+  return SC_INFLATE_ENTRY (SC_INFLATE_BAD, 0, 0);
+}
+
+/** Build a decode table from the code lengths of an alphabet.
+ * Codes not assigned by an incomplete code decode to invalid entries.
+ * \return              0 on success, -1 if the code is oversubscribed.
+ */
+static int
+sc_inflate_build (const unsigned char *lengths, int num,
+                  sc_inflate_alphabet_t alphabet, int root, uint32_t *table)
+{
+  int                 sym, len, left, sb, i;
+  int                 count[16], next[16];
+  uint16_t            codes[288];
+  unsigned char       maxlen[1 << SC_INFLATE_LIT_ROOT];
+  uint32_t            r, e, off, size;
+
+  SC_ASSERT (num <= 288 && root <= SC_INFLATE_LIT_ROOT);
+
+  /* count the codes of every length and check the Kraft inequality */
+  memset (count, 0, sizeof (count));
+  for (sym = 0; sym < num; ++sym) {
+    ++count[lengths[sym]];
+  }
+  count[0] = 0;
+  left = 1;
+  for (len = 1; len <= 15; ++len) {
+    left <<= 1;
+    left -= count[len];
+    if (left < 0) {
+      return -1;
+    }
+  }
+
+  /* assign canonical codes and find the longest code per table prefix */
+  next[1] = 0;
+  for (len = 2; len <= 15; ++len) {
+    next[len] = (next[len - 1] + count[len - 1]) << 1;
+  }
+  size = (uint32_t) 1 << root;
+  memset (maxlen, 0, size);
+  for (sym = 0; sym < num; ++sym) {
+    len = lengths[sym];
+    if (len > 0) {
+      codes[sym] = (uint16_t) next[len]++;
+      if (len > root) {
+        r = sc_deflate_reverse (codes[sym], len) & (size - 1);
+        maxlen[r] = (unsigned char) SC_MAX (maxlen[r], len);
+      }
+    }
+  }
+
+  /* the root table links to a subtable for every prefix of long codes */
+  for (r = 0; r < size; ++r) {
+    table[r] = SC_INFLATE_ENTRY (SC_INFLATE_BAD, 0, 0);
+  }
+  off = size;
+  for (r = 0; r < size; ++r) {
+    if (maxlen[r] > 0) {
+      sb = maxlen[r] - root;
+      table[r] = SC_INFLATE_ENTRY (SC_INFLATE_SUB, off, sb) | root;
+      for (i = 0; i < 1 << sb; ++i) {
+        table[off + i] = SC_INFLATE_ENTRY (SC_INFLATE_BAD, 0, 0);
+      }
+      off += 1 << sb;
+    }
+  }
+
+  /* every short code fills the entries of all its possible suffixes */
+  for (sym = 0; sym < num; ++sym) {
+    len = lengths[sym];
+    if (len == 0) {
+      continue;
+    }
+    e = sc_inflate_symbol (alphabet, sym) | len;
+    r = sc_deflate_reverse (codes[sym], len);
+    if (len <= root) {
+      for (; r < size; r += 1 << len) {
+        table[r] = e;
+      }
+    }
+    else {
+      off = SC_INFLATE_VALUE (table[r & (size - 1)]);
+      sb = SC_INFLATE_EXTRA (table[r & (size - 1)]);
+      for (r >>= root; r < (uint32_t) 1 << sb; r += 1 << (len - root)) {
+        table[off + r] = e;
+      }
+    }
+  }
+  return 0;
+}
+
+/** Combine pairs of literals that fit into the root table together. */
+static void
+sc_inflate_pairs (uint32_t *table)
+{
+  int                 i, n;
+  uint32_t            single[1 << SC_INFLATE_LIT_ROOT], e, f;
+
+  memcpy (single, table, sizeof (single));
+  for (i = 0; i < 1 << SC_INFLATE_LIT_ROOT; ++i) {
+    e = single[i];
+    if (SC_INFLATE_KIND (e) != SC_INFLATE_LIT) {
+      continue;
+    }
+    /* a code fitting into the remaining bits is fully determined */
+    n = SC_INFLATE_BITS (e);
+    f = single[i >> n];
+    if (SC_INFLATE_KIND (f) == SC_INFLATE_LIT &&
+        n + SC_INFLATE_BITS (f) <= SC_INFLATE_LIT_ROOT) {
+      table[i] = SC_INFLATE_ENTRY (SC_INFLATE_LIT2, SC_INFLATE_VALUE (e) |
+                                   (SC_INFLATE_VALUE (f) << 8), 0) |
+        (n + SC_INFLATE_BITS (f));
+    }
+  }
+}
+
+/** Resize the output array to make room for more bytes.
+ * \return              0 on success, -1 if the output is not resizable.
+ */
+static int
+sc_inflate_room (sc_inflate_t * s, unsigned char **out, size_t need)
+{
+  size_t              used, room;
+
+  if (s->grow == NULL) {
+    return -1;
+  }
+  used = (size_t) (*out - s->out_start);
+  room = (size_t) (s->out_end - s->out_start);
+  room = SC_MAX (2 * room, used + need);
+  sc_array_resize (s->grow, s->grow_offset + room);
+  s->out_start = (unsigned char *) s->grow->array + s->grow_offset;
+  s->out_end = s->out_start + room;
+  *out = s->out_start + used;
+  return 0;
+}
+
+/** Check whether more bits have been consumed than there are input. */
+static int
+sc_inflate_overrun (sc_inflate_t * s)
+{
+  return s->bitcount < 8 * s->pad;
+}
+
+static              uint32_t
+sc_inflate_bits (sc_inflate_t * s, int n)
+{
+  uint32_t            v;
+
+  SC_ASSERT (0 < n && n <= 16);
+  SC_INFLATE_REFILL (s->in, s->in_end, s->bitbuf, s->bitcount, s->pad);
+  v = (uint32_t) (s->bitbuf & ((1u << n) - 1));
+  s->bitbuf >>= n;
+  s->bitcount -= n;
+  return v;
+}
+
+/** Discard bits to the next byte boundary and give back whole bytes. */
+static int
+sc_inflate_unread (sc_inflate_t * s)
+{
+  int                 n = s->bitcount & 7;
+
+  s->bitbuf >>= n;
+  s->bitcount -= n;
+  if (sc_inflate_overrun (s)) {
+    return -1;
+  }
+  s->in -= s->bitcount / 8 - s->pad;
+  s->bitbuf = 0;
+  s->bitcount = 0;
+  s->pad = 0;
+  return 0;
+}
+
+/** Decode the Huffman coded symbols of a block up to its end.
+ * This is the inner loop of decompression.  A refill of the bit buffer
+ * provides enough bits for a length and a distance with extra bits.
+ */
+static int
+sc_inflate_codes (sc_inflate_t * s)
+{
+  const unsigned char *in = s->in;
+  const unsigned char *in_end = s->in_end;
+  const uint32_t     *lit = s->lit;
+  const uint32_t     *dist = s->dist;
+  unsigned char      *out = s->out;
+  unsigned char      *out_start = s->out_start;
+  unsigned char      *out_end = s->out_end;
+  unsigned char      *from;
+  uint64_t            bitbuf = s->bitbuf;
+  int                 bitcount = s->bitcount;
+  int                 pad = s->pad;
+  int                 retval = -1;
+  int                 n, kind;
+  size_t              len, d, k;
+  uint32_t            e;
+
+  for (;;) {
+    SC_INFLATE_REFILL (in, in_end, bitbuf, bitcount, pad);
+    if (bitcount < 8 * pad) {
+      break;
+    }
+    e = lit[bitbuf & ((1 << SC_INFLATE_LIT_ROOT) - 1)];
+    if (SC_INFLATE_KIND (e) == SC_INFLATE_SUB) {
+      e = lit[SC_INFLATE_VALUE (e) + ((bitbuf >> SC_INFLATE_LIT_ROOT) &
+                                      ((1u << SC_INFLATE_EXTRA (e)) - 1))];
+    }
+    n = SC_INFLATE_BITS (e);
+    bitbuf >>= n;
+    bitcount -= n;
+    kind = SC_INFLATE_KIND (e);
+
+    /* one or two literals */
+    if (kind <= SC_INFLATE_LIT2) {
+      if (out_end - out < 1 + kind) {
+        if (sc_inflate_room (s, &out, 2)) {
+          break;
+        }
+        out_start = s->out_start;
+        out_end = s->out_end;
+      }
+      *out++ = (unsigned char) SC_INFLATE_VALUE (e);
+      if (kind == SC_INFLATE_LIT2) {
+        *out++ = (unsigned char) (SC_INFLATE_VALUE (e) >> 8);
+      }
+      continue;
+    }
+    if (kind == SC_INFLATE_END) {
+      retval = 0;
+      break;
+    }
+    if (kind != SC_INFLATE_BASE) {
+      break;
+    }
+
+    /* length and distance of a match */
+    n = SC_INFLATE_EXTRA (e);
+    len = SC_INFLATE_VALUE (e) + (size_t) (bitbuf & ((1u << n) - 1));
+    bitbuf >>= n;
+    bitcount -= n;
+    e = dist[bitbuf & ((1 << SC_INFLATE_DIST_ROOT) - 1)];
+    if (SC_INFLATE_KIND (e) == SC_INFLATE_SUB) {
+      e = dist[SC_INFLATE_VALUE (e) + ((bitbuf >> SC_INFLATE_DIST_ROOT) &
+                                       ((1u << SC_INFLATE_EXTRA (e)) - 1))];
+    }
+    n = SC_INFLATE_BITS (e);
+    bitbuf >>= n;
+    bitcount -= n;
+    if (SC_INFLATE_KIND (e) != SC_INFLATE_BASE) {
+      break;
+    }
+    n = SC_INFLATE_EXTRA (e);
+    d = SC_INFLATE_VALUE (e) + (size_t) (bitbuf & ((1u << n) - 1));
+    bitbuf >>= n;
+    bitcount -= n;
+
+    /* copy the match, which may overlap its own output */
+    if (d > (size_t) (out - out_start)) {
+      break;
+    }
+    if ((size_t) (out_end - out) < len) {
+      if (sc_inflate_room (s, &out, len)) {
+        break;
+      }
+      out_start = s->out_start;
+      out_end = s->out_end;
+    }
+    from = out - d;
+    if (d >= len) {
+      memcpy (out, from, len);
+    }
+    else {
+      for (k = 0; k < len; ++k) {
+        out[k] = from[k];
+      }
+    }
+    out += len;
+  }
+
+  s->in = in;
+  s->bitbuf = bitbuf;
+  s->bitcount = bitcount;
+  s->pad = pad;
+  s->out = out;
+  return retval;
+}
+
+static int
+sc_inflate_stored (sc_inflate_t * s)
+{
+  size_t              len, nlen;
+  unsigned char      *out = s->out;
+
+  if (sc_inflate_unread (s) || s->in_end - s->in < 4) {
+    return -1;
+  }
+  len = (size_t) s->in[0] | ((size_t) s->in[1] << 8);
+  nlen = (size_t) s->in[2] | ((size_t) s->in[3] << 8);
+  s->in += 4;
+  if (len != (~nlen & 0xFFFF) || (size_t) (s->in_end - s->in) < len) {
+    return -1;
+  }
+  if ((size_t) (s->out_end - out) < len && sc_inflate_room (s, &out, len)) {
+    return -1;
+  }
+  memcpy (out, s->in, len);
+  s->in += len;
+  s->out = out + len;
+  return 0;
+}
+
+static int
+sc_inflate_fixed (sc_inflate_t * s)
+{
+  int                 sym;
+  unsigned char       lengths[288];
+
+  if (!s->fixed) {
+    for (sym = 0; sym < 288; ++sym) {
+      lengths[sym] = sym < 144 ? 8 : sym < 256 ? 9 : sym < 280 ? 7 : 8;
+    }
+    (void) sc_inflate_build (lengths, 288, SC_INFLATE_LITLENS,
+                             SC_INFLATE_LIT_ROOT, s->lit);
+    sc_inflate_pairs (s->lit);
+    memset (lengths, 5, 32);
+    (void) sc_inflate_build (lengths, 32, SC_INFLATE_DISTS,
+                             SC_INFLATE_DIST_ROOT, s->dist);
+    s->fixed = 1;
+  }
+  return sc_inflate_codes (s);
+}
+
+static int
+sc_inflate_dynamic (sc_inflate_t * s)
+{
+  static const unsigned char order[19] =
+    { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+  int                 nlen, ndist, ncode;
+  int                 i, sym, rep, prev;
+  unsigned char       lengths[286 + 30];
+  uint32_t            e;
+
+  s->fixed = 0;
+  nlen = (int) sc_inflate_bits (s, 5) + 257;
+  ndist = (int) sc_inflate_bits (s, 5) + 1;
+  ncode = (int) sc_inflate_bits (s, 4) + 4;
+  if (nlen > 286 || ndist > 30) {
+    return -1;
+  }
+
+  /* the code lengths are themselves Huffman coded */
+  memset (lengths, 0, 19);
+  for (i = 0; i < ncode; ++i) {
+    lengths[order[i]] = (unsigned char) sc_inflate_bits (s, 3);
+  }
+  if (sc_inflate_build (lengths, 19, SC_INFLATE_CODELENS,
+                        SC_INFLATE_CODES_ROOT, s->dist)) {
+    return -1;
+  }
+  for (i = 0; i < nlen + ndist;) {
+    SC_INFLATE_REFILL (s->in, s->in_end, s->bitbuf, s->bitcount, s->pad);
+    e = s->dist[s->bitbuf & ((1 << SC_INFLATE_CODES_ROOT) - 1)];
+    if (SC_INFLATE_KIND (e) != SC_INFLATE_LIT) {
+      return -1;
+    }
+    s->bitbuf >>= SC_INFLATE_BITS (e);
+    s->bitcount -= SC_INFLATE_BITS (e);
+    sym = (int) SC_INFLATE_VALUE (e);
+    if (sym < 16) {
+      lengths[i++] = (unsigned char) sym;
+      continue;
+    }
+    if (sym == 16) {
+      if (i == 0) {
+        return -1;
+      }
+      prev = lengths[i - 1];
+      rep = 3 + (int) sc_inflate_bits (s, 2);
+    }
+    else if (sym == 17) {
+      prev = 0;
+      rep = 3 + (int) sc_inflate_bits (s, 3);
+    }
+    else {
+      prev = 0;
+      rep = 11 + (int) sc_inflate_bits (s, 7);
+    }
+    if (i + rep > nlen + ndist) {
+      return -1;
+    }
+    for (; rep > 0; --rep) {
+      lengths[i++] = (unsigned char) prev;
+    }
+  }
+
+  /* the end of block code is required */
+  if (sc_inflate_overrun (s) || lengths[256] == 0 ||
+      sc_inflate_build (lengths, nlen, SC_INFLATE_LITLENS,
+                        SC_INFLATE_LIT_ROOT, s->lit) ||
+      sc_inflate_build (lengths + nlen, ndist, SC_INFLATE_DISTS,
+                        SC_INFLATE_DIST_ROOT, s->dist)) {
+    return -1;
+  }
+  sc_inflate_pairs (s->lit);
+  return sc_inflate_codes (s);
+}
+
+/** Decompress blocks up to and including the final block. */
+static int
+sc_inflate_run (sc_inflate_t * s)
+{
+  int                 final, type, retval;
+
+  do {
+    final = (int) sc_inflate_bits (s, 1);
+    type = (int) sc_inflate_bits (s, 2);
+    if (type == 0) {
+      retval = sc_inflate_stored (s);
+    }
+    else if (type == 1) {
+      retval = sc_inflate_fixed (s);
+    }
+    else if (type == 2) {
+      retval = sc_inflate_dynamic (s);
+    }
+    else {
+      retval = -1;
+    }
+    if (retval || sc_inflate_overrun (s)) {
+      return -1;
+    }
+  }
+  while (!final);
+  return sc_inflate_unread (s);
+}
+
+static sc_inflate_t *
+sc_inflate_new (const void *in, size_t in_bytes)
+{
+  sc_inflate_t       *s = SC_ALLOC (sc_inflate_t, 1);
+
+  s->in = (const unsigned char *) in;
+  s->in_end = s->in + in_bytes;
+  s->bitbuf = 0;
+  s->bitcount = 0;
+  s->pad = 0;
+  s->grow = NULL;
+  s->grow_offset = 0;
+  s->fixed = 0;
+  return s;
+}
+
+int
+sc_inflate (const void *in, size_t *in_bytes, void *out, size_t *out_bytes)
+{
+  int                 retval;
+  sc_inflate_t       *s;
+
+  SC_ASSERT (in_bytes != NULL && (in != NULL || *in_bytes == 0));
+  SC_ASSERT (out_bytes != NULL && (out != NULL || *out_bytes == 0));
+
+  s = sc_inflate_new (in, *in_bytes);
+  s->out_start = s->out = (unsigned char *) out;
+  s->out_end = s->out + *out_bytes;
+  retval = sc_inflate_run (s);
+  if (!retval) {
+    *in_bytes = (size_t) (s->in - (const unsigned char *) in);
+    *out_bytes = (size_t) (s->out - s->out_start);
+  }
+  SC_FREE (s);
+  return retval;
+}
+
+int
+sc_inflate_array (const void *in, size_t *in_bytes, sc_array_t *out)
+{
+  int                 retval;
+  size_t              offset, room;
+  sc_inflate_t       *s;
+
+  SC_ASSERT (in_bytes != NULL && (in != NULL || *in_bytes == 0));
+  SC_ASSERT (out != NULL && SC_ARRAY_IS_OWNER (out));
+  SC_ASSERT (out->elem_size == 1);
+
+  /* start with room for a moderate compression ratio */
+  s = sc_inflate_new (in, *in_bytes);
+  offset = out->elem_count;
+  room = 3 * *in_bytes + 1024;
+  sc_array_resize (out, offset + room);
+  s->grow = out;
+  s->grow_offset = offset;
+  s->out_start = s->out = (unsigned char *) out->array + offset;
+  s->out_end = s->out + room;
+  retval = sc_inflate_run (s);
+  if (!retval) {
+    *in_bytes = (size_t) (s->in - (const unsigned char *) in);
+    sc_array_resize (out, offset + (size_t) (s->out - s->out_start));
+  }
+  else {
+    sc_array_resize (out, offset);
+  }
+  SC_FREE (s);
+  return retval;
+}
@@ -0,0 +1,97 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#ifndef SC_DEFLATE_H
+#define SC_DEFLATE_H
+
+/** \file sc_deflate.h
+ * Builtin compression and decompression in the deflate format (RFC 1951).
+ *
+ * These routines let libsc read and write compressed data when zlib is
+ * not available.  The compressor is a greedy LZ77 matcher with hash
+ * chains that writes fixed Huffman codes, falling back to stored blocks
+ * where this is shorter.  It trades compression ratio for speed.
+ * The decompressor handles all valid deflate data.  It decodes with
+ * lookup tables that return two literals at once where their codes fit.
+ *
+ * This module is internal to libsc and its interface may change.
+ */
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Maximum number of input bytes compressed into one deflate block. */
+#define SC_DEFLATE_BLOCK 65535
+
+/** Upper bound on the output of \ref sc_deflate for a number of bytes. */
+#define SC_DEFLATE_BOUND(n) ((size_t) (n) + 10 +                        \
+                             5 * (((size_t) (n) + SC_DEFLATE_BLOCK - 1) \
+                                  / SC_DEFLATE_BLOCK))
+
+/** Compress data into deflate blocks that begin on a byte boundary.
+ * Repeated matches are only found within the input of one call.
+ * \param [in] in           Bytes to compress.
+ * \param [in] in_bytes     Number of bytes to compress.
+ * \param [in] final        If true, the last block is marked final and
+ *                          the output ends the deflate stream.  Otherwise
+ *                          the output ends with an empty stored block, such
+ *                          that the output of further calls may follow.
+ *                          A call that is not final with empty input
+ *                          produces no output.
+ * \param [out] out         Room for \ref SC_DEFLATE_BOUND of \a in_bytes.
+ * \return                  Number of bytes written.
+ */
+size_t              sc_deflate (const void *in, size_t in_bytes,
+                                int final, void *out);
+
+/** Decompress a complete deflate stream into a buffer.
+ * \param [in] in           Compressed data.
+ * \param [in,out] in_bytes On input, number of bytes available.  On
+ *                          output, number of bytes of the deflate stream,
+ *                          which ends with the final block.
+ * \param [out] out         Decompressed data.
+ * \param [in,out] out_bytes    On input, room in \a out.  On output,
+ *                          number of bytes decompressed.
+ * \return                  0 on success, -1 if the input is invalid,
+ *                          truncated, or decompresses to more bytes
+ *                          than there is room.
+ */
+int                 sc_inflate (const void *in, size_t *in_bytes,
+                                void *out, size_t *out_bytes);
+
+/** Decompress a complete deflate stream and append it to an array.
+ * \param [in] in           Compressed data.
+ * \param [in,out] in_bytes As for \ref sc_inflate.
+ * \param [in,out] out      Resizable array of element size 1.  The output
+ *                          is appended.  On error, the array is resized
+ *                          to its original count.
+ * \return                  0 on success, -1 if the input is invalid
+ *                          or truncated.
+ */
+int                 sc_inflate_array (const void *in, size_t *in_bytes,
+                                      sc_array_t *out);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_DEFLATE_H */
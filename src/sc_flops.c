@@ -22,6 +22,7 @@
 */
 
 #include <sc_flops.h>
+#include <sc_statistics.h>
 
 #ifdef SC_PAPI
 #ifdef SC_HAVE_SYS_TYPES_H
@@ -30,6 +31,144 @@
 #include <papi.h>
 #endif
 
+#if defined SC_HAVE_LINUX_PERF_EVENT_H && defined SC_HAVE_UNISTD_H
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef SYS_perf_event_open
+#define SC_FLOPS_PERF
+#endif
+#endif
+
+/* the perf events read in addition to sc_flops_counter_t */
+#define SC_FLOPS_PERF_FLPOPS SC_FLOPS_NUM_COUNTERS
+#define SC_FLOPS_PERF_TASK_CLOCK (SC_FLOPS_NUM_COUNTERS + 1)
+#define SC_FLOPS_PERF_NUM (SC_FLOPS_NUM_COUNTERS + 2)
+
+#ifdef SC_FLOPS_PERF
+
+/** Hardware counters are opened once per program for the calling thread. */
+static struct sc_flops_perf
+{
+  int                 initialized;
+  int                 leader;   /**< Group of hardware events or -1. */
+  int                 nevents;  /**< Number of events in the group. */
+  int                 slot[SC_FLOPS_PERF_NUM];  /**< Group position. */
+  int                 task_clock;       /**< Separate software event. */
+}
+sc_flops_perf = { 0, -1, 0, { 0 }, -1 };
+
+static int
+sc_flops_perf_open (__u32 type, __u64 config, int group_fd)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group_fd < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+
+  return (int) syscall (SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void
+sc_flops_perf_setup (void)
+{
+  int                 i, fd;
+  const char         *raw;
+  __u64               configs[SC_FLOPS_PERF_NUM];
+  __u32               types[SC_FLOPS_PERF_NUM];
+  struct sc_flops_perf *fp = &sc_flops_perf;
+
+  if (fp->initialized) {
+    return;
+  }
+  fp->initialized = 1;
+
+  types[SC_FLOPS_CYCLES] = PERF_TYPE_HARDWARE;
+  configs[SC_FLOPS_CYCLES] = PERF_COUNT_HW_CPU_CYCLES;
+  types[SC_FLOPS_INSTRUCTIONS] = PERF_TYPE_HARDWARE;
+  configs[SC_FLOPS_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS;
+  types[SC_FLOPS_CACHE_REFERENCES] = PERF_TYPE_HARDWARE;
+  configs[SC_FLOPS_CACHE_REFERENCES] = PERF_COUNT_HW_CACHE_REFERENCES;
+  types[SC_FLOPS_CACHE_MISSES] = PERF_TYPE_HARDWARE;
+  configs[SC_FLOPS_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES;
+
+  /* there is no generic floating point event */
+  types[SC_FLOPS_PERF_FLPOPS] = PERF_TYPE_RAW;
+  raw = getenv ("SC_FLOPS_PERF_RAW");
+  configs[SC_FLOPS_PERF_FLPOPS] =
+    raw != NULL ? (__u64) strtoull (raw, NULL, 0) : 0;
+
+  /* hardware events are read together in one system call */
+  for (i = 0; i < SC_FLOPS_PERF_TASK_CLOCK; ++i) {
+    fp->slot[i] = -1;
+    if (i == SC_FLOPS_PERF_FLPOPS && configs[i] == 0) {
+      continue;
+    }
+    fd = sc_flops_perf_open (types[i], configs[i], fp->leader);
+    if (fd < 0) {
+      continue;
+    }
+    if (fp->leader < 0) {
+      fp->leader = fd;
+    }
+    fp->slot[i] = fp->nevents++;
+  }
+  if (fp->leader >= 0) {
+    ioctl (fp->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl (fp->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  /* the task clock replaces the process time of PAPI */
+  fp->slot[SC_FLOPS_PERF_TASK_CLOCK] = -1;
+  fp->task_clock = sc_flops_perf_open (PERF_TYPE_SOFTWARE,
+                                       PERF_COUNT_SW_TASK_CLOCK, -1);
+  if (fp->task_clock >= 0) {
+    ioctl (fp->task_clock, PERF_EVENT_IOC_RESET, 0);
+    ioctl (fp->task_clock, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+#endif /* SC_FLOPS_PERF */
+
+/** Read the perf events since their setup, -1 where not available. */
+static void
+sc_flops_perf_read (long long values[SC_FLOPS_PERF_NUM])
+{
+  int                 i;
+#ifdef SC_FLOPS_PERF
+  __u64               buffer[1 + SC_FLOPS_PERF_NUM];
+  struct sc_flops_perf *fp = &sc_flops_perf;
+#endif
+
+  for (i = 0; i < SC_FLOPS_PERF_NUM; ++i) {
+    values[i] = -1;
+  }
+#ifdef SC_FLOPS_PERF
+  SC_ASSERT (fp->initialized);
+  if (fp->leader >= 0 &&
+      read (fp->leader, buffer, sizeof (buffer)) >= (ssize_t)
+      ((1 + fp->nevents) * sizeof (__u64))) {
+    for (i = 0; i < SC_FLOPS_PERF_TASK_CLOCK; ++i) {
+      if (fp->slot[i] >= 0) {
+        values[i] = (long long) buffer[1 + fp->slot[i]];
+      }
+    }
+  }
+  if (fp->task_clock >= 0 &&
+      read (fp->task_clock, buffer, 2 * sizeof (__u64)) ==
+      2 * sizeof (__u64)) {
+    values[SC_FLOPS_PERF_TASK_CLOCK] = (long long) buffer[1];
+  }
+#endif
+}
+
 void
 sc_flops_papi (float *rtime, float *ptime, long long *flpops, float *mflops)
 {
@@ -47,12 +186,27 @@ sc_flops_papi (float *rtime, float *ptime, long long *flpops, float *mflops)
 static void
 sc_flops_start_internal (sc_flopinfo_t * fi, int use_papi)
 {
+  int                 i;
   float               rtime, ptime, mflops;
   long long           flpops;
+  long long           values[SC_FLOPS_PERF_NUM];
 
   fi->seconds = sc_MPI_Wtime ();
+  for (i = 0; i < SC_FLOPS_PERF_NUM; ++i) {
+    values[i] = -1;
+  }
   if (use_papi) {
     sc_flops_papi (&rtime, &ptime, &flpops, &mflops);     /* ignore results */
+#ifdef SC_FLOPS_PERF
+    sc_flops_perf_setup ();
+#endif
+    sc_flops_perf_read (values);
+  }
+  /* the perf counters are only reset once per process, so intervals
+     are measured against their current raw values */
+  for (i = 0; i < SC_FLOPS_NUM_COUNTERS; ++i) {
+    fi->ccounters[i] = values[i] >= 0 ? values[i] : -1;
+    fi->icounters[i] = values[i] >= 0 ? 0 : -1;
   }
 
   fi->cwtime = 0.;
@@ -81,13 +235,36 @@ sc_flops_start_nopapi (sc_flopinfo_t *fi)
 void
 sc_flops_count (sc_flopinfo_t * fi)
 {
+  int                 i;
   double              seconds;
   float               rtime = 0., ptime = 0.;
   long long           flpops = 0;
+  long long           values[SC_FLOPS_PERF_NUM];
 
   seconds = sc_MPI_Wtime ();
   if (fi->use_papi) {
     sc_flops_papi (&rtime, &ptime, &flpops, &fi->mflops);
+
+    /* the perf counters complement or replace what PAPI provides */
+    sc_flops_perf_read (values);
+    for (i = 0; i < SC_FLOPS_NUM_COUNTERS; ++i) {
+      if (fi->ccounters[i] >= 0 && values[i] >= 0) {
+        fi->icounters[i] = values[i] - fi->ccounters[i];
+        fi->ccounters[i] = values[i];
+      }
+    }
+#ifndef SC_PAPI
+    if (values[SC_FLOPS_PERF_TASK_CLOCK] >= 0) {
+      ptime = (float) (1.e-9 * values[SC_FLOPS_PERF_TASK_CLOCK]);
+    }
+    if (values[SC_FLOPS_PERF_FLPOPS] >= 0) {
+      flpops = values[SC_FLOPS_PERF_FLPOPS];
+      if (seconds > fi->seconds) {
+        fi->mflops = (float) ((double) (flpops - fi->cflpops) / 1.e6 /
+                              (seconds - fi->seconds));
+      }
+    }
+#endif
   }
 
   fi->iwtime = seconds - fi->seconds;
@@ -132,6 +309,7 @@ sc_flops_shot (sc_flopinfo_t * fi, sc_flopinfo_t * snapshot)
 void
 sc_flops_shotv (sc_flopinfo_t * fi, ...)
 {
+  int                 i;
   sc_flopinfo_t      *snapshot;
   va_list             ap;
 
@@ -151,6 +329,404 @@ sc_flops_shotv (sc_flopinfo_t * fi, ...)
     snapshot->crtime = fi->crtime;
     snapshot->cptime = fi->cptime;
     snapshot->cflpops = fi->cflpops;
+
+    for (i = 0; i < SC_FLOPS_NUM_COUNTERS; ++i) {
+      if (fi->ccounters[i] >= 0 && snapshot->ccounters[i] >= 0) {
+        snapshot->icounters[i] = fi->ccounters[i] - snapshot->ccounters[i];
+      }
+      snapshot->ccounters[i] = fi->ccounters[i];
+    }
   }
   va_end (ap);
 }
+
+/** One node of the call tree of a region profiler. */
+typedef struct sc_flops_rnode
+{
+  int                 region;   /**< Interned region id, -1 for the root. */
+  int                 parent;   /**< Index of parent node or -1. */
+  int                 child;    /**< Index of first child node or -1. */
+  int                 sibling;  /**< Index of next sibling node or -1. */
+  long                count;    /**< Number of completed visits. */
+  double              seconds;  /**< Inclusive time of completed visits. */
+}
+sc_flops_rnode_t;
+
+/** An open region on the stack of a region profiler. */
+typedef struct sc_flops_rframe
+{
+  int                 node;     /**< Index of the visited node. */
+  double              start;    /**< Timestamp when entering the node. */
+}
+sc_flops_rframe_t;
+
+struct sc_flops_regions
+{
+  sc_MPI_Comm         mpicomm;
+  long                serial;   /**< Unique among all profilers. */
+  sc_keyvalue_t      *kv;       /**< Map region name to its id. */
+  sc_array_t         *names;    /**< Owned region names by id. */
+  sc_array_t         *nodes;    /**< Call tree, node 0 is the root. */
+  sc_array_t         *stack;    /**< Currently open regions. */
+  int                 current;  /**< Node of the innermost open region. */
+
+  /* results of sc_flops_regions_compute */
+  char               *pathbuf;  /**< Global paths separated by '\0'. */
+  sc_array_t         *paths;    /**< Pointers into pathbuf, sorted. */
+  sc_array_t         *stats;    /**< Inclusive times, then exclusive times. */
+  int                 mpisize;
+};
+
+static sc_flops_rnode_t *
+sc_flops_regions_node (sc_flops_regions_t * fr, int node)
+{
+  return (sc_flops_rnode_t *) sc_array_index_int (fr->nodes, node);
+}
+
+static int
+sc_flops_regions_add_node (sc_flops_regions_t * fr, int region, int parent)
+{
+  int                 node;
+  sc_flops_rnode_t   *rn, *pn;
+
+  node = (int) fr->nodes->elem_count;
+  rn = (sc_flops_rnode_t *) sc_array_push (fr->nodes);
+  rn->region = region;
+  rn->parent = parent;
+  rn->child = -1;
+  rn->count = 0;
+  rn->seconds = 0.;
+  if (parent >= 0) {
+    /* prepend to the children of the parent */
+    pn = sc_flops_regions_node (fr, parent);
+    rn->sibling = pn->child;
+    pn->child = node;
+  }
+  else {
+    rn->sibling = -1;
+  }
+  return node;
+}
+
+static void
+sc_flops_regions_reset_results (sc_flops_regions_t * fr)
+{
+  if (fr->stats != NULL) {
+    sc_array_destroy_null (&fr->stats);
+  }
+  if (fr->paths != NULL) {
+    sc_array_destroy_null (&fr->paths);
+  }
+  if (fr->pathbuf != NULL) {
+    SC_FREE (fr->pathbuf);
+    fr->pathbuf = NULL;
+  }
+}
+
+/* the serial number of the most recently created profiler */
+static long         sc_flops_regions_last_serial = 0;
+
+sc_flops_regions_t *
+sc_flops_regions_new (sc_MPI_Comm mpicomm)
+{
+  sc_flops_regions_t *fr;
+
+  fr = SC_ALLOC_ZERO (sc_flops_regions_t, 1);
+  fr->mpicomm = mpicomm;
+  fr->serial = ++sc_flops_regions_last_serial;
+  fr->kv = sc_keyvalue_new ();
+  fr->names = sc_array_new (sizeof (char *));
+  fr->nodes = sc_array_new (sizeof (sc_flops_rnode_t));
+  fr->stack = sc_array_new (sizeof (sc_flops_rframe_t));
+  fr->current = sc_flops_regions_add_node (fr, -1, -1);
+
+  return fr;
+}
+
+long
+sc_flops_regions_serial (sc_flops_regions_t * fr)
+{
+  return fr->serial;
+}
+
+void
+sc_flops_regions_destroy (sc_flops_regions_t * fr)
+{
+  size_t              zz;
+
+  sc_flops_regions_reset_results (fr);
+  sc_keyvalue_destroy (fr->kv);
+  for (zz = 0; zz < fr->names->elem_count; ++zz) {
+    SC_FREE (*(char **) sc_array_index (fr->names, zz));
+  }
+  sc_array_destroy (fr->names);
+  sc_array_destroy (fr->nodes);
+  sc_array_destroy (fr->stack);
+
+  SC_FREE (fr);
+}
+
+int
+sc_flops_regions_intern (sc_flops_regions_t * fr, const char *name)
+{
+  int                 region;
+  char               *copy;
+
+  region = sc_keyvalue_get_int (fr->kv, name, -1);
+  if (region < 0) {
+    /* the key value container does not copy the key */
+    copy = SC_STRDUP (name);
+    region = (int) fr->names->elem_count;
+    *(char **) sc_array_push (fr->names) = copy;
+    sc_keyvalue_set_int (fr->kv, copy, region);
+  }
+  return region;
+}
+
+void
+sc_flops_regions_enter (sc_flops_regions_t * fr, int region)
+{
+  int                 node;
+  sc_flops_rnode_t   *rn;
+  sc_flops_rframe_t  *frame;
+
+  SC_CHECK_ABORT (0 <= region && (size_t) region < fr->names->elem_count,
+                  "Region id not interned by this profiler");
+
+  /* the number of distinct children is usually small */
+  for (node = sc_flops_regions_node (fr, fr->current)->child; node >= 0;
+       node = rn->sibling) {
+    rn = sc_flops_regions_node (fr, node);
+    if (rn->region == region) {
+      break;
+    }
+  }
+  if (node < 0) {
+    node = sc_flops_regions_add_node (fr, region, fr->current);
+  }
+  fr->current = node;
+
+  frame = (sc_flops_rframe_t *) sc_array_push (fr->stack);
+  frame->node = node;
+  frame->start = sc_MPI_Wtime ();
+}
+
+void
+sc_flops_regions_leave (sc_flops_regions_t * fr)
+{
+  double              seconds;
+  sc_flops_rnode_t   *rn;
+  sc_flops_rframe_t  *frame;
+
+  seconds = sc_MPI_Wtime ();
+
+  SC_ASSERT (fr->stack->elem_count > 0);
+  frame = (sc_flops_rframe_t *) sc_array_pop (fr->stack);
+  SC_ASSERT (frame->node == fr->current);
+
+  rn = sc_flops_regions_node (fr, frame->node);
+  rn->seconds += seconds - frame->start;
+  ++rn->count;
+  fr->current = rn->parent;
+}
+
+static int
+sc_flops_regions_path_compare (const void *v1, const void *v2)
+{
+  return strcmp (*(char *const *) v1, *(char *const *) v2);
+}
+
+/** Append the path of a node to a buffer, including the trailing '\0'. */
+static void
+sc_flops_regions_path (sc_flops_regions_t * fr, int node, sc_array_t * buf)
+{
+  size_t              len, at;
+  const char         *name;
+  char               *c;
+  sc_flops_rnode_t   *rn;
+
+  rn = sc_flops_regions_node (fr, node);
+  SC_ASSERT (rn->region >= 0);
+  if (rn->parent > 0) {
+    sc_flops_regions_path (fr, rn->parent, buf);
+    *(char *) sc_array_index (buf, buf->elem_count - 1) = ';';
+  }
+
+  name = *(char **) sc_array_index_int (fr->names, rn->region);
+  len = strlen (name) + 1;
+  at = buf->elem_count;
+  sc_array_push_count (buf, len);
+  memcpy (sc_array_index (buf, at), name, len);
+
+  /* the folded output format reserves these characters */
+  for (c = (char *) sc_array_index (buf, at); *c != '\0'; ++c) {
+    if (*c == ';' || isspace ((unsigned char) *c)) {
+      *c = '_';
+    }
+  }
+}
+
+void
+sc_flops_regions_compute (sc_flops_regions_t * fr)
+{
+  int                 mpiret;
+  int                 mpirank, mpisize;
+  int                 i, num_nodes, node;
+  int                 local_len, global_len, total;
+  int                *lens, *displs;
+  size_t              zz, num_paths;
+  double             *self;
+  char               *gathered, *c, **pc;
+  sc_array_t         *localbuf, *all;
+  sc_keyvalue_t      *local;
+  sc_flops_rnode_t   *rn;
+  sc_statinfo_t      *si;
+
+  sc_flops_regions_reset_results (fr);
+
+  mpiret = sc_MPI_Comm_size (fr->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (fr->mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  fr->mpisize = mpisize;
+
+  /* serialize the local paths, node 0 is the root without a path */
+  localbuf = sc_array_new (sizeof (char));
+  num_nodes = (int) fr->nodes->elem_count;
+  for (i = 1; i < num_nodes; ++i) {
+    sc_flops_regions_path (fr, i, localbuf);
+  }
+  local_len = (int) localbuf->elem_count;
+
+  /* rank 0 collects all paths and removes duplicates */
+  lens = displs = NULL;
+  gathered = NULL;
+  total = 0;
+  if (mpirank == 0) {
+    lens = SC_ALLOC (int, 2 * mpisize);
+    displs = lens + mpisize;
+  }
+  mpiret = sc_MPI_Gather (&local_len, 1, sc_MPI_INT,
+                          lens, 1, sc_MPI_INT, 0, fr->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    for (i = 0; i < mpisize; ++i) {
+      displs[i] = total;
+      total += lens[i];
+    }
+    gathered = SC_ALLOC (char, total + 1);
+  }
+  mpiret = sc_MPI_Gatherv (localbuf->array, local_len, sc_MPI_CHAR,
+                           gathered, lens, displs, sc_MPI_CHAR,
+                           0, fr->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  global_len = 0;
+  if (mpirank == 0) {
+    all = sc_array_new (sizeof (char *));
+    for (c = gathered; c < gathered + total; c += strlen (c) + 1) {
+      *(char **) sc_array_push (all) = c;
+    }
+    sc_array_sort (all, sc_flops_regions_path_compare);
+    sc_array_uniq (all, sc_flops_regions_path_compare);
+    for (zz = 0; zz < all->elem_count; ++zz) {
+      global_len += (int) strlen (*(char **) sc_array_index (all, zz)) + 1;
+    }
+    fr->pathbuf = SC_ALLOC (char, global_len + 1);
+    c = fr->pathbuf;
+    for (zz = 0; zz < all->elem_count; ++zz) {
+      pc = (char **) sc_array_index (all, zz);
+      strcpy (c, *pc);
+      c += strlen (c) + 1;
+    }
+    sc_array_destroy (all);
+    SC_FREE (gathered);
+    SC_FREE (lens);
+  }
+
+  /* every process learns the sorted list of global paths */
+  mpiret = sc_MPI_Bcast (&global_len, 1, sc_MPI_INT, 0, fr->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank != 0) {
+    fr->pathbuf = SC_ALLOC (char, global_len + 1);
+  }
+  mpiret = sc_MPI_Bcast (fr->pathbuf, global_len, sc_MPI_CHAR,
+                         0, fr->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  fr->paths = sc_array_new (sizeof (char *));
+  for (c = fr->pathbuf; c < fr->pathbuf + global_len; c += strlen (c) + 1) {
+    *(char **) sc_array_push (fr->paths) = c;
+  }
+  num_paths = fr->paths->elem_count;
+
+  /* exclusive time of a node subtracts the time of its children */
+  local = sc_keyvalue_new ();
+  self = SC_ALLOC (double, num_nodes);
+  for (i = 0; i < num_nodes; ++i) {
+    self[i] = sc_flops_regions_node (fr, i)->seconds;
+  }
+  c = (char *) localbuf->array;
+  for (i = 1; i < num_nodes; ++i) {
+    rn = sc_flops_regions_node (fr, i);
+    self[rn->parent] -= rn->seconds;
+    sc_keyvalue_set_int (local, c, i);
+    c += strlen (c) + 1;
+  }
+
+  /* inclusive times come first, exclusive times second */
+  fr->stats = sc_array_new_count (sizeof (sc_statinfo_t), 2 * num_paths);
+  for (zz = 0; zz < num_paths; ++zz) {
+    c = *(char **) sc_array_index (fr->paths, zz);
+    node = sc_keyvalue_get_int (local, c, -1);
+    rn = node >= 0 ? sc_flops_regions_node (fr, node) : NULL;
+    si = (sc_statinfo_t *) sc_array_index (fr->stats, zz);
+    if (rn != NULL && rn->count > 0) {
+      sc_stats_set1 (si, rn->seconds, c);
+      sc_stats_set1 (si + num_paths, SC_MAX (self[node], 0.), c);
+    }
+    else {
+      sc_stats_init (si, c);
+      sc_stats_init (si + num_paths, c);
+    }
+  }
+  sc_stats_compute (fr->mpicomm, 2 * (int) num_paths,
+                    (sc_statinfo_t *) fr->stats->array);
+
+  SC_FREE (self);
+  sc_keyvalue_destroy (local);
+  sc_array_destroy (localbuf);
+}
+
+void
+sc_flops_regions_print (sc_flops_regions_t * fr,
+                        int package_id, int log_priority, int full)
+{
+  SC_CHECK_ABORT (fr->stats != NULL, "Regions are not computed");
+
+  sc_stats_print (package_id, log_priority,
+                  (int) fr->paths->elem_count,
+                  (sc_statinfo_t *) fr->stats->array, full, 0);
+}
+
+int
+sc_flops_regions_write_folded (sc_flops_regions_t * fr, FILE * file)
+{
+  size_t              zz, num_paths;
+  long long           micro;
+  sc_statinfo_t      *si;
+
+  SC_CHECK_ABORT (fr->stats != NULL, "Regions are not computed");
+
+  num_paths = fr->paths->elem_count;
+  for (zz = 0; zz < num_paths; ++zz) {
+    si = (sc_statinfo_t *) sc_array_index (fr->stats, num_paths + zz);
+    micro = (long long) (1.e6 * si->sum_values / fr->mpisize + .5);
+    if (micro <= 0) {
+      continue;
+    }
+    if (fprintf (file, "%s %lld\n",
+                 *(char **) sc_array_index (fr->paths, zz), micro) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
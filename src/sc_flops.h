@@ -28,6 +28,19 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** Hardware counters measured in addition to floating point operations.
+ * They are read with the Linux perf_event interface where available.
+ */
+typedef enum sc_flops_counter
+{
+  SC_FLOPS_CYCLES,              /**< CPU cycles. */
+  SC_FLOPS_INSTRUCTIONS,        /**< Retired instructions. */
+  SC_FLOPS_CACHE_REFERENCES,    /**< Last level cache references. */
+  SC_FLOPS_CACHE_MISSES,        /**< Last level cache misses. */
+  SC_FLOPS_NUM_COUNTERS         /**< Number of hardware counters. */
+}
+sc_flops_counter_t;
+
 typedef struct sc_flopinfo
 {
   double              seconds;  /* current time from sc_MPI_Wtime */
@@ -45,8 +58,13 @@ typedef struct sc_flopinfo
   long long           iflpops;  /* interval floating point operations */
   float               mflops;   /* MFlop/s rate in this interval */
 
-  /* without SC_PAPI only seconds, ?wtime and ?rtime are meaningful */
+  /* without SC_PAPI only seconds, ?wtime and ?rtime are meaningful,
+     unless the perf_event counters below are available */
   int                 use_papi;
+
+  /* indexed by sc_flops_counter_t; -1 if a counter is not available */
+  long long           ccounters[SC_FLOPS_NUM_COUNTERS]; /* cumulative */
+  long long           icounters[SC_FLOPS_NUM_COUNTERS]; /* interval */
 }
 sc_flopinfo_t;
 
@@ -66,6 +84,17 @@ void                sc_flops_papi (float *rtime, float *ptime,
  * Must only be called once during the program run.
  * This function calls sc_flops_papi.
  *
+ * On Linux without SC_PAPI, the counters are read with perf_event_open.
+ * They are opened for the calling thread and cover the hardware counters
+ * listed in \ref sc_flops_counter_t, which fill ccounters and icounters.
+ * The counters are shared by all sc_flopinfo_t of a thread, thus ccounters
+ * hold their raw values and only icounters refer to this structure.
+ * The process time is taken from the task clock.  Since there is no
+ * portable floating point event, the environment variable
+ * SC_FLOPS_PERF_RAW may name a raw, model specific event code (such as
+ * 0x01c7 for scalar double operations on recent Intel CPUs) to be counted
+ * in cflpops and iflpops.  Counters the kernel refuses to open are -1.
+ *
  * \param [out] fi  Members will be initialized.
  */
 void                sc_flops_start (sc_flopinfo_t * fi);
@@ -73,7 +102,7 @@ void                sc_flops_start (sc_flopinfo_t * fi);
 /**
  * Prepare sc_flopinfo_t structure and ignore the flop counters.
  * This sc_flopinfo_t does not call PAPI_flops() in this function
- * or in sc_flops_count().
+ * or in sc_flops_count().  The hardware counters are set to -1.
  *
  * \param [out] fi  Members will be initialized.
  */
@@ -133,6 +162,115 @@ void                sc_flops_shotv (sc_flopinfo_t * fi, ...);
     sc_statistics_accumulate ((stat), __func__, (snap)->iwtime); \
   } while (0)
 
+/** Opaque hierarchical profiler for nested timed regions.
+ * Regions are identified by integer ids interned from their names.
+ * Entering and leaving a region reads one timestamp and updates a call
+ * tree; no string lookup and no communication is involved.
+ * The call trees of all processes are merged by \ref sc_flops_regions_compute
+ * and reduced with \ref sc_stats_compute.
+ */
+typedef struct sc_flops_regions sc_flops_regions_t;
+
+/** Create a new region profiler.
+ * \param [in] mpicomm  Communicator used by \ref sc_flops_regions_compute.
+ * \return              Profiler with an empty call tree.
+ */
+sc_flops_regions_t *sc_flops_regions_new (sc_MPI_Comm mpicomm);
+
+/** Destroy a region profiler and all its results.
+ * \param [in,out] fr   Profiler is invalidated.
+ */
+void                sc_flops_regions_destroy (sc_flops_regions_t * fr);
+
+/** Return a positive number that identifies a profiler.
+ * Profilers created later in the same process have larger numbers, so
+ * the number is not repeated even if a profiler reuses the memory of a
+ * destroyed one.
+ * \param [in] fr       Valid profiler.
+ * \return              Serial number of the profiler.
+ */
+long                sc_flops_regions_serial (sc_flops_regions_t * fr);
+
+/** Return the integer id of a region name, registering it on first use.
+ * The characters ';' and white space are replaced by '_' in the output.
+ * \param [in,out] fr   Valid profiler.
+ * \param [in] name     Region name, copied internally.
+ * \return              Non-negative id, identical for identical names.
+ */
+int                 sc_flops_regions_intern (sc_flops_regions_t * fr,
+                                             const char *name);
+
+/** Enter a region nested in the currently open one.
+ * \param [in,out] fr   Valid profiler.
+ * \param [in] region   Id returned by \ref sc_flops_regions_intern
+ *                      for this profiler.  Aborts on an unknown id.
+ */
+void                sc_flops_regions_enter (sc_flops_regions_t * fr,
+                                            int region);
+
+/** Leave the most recently entered region and add its elapsed time.
+ * \param [in,out] fr   Valid profiler with at least one open region.
+ */
+void                sc_flops_regions_leave (sc_flops_regions_t * fr);
+
+/** Merge the call trees of all processes and compute their statistics.
+ * This function is collective over the profiler's communicator.
+ * Open regions are not included in the results.
+ * Every call path is reported as one variable whose value per process is
+ * the inclusive time spent in it; processes that never entered a path do
+ * not contribute to its count, minimum, and maximum.
+ * \param [in,out] fr   Valid profiler.  Previous results are replaced.
+ */
+void                sc_flops_regions_compute (sc_flops_regions_t * fr);
+
+/** Print the inclusive time statistics of every call path.
+ * Must be called after \ref sc_flops_regions_compute.
+ * \param [in] fr           Valid profiler.
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] log_priority Log priority for output according to sc.h.
+ * \param [in] full         Print full information as in \ref sc_stats_print.
+ */
+void                sc_flops_regions_print (sc_flops_regions_t * fr,
+                                            int package_id, int log_priority,
+                                            int full);
+
+/** Write the call tree in the folded stack format of flame graph tools.
+ * Every line reads "outer;inner;innermost value" where the value is the
+ * exclusive time of the path in microseconds, averaged over all processes.
+ * Must be called after \ref sc_flops_regions_compute.
+ * This function is not collective; usually it is called on rank 0 only.
+ * \param [in] fr       Valid profiler.
+ * \param [in,out] file Open file stream to write to.
+ * \return              0 on success, -1 if writing the file failed.
+ */
+int                 sc_flops_regions_write_folded (sc_flops_regions_t * fr,
+                                                   FILE * file);
+
+/** Enter a region, interning its name only when the profiler changes.
+ * The id is cached at the call site together with the serial number of
+ * the profiler it was interned for, so alternating between profilers or
+ * creating a new one interns the name again.
+ */
+#define SC_FLOPS_REGION_ENTER(fr,name)                                  \
+  do {                                                                  \
+    static long         sc_flops_region_serial_ = 0;                    \
+    static int          sc_flops_region_id_ = -1;                       \
+    if (sc_flops_region_serial_ != sc_flops_regions_serial (fr)) {      \
+      sc_flops_region_id_ = sc_flops_regions_intern ((fr), (name));     \
+      sc_flops_region_serial_ = sc_flops_regions_serial (fr);           \
+    }                                                                   \
+    sc_flops_regions_enter ((fr), sc_flops_region_id_);                 \
+  } while (0)
+
+/** Leave a region entered with \ref SC_FLOPS_REGION_ENTER. */
+#define SC_FLOPS_REGION_LEAVE(fr) sc_flops_regions_leave (fr)
+
+/** Enter a region named by the current function. */
+#define SC_FUNC_REGION_ENTER(fr) SC_FLOPS_REGION_ENTER ((fr), __func__)
+
+/** Leave a region entered with \ref SC_FUNC_REGION_ENTER. */
+#define SC_FUNC_REGION_LEAVE(fr) sc_flops_regions_leave (fr)
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_FLOPS_H */
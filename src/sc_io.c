@@ -22,8 +22,9 @@
 */
 
 #include <sc_io.h>
-#include <sc_puff.h>
-#include <libb64.h>
+#include <sc_deflate.h>
+#include <sc_base64.h>
+#include <sc_string.h>
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
 #else
@@ -36,6 +37,82 @@
 #ifndef SC_ENABLE_MPIIO
 #include <errno.h>
 #endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#ifdef CPU_COUNT
+#define SC_IO_HAVE_AFFINITY
+#endif
+#endif
+#endif
+#ifdef SC_HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if defined (SC_HAVE_SYS_MMAN_H) && defined (SC_HAVE_SYS_STAT_H) && \
+  defined (SC_HAVE_FCNTL_H) && defined (SC_HAVE_UNISTD_H)
+#define SC_IO_HAVE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef SC_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined (SC_HAVE_FCNTL_H) && defined (SC_HAVE_UNISTD_H)
+#define SC_IO_HAVE_WRITER
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined (__x86_64__) && \
+  ((defined (__GNUC__) && __GNUC__ >= 5) || defined (__clang__))
+#define SC_IO_CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
+
+/* byte count of the bounded buffers used by the stream encodings */
+#define SC_IO_STREAM_BYTES 65536
+
+/* default block size, block alignment and block count of the writer */
+#define SC_IO_WRITER_BYTES (1 << 20)
+#define SC_IO_WRITER_ALIGN 4096
+#define SC_IO_WRITER_QUEUE 4
+#define SC_IO_WRITER_ROUNDUP(b) \
+  (((b) + SC_IO_WRITER_ALIGN - 1) / SC_IO_WRITER_ALIGN * SC_IO_WRITER_ALIGN)
+
+static int          sc_io_encoder_new (sc_io_sink_t * sink);
+static int          sc_io_encoder_write (sc_io_sink_t * sink,
+                                         const char *data, size_t bytes);
+static int          sc_io_encoder_finish (sc_io_sink_t * sink);
+static void         sc_io_encoder_destroy (sc_io_sink_t * sink);
+static int          sc_io_decoder_new (sc_io_source_t * source);
+static int          sc_io_decoder_read (sc_io_source_t * source, char *data,
+                                        size_t bytes_avail,
+                                        size_t *bytes_out);
+static void         sc_io_decoder_destroy (sc_io_source_t * source);
+static int          sc_io_writer_new (sc_io_sink_t * sink,
+                                      const char *filename,
+                                      size_t block_bytes, int flags);
+static int          sc_io_writer_write (sc_io_sink_t * sink,
+                                        const char *data, size_t bytes);
+static int          sc_io_writer_flush (sc_io_sink_t * sink);
+static int          sc_io_writer_destroy (sc_io_sink_t * sink);
+
+/** Close the file of a sink that has been opened by the sink. */
+static int
+sc_io_sink_close (sc_io_sink_t * sink)
+{
+  if (sink->writer != NULL) {
+    return sc_io_writer_destroy (sink);
+  }
+  if (sink->iotype == SC_IO_TYPE_FILENAME ||
+      sink->iotype == SC_IO_TYPE_FILEBLOCK) {
+    SC_ASSERT (sink->file != NULL);
+    return fclose (sink->file);
+  }
+  return 0;
+}
 
 sc_io_sink_t       *
 sc_io_sink_new (int iotype, int iomode, int ioencode, ...)
@@ -82,11 +159,38 @@ sc_io_sink_new (int iotype, int iomode, int ioencode, ...)
       return NULL;
     }
   }
+  else if (iotype == SC_IO_TYPE_FILEBLOCK) {
+    const char         *filename = va_arg (ap, const char *);
+    size_t              block_bytes = va_arg (ap, size_t);
+    int                 flags = va_arg (ap, int);
+
+    /* open a file on disk by name for writing in blocks */
+    if (sc_io_writer_new (sink, filename, block_bytes, flags)) {
+      va_end (ap);
+      SC_FREE (sink);
+      return NULL;
+    }
+  }
+  else if (iotype == SC_IO_TYPE_MMAP) {
+    /* a mapped file is read-only */
+    va_end (ap);
+    SC_FREE (sink);
+    return NULL;
+  }
   else {
     SC_ABORT_NOT_REACHED ();
   }
   va_end (ap);
 
+  /* the encoded output is a byte stream */
+  if (sink->encode != SC_IO_ENCODE_NONE &&
+      ((iotype == SC_IO_TYPE_BUFFER && sink->buffer->elem_size != 1) ||
+       sc_io_encoder_new (sink))) {
+    (void) sc_io_sink_close (sink);
+    SC_FREE (sink);
+    return NULL;
+  }
+
   /* this sink can now be called for writing */
   return sink;
 }
@@ -98,12 +202,12 @@ sc_io_sink_destroy (sc_io_sink_t * sink)
 
   /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
   retval = sc_io_sink_complete (sink, NULL, NULL);
-  if (sink->iotype == SC_IO_TYPE_FILENAME) {
-    SC_ASSERT (sink->file != NULL);
-
-    /* Attempt close even on complete error */
-    retval = fclose (sink->file) || retval;
+  if (sink->encoder != NULL) {
+    sc_io_encoder_destroy (sink);
   }
+
+  /* Attempt close even on complete error */
+  retval = sc_io_sink_close (sink) || retval;
   SC_FREE (sink);
 
   return retval ? SC_IO_ERROR_FATAL : SC_IO_ERROR_NONE;
@@ -128,20 +232,13 @@ sc_io_sink_destroy_null (sc_io_sink_t ** sink)
   return retval;
 }
 
-int
-sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
+/** Write bytes to the sink's target without encoding them. */
+static int
+sc_io_sink_write_raw (sc_io_sink_t * sink, const void *data,
+                      size_t bytes_avail)
 {
   size_t              bytes_out;
 
-  /* basic output preconditions */
-  SC_ASSERT (sink != NULL);
-  SC_ASSERT (data != NULL || bytes_avail == 0);
-
-  /* do nothing if there is no data requested */
-  if (bytes_avail == 0) {
-    return SC_IO_ERROR_NONE;
-  }
-
   /* do a regular write */
   bytes_out = 0;
 
@@ -166,8 +263,16 @@ sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
     sink->buffer_bytes += bytes_avail;
     bytes_out = bytes_avail;
   }
+  else if (sink->writer != NULL) {
+    /* copy the data into blocks written behind */
+    if (sc_io_writer_write (sink, (const char *) data, bytes_avail)) {
+      return SC_IO_ERROR_FATAL;
+    }
+    bytes_out = bytes_avail;
+  }
   else if (sink->iotype == SC_IO_TYPE_FILENAME ||
-           sink->iotype == SC_IO_TYPE_FILEFILE) {
+           sink->iotype == SC_IO_TYPE_FILEFILE ||
+           sink->iotype == SC_IO_TYPE_FILEBLOCK) {
     SC_ASSERT (sink->file != NULL);
     bytes_out = fwrite (data, 1, bytes_avail, sink->file);
     if (bytes_out != bytes_avail) {
@@ -177,18 +282,52 @@ sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
   }
 
   /* update internal state and return on successful operation */
-  sink->bytes_in += bytes_avail;
   sink->bytes_out += bytes_out;
 
   /* success! */
   return SC_IO_ERROR_NONE;
 }
 
+int
+sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
+{
+  int                 retval;
+
+  /* basic output preconditions */
+  SC_ASSERT (sink != NULL);
+  SC_ASSERT (data != NULL || bytes_avail == 0);
+
+  /* do nothing if there is no data requested */
+  if (bytes_avail == 0) {
+    return SC_IO_ERROR_NONE;
+  }
+
+  /* pass the data through the encoder if there is one */
+  if (sink->encoder == NULL) {
+    retval = sc_io_sink_write_raw (sink, data, bytes_avail);
+  }
+  else {
+    retval = sc_io_encoder_write (sink, (const char *) data, bytes_avail);
+  }
+  if (retval) {
+    return SC_IO_ERROR_FATAL;
+  }
+  sink->bytes_in += bytes_avail;
+
+  /* success! */
+  return SC_IO_ERROR_NONE;
+}
+
 int
 sc_io_sink_complete (sc_io_sink_t * sink, size_t *bytes_in, size_t *bytes_out)
 {
   int                 retval;
 
+  /* terminate the encoded stream; further writes begin a new one */
+  if (sink->encoder != NULL && sc_io_encoder_finish (sink)) {
+    return SC_IO_ERROR_FATAL;
+  }
+
   retval = 0;
   if (sink->iotype == SC_IO_TYPE_BUFFER) {
     SC_ASSERT (sink->buffer != NULL);
@@ -196,8 +335,12 @@ sc_io_sink_complete (sc_io_sink_t * sink, size_t *bytes_in, size_t *bytes_out)
       return SC_IO_ERROR_AGAIN;
     }
   }
+  else if (sink->writer != NULL) {
+    retval = sc_io_writer_flush (sink);
+  }
   else if (sink->iotype == SC_IO_TYPE_FILENAME ||
-           sink->iotype == SC_IO_TYPE_FILEFILE) {
+           sink->iotype == SC_IO_TYPE_FILEFILE ||
+           sink->iotype == SC_IO_TYPE_FILEBLOCK) {
     SC_ASSERT (sink->file != NULL);
     retval = fflush (sink->file);
   }
@@ -223,7 +366,7 @@ sc_io_sink_align (sc_io_sink_t * sink, size_t bytes_align)
   char               *fill;
   int                 retval;
 
-  fill_bytes = (bytes_align - sink->bytes_out % bytes_align) % bytes_align;
+  fill_bytes = (bytes_align - sink->bytes_in % bytes_align) % bytes_align;
   fill = SC_ALLOC_ZERO (char, fill_bytes);
   retval = sc_io_sink_write (sink, fill, fill_bytes);
   SC_FREE (fill);
@@ -270,11 +413,37 @@ sc_io_source_new (int iotype, int ioencode, ...)
       return NULL;
     }
   }
+  else if (iotype == SC_IO_TYPE_MMAP) {
+    const char         *filename = va_arg (ap, const char *);
+
+    /* read from a mapped file like from a buffer */
+    source->buffer = sc_io_file_map (filename, SC_IO_MAP_SEQUENTIAL);
+    if (source->buffer == NULL) {
+      va_end (ap);
+      SC_FREE (source);
+      return NULL;
+    }
+  }
+  else if (iotype == SC_IO_TYPE_FILEBLOCK) {
+    /* the block writer is write-only */
+    va_end (ap);
+    SC_FREE (source);
+    return NULL;
+  }
   else {
     SC_ABORT_NOT_REACHED ();
   }
   va_end (ap);
 
+  /* prepare decoding the input */
+  if (source->encode != SC_IO_ENCODE_NONE && sc_io_decoder_new (source)) {
+    if (iotype == SC_IO_TYPE_FILENAME) {
+      (void) fclose (source->file);
+    }
+    SC_FREE (source);
+    return NULL;
+  }
+
   /* this source can now be called for reading */
   return source;
 }
@@ -292,6 +461,12 @@ sc_io_source_destroy (sc_io_source_t * source)
     retval = sc_io_sink_destroy (source->mirror) || retval;
     sc_array_destroy (source->mirror_buffer);
   }
+  if (source->decoder != NULL) {
+    sc_io_decoder_destroy (source);
+  }
+  if (source->iotype == SC_IO_TYPE_MMAP) {
+    retval = sc_io_file_unmap (source->buffer) || retval;
+  }
 
   /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
   if (source->iotype == SC_IO_TYPE_FILENAME) {
@@ -324,30 +499,24 @@ sc_io_source_destroy_null (sc_io_source_t ** source)
   return retval;
 }
 
-int
-sc_io_source_read (sc_io_source_t * source, void *data,
-                   size_t bytes_avail, size_t *bytes_out)
+/** Read bytes from the source's origin without decoding them.
+ * The byte count read is always returned in bbytes_out.
+ * The end of input is recorded in is_eof.
+ */
+static int
+sc_io_source_read_raw (sc_io_source_t * source, void *data,
+                       size_t bytes_avail, size_t *pbytes_out, int *is_eof)
 {
   int                 retval;
   size_t              bbytes_out;
 
-  /* basic input preconditions.  It is legal if data is NULL */
-  SC_ASSERT (source != NULL);
-
-  /* do nothing also if the end of the file has been reached */
-  if (bytes_avail == 0 || source->is_eof) {
-    if (bytes_out != NULL) {
-      *bytes_out = 0;
-    }
-    return SC_IO_ERROR_NONE;
-  }
-
   /* do a regular read */
   retval = 0;
   bbytes_out = 0;
 
   /* switch on the type of source */
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
+  if (source->iotype == SC_IO_TYPE_BUFFER ||
+      source->iotype == SC_IO_TYPE_MMAP) {
     SC_ASSERT (source->buffer != NULL);
 
     /* access available elements by their byte count */
@@ -366,7 +535,7 @@ sc_io_source_read (sc_io_source_t * source, void *data,
     /* check for end of input and read if data is available */
     if (bbytes_out == 0) {
       /* register end of available data */
-      source->is_eof = 1;
+      *is_eof = 1;
     }
     else {
       /* we may be instructed to read less bytes than available */
@@ -388,7 +557,7 @@ sc_io_source_read (sc_io_source_t * source, void *data,
       bbytes_out = fread (data, 1, bytes_avail, source->file);
       if (bbytes_out < bytes_avail) {
         /* the item count read is short or zero, which is also short */
-        retval = !(source->is_eof = feof (source->file)) ||
+        retval = !(*is_eof = feof (source->file)) ||
                  ferror (source->file);
       }
       if (retval == SC_IO_ERROR_NONE && source->mirror != NULL) {
@@ -402,6 +571,46 @@ sc_io_source_read (sc_io_source_t * source, void *data,
     }
   }
 
+  /* process error conditions */
+  if (retval) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  /* return on successful operation */
+  *pbytes_out = bbytes_out;
+  source->bytes_in += bbytes_out;
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_source_read (sc_io_source_t * source, void *data,
+                   size_t bytes_avail, size_t *bytes_out)
+{
+  int                 retval;
+  size_t              bbytes_out;
+
+  /* basic input preconditions.  It is legal if data is NULL */
+  SC_ASSERT (source != NULL);
+
+  /* do nothing also if the end of the file has been reached */
+  if (bytes_avail == 0 || source->is_eof) {
+    if (bytes_out != NULL) {
+      *bytes_out = 0;
+    }
+    return SC_IO_ERROR_NONE;
+  }
+
+  /* pass the data through the decoder if there is one */
+  bbytes_out = 0;
+  if (source->decoder == NULL) {
+    retval = sc_io_source_read_raw (source, data, bytes_avail,
+                                    &bbytes_out, &source->is_eof);
+  }
+  else {
+    retval = sc_io_decoder_read (source, (char *) data, bytes_avail,
+                                 &bbytes_out);
+  }
+
   /* process error conditions */
   if (retval) {
     return SC_IO_ERROR_FATAL;
@@ -414,7 +623,6 @@ sc_io_source_read (sc_io_source_t * source, void *data,
   if (bytes_out != NULL) {
     *bytes_out = bbytes_out;
   }
-  source->bytes_in += bbytes_out;
   source->bytes_out += bbytes_out;
 
   /* success! */
@@ -427,7 +635,8 @@ sc_io_source_complete (sc_io_source_t * source,
 {
   int                 retval = SC_IO_ERROR_NONE;
 
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
+  if (source->iotype == SC_IO_TYPE_BUFFER ||
+      source->iotype == SC_IO_TYPE_MMAP) {
     SC_ASSERT (source->buffer != NULL);
     if (source->buffer_bytes % source->buffer->elem_size != 0) {
       return SC_IO_ERROR_AGAIN;
@@ -464,7 +673,9 @@ sc_io_source_align (sc_io_source_t * source, size_t bytes_align)
 int
 sc_io_source_activate_mirror (sc_io_source_t * source)
 {
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
+  if (source->iotype == SC_IO_TYPE_BUFFER ||
+      source->iotype == SC_IO_TYPE_MMAP ||
+      source->encode != SC_IO_ENCODE_NONE) {
     return SC_IO_ERROR_FATAL;
   }
   if (source->mirror != NULL) {
@@ -560,9 +771,12 @@ sc_io_file_load (const char *filename, sc_array_t * buffer)
   /* source is always a meaningful pointer and freed before return */
   sc_io_source_t     *source = NULL;
 
-  /* fixed window size for reading a usually small file */
-  const size_t        bwins = 1 << 14;
+  /* window size for reading a usually small file */
+  size_t              bwins = 1 << 14;
   size_t              bpos, bout;
+#ifdef SC_HAVE_SYS_STAT_H
+  struct stat         st;
+#endif
 
   SC_ASSERT (filename != NULL);
   SC_ASSERT (buffer != NULL);
@@ -575,6 +789,13 @@ sc_io_file_load (const char *filename, sc_array_t * buffer)
     SC_LERRORF ("sc_io_file_load: error opening %s\n", filename);
     return file_return (-1, sink, source);
   }
+#ifdef SC_HAVE_SYS_STAT_H
+
+  /* read a regular file of known size in one window to avoid regrowing */
+  if (!fstat (fileno (source->file), &st) && S_ISREG (st.st_mode)) {
+    bwins = SC_MAX (bwins, (size_t) st.st_size + 1);
+  }
+#endif
 
   /* perform reading in a loop */
   bpos = 0;
@@ -611,6 +832,205 @@ sc_io_file_load (const char *filename, sc_array_t * buffer)
   return file_return (0, sink, source);
 }
 
+/* CRC32C uses the reflected Castagnoli polynomial */
+#define SC_IO_CRC32C_POLY 0x82F63B78U
+
+/* lookup tables to process 8 bytes per step in software */
+static uint32_t     sc_io_crc32c_table[8][256];
+
+#ifdef SC_ENABLE_PTHREAD
+static pthread_once_t sc_io_crc32c_once = PTHREAD_ONCE_INIT;
+#else
+static int          sc_io_crc32c_ready = 0;
+#endif
+
+static void
+sc_io_crc32c_table_init (void)
+{
+  int                 i, j, k;
+  uint32_t            crc;
+
+  for (i = 0; i < 256; ++i) {
+    crc = (uint32_t) i;
+    for (j = 0; j < 8; ++j) {
+      crc = (crc >> 1) ^ (SC_IO_CRC32C_POLY & (0U - (crc & 1U)));
+    }
+    sc_io_crc32c_table[0][i] = crc;
+  }
+  for (i = 0; i < 256; ++i) {
+    crc = sc_io_crc32c_table[0][i];
+    for (k = 1; k < 8; ++k) {
+      crc = sc_io_crc32c_table[0][crc & 0xFF] ^ (crc >> 8);
+      sc_io_crc32c_table[k][i] = crc;
+    }
+  }
+}
+
+static uint32_t
+sc_io_crc32c_soft (uint32_t crc, const unsigned char *p, size_t len)
+{
+  uint32_t            lo, hi;
+  uint32_t          (*t)[256];
+
+#ifdef SC_ENABLE_PTHREAD
+  SC_EXECUTE_ASSERT_FALSE (pthread_once (&sc_io_crc32c_once,
+                                         sc_io_crc32c_table_init));
+#else
+  if (!sc_io_crc32c_ready) {
+    sc_io_crc32c_table_init ();
+    sc_io_crc32c_ready = 1;
+  }
+#endif
+  t = sc_io_crc32c_table;
+
+  for (; len > 0 && ((size_t) p & 7); --len) {
+    crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  }
+  for (; len >= 8; len -= 8, p += 8) {
+    /* assemble little endian words independent of the host */
+    lo = crc ^ ((uint32_t) p[0] | (uint32_t) p[1] << 8 |
+                (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24);
+    hi = ((uint32_t) p[4] | (uint32_t) p[5] << 8 |
+          (uint32_t) p[6] << 16 | (uint32_t) p[7] << 24);
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+      t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+      t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+      t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; len > 0; --len) {
+    crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#ifdef SC_IO_CRC32C_SSE42
+
+__attribute__ ((target ("sse4.2")))
+static uint32_t
+sc_io_crc32c_sse42 (uint32_t crc, const unsigned char *p, size_t len)
+{
+  uint64_t            c, v;
+
+  for (; len > 0 && ((size_t) p & 7); --len) {
+    crc = _mm_crc32_u8 (crc, *p++);
+  }
+  c = crc;
+  for (; len >= 8; len -= 8, p += 8) {
+    memcpy (&v, p, 8);
+    c = _mm_crc32_u64 (c, v);
+  }
+  crc = (uint32_t) c;
+  for (; len > 0; --len) {
+    crc = _mm_crc32_u8 (crc, *p++);
+  }
+  return crc;
+}
+
+#endif /* SC_IO_CRC32C_SSE42 */
+
+uint32_t
+sc_io_crc32c (uint32_t crc, const void *data, size_t length)
+{
+#ifdef SC_IO_CRC32C_SSE42
+  static int          has_sse42 = -1;
+#endif
+
+  SC_ASSERT (data != NULL || length == 0);
+
+  crc = ~crc;
+#ifdef SC_IO_CRC32C_SSE42
+  if (has_sse42 < 0) {
+    has_sse42 = __builtin_cpu_supports ("sse4.2") ? 1 : 0;
+  }
+  if (has_sse42) {
+    return ~sc_io_crc32c_sse42 (crc, (const unsigned char *) data, length);
+  }
+#endif
+  return ~sc_io_crc32c_soft (crc, (const unsigned char *) data, length);
+}
+
+sc_array_t         *
+sc_io_file_map (const char *filename, sc_io_map_advice_t advice)
+{
+#ifdef SC_IO_HAVE_MMAP
+  int                 fd, madv;
+  size_t              size;
+  void               *map;
+  struct stat         st;
+
+  SC_ASSERT (filename != NULL);
+
+  /* open the file and map it with its current size */
+  if ((fd = open (filename, O_RDONLY)) < 0) {
+    SC_LERRORF ("sc_io_file_map: error opening %s\n", filename);
+    return NULL;
+  }
+  if (fstat (fd, &st) || !S_ISREG (st.st_mode)) {
+    SC_LERRORF ("sc_io_file_map: not a regular file %s\n", filename);
+    (void) close (fd);
+    return NULL;
+  }
+  size = (size_t) st.st_size;
+  if (size == 0) {
+    /* an empty file cannot be mapped */
+    (void) close (fd);
+    return sc_array_new_data (NULL, 1, 0);
+  }
+  map = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  (void) close (fd);
+  if (map == MAP_FAILED) {
+    SC_LERRORF ("sc_io_file_map: error mapping %s\n", filename);
+    return NULL;
+  }
+
+  /* the hint is advisory and its failure is not an error */
+  switch (advice) {
+  case SC_IO_MAP_SEQUENTIAL:
+    madv = MADV_SEQUENTIAL;
+    break;
+  case SC_IO_MAP_RANDOM:
+    madv = MADV_RANDOM;
+    break;
+  case SC_IO_MAP_WILLNEED:
+    madv = MADV_WILLNEED;
+    break;
+  default:
+    madv = MADV_NORMAL;
+  }
+  (void) madvise (map, size, madv);
+
+  return sc_array_new_data (map, 1, size);
+#else
+  sc_array_t         *buffer;
+
+  /* without mmap we load the file into memory */
+  buffer = sc_array_new (1);
+  if (sc_io_file_load (filename, buffer)) {
+    sc_array_destroy (buffer);
+    return NULL;
+  }
+  return buffer;
+#endif
+}
+
+int
+sc_io_file_unmap (sc_array_t * view)
+{
+  int                 retval = 0;
+
+  SC_ASSERT (view != NULL);
+  SC_ASSERT (view->elem_size == 1);
+
+#ifdef SC_IO_HAVE_MMAP
+  if (!SC_ARRAY_IS_OWNER (view) && view->elem_count > 0) {
+    retval = munmap (view->array, view->elem_count);
+  }
+#endif
+  sc_array_destroy (view);
+
+  return retval ? -1 : 0;
+}
+
 /* byte count for one line of data must be a multiple of 3 */
 #define SC_IO_DBC 57
 #if SC_IO_DBC % 3 != 0
@@ -623,9 +1043,8 @@ sc_io_file_load (const char *filename, sc_array_t * buffer)
 #define SC_IO_LBE (SC_IO_LBD + 1)   /* after second line break byte */
 #define SC_IO_LBF (SC_IO_LBE + 1)   /* after line break and NUL byte */
 
-/* see RFC 1950 and RFC 1951 for the uncompressed zlib format */
+/* see RFC 1950 for the zlib format around the builtin deflate */
 #ifndef SC_HAVE_ZLIB
-#define SC_IO_NONCOMP_BLOCK 65531       /**< +5 byte header = 64k */
 #define SC_IO_ADLER32_PRIME 65521       /**< defined by RFC 1950 */
 
 static void
@@ -665,86 +1084,45 @@ sc_io_adler32_update (uint32_t *adler, const char *buffer, size_t length)
 static size_t
 sc_io_noncompress_bound (size_t length)
 {
-  size_t              num_blocks =
-    (length + (SC_IO_NONCOMP_BLOCK - 1)) / SC_IO_NONCOMP_BLOCK;
-
-  return 2 + 5 * SC_MAX (num_blocks, 1) + length + 4;
+  return 2 + SC_DEFLATE_BOUND (length) + 4;
 }
 
-static void
+/** Compress into the zlib format by the builtin deflate.
+ * \return              Number of bytes written.
+ */
+static size_t
 sc_io_noncompress (char *dest, size_t dest_size,
                    const char *src, size_t src_size)
 {
-  uint16_t            bsize, nsize;
+  size_t              length;
   uint32_t            adler;
 
   /* write zlib format header */
-  SC_ASSERT (dest_size >= 2);
+  SC_ASSERT (dest_size >= sc_io_noncompress_bound (src_size));
   dest[0] = (7 << 4) + 8;
   dest[1] = 1;
-  dest += 2;
-  dest_size -= 2;
 
-  /* prepare checksum */
-  sc_io_adler32_init (&adler);
-
-  /* write individual non-compressed blocks */
-  do {
-    /* write block header */
-    SC_ASSERT (dest_size >= 5);
-    if (src_size > SC_IO_NONCOMP_BLOCK) {
-      /* not the final block */
-      bsize = SC_IO_NONCOMP_BLOCK;
-      dest[0] = 0;
-    }
-    else {
-      /* last block */
-      bsize = src_size;
-      dest[0] = 1;
-    }
-    nsize = ~bsize;
-    dest[1] = (char) (bsize & 0xFF);
-    dest[2] = (char) (bsize >> 8);
-    dest[3] = (char) (nsize & 0xFF);
-    dest[4] = (char) (nsize >> 8);
-    dest += 5;
-    dest_size -= 5;
-
-    /* copy data */
-    SC_ASSERT (dest_size >= bsize);
-    SC_ASSERT (src_size >= bsize);
-    memcpy (dest, src, bsize);
-    dest += bsize;
-    dest_size -= bsize;
-
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, src, bsize);
-    src += bsize;
-    src_size -= bsize;
-  }
-  while (src_size > 0);
+  /* write deflate blocks */
+  length = 2 + sc_deflate (src, src_size, 1, dest + 2);
 
   /* write adler32 checksum */
-  SC_ASSERT (src_size == 0);
-  SC_ASSERT (dest_size == 4);
+  sc_io_adler32_init (&adler);
+  sc_io_adler32_update (&adler, src, src_size);
+  dest += length;
   dest[0] = (char) (adler >> 24);
   dest[1] = (char) ((adler >> 16) & 0xFF);
   dest[2] = (char) ((adler >> 8) & 0xFF);
   dest[3] = (char) (adler & 0xFF);
+  return length + 4;
 }
 
 static int
 sc_io_nonuncompress (char *dest, size_t dest_size,
                      const char *src, size_t src_size, void *re)
 {
-  int                 final_block;
   uint32_t            adler;
   unsigned char       uca, ucb;
-#ifndef SC_PUFF_INCLUDED
-  uint16_t            bsize, nsize;
-#else
-  unsigned long       destlen, sourcelen;
-#endif
+  size_t              in_bytes, out_bytes;
 
   /* in the future we will add runtime error reporting */
   SC_ASSERT (re == NULL);
@@ -770,100 +1148,1231 @@ sc_io_nonuncompress (char *dest, size_t dest_size,
   }
   src += 2;
   src_size -= 2;
+  if (src_size < 4) {
+    SC_LERROR ("uncompress content error\n");
+    return -1;
+  }
+
+  /* the deflate data must fill the space up to the checksum */
+  in_bytes = src_size - 4;
+  out_bytes = dest_size;
+  if (sc_inflate (src, &in_bytes, dest, &out_bytes)) {
+    SC_LERROR ("uncompress by inflate failed\n");
+    return -1;
+  }
+  if (in_bytes != src_size - 4 || out_bytes != dest_size) {
+    SC_LERROR ("uncompress content error\n");
+    return -1;
+  }
+  src += in_bytes;
 
-  /* prepare checksum */
+  /* verify adler32 checksum */
   sc_io_adler32_init (&adler);
+  sc_io_adler32_update (&adler, dest, dest_size);
+  if (src[0] != (char) (adler >> 24) ||
+      src[1] != (char) ((adler >> 16) & 0xFF) ||
+      src[2] != (char) ((adler >> 8) & 0xFF) ||
+      src[3] != (char) (adler & 0xFF)) {
+    SC_LERROR ("uncompress checksum error\n");
+    return -1;
+  }
 
-  /* go through zlib blocks */
-  do {
-    /* verify minimum required size */
-    if (src_size < 5) {
-      SC_LERROR ("uncompress block header short\n");
-      return -1;
-    }
-#ifdef SC_PUFF_INCLUDED
+  /* task accomplished */
+  return 0;
+}
 
-    /* use the builtin puff fallback to decompress deflate data */
-    destlen = (unsigned long) dest_size;
-    sourcelen = (unsigned long) src_size - 4;
-    if (sc_puff ((unsigned char *) dest, &destlen,
-                 (const unsigned char *) src, &sourcelen)) {
-      SC_LERROR ("uncompress by puff failed\n");
-      return -1;
-    }
-    if (destlen != (unsigned long) dest_size ||
-        sourcelen != (unsigned long) src_size - 4) {
-      SC_LERROR ("uncompress by puff mismatch\n");
-      return -1;
-    }
+#endif /* !SC_HAVE_ZLIB */
 
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, dest, dest_size);
-    src += sourcelen;
-    src_size = 4;
-    dest += destlen;
-    dest_size = 0;
-    final_block = 1;
+/** State of the stream encoding of a sink. */
+typedef struct sc_io_encoder
+{
+  int                 active;   /**< a stream is begun and not finished */
+#ifdef SC_HAVE_ZLIB
+  z_stream            zs;       /**< zlib deflate state */
+  char                buf[SC_IO_STREAM_BYTES];  /**< encoded output */
+#else
+  uint32_t            adler;    /**< checksum of the current stream */
+  size_t              fill;     /**< bytes of data not yet encoded */
+  char                data[SC_IO_STREAM_BYTES]; /**< data not yet encoded */
+  char                buf[SC_DEFLATE_BOUND (SC_IO_STREAM_BYTES)];
+                                /**< encoded output */
+#endif
+}
+sc_io_encoder_t;
+
+/** State of the stream decoding of a source. */
+typedef struct sc_io_decoder
+{
+  int                 active;   /**< a stream is begun and not finished */
+  int                 input_eof;        /**< the raw input is exhausted */
+  int                 failed;   /**< an error occurred; all reads fail */
+#ifdef SC_HAVE_ZLIB
+  z_stream            zs;       /**< zlib inflate state */
+  char                buf[SC_IO_STREAM_BYTES];  /**< encoded input */
 #else
+  sc_array_t         *decoded;  /**< all input decoded on first read */
+  size_t              pos;      /**< bytes of decoded data returned */
+#endif
+}
+sc_io_decoder_t;
+
+static int
+sc_io_encoder_new (sc_io_sink_t * sink)
+{
+  sc_io_encoder_t    *enc;
+
+  SC_ASSERT (sink->encode == SC_IO_ENCODE_ZLIB);
+  enc = SC_ALLOC_ZERO (sc_io_encoder_t, 1);
+#ifdef SC_HAVE_ZLIB
+  if (deflateInit (&enc->zs, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    SC_FREE (enc);
+    return -1;
+  }
+#endif
+  sink->encoder = enc;
+  return 0;
+}
+
+static void
+sc_io_encoder_destroy (sc_io_sink_t * sink)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+
+#ifdef SC_HAVE_ZLIB
+  (void) deflateEnd (&enc->zs);
+#endif
+  SC_FREE (enc);
+  sink->encoder = NULL;
+}
+
+#ifdef SC_HAVE_ZLIB
 
-    /* examine block header */
-    uca = (unsigned char) src[0];
-    if (uca > 1) {
-      SC_LERROR ("uncompress block header unsupported\n");
+/** Run deflate and write its output until it has no more to give. */
+static int
+sc_io_encoder_deflate (sc_io_sink_t * sink, int flush)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+  z_stream           *zs = &enc->zs;
+  size_t              have;
+
+  do {
+    zs->next_out = (Bytef *) enc->buf;
+    zs->avail_out = SC_IO_STREAM_BYTES;
+    if (deflate (zs, flush) == Z_STREAM_ERROR) {
       return -1;
     }
-    final_block = (uca == 1);
-    uca = (unsigned char) src[1];
-    ucb = (unsigned char) src[2];
-    bsize = (ucb << 8) + uca;
-    uca = (unsigned char) src[3];
-    ucb = (unsigned char) src[4];
-    nsize = (ucb << 8) + uca;
-    if ((final_block && bsize < dest_size) || bsize + nsize != 65535) {
-      SC_LERROR ("uncompress block header invalid\n");
+    have = SC_IO_STREAM_BYTES - zs->avail_out;
+    if (have > 0 && sc_io_sink_write_raw (sink, enc->buf, have)) {
+      return -1;
+    }
+  }
+  while (zs->avail_out == 0);
+  return 0;
+}
+
+static int
+sc_io_encoder_write (sc_io_sink_t * sink, const char *data, size_t bytes)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+  z_stream           *zs = &enc->zs;
+  size_t              chunk;
+
+  if (!enc->active) {
+    if (deflateReset (zs) != Z_OK) {
       return -1;
     }
-    src += 5;
-    src_size -= 5;
+    enc->active = 1;
+  }
 
-    /* copy data */
-    if (bsize > dest_size || bsize > src_size) {
-      SC_LERROR ("uncompress content overflow\n");
+  /* the input count of zlib may be shorter than size_t */
+  while (bytes > 0) {
+    chunk = SC_MIN (bytes, (size_t) UINT_MAX);
+    zs->next_in = (Bytef *) data;
+    zs->avail_in = (uInt) chunk;
+    if (sc_io_encoder_deflate (sink, Z_NO_FLUSH)) {
       return -1;
     }
-    memcpy (dest, src, bsize);
-    src += bsize;
-    src_size -= bsize;
+    SC_ASSERT (zs->avail_in == 0);
+    data += chunk;
+    bytes -= chunk;
+  }
+  return 0;
+}
+
+static int
+sc_io_encoder_finish (sc_io_sink_t * sink)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+
+  if (!enc->active) {
+    return 0;
+  }
+  enc->active = 0;
+  enc->zs.next_in = Z_NULL;
+  enc->zs.avail_in = 0;
+  return sc_io_encoder_deflate (sink, Z_FINISH);
+}
+
+#else
 
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, dest, bsize);
-    dest += bsize;
-    dest_size -= bsize;
+/** Deflate the pending data and write it as part of a zlib stream.
+ * Unless final, the output ends on a byte boundary for more to follow.
+ */
+static int
+sc_io_encoder_block (sc_io_sink_t * sink, int final)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+  size_t              bytes;
+
+  SC_ASSERT (enc->fill <= SC_IO_STREAM_BYTES);
+  bytes = sc_deflate (enc->data, enc->fill, final, enc->buf);
+  enc->fill = 0;
+  return bytes > 0 ? sc_io_sink_write_raw (sink, enc->buf, bytes) : 0;
+}
+
+static int
+sc_io_encoder_write (sc_io_sink_t * sink, const char *data, size_t bytes)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+  size_t              chunk;
+  char                header[2];
+
+  /* begin a stream with the zlib format header */
+  if (!enc->active) {
+    header[0] = (7 << 4) + 8;
+    header[1] = 1;
+    if (sc_io_sink_write_raw (sink, header, 2)) {
+      return -1;
+    }
+    sc_io_adler32_init (&enc->adler);
+    enc->fill = 0;
+    enc->active = 1;
+  }
+
+  /* collect data to deflate it in pieces */
+  while (bytes > 0) {
+    chunk = SC_MIN (bytes, SC_IO_STREAM_BYTES - enc->fill);
+    memcpy (enc->data + enc->fill, data, chunk);
+    sc_io_adler32_update (&enc->adler, data, chunk);
+    enc->fill += chunk;
+    data += chunk;
+    bytes -= chunk;
+    if (enc->fill == SC_IO_STREAM_BYTES && sc_io_encoder_block (sink, 0)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int
+sc_io_encoder_finish (sc_io_sink_t * sink)
+{
+  sc_io_encoder_t    *enc = (sc_io_encoder_t *) sink->encoder;
+  char                trailer[4];
+
+  if (!enc->active) {
+    return 0;
+  }
+  enc->active = 0;
+  if (sc_io_encoder_block (sink, 1)) {
+    return -1;
+  }
+  trailer[0] = (char) (enc->adler >> 24);
+  trailer[1] = (char) ((enc->adler >> 16) & 0xFF);
+  trailer[2] = (char) ((enc->adler >> 8) & 0xFF);
+  trailer[3] = (char) (enc->adler & 0xFF);
+  return sc_io_sink_write_raw (sink, trailer, 4);
+}
+
+#endif /* SC_HAVE_ZLIB */
+
+static int
+sc_io_decoder_new (sc_io_source_t * source)
+{
+  sc_io_decoder_t    *dec;
+
+  SC_ASSERT (source->encode == SC_IO_ENCODE_ZLIB);
+  dec = SC_ALLOC_ZERO (sc_io_decoder_t, 1);
+#ifdef SC_HAVE_ZLIB
+  if (inflateInit (&dec->zs) != Z_OK) {
+    SC_FREE (dec);
+    return -1;
+  }
 #endif
+  source->decoder = dec;
+  return 0;
+}
+
+static void
+sc_io_decoder_destroy (sc_io_source_t * source)
+{
+  sc_io_decoder_t    *dec = (sc_io_decoder_t *) source->decoder;
+
+#ifdef SC_HAVE_ZLIB
+  (void) inflateEnd (&dec->zs);
+#else
+  if (dec->decoded != NULL) {
+    sc_array_destroy (dec->decoded);
   }
-  while (!final_block);
-  if (src_size != 4 || dest_size != 0) {
-    SC_LERROR ("uncompress content error\n");
+#endif
+  SC_FREE (dec);
+  source->decoder = NULL;
+}
+
+#ifdef SC_HAVE_ZLIB
+
+static int
+sc_io_decoder_read_stream (sc_io_source_t * source, char *data,
+                           size_t bytes_avail, size_t *bytes_out)
+{
+  sc_io_decoder_t    *dec = (sc_io_decoder_t *) source->decoder;
+  z_stream           *zs = &dec->zs;
+  int                 zrv;
+  size_t              produced, chunk, nread;
+  char                skip[4096];
+
+  produced = 0;
+  while (produced < bytes_avail) {
+    /* refill the bounded input buffer */
+    if (zs->avail_in == 0 && !dec->input_eof) {
+      if (sc_io_source_read_raw (source, dec->buf, SC_IO_STREAM_BYTES,
+                                 &nread, &dec->input_eof)) {
+        return -1;
+      }
+      zs->next_in = (Bytef *) dec->buf;
+      zs->avail_in = (uInt) nread;
+    }
+    if (zs->avail_in == 0) {
+      SC_ASSERT (dec->input_eof);
+      if (dec->active) {
+        SC_LERROR ("sc_io_source: encoded stream truncated\n");
+        return -1;
+      }
+      source->is_eof = 1;
+      break;
+    }
+
+    /* concatenated streams are decoded one after the other */
+    if (!dec->active) {
+      if (inflateReset (zs) != Z_OK) {
+        return -1;
+      }
+      dec->active = 1;
+    }
+
+    /* data may be NULL to skip output */
+    chunk = bytes_avail - produced;
+    if (data != NULL) {
+      chunk = SC_MIN (chunk, (size_t) UINT_MAX);
+      zs->next_out = (Bytef *) (data + produced);
+    }
+    else {
+      chunk = SC_MIN (chunk, sizeof (skip));
+      zs->next_out = (Bytef *) skip;
+    }
+    zs->avail_out = (uInt) chunk;
+    zrv = inflate (zs, Z_NO_FLUSH);
+    produced += chunk - zs->avail_out;
+    if (zrv == Z_STREAM_END) {
+      dec->active = 0;
+    }
+    else if (zrv != Z_OK && zrv != Z_BUF_ERROR) {
+      SC_LERROR ("sc_io_source: encoded stream corrupt\n");
+      return -1;
+    }
+  }
+
+  *bytes_out = produced;
+  return 0;
+}
+
+#else
+
+/** Read all input and decode its concatenated zlib streams. */
+static int
+sc_io_decoder_load (sc_io_source_t * source, sc_io_decoder_t * dec)
+{
+  int                 retval;
+  size_t              pos, nread, dpos, remain, consumed = 0;
+  uint32_t            adler, trailer;
+  unsigned char      *src;
+  sc_array_t         *raw;
+
+  /* without zlib the input is kept in memory as a whole */
+  raw = sc_array_new (1);
+  do {
+    pos = raw->elem_count;
+    sc_array_resize (raw, pos + SC_IO_STREAM_BYTES);
+    if (sc_io_source_read_raw (source, raw->array + pos, SC_IO_STREAM_BYTES,
+                               &nread, &dec->input_eof)) {
+      sc_array_destroy (raw);
+      return -1;
+    }
+    sc_array_resize (raw, pos + nread);
+  }
+  while (!dec->input_eof);
+
+  retval = -1;
+  dec->decoded = sc_array_new (1);
+  for (pos = 0; pos < raw->elem_count; pos += 2 + consumed + 4) {
+    src = (unsigned char *) raw->array + pos;
+    remain = raw->elem_count - pos;
+
+    /* check zlib format header */
+    if (remain < 2 + 4 || (src[0] & 0x8F) != 8 ||
+        ((((unsigned) src[0]) << 8) + src[1]) % 31 || (src[1] & 0x20)) {
+      SC_LERROR ("sc_io_source: encoded header invalid\n");
+      goto load_error;
+    }
+
+    /* decode and append to the previous streams */
+    consumed = remain - 2 - 4;
+    dpos = dec->decoded->elem_count;
+    if (sc_inflate_array (src + 2, &consumed, dec->decoded)) {
+      SC_LERROR ("sc_io_source: decode by inflate failed\n");
+      goto load_error;
+    }
+
+    /* verify adler32 checksum */
+    sc_io_adler32_init (&adler);
+    sc_io_adler32_update (&adler, dec->decoded->array + dpos,
+                          dec->decoded->elem_count - dpos);
+    src += 2 + consumed;
+    trailer = ((uint32_t) src[0] << 24) | ((uint32_t) src[1] << 16) |
+      ((uint32_t) src[2] << 8) | (uint32_t) src[3];
+    if (adler != trailer) {
+      SC_LERROR ("sc_io_source: encoded checksum mismatch\n");
+      goto load_error;
+    }
+  }
+  retval = 0;
+
+load_error:
+  if (retval) {
+    /* partially decoded data must not be returned */
+    sc_array_destroy (dec->decoded);
+    dec->decoded = NULL;
+    dec->pos = 0;
+  }
+  sc_array_destroy (raw);
+  return retval;
+}
+
+static int
+sc_io_decoder_read_stream (sc_io_source_t * source, char *data,
+                           size_t bytes_avail, size_t *bytes_out)
+{
+  sc_io_decoder_t    *dec = (sc_io_decoder_t *) source->decoder;
+  size_t              bytes;
+
+  if (dec->decoded == NULL && sc_io_decoder_load (source, dec)) {
+    return -1;
+  }
+  SC_ASSERT (dec->pos <= dec->decoded->elem_count);
+  bytes = SC_MIN (bytes_avail, dec->decoded->elem_count - dec->pos);
+  if (data != NULL) {
+    memcpy (data, dec->decoded->array + dec->pos, bytes);
+  }
+  dec->pos += bytes;
+  if (bytes < bytes_avail) {
+    source->is_eof = 1;
+  }
+  *bytes_out = bytes;
+  return 0;
+}
+
+#endif /* SC_HAVE_ZLIB */
+
+static int
+sc_io_decoder_read (sc_io_source_t * source, char *data,
+                    size_t bytes_avail, size_t *bytes_out)
+{
+  sc_io_decoder_t    *dec = (sc_io_decoder_t *) source->decoder;
+
+  /* a decoding error is permanent for the source */
+  if (dec->failed ||
+      sc_io_decoder_read_stream (source, data, bytes_avail, bytes_out)) {
+    dec->failed = 1;
+    return -1;
+  }
+  return 0;
+}
+
+#ifdef SC_IO_HAVE_WRITER
+
+/** State of the block writer of a sink.
+ * The caller fills one block while the others are queued for writing.
+ * The file offset of every block is fixed when it is queued.
+ */
+typedef struct sc_io_writer
+{
+  int                 fd;       /**< file descriptor opened by the writer */
+  int                 flags;    /**< effective \ref sc_io_block_flags_t */
+  size_t              block_bytes;      /**< multiple of the alignment */
+  off_t               offset;   /**< file offset of the filled block */
+  size_t              fill;     /**< bytes in the filled block */
+  int                 ifill;    /**< index of the filled block */
+  int                 error;    /**< a write or sync has failed */
+  char               *blocks[SC_IO_WRITER_QUEUE];       /**< aligned memory */
+  size_t              lengths[SC_IO_WRITER_QUEUE];      /**< bytes to write */
+  off_t               offsets[SC_IO_WRITER_QUEUE];      /**< where to write */
+  int                 syncs[SC_IO_WRITER_QUEUE];        /**< sync after write */
+#ifdef SC_ENABLE_PTHREAD
+  int                 head;     /**< index of the next block to write */
+  int                 count;    /**< number of blocks queued for writing */
+  int                 shutdown; /**< the thread shall exit when idle */
+  pthread_t           thread;   /**< writes the queued blocks */
+  pthread_mutex_t     mutex;    /**< protects the queue and error */
+  pthread_cond_t      cond;     /**< signals any change of the queue */
+#endif
+}
+sc_io_writer_t;
+
+/** Write a block to its offset in the file. */
+static int
+sc_io_writer_block (sc_io_writer_t * w, int i)
+{
+  const char         *pos = w->blocks[i];
+  size_t              length = w->lengths[i];
+  off_t               offset = w->offsets[i];
+  ssize_t             written;
+
+  while (length > 0) {
+    written = pwrite (w->fd, pos, length, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    pos += written;
+    length -= (size_t) written;
+    offset += written;
+  }
+  return 0;
+}
+
+/** Synchronize the file contents to disk. */
+static int
+sc_io_writer_sync (sc_io_writer_t * w)
+{
+#ifdef SC_HAVE_FSYNC
+  return fsync (w->fd);
+#else
+  return 0;
+#endif
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+static void        *
+sc_io_writer_thread (void *v)
+{
+  int                 i, sync, retval;
+  sc_io_writer_t     *w = (sc_io_writer_t *) v;
+
+  pthread_mutex_lock (&w->mutex);
+  for (;;) {
+    while (w->count == 0 && !w->shutdown) {
+      pthread_cond_wait (&w->cond, &w->mutex);
+    }
+    if (w->count == 0) {
+      break;
+    }
+    i = w->head;
+    sync = w->syncs[i];
+    pthread_mutex_unlock (&w->mutex);
+
+    /* the block is released before the sync to let the caller proceed */
+    retval = sc_io_writer_block (w, i);
+    pthread_mutex_lock (&w->mutex);
+    w->error = w->error || retval;
+    w->head = (w->head + 1) % SC_IO_WRITER_QUEUE;
+    --w->count;
+    pthread_cond_broadcast (&w->cond);
+    if (sync) {
+      pthread_mutex_unlock (&w->mutex);
+      retval = sc_io_writer_sync (w);
+      pthread_mutex_lock (&w->mutex);
+      w->error = w->error || retval;
+    }
+  }
+  pthread_mutex_unlock (&w->mutex);
+
+  return NULL;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+/** Queue the filled block for writing and return a free one to fill.
+ * \return              Nonzero if any previous write has failed.
+ */
+static int
+sc_io_writer_submit (sc_io_writer_t * w, size_t length, int sync)
+{
+  const int           i = w->ifill;
+  int                 retval;
+
+  w->lengths[i] = length;
+  w->offsets[i] = w->offset;
+  w->syncs[i] = sync;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&w->mutex);
+  SC_ASSERT (i == (w->head + w->count) % SC_IO_WRITER_QUEUE);
+  ++w->count;
+  pthread_cond_broadcast (&w->cond);
+  while (w->count == SC_IO_WRITER_QUEUE) {
+    pthread_cond_wait (&w->cond, &w->mutex);
+  }
+  w->ifill = (w->head + w->count) % SC_IO_WRITER_QUEUE;
+  retval = w->error;
+  pthread_mutex_unlock (&w->mutex);
+#else
+  w->error = w->error || sc_io_writer_block (w, i) ||
+    (sync && sc_io_writer_sync (w));
+  retval = w->error;
+#endif
+
+  return retval;
+}
+
+/** Wait until all queued blocks are written.
+ * \return              Nonzero if any write has failed.
+ */
+static int
+sc_io_writer_wait (sc_io_writer_t * w)
+{
+  int                 retval;
+
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&w->mutex);
+  while (w->count > 0) {
+    pthread_cond_wait (&w->cond, &w->mutex);
+  }
+  retval = w->error;
+  pthread_mutex_unlock (&w->mutex);
+#else
+  retval = w->error;
+#endif
+
+  return retval;
+}
+
+static void
+sc_io_writer_free (sc_io_writer_t * w)
+{
+  int                 i;
+
+  for (i = 0; i < SC_IO_WRITER_QUEUE; ++i) {
+#ifdef SC_HAVE_POSIX_MEMALIGN
+    free (w->blocks[i]);
+#else
+    SC_FREE (w->blocks[i]);
+#endif
+  }
+  SC_FREE (w);
+}
+
+static int
+sc_io_writer_new (sc_io_sink_t * sink, const char *filename,
+                  size_t block_bytes, int flags)
+{
+  int                 i, oflags;
+  sc_io_writer_t     *w;
+
+  SC_ASSERT (filename != NULL);
+
+  w = SC_ALLOC_ZERO (sc_io_writer_t, 1);
+  w->flags = flags;
+  if (block_bytes == 0) {
+    block_bytes = SC_IO_WRITER_BYTES;
+  }
+  w->block_bytes = SC_IO_WRITER_ROUNDUP (block_bytes);
+  for (i = 0; i < SC_IO_WRITER_QUEUE; ++i) {
+#ifdef SC_HAVE_POSIX_MEMALIGN
+    if (posix_memalign ((void **) &w->blocks[i], SC_IO_WRITER_ALIGN,
+                        w->block_bytes)) {
+      w->blocks[i] = NULL;
+      sc_io_writer_free (w);
+      return -1;
+    }
+#else
+    /* unaligned memory cannot be used for direct access */
+    w->blocks[i] = SC_ALLOC (char, w->block_bytes);
+    w->flags &= ~SC_IO_BLOCK_DIRECT;
+#endif
+  }
+
+  /* writes go to explicit offsets, so we do not open for appending */
+  oflags = O_WRONLY | O_CREAT;
+  if (sink->mode == SC_IO_MODE_WRITE) {
+    oflags |= O_TRUNC;
+  }
+  if ((w->fd = open (filename, oflags, 0666)) < 0) {
+    sc_io_writer_free (w);
+    return -1;
+  }
+  if (sink->mode == SC_IO_MODE_APPEND &&
+      (w->offset = lseek (w->fd, 0, SEEK_END)) < 0) {
+    (void) close (w->fd);
+    sc_io_writer_free (w);
+    return -1;
+  }
+
+  /* direct access is optional and requires aligned offsets */
+  if (w->flags & SC_IO_BLOCK_DIRECT) {
+#ifdef O_DIRECT
+    if (w->offset % SC_IO_WRITER_ALIGN != 0 ||
+        (oflags = fcntl (w->fd, F_GETFL)) < 0 ||
+        fcntl (w->fd, F_SETFL, oflags | O_DIRECT) < 0) {
+      w->flags &= ~SC_IO_BLOCK_DIRECT;
+    }
+#else
+    w->flags &= ~SC_IO_BLOCK_DIRECT;
+#endif
+  }
+
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_init (&w->mutex, NULL);
+  pthread_cond_init (&w->cond, NULL);
+  if (pthread_create (&w->thread, NULL, sc_io_writer_thread, w)) {
+    pthread_cond_destroy (&w->cond);
+    pthread_mutex_destroy (&w->mutex);
+    (void) close (w->fd);
+    sc_io_writer_free (w);
+    return -1;
+  }
+#endif
+  sink->writer = w;
+  return 0;
+}
+
+static int
+sc_io_writer_write (sc_io_sink_t * sink, const char *data, size_t bytes)
+{
+  size_t              n;
+  sc_io_writer_t     *w = (sc_io_writer_t *) sink->writer;
+
+  while (bytes > 0) {
+    n = SC_MIN (bytes, w->block_bytes - w->fill);
+    memcpy (w->blocks[w->ifill] + w->fill, data, n);
+    w->fill += n;
+    data += n;
+    bytes -= n;
+    if (w->fill == w->block_bytes) {
+      if (sc_io_writer_submit (w, w->block_bytes, 0)) {
+        return -1;
+      }
+      w->offset += w->block_bytes;
+      w->fill = 0;
+    }
+  }
+  return 0;
+}
+
+static int
+sc_io_writer_flush (sc_io_sink_t * sink)
+{
+  int                 i, retval;
+  size_t              length;
+  sc_io_writer_t     *w = (sc_io_writer_t *) sink->writer;
+
+  /* direct access writes the partial block padded with zeros */
+  i = w->ifill;
+  length = w->fill;
+  if (w->flags & SC_IO_BLOCK_DIRECT) {
+    length = SC_IO_WRITER_ROUNDUP (length);
+    memset (w->blocks[i] + w->fill, 0, length - w->fill);
+  }
+  retval = sc_io_writer_submit (w, length, w->flags & SC_IO_BLOCK_FSYNC);
+  retval = sc_io_writer_wait (w) || retval;
+
+  if (length == w->fill) {
+    w->offset += w->fill;
+    w->fill = 0;
+  }
+  else if (w->ifill != i) {
+    /* the padded block is overwritten once it is filled up */
+    memcpy (w->blocks[w->ifill], w->blocks[i], w->fill);
+  }
+  return retval;
+}
+
+static int
+sc_io_writer_destroy (sc_io_sink_t * sink)
+{
+  int                 retval;
+  sc_io_writer_t     *w = (sc_io_writer_t *) sink->writer;
+
+#ifdef SC_ENABLE_PTHREAD
+  /* the thread finishes all queued work before it exits */
+  pthread_mutex_lock (&w->mutex);
+  w->shutdown = 1;
+  pthread_cond_broadcast (&w->cond);
+  pthread_mutex_unlock (&w->mutex);
+  SC_EXECUTE_ASSERT_FALSE (pthread_join (w->thread, NULL));
+  pthread_cond_destroy (&w->cond);
+  pthread_mutex_destroy (&w->mutex);
+#endif
+  retval = w->error;
+
+  /* remove the padding of the last block */
+  if (w->flags & SC_IO_BLOCK_DIRECT) {
+    retval = ftruncate (w->fd, w->offset + (off_t) w->fill) || retval;
+  }
+  retval = close (w->fd) || retval;
+  sc_io_writer_free (w);
+  sink->writer = NULL;
+
+  return retval ? -1 : 0;
+}
+
+#else /* !SC_IO_HAVE_WRITER */
+
+static int
+sc_io_writer_new (sc_io_sink_t * sink, const char *filename,
+                  size_t block_bytes, int flags)
+{
+  /* fall back to writing through a large stdio buffer */
+  sink->file = fopen (filename, sink->mode == SC_IO_MODE_WRITE ? "wb" : "ab");
+  if (sink->file == NULL) {
+    return -1;
+  }
+  if (block_bytes == 0) {
+    block_bytes = SC_IO_WRITER_BYTES;
+  }
+  (void) setvbuf (sink->file, NULL, _IOFBF, block_bytes);
+  return 0;
+}
+
+static int
+sc_io_writer_write (sc_io_sink_t * sink, const char *data, size_t bytes)
+{
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
+
+static int
+sc_io_writer_flush (sc_io_sink_t * sink)
+{
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
+
+static int
+sc_io_writer_destroy (sc_io_sink_t * sink)
+{
+  SC_ABORT_NOT_REACHED ();
+  return -1;
+}
+
+#endif /* !SC_IO_HAVE_WRITER */
+
+#define SC_IO_ENCODE_INFO_LEN 9
+
+/* number of base 64 lines coded by one task */
+#define SC_IO_TASK_LINES 4096
+
+/* default number of bytes compressed per block by sc_io_encode_parallel */
+#define SC_IO_ENCODE_BLOCK_BYTES (1 << 20)
+
+/** Function to execute one of a number of independent tasks. */
+typedef void        (*sc_io_task_t) (void *ctx, size_t itask);
+
+/** Tasks to be executed by a number of threads. */
+typedef struct sc_io_tasks
+{
+  sc_io_task_t        task;     /**< called for every task index */
+  void               *ctx;      /**< passed to every call */
+  size_t              num_tasks;        /**< number of task indices */
+  size_t              next;     /**< next task index to execute */
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_t     mutex;    /**< protects the next task index */
+#endif
+}
+sc_io_tasks_t;
+
+static void        *
+sc_io_tasks_worker (void *v)
+{
+  size_t              itask;
+  sc_io_tasks_t      *tasks = (sc_io_tasks_t *) v;
+
+  for (;;) {
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_lock (&tasks->mutex);
+#endif
+    itask = tasks->next++;
+#ifdef SC_ENABLE_PTHREAD
+    pthread_mutex_unlock (&tasks->mutex);
+#endif
+    if (itask >= tasks->num_tasks) {
+      break;
+    }
+    tasks->task (tasks->ctx, itask);
+  }
+  return NULL;
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+/** Return the number of processors this process may run on.
+ * The affinity mask is respected, such that an MPI process bound to one
+ * core does not start more threads than it has cores to run them.
+ * \return                  Between 1 and 64.
+ */
+static int
+sc_io_threads_available (void)
+{
+  long                num_cpus = 1;
+#ifdef SC_IO_HAVE_AFFINITY
+  cpu_set_t           cpus;
+
+  CPU_ZERO (&cpus);
+  if (!sched_getaffinity (0, sizeof (cpus), &cpus)) {
+    num_cpus = CPU_COUNT (&cpus);
+  }
+#elif defined (SC_HAVE_UNISTD_H) && defined (_SC_NPROCESSORS_ONLN)
+  num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+  return (int) SC_MAX (1, SC_MIN (num_cpus, 64));
+}
+
+#endif
+
+/** Execute independent tasks, in parallel if threads are enabled.
+ * \param [in] num_threads      Maximum number of threads including the
+ *                              calling one.  If <= 0, use as many as
+ *                              processors are available to the process.
+ */
+static void
+sc_io_tasks_run (sc_io_task_t task, void *ctx, size_t num_tasks,
+                 int num_threads)
+{
+  sc_io_tasks_t       tasks;
+#ifdef SC_ENABLE_PTHREAD
+  int                 t, started;
+  pthread_t          *threads;
+#endif
+
+  tasks.task = task;
+  tasks.ctx = ctx;
+  tasks.num_tasks = num_tasks;
+  tasks.next = 0;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_init (&tasks.mutex, NULL);
+  if (num_threads <= 0) {
+    num_threads = sc_io_threads_available ();
+  }
+  if ((size_t) num_threads > num_tasks) {
+    num_threads = (int) num_tasks;
+  }
+  if (num_threads > 1) {
+    /* the calling thread works as well and any failed start is harmless */
+    threads = SC_ALLOC (pthread_t, num_threads - 1);
+    for (started = 0; started < num_threads - 1; ++started) {
+      if (pthread_create (&threads[started], NULL,
+                          sc_io_tasks_worker, &tasks)) {
+        break;
+      }
+    }
+    (void) sc_io_tasks_worker (&tasks);
+    for (t = 0; t < started; ++t) {
+      SC_EXECUTE_ASSERT_FALSE (pthread_join (threads[t], NULL));
+    }
+    SC_FREE (threads);
+  }
+  else {
+    (void) sc_io_tasks_worker (&tasks);
+  }
+  pthread_mutex_destroy (&tasks.mutex);
+#else
+  (void) sc_io_tasks_worker (&tasks);
+#endif
+}
+
+/** Context of the base 64 coding of independent lines. */
+typedef struct sc_io_base64_job
+{
+  const char         *in;       /**< input of the coding */
+  size_t              in_bytes; /**< byte count of the input */
+  char               *out;      /**< output of the coding */
+  size_t              lines;    /**< number of lines */
+  int                 line_break_character; /**< first line break byte */
+  char               *errors;   /**< decoding error flag per task */
+  size_t              last_out; /**< decoded bytes of the last line */
+}
+sc_io_base64_job_t;
+
+/* Every line but the last encodes SC_IO_DBC bytes, a multiple of 3,
+   such that the coding of each line is independent of all others. */
+static void
+sc_io_base64_encode_task (void *ctx, size_t itask)
+{
+  size_t              zlin, lein, lout;
+  size_t              first = itask * SC_IO_TASK_LINES;
+  size_t              last;
+  char               *opos;
+  sc_io_base64_job_t *job = (sc_io_base64_job_t *) ctx;
+
+  last = SC_MIN (job->lines, first + SC_IO_TASK_LINES);
+  for (zlin = first; zlin < last; ++zlin) {
+    lein = SC_MIN (job->in_bytes - zlin * SC_IO_DBC, SC_IO_DBC);
+    opos = job->out + zlin * SC_IO_LBE;
+    lout = sc_base64_encode (job->in + zlin * SC_IO_DBC, lein, opos);
+    SC_ASSERT (lout == SC_IO_LBC || zlin == job->lines - 1);
+    opos[lout] = (char) job->line_break_character;
+    opos[lout + 1] = '\n';
+  }
+}
+
+/** Encode data to base 64 in lines terminated by line breaks and a NUL.
+ * The output array is resized to the encoded length.
+ */
+static void
+sc_io_base64_encode (const char *in, size_t in_bytes, sc_array_t *out,
+                     int line_break_character, int num_threads)
+{
+  size_t              encoded_size;
+  sc_io_base64_job_t  job;
+
+  SC_ASSERT (in_bytes > 0);
+  SC_ASSERT (out->elem_size == 1);
+
+  job.in = in;
+  job.in_bytes = in_bytes;
+  job.lines = (in_bytes + SC_IO_DBC - 1) / SC_IO_DBC;
+  job.line_break_character = line_break_character;
+  encoded_size = 4 * ((in_bytes + 2) / 3) + 2 * job.lines + 1;
+  sc_array_resize (out, encoded_size);
+  job.out = out->array;
+
+  sc_io_tasks_run (sc_io_base64_encode_task, &job,
+                   (job.lines + SC_IO_TASK_LINES - 1) / SC_IO_TASK_LINES,
+                   num_threads);
+  out->array[encoded_size - 1] = '\0';
+}
+
+static void
+sc_io_base64_decode_task (void *ctx, size_t itask)
+{
+  size_t              zlin, lein, lout;
+  size_t              first = itask * SC_IO_TASK_LINES;
+  size_t              last;
+  sc_io_base64_job_t *job = (sc_io_base64_job_t *) ctx;
+
+  last = SC_MIN (job->lines, first + SC_IO_TASK_LINES);
+  for (zlin = first; zlin < last; ++zlin) {
+    lein = SC_MIN (job->in_bytes - zlin * SC_IO_LBE, SC_IO_LBC);
+    if (sc_base64_decode (job->in + zlin * SC_IO_LBE, lein,
+                          job->out + zlin * SC_IO_DBC, &lout) ||
+        lout == 0 || (zlin < job->lines - 1 && lout != SC_IO_DBC)) {
+      job->errors[itask] = 1;
+      return;
+    }
+    if (zlin == job->lines - 1) {
+      job->last_out = lout;
+    }
+  }
+}
+
+/** Decode base 64 lines as written by \ref sc_io_base64_encode.
+ * \param [out] decoded     Initialized array of element size 1, resized
+ *                          to the decoded data.
+ * \return                  0 on success, -1 on decoding error.
+ */
+static int
+sc_io_base64_decode (const char *in, size_t in_bytes, sc_array_t *decoded,
+                     int num_threads)
+{
+  int                 retval = 0;
+  size_t              zz, num_tasks;
+  sc_io_base64_job_t  job;
+
+  SC_ASSERT (decoded->elem_size == 1);
+
+  /* the input length excludes the terminating NUL */
+  job.in = in;
+  job.lines = (in_bytes + SC_IO_LBD) / SC_IO_LBE;
+  if (job.lines == 0 || in_bytes < (job.lines - 1) * SC_IO_LBE + 3) {
+    SC_LERROR ("base 64 decode short\n");
+    return -1;
+  }
+  job.in_bytes = in_bytes - 2;
+  job.last_out = 0;
+  sc_array_resize (decoded, job.lines * SC_IO_DBC);
+  job.out = decoded->array;
+  num_tasks = (job.lines + SC_IO_TASK_LINES - 1) / SC_IO_TASK_LINES;
+  job.errors = SC_ALLOC_ZERO (char, num_tasks);
+
+  sc_io_tasks_run (sc_io_base64_decode_task, &job, num_tasks, num_threads);
+  for (zz = 0; zz < num_tasks; ++zz) {
+    if (job.errors[zz]) {
+      SC_LERROR ("base 64 decode mismatch\n");
+      retval = -1;
+      break;
+    }
+  }
+  SC_FREE (job.errors);
+  if (!retval) {
+    sc_array_resize (decoded, (job.lines - 1) * SC_IO_DBC + job.last_out);
+  }
+  return retval;
+}
+
+/** Context of the compression of independent blocks. */
+typedef struct sc_io_block_job
+{
+  const char         *in;       /**< uncompressed data */
+  size_t              in_bytes; /**< uncompressed byte count */
+  size_t              block_size;       /**< uncompressed bytes per block */
+  int                 level;    /**< zlib compression level */
+  char              **blocks;   /**< compressed data per block */
+  size_t             *lengths;  /**< compressed byte count per block */
+  char               *out;      /**< uncompressed output on decoding */
+  const char         *src;      /**< compressed input on decoding */
+  size_t             *offsets;  /**< input offset per block on decoding */
+  char               *errors;   /**< error flag per block on decoding */
+}
+sc_io_block_job_t;
+
+static void
+sc_io_block_compress_task (void *ctx, size_t iblock)
+{
+  size_t              pos, len;
+  sc_io_block_job_t  *job = (sc_io_block_job_t *) ctx;
+#ifdef SC_HAVE_ZLIB
+  int                 zrv;
+  uLong               bound;
+#else
+  size_t              bound;
+#endif
+
+  pos = iblock * job->block_size;
+  len = SC_MIN (job->in_bytes - pos, job->block_size);
+#ifndef SC_HAVE_ZLIB
+  bound = sc_io_noncompress_bound (len);
+  job->blocks[iblock] = SC_ALLOC (char, bound);
+  job->lengths[iblock] = sc_io_noncompress (job->blocks[iblock], bound,
+                                            job->in + pos, len);
+#else
+  bound = compressBound ((uLong) len);
+  job->blocks[iblock] = SC_ALLOC (char, bound);
+  zrv = compress2 ((Bytef *) job->blocks[iblock], &bound,
+                   (const Bytef *) job->in + pos, (uLong) len, job->level);
+  SC_CHECK_ABORT (zrv == Z_OK, "Error on zlib compression");
+  job->lengths[iblock] = (size_t) bound;
+#endif
+}
+
+static void
+sc_io_block_uncompress_task (void *ctx, size_t iblock)
+{
+  size_t              pos, len;
+  sc_io_block_job_t  *job = (sc_io_block_job_t *) ctx;
+#ifdef SC_HAVE_ZLIB
+  uLong               uncompsize;
+#endif
+
+  pos = iblock * job->block_size;
+  len = SC_MIN (job->in_bytes - pos, job->block_size);
+#ifndef SC_HAVE_ZLIB
+  job->errors[iblock] =
+    (sc_io_nonuncompress (job->out + pos, len, job->src +
+                          job->offsets[iblock], job->lengths[iblock],
+                          NULL) != 0);
+#else
+  uncompsize = (uLong) len;
+  job->errors[iblock] =
+    (uncompress ((Bytef *) job->out + pos, &uncompsize,
+                 (const Bytef *) job->src + job->offsets[iblock],
+                 (uLong) job->lengths[iblock]) != Z_OK ||
+     uncompsize != (uLong) len);
+#endif
+}
+
+/** Read a big-endian 8-byte number. */
+static size_t
+sc_io_get_be64 (const char *pos)
+{
+  int                 i;
+  size_t              value = 0;
+
+  for (i = 0; i < 8; ++i) {
+    value |= ((size_t) (unsigned char) pos[i]) << ((7 - i) * 8);
+  }
+  return value;
+}
+
+/** Write a big-endian 8-byte number. */
+static void
+sc_io_put_be64 (char *pos, size_t value)
+{
+  int                 i;
+
+  for (i = 0; i < 8; ++i) {
+    pos[i] = (char) ((value >> ((7 - i) * 8)) & 0xFF);
+  }
+}
+
+/** Uncompress the blocks of the format written by sc_io_encode_parallel.
+ * \param [in] src          Decoded input past the format character.
+ * \return                  0 on success, -1 on format or data error.
+ */
+static int
+sc_io_decode_blocks (const char *src, size_t src_size,
+                     char *out, size_t out_size, int num_threads)
+{
+  int                 retval = 0;
+  size_t              zz, num_blocks, offset;
+  sc_io_block_job_t   job;
+
+  /* read the block size and the table of compressed lengths */
+  if (src_size < 8 || (job.block_size = sc_io_get_be64 (src)) == 0) {
+    SC_LERROR ("encoded block size missing\n");
     return -1;
   }
-
-  /* verify adler32 checksum */
-  if (src[0] != (char) (adler >> 24) ||
-      src[1] != (char) ((adler >> 16) & 0xFF) ||
-      src[2] != (char) ((adler >> 8) & 0xFF) ||
-      src[3] != (char) (adler & 0xFF)) {
-    SC_LERROR ("uncompress checksum error\n");
+  num_blocks = out_size / job.block_size + (out_size % job.block_size > 0);
+  if ((src_size - 8) / 8 < num_blocks) {
+    SC_LERROR ("encoded block table short\n");
     return -1;
   }
+  job.in_bytes = out_size;
+  job.out = out;
+  job.src = src;
+  job.lengths = SC_ALLOC (size_t, num_blocks);
+  job.offsets = SC_ALLOC (size_t, num_blocks);
+  job.errors = SC_ALLOC_ZERO (char, num_blocks);
+  offset = 8 + 8 * num_blocks;
+  for (zz = 0; zz < num_blocks; ++zz) {
+    job.lengths[zz] = sc_io_get_be64 (src + 8 + 8 * zz);
+    if (job.lengths[zz] > src_size - offset) {
+      SC_LERROR ("encoded block data short\n");
+      retval = -1;
+      break;
+    }
+    job.offsets[zz] = offset;
+    offset += job.lengths[zz];
+  }
 
-  /* task accomplished */
-  return 0;
+  /* uncompress all blocks independently */
+  if (!retval) {
+    sc_io_tasks_run (sc_io_block_uncompress_task, &job, num_blocks,
+                     num_threads);
+    for (zz = 0; zz < num_blocks; ++zz) {
+      if (job.errors[zz]) {
+        SC_LERROR ("block uncompress error\n");
+        retval = -1;
+        break;
+      }
+    }
+  }
+  SC_FREE (job.lengths);
+  SC_FREE (job.offsets);
+  SC_FREE (job.errors);
+  return retval;
 }
 
-#endif /* !SC_HAVE_ZLIB */
-
-#define SC_IO_ENCODE_INFO_LEN 9
-
 void
 sc_io_encode (sc_array_t *data, sc_array_t *out)
 {
@@ -881,18 +2390,9 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
 #else
   int                 zrv;
   uLong               input_compress_bound;
-#endif
-  char               *ipos, *opos;
-  char                base_out[2 * SC_IO_LBC];
-  size_t              base64_lines;
-  size_t              encoded_size;
-  size_t              zlin, irem;
-#ifdef SC_ENABLE_DEBUG
-  size_t              ocnt;
 #endif
   unsigned char       original_size[SC_IO_ENCODE_INFO_LEN];
   sc_array_t          compressed;
-  base64_encodestate  bstate;
 
   SC_ASSERT (data != NULL);
   if (out == NULL) {
@@ -929,8 +2429,9 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
                        SC_IO_ENCODE_INFO_LEN + input_compress_bound);
   memcpy (compressed.array, original_size, SC_IO_ENCODE_INFO_LEN);
 #ifndef SC_HAVE_ZLIB
-  sc_io_noncompress (compressed.array + SC_IO_ENCODE_INFO_LEN,
-                     input_compress_bound, data->array, input_size);
+  input_compress_bound =
+    sc_io_noncompress (compressed.array + SC_IO_ENCODE_INFO_LEN,
+                       input_compress_bound, data->array, input_size);
 #else
   zrv = compress2 ((Bytef *) compressed.array + SC_IO_ENCODE_INFO_LEN,
                    &input_compress_bound, (Bytef *) data->array,
@@ -938,79 +2439,13 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
   SC_CHECK_ABORT (zrv == Z_OK, "Error on zlib compression");
 #endif /* SC_HAVE_ZLIB */
 
-  /* prepare output array */
+  /* encode to base 64 */
   if (out == NULL) {
     out = data;
   }
-  SC_ASSERT (out->elem_size == 1);
-  input_size = (size_t) (SC_IO_ENCODE_INFO_LEN + input_compress_bound);
-  base64_lines = (input_size + SC_IO_DBC - 1) / SC_IO_DBC;
-  encoded_size = 4 * ((input_size + 2) / 3) + 2 * base64_lines + 1;
-  sc_array_resize (out, encoded_size);
-
-  /* run base64 encoder */
-  base64_init_encodestate (&bstate);
-  ipos = compressed.array;
-  irem = input_size;
-  opos = out->array;
-#ifdef SC_ENABLE_DEBUG
-  ocnt = 0;
-#endif
-  SC_ASSERT (ocnt + 1 <= encoded_size);
-  opos[0] = '\0';
-  for (zlin = 0; zlin < base64_lines; ++zlin) {
-    size_t              lein = SC_MIN (irem, SC_IO_DBC);
-    size_t              lout =
-      base64_encode_block (ipos, lein, base_out, &bstate);
-
-    SC_ASSERT (lein > 0);
-    if (zlin < base64_lines - 1) {
-      /* not the final line */
-      SC_ASSERT (irem > SC_IO_DBC);
-      SC_ASSERT (lout == SC_IO_LBC);
-      SC_ASSERT (ocnt + SC_IO_LBF <= encoded_size);
-      memcpy (opos, base_out, SC_IO_LBC);
-      opos[SC_IO_LBC] = (char) line_break_character;
-      opos[SC_IO_LBD] = '\n';
-      opos[SC_IO_LBE] = '\0';
-      opos += SC_IO_LBE;
-#ifdef SC_ENABLE_DEBUG
-      ocnt += SC_IO_LBE;
-#endif
-      ipos += SC_IO_DBC;
-      irem -= SC_IO_DBC;
-    }
-    else {
-      /* the final line */
-      SC_ASSERT (irem <= SC_IO_DBC);
-      SC_ASSERT (lout <= SC_IO_LBC);
-      SC_ASSERT (ocnt + lout <= encoded_size);
-      memcpy (opos, base_out, lout);
-      opos += lout;
-#ifdef SC_ENABLE_DEBUG
-      ocnt += lout;
-#endif
-      lout = base64_encode_blockend (base_out, &bstate);
-      SC_ASSERT (lout <= 4);
-      SC_ASSERT (ocnt + lout <= encoded_size);
-      memcpy (opos, base_out, lout);
-      opos += lout;
-#ifdef SC_ENABLE_DEBUG
-      ocnt += lout;
-#endif
-      SC_ASSERT (ocnt + 3 <= encoded_size);
-      opos[0] = (char) line_break_character;
-      opos[1] = '\n';
-      opos[2] = '\0';
-      opos = NULL;
-#ifdef SC_ENABLE_DEBUG
-      ocnt += 3;
-#endif
-      SC_ASSERT (ocnt == encoded_size);
-      ipos = NULL;
-      irem = 0;
-    }
-  }
+  sc_io_base64_encode (compressed.array,
+                       SC_IO_ENCODE_INFO_LEN + input_compress_bound, out,
+                       line_break_character, 1);
 
   /* free temporary memory */
   sc_array_reset (&compressed);
@@ -1023,7 +2458,6 @@ sc_io_decode_info (sc_array_t *data, size_t *original_size,
   int                 i;
   size_t              osize;
   char                dec[12];
-  base64_decodestate  bstate;
 
   /* in the future we will add runtime error reporting */
   SC_ASSERT (re == NULL);
@@ -1039,9 +2473,7 @@ sc_io_decode_info (sc_array_t *data, size_t *original_size,
 
   /* decode first 12 characters of encoded data */
   memset (dec, 0, 12);
-  base64_init_decodestate (&bstate);
-  osize = base64_decode_block (data->array, 12, dec, &bstate);
-  if (osize != 9) {
+  if (sc_base64_decode (data->array, 12, dec, &osize) || osize != 9) {
     SC_LERROR ("sc_io_decode_info base 64 error\n");
     return -1;
   }
@@ -1079,22 +2511,16 @@ int
 sc_io_decode (sc_array_t *data, sc_array_t *out,
               size_t max_original_size, void *re)
 {
-  int                 i;
   int                 zrv;
   int                 retval = -1;
-  char               *ipos, *opos;
-  char                base_out[SC_IO_LBC];
-  size_t              compressed_size;
-  size_t              base64_lines;
+  char                format_char;
   size_t              encoded_size;
   size_t              current_size;
-  size_t              zlin, irem;
   size_t              ocnt;
 #ifdef SC_HAVE_ZLIB
   uLong               uncompsize;
 #endif
   sc_array_t          compressed;
-  base64_decodestate  bstate;
 
   /* in the future we will add runtime error reporting */
   SC_ASSERT (re == NULL);
@@ -1110,75 +2536,24 @@ sc_io_decode (sc_array_t *data, sc_array_t *out,
   }
 
   /* decode line by line from base 64 */
-  base64_init_decodestate (&bstate);
-  base64_lines = (encoded_size - 1 + SC_IO_LBD) / SC_IO_LBE;
-  compressed_size = base64_lines * SC_IO_DBC;
-  ipos = data->array;
-  SC_ASSERT (encoded_size >= base64_lines + 1);
-  irem = encoded_size - 1 - 2 * base64_lines;
-  sc_array_init_count (&compressed, 1, compressed_size);
-  opos = compressed.array;
-  ocnt = 0;
-  for (zlin = 0; zlin < base64_lines; ++zlin) {
-    size_t              lein = SC_MIN (irem, SC_IO_LBC);
-    size_t              lout =
-      base64_decode_block (ipos, lein, base_out, &bstate);
-
-    SC_ASSERT (lein > 0);
-    if (lout == 0) {
-      SC_LERROR ("base 64 decode short\n");
-      goto decode_error;
-    }
-#if 0
-    if (ipos[lein] != '\n') {
-      SC_LERROR ("base 64 missing newline\n");
-      goto decode_error;
-    }
-#endif
-    if (zlin < base64_lines - 1) {
-      SC_ASSERT (lein == SC_IO_LBC);
-      if (lout != SC_IO_DBC) {
-        SC_LERROR ("base 64 decode mismatch\n");
-        goto decode_error;
-      }
-      memcpy (opos, base_out, SC_IO_DBC);
-      ipos += SC_IO_LBE;
-      SC_ASSERT (irem >= SC_IO_LBC);
-      irem -= SC_IO_LBC;
-      opos += SC_IO_DBC;
-      ocnt += SC_IO_DBC;
-    }
-    else {
-      SC_ASSERT (lein <= SC_IO_LBC);
-      SC_ASSERT (lout <= SC_IO_DBC);
-      memcpy (opos, base_out, lout);
-      ipos += lein + 2;
-      SC_ASSERT (irem >= lein);
-      irem -= lein;
-      opos += lout;
-      ocnt += lout;
-    }
-  }
-  SC_ASSERT (irem == 0);
-  SC_ASSERT (ocnt <= compressed_size);
-  SC_ASSERT (ipos + 1 == data->array + encoded_size);
+  sc_array_init (&compressed, 1);
+  if (sc_io_base64_decode (data->array, encoded_size - 1, &compressed, 0)) {
+    goto decode_error;
+  }
+  ocnt = compressed.elem_count;
   if (ocnt < SC_IO_ENCODE_INFO_LEN) {
     SC_LERRORF ("base 64 decodes to less than %d bytes\n",
                 SC_IO_ENCODE_INFO_LEN);
     goto decode_error;
   }
-  if (compressed.array[SC_IO_ENCODE_INFO_LEN - 1] != 'z') {
+  format_char = compressed.array[SC_IO_ENCODE_INFO_LEN - 1];
+  if (format_char != 'z' && format_char != 'Z') {
     SC_LERROR ("encoded format character mismatch\n");
     goto decode_error;
   }
 
   /* determine length of uncompressed data */
-  encoded_size = 0;
-  for (i = 0; i < 8; ++i) {
-    /* enforce big endian byte order for original size */
-    unsigned char       uc = (unsigned char) compressed.array[i];
-    encoded_size |= ((size_t) uc) << ((7 - i) * 8);
-  }
+  encoded_size = sc_io_get_be64 (compressed.array);
   if (out == NULL) {
     /* allow for in-place operation */
     out = data;
@@ -1203,29 +2578,39 @@ sc_io_decode (sc_array_t *data, sc_array_t *out,
   sc_array_resize (out, encoded_size / out->elem_size);
 
   /* decompress decoded data */
-#ifndef SC_HAVE_ZLIB
-  zrv = sc_io_nonuncompress (out->array, encoded_size,
-                             compressed.array + SC_IO_ENCODE_INFO_LEN,
-                             ocnt - SC_IO_ENCODE_INFO_LEN, re);
-  if (zrv) {
-    SC_LERROR ("Please consider configuring the build"
-               " such that zlib is found.\n");
-    goto decode_error;
+  if (format_char == 'Z') {
+    /* the blocks of the parallel format are independent */
+    if (sc_io_decode_blocks (compressed.array + SC_IO_ENCODE_INFO_LEN,
+                             ocnt - SC_IO_ENCODE_INFO_LEN, out->array,
+                             encoded_size, 0)) {
+      goto decode_error;
+    }
   }
+  else {
+#ifndef SC_HAVE_ZLIB
+    zrv = sc_io_nonuncompress (out->array, encoded_size,
+                               compressed.array + SC_IO_ENCODE_INFO_LEN,
+                               ocnt - SC_IO_ENCODE_INFO_LEN, re);
+    if (zrv) {
+      SC_LERROR ("Please consider configuring the build"
+                 " such that zlib is found.\n");
+      goto decode_error;
+    }
 #else
-  uncompsize = (uLong) encoded_size;
-  zrv = uncompress ((Bytef *) out->array, &uncompsize,
-                    (Bytef *) (compressed.array + SC_IO_ENCODE_INFO_LEN),
-                    ocnt - SC_IO_ENCODE_INFO_LEN);
-  if (zrv != Z_OK) {
-    SC_LERROR ("zlib uncompress error\n");
-    goto decode_error;
-  }
-  if (uncompsize != (uLong) encoded_size) {
-    SC_LERROR ("zlib uncompress short\n");
-    goto decode_error;
-  }
+    uncompsize = (uLong) encoded_size;
+    zrv = uncompress ((Bytef *) out->array, &uncompsize,
+                      (Bytef *) (compressed.array + SC_IO_ENCODE_INFO_LEN),
+                      ocnt - SC_IO_ENCODE_INFO_LEN);
+    if (zrv != Z_OK) {
+      SC_LERROR ("zlib uncompress error\n");
+      goto decode_error;
+    }
+    if (uncompsize != (uLong) encoded_size) {
+      SC_LERROR ("zlib uncompress short\n");
+      goto decode_error;
+    }
 #endif /* SC_HAVE_ZLIB */
+  }
 
   /* exit cleanly */
   retval = 0;
@@ -1234,6 +2619,74 @@ decode_error:
   return retval;
 }
 
+void
+sc_io_encode_parallel (sc_array_t *data, sc_array_t *out,
+                       int zlib_compression_level, int line_break_character,
+                       size_t block_size, int num_threads)
+{
+  size_t              zz, num_blocks;
+  size_t              header_size, total_size;
+  char               *pos;
+  sc_array_t          compressed;
+  sc_io_block_job_t   job;
+
+  SC_ASSERT (data != NULL);
+  if (out == NULL) {
+    /* in-place operation on string */
+    SC_ASSERT (SC_ARRAY_IS_OWNER (data));
+    SC_ASSERT (data->elem_size == 1);
+  }
+  else {
+    /* data is placed in output string */
+    SC_ASSERT (SC_ARRAY_IS_OWNER (out));
+    SC_ASSERT (out->elem_size == 1);
+  }
+  SC_ASSERT (-1 <= zlib_compression_level && zlib_compression_level <= 9);
+
+  /* compress the blocks independently */
+  job.in = data->array;
+  job.in_bytes = data->elem_count * data->elem_size;
+  job.block_size = block_size > 0 ? block_size : SC_IO_ENCODE_BLOCK_BYTES;
+  job.level = zlib_compression_level;
+  num_blocks = (job.in_bytes + job.block_size - 1) / job.block_size;
+  job.blocks = SC_ALLOC (char *, num_blocks);
+  job.lengths = SC_ALLOC (size_t, num_blocks);
+  sc_io_tasks_run (sc_io_block_compress_task, &job, num_blocks, num_threads);
+
+  /* size, format, block size, compressed lengths and data */
+  header_size = SC_IO_ENCODE_INFO_LEN + 8 + 8 * num_blocks;
+  total_size = header_size;
+  for (zz = 0; zz < num_blocks; ++zz) {
+    total_size += job.lengths[zz];
+  }
+  sc_array_init_count (&compressed, 1, total_size);
+  pos = compressed.array;
+  sc_io_put_be64 (pos, job.in_bytes);
+  pos[SC_IO_ENCODE_INFO_LEN - 1] = 'Z';
+  sc_io_put_be64 (pos + SC_IO_ENCODE_INFO_LEN, job.block_size);
+  pos += SC_IO_ENCODE_INFO_LEN + 8;
+  for (zz = 0; zz < num_blocks; ++zz) {
+    sc_io_put_be64 (pos, job.lengths[zz]);
+    pos += 8;
+  }
+  for (zz = 0; zz < num_blocks; ++zz) {
+    memcpy (pos, job.blocks[zz], job.lengths[zz]);
+    pos += job.lengths[zz];
+    SC_FREE (job.blocks[zz]);
+  }
+  SC_ASSERT (pos == compressed.array + total_size);
+  SC_FREE (job.blocks);
+  SC_FREE (job.lengths);
+
+  /* encode to base 64 */
+  if (out == NULL) {
+    out = data;
+  }
+  sc_io_base64_encode (compressed.array, total_size, out,
+                       line_break_character, num_threads);
+  sc_array_reset (&compressed);
+}
+
 int
 sc_vtk_write_binary (FILE * vtkfile, char *numeric_data, size_t byte_length)
 {
@@ -1241,7 +2694,7 @@ sc_vtk_write_binary (FILE * vtkfile, char *numeric_data, size_t byte_length)
   size_t              code_length, base_length;
   uint32_t            int_header;
   char               *base_data;
-  base64_encodestate  encode_state;
+  sc_base64_state_t   encode_state;
 
   /* VTK format used 32bit header info */
   SC_ASSERT (byte_length <= (size_t) UINT32_MAX);
@@ -1255,10 +2708,9 @@ sc_vtk_write_binary (FILE * vtkfile, char *numeric_data, size_t byte_length)
   code_length = SC_MAX (code_length, 4) + 1;
   base_data = SC_ALLOC (char, code_length);
 
-  base64_init_encodestate (&encode_state);
-  base_length =
-    base64_encode_block ((char *) &int_header, sizeof (int_header), base_data,
-                         &encode_state);
+  sc_base64_encode_init (&encode_state);
+  base_length = sc_base64_encode_block (&encode_state, &int_header,
+                                        sizeof (int_header), base_data);
   SC_ASSERT (base_length < code_length);
   base_data[base_length] = '\0';
   (void) fwrite (base_data, 1, base_length, vtkfile);
@@ -1267,8 +2719,9 @@ sc_vtk_write_binary (FILE * vtkfile, char *numeric_data, size_t byte_length)
   remaining = byte_length;
   while (remaining > 0) {
     writenow = SC_MIN (remaining, chunksize);
-    base_length = base64_encode_block (numeric_data + chunks * chunksize,
-                                       writenow, base_data, &encode_state);
+    base_length = sc_base64_encode_block (&encode_state,
+                                          numeric_data + chunks * chunksize,
+                                          writenow, base_data);
     SC_ASSERT (base_length < code_length);
     base_data[base_length] = '\0';
     (void) fwrite (base_data, 1, base_length, vtkfile);
@@ -1276,7 +2729,7 @@ sc_vtk_write_binary (FILE * vtkfile, char *numeric_data, size_t byte_length)
     ++chunks;
   }
 
-  base_length = base64_encode_blockend (base_data, &encode_state);
+  base_length = sc_base64_encode_blockend (&encode_state, base_data);
   SC_ASSERT (base_length < code_length);
   base_data[base_length] = '\0';
   (void) fwrite (base_data, 1, base_length, vtkfile);
@@ -1305,7 +2758,7 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
   char               *comp_data, *base_data;
   uint32_t           *compression_header;
   uLongf              comp_length;
-  base64_encodestate  encode_state;
+  sc_base64_state_t   encode_state;
 
   /* compute block sizes */
   blocksize = (size_t) (1 << 15);       /* 32768 */
@@ -1329,18 +2782,15 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
   for (iz = 3; iz < header_entries; ++iz) {
     compression_header[iz] = 0;
   }
-  base64_init_encodestate (&encode_state);
-  base_length = base64_encode_block ((char *) compression_header,
-                                     header_size, base_data, &encode_state);
-  base_length +=
-    base64_encode_blockend (base_data + base_length, &encode_state);
+  base_length = sc_base64_encode (compression_header, header_size,
+                                  base_data);
   SC_ASSERT (base_length < code_length);
   base_data[base_length] = '\0';
   header_pos = ftell (vtkfile);
   (void) fwrite (base_data, 1, base_length, vtkfile);
 
   /* write the regular data blocks */
-  base64_init_encodestate (&encode_state);
+  sc_base64_encode_init (&encode_state);
   for (theblock = 0; theblock < numregularblocks; ++theblock) {
     comp_length = code_length;
     retval = compress2 ((Bytef *) comp_data, &comp_length,
@@ -1348,8 +2798,8 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
                         (uLong) blocksize, Z_BEST_COMPRESSION);
     SC_IO_CHECK_ZLIB (retval);
     compression_header[3 + theblock] = comp_length;
-    base_length = base64_encode_block (comp_data, comp_length,
-                                       base_data, &encode_state);
+    base_length = sc_base64_encode_block (&encode_state, comp_data,
+                                          comp_length, base_data);
     SC_ASSERT (base_length < code_length);
     base_data[base_length] = '\0';
     (void) fwrite (base_data, 1, base_length, vtkfile);
@@ -1363,26 +2813,23 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
                         (uLong) lastsize, Z_BEST_COMPRESSION);
     SC_IO_CHECK_ZLIB (retval);
     compression_header[3 + theblock] = comp_length;
-    base_length = base64_encode_block (comp_data, comp_length,
-                                       base_data, &encode_state);
+    base_length = sc_base64_encode_block (&encode_state, comp_data,
+                                          comp_length, base_data);
     SC_ASSERT (base_length < code_length);
     base_data[base_length] = '\0';
     (void) fwrite (base_data, 1, base_length, vtkfile);
   }
 
   /* write base64 end block */
-  base_length = base64_encode_blockend (base_data, &encode_state);
+  base_length = sc_base64_encode_blockend (&encode_state, base_data);
   SC_ASSERT (base_length < code_length);
   base_data[base_length] = '\0';
   (void) fwrite (base_data, 1, base_length, vtkfile);
 
   /* seek back, write header block, seek forward */
   final_pos = ftell (vtkfile);
-  base64_init_encodestate (&encode_state);
-  base_length = base64_encode_block ((char *) compression_header,
-                                     header_size, base_data, &encode_state);
-  base_length +=
-    base64_encode_blockend (base_data + base_length, &encode_state);
+  base_length = sc_base64_encode (compression_header, header_size,
+                                  base_data);
   SC_ASSERT (base_length < code_length);
   base_data[base_length] = '\0';
   fseek1 = fseek (vtkfile, header_pos, SEEK_SET);
@@ -2249,6 +3696,249 @@ sc_io_write_at_all (sc_MPI_File mpifile, sc_MPI_Offset offset,
 #endif
 }
 
+/* largest number of bytes passed to one file access as an int count */
+#define SC_IO_SEGMENT_CHUNK ((size_t) 1 << 30)
+
+#ifdef SC_ENABLE_MPIIO
+
+/** Access segments by hindexed datatypes in memory and in the file view. */
+static int
+sc_io_segments_at_all (sc_MPI_File mpifile, const sc_io_segment_t *segments,
+                       size_t num_segments, int writing, size_t *obytes)
+{
+  int                 mpiret, errcode, retval, count;
+  int                 nblocks, ib;
+  int                *lengths;
+  size_t              zz, pos, len, total;
+  MPI_Aint           *mdisp, *fdisp;
+  sc_MPI_Offset       base;
+  sc_MPI_Datatype     memtype, filetype;
+  sc_MPI_Status       mpistatus;
+
+  /* split segments into blocks whose lengths fit into an int */
+  for (nblocks = 0, total = 0, zz = 0; zz < num_segments; ++zz) {
+    SC_ASSERT (zz == 0 || segments[zz].offset >= segments[zz - 1].offset +
+               (sc_MPI_Offset) segments[zz - 1].length);
+    nblocks += (int) ((segments[zz].length + SC_IO_SEGMENT_CHUNK - 1) /
+                      SC_IO_SEGMENT_CHUNK);
+    total += segments[zz].length;
+  }
+  base = num_segments > 0 ? segments[0].offset : 0;
+  lengths = SC_ALLOC (int, nblocks);
+  mdisp = SC_ALLOC (MPI_Aint, nblocks);
+  fdisp = SC_ALLOC (MPI_Aint, nblocks);
+  for (ib = 0, zz = 0; zz < num_segments; ++zz) {
+    for (pos = 0; pos < segments[zz].length; pos += len) {
+      len = SC_MIN (segments[zz].length - pos, SC_IO_SEGMENT_CHUNK);
+      lengths[ib] = (int) len;
+      mpiret = MPI_Get_address ((char *) segments[zz].data + pos,
+                                &mdisp[ib]);
+      SC_CHECK_MPI (mpiret);
+      fdisp[ib] = (MPI_Aint) (segments[zz].offset + (sc_MPI_Offset) pos -
+                              base);
+      ++ib;
+    }
+  }
+  SC_ASSERT (ib == nblocks);
+
+  /* a process without data accesses nothing through the default view */
+  if (nblocks > 0) {
+    mpiret = MPI_Type_create_hindexed (nblocks, lengths, mdisp, MPI_BYTE,
+                                       &memtype);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Type_commit (&memtype);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Type_create_hindexed (nblocks, lengths, fdisp, MPI_BYTE,
+                                       &filetype);
+    SC_CHECK_MPI (mpiret);
+    mpiret = MPI_Type_commit (&filetype);
+    SC_CHECK_MPI (mpiret);
+    count = 1;
+  }
+  else {
+    memtype = filetype = MPI_BYTE;
+    count = 0;
+  }
+  SC_FREE (lengths);
+  SC_FREE (mdisp);
+  SC_FREE (fdisp);
+
+  /* the view is collective and reset to the default afterwards */
+  mpiret = MPI_File_set_view (mpifile, base, MPI_BYTE, filetype, "native",
+                              MPI_INFO_NULL);
+  if (mpiret == sc_MPI_SUCCESS) {
+    if (writing) {
+      mpiret = MPI_File_write_at_all (mpifile, 0, MPI_BOTTOM, count,
+                                      memtype, &mpistatus);
+    }
+    else {
+      mpiret = MPI_File_read_at_all (mpifile, 0, MPI_BOTTOM, count,
+                                     memtype, &mpistatus);
+    }
+    if (mpiret == sc_MPI_SUCCESS && count > 0) {
+      /* a short read is counted in bytes */
+      retval = MPI_Get_count (&mpistatus, memtype, &count);
+      SC_CHECK_MPI (retval);
+      if (count == 1) {
+        *obytes = total;
+      }
+      else {
+        retval = MPI_Get_elements (&mpistatus, MPI_BYTE, &count);
+        SC_CHECK_MPI (retval);
+        *obytes = (size_t) count;
+      }
+    }
+    retval = MPI_File_set_view (mpifile, 0, MPI_BYTE, MPI_BYTE, "native",
+                                MPI_INFO_NULL);
+    if (mpiret == sc_MPI_SUCCESS) {
+      mpiret = retval;
+    }
+  }
+  if (nblocks > 0) {
+    retval = MPI_Type_free (&memtype);
+    SC_CHECK_MPI (retval);
+    retval = MPI_Type_free (&filetype);
+    SC_CHECK_MPI (retval);
+  }
+
+  retval = sc_io_error_class (mpiret, &errcode);
+  SC_CHECK_MPI (retval);
+  return errcode;
+}
+
+#elif !defined SC_ENABLE_MPI
+
+/** Access segments one after the other in pieces that fit into an int. */
+static int
+sc_io_segments_at_all (sc_MPI_File mpifile, const sc_io_segment_t *segments,
+                       size_t num_segments, int writing, size_t *obytes)
+{
+  int                 errcode, ocount;
+  size_t              zz, pos, len;
+
+  for (zz = 0; zz < num_segments; ++zz) {
+    for (pos = 0; pos < segments[zz].length; pos += len) {
+      len = SC_MIN (segments[zz].length - pos, SC_IO_SEGMENT_CHUNK);
+      if (writing) {
+        errcode = sc_io_write_at (mpifile, segments[zz].offset +
+                                  (sc_MPI_Offset) pos,
+                                  (char *) segments[zz].data + pos,
+                                  (int) len, sc_MPI_BYTE, &ocount);
+      }
+      else {
+        errcode = sc_io_read_at (mpifile, segments[zz].offset +
+                                 (sc_MPI_Offset) pos,
+                                 (char *) segments[zz].data + pos,
+                                 (int) len, sc_MPI_BYTE, &ocount);
+      }
+      *obytes += (size_t) ocount;
+      if (errcode != sc_MPI_SUCCESS || ocount != (int) len) {
+        return errcode;
+      }
+    }
+  }
+  return sc_MPI_SUCCESS;
+}
+
+#endif
+
+int
+sc_io_writev_at_all (sc_MPI_File mpifile, const sc_io_segment_t *segments,
+                     size_t num_segments, size_t *obytes)
+{
+#if defined SC_ENABLE_MPI && !defined SC_ENABLE_MPIIO
+  int                 errcode, ocount;
+  size_t              zz, total;
+  char               *pos;
+  sc_array_t          staging;
+#endif
+
+  SC_ASSERT (num_segments == 0 || segments != NULL);
+  SC_ASSERT (obytes != NULL);
+  *obytes = 0;
+
+#if defined SC_ENABLE_MPI && !defined SC_ENABLE_MPIIO
+  /* WARNING: This code and configuration case is deprecated. */
+
+  /* the fallback ignores offsets and appends contiguous data by rank */
+  for (total = 0, zz = 0; zz < num_segments; ++zz) {
+    total += segments[zz].length;
+  }
+  SC_CHECK_ABORT (total <= (size_t) INT_MAX, "writev_at_all: too large");
+  sc_array_init_count (&staging, 1, total);
+  for (pos = staging.array, zz = 0; zz < num_segments; ++zz) {
+    if (segments[zz].length > 0) {
+      memcpy (pos, segments[zz].data, segments[zz].length);
+      pos += segments[zz].length;
+    }
+  }
+  errcode = sc_io_write_at_all (mpifile, num_segments > 0 ?
+                                segments[0].offset : 0, staging.array,
+                                (int) total, sc_MPI_BYTE, &ocount);
+  *obytes = (size_t) ocount;
+  sc_array_reset (&staging);
+  return errcode;
+#else
+  return sc_io_segments_at_all (mpifile, segments, num_segments, 1, obytes);
+#endif
+}
+
+int
+sc_io_readv_at_all (sc_MPI_File mpifile, const sc_io_segment_t *segments,
+                    size_t num_segments, size_t *obytes)
+{
+#if defined SC_ENABLE_MPI && !defined SC_ENABLE_MPIIO
+  int                 mpiret, errcode, ocount, done;
+  long                local, calls;
+  size_t              zz, pos, len;
+#endif
+
+  SC_ASSERT (num_segments == 0 || segments != NULL);
+  SC_ASSERT (obytes != NULL);
+  *obytes = 0;
+
+#if defined SC_ENABLE_MPI && !defined SC_ENABLE_MPIIO
+  /* WARNING: This code and configuration case is deprecated. */
+
+  /* every process takes part in the same number of collective reads */
+  for (local = 0, zz = 0; zz < num_segments; ++zz) {
+    local += (long) ((segments[zz].length + SC_IO_SEGMENT_CHUNK - 1) /
+                     SC_IO_SEGMENT_CHUNK);
+  }
+  mpiret = sc_MPI_Allreduce (&local, &calls, 1, sc_MPI_LONG, sc_MPI_MAX,
+                             mpifile->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  errcode = sc_MPI_SUCCESS;
+  done = 0;
+  zz = 0;
+  pos = len = 0;
+  for (; calls > 0; --calls) {
+    /* advance to the next piece of a nonempty segment */
+    while (!done && zz < num_segments && pos >= segments[zz].length) {
+      ++zz;
+      pos = 0;
+    }
+    if (!done && zz < num_segments) {
+      len = SC_MIN (segments[zz].length - pos, SC_IO_SEGMENT_CHUNK);
+      errcode = sc_io_read_at_all (mpifile, segments[zz].offset +
+                                   (sc_MPI_Offset) pos,
+                                   (char *) segments[zz].data + pos,
+                                   (int) len, sc_MPI_BYTE, &ocount);
+      *obytes += (size_t) ocount;
+      pos += len;
+      done = (errcode != sc_MPI_SUCCESS || ocount != (int) len);
+    }
+    else {
+      (void) sc_io_read_at_all (mpifile, 0, NULL, 0, sc_MPI_BYTE, &ocount);
+    }
+  }
+  return errcode;
+#else
+  return sc_io_segments_at_all (mpifile, segments, num_segments, 0, obytes);
+#endif
+}
+
 int
 sc_io_close (sc_MPI_File * mpifile)
 {
@@ -2289,3 +3979,274 @@ sc_io_close (sc_MPI_File * mpifile)
 
   return eclass;
 }
+
+/* uncompressed bytes per block of compressed VTK data arrays */
+#define SC_VTK_BLOCK_BYTES ((size_t) 1 << 15)
+
+/** Append one formatted line of XML to a character array. */
+static void
+sc_vtk_putf (sc_array_t *text, const char *fmt, ...)
+{
+  int                 length;
+  const char         *content;
+  va_list             ap;
+  sc_string_t         scs;
+
+  sc_string_init (&scs);
+  va_start (ap, fmt);
+  SC_CHECK_ABORT (!sc_string_putv (&scs, fmt, ap), "VTK line too long");
+  va_end (ap);
+  content = sc_string_get_content (&scs, &length);
+  memcpy (sc_array_push_count (text, (size_t) length), content,
+          (size_t) length);
+}
+
+/** Append a data array as zlib blocks with VTK headers of 64 bits. */
+static void
+sc_vtk_compress_field (sc_array_t *app, const sc_vtk_field_t *field,
+                       int zlib_compression_level, int num_threads)
+{
+  size_t              zz, num_blocks;
+  uint64_t           *header;
+  sc_io_block_job_t   job;
+
+  job.in = field->data->array;
+  job.in_bytes = field->data->elem_count * field->data->elem_size;
+
+  /* compress the blocks independently */
+  job.block_size = SC_VTK_BLOCK_BYTES;
+  job.level = zlib_compression_level;
+  num_blocks = (job.in_bytes + job.block_size - 1) / job.block_size;
+  job.blocks = SC_ALLOC (char *, num_blocks);
+  job.lengths = SC_ALLOC (size_t, num_blocks);
+  sc_io_tasks_run (sc_io_block_compress_task, &job, num_blocks, num_threads);
+
+  /* block count, block size, last block size and compressed sizes */
+  header = SC_ALLOC (uint64_t, 3 + num_blocks);
+  header[0] = (uint64_t) num_blocks;
+  header[1] = (uint64_t) job.block_size;
+  header[2] = (uint64_t) (job.in_bytes - (num_blocks > 0 ?
+                                          (num_blocks - 1) *
+                                          job.block_size : 0));
+  for (zz = 0; zz < num_blocks; ++zz) {
+    header[3 + zz] = (uint64_t) job.lengths[zz];
+  }
+  memcpy (sc_array_push_count (app, (3 + num_blocks) * sizeof (uint64_t)),
+          header, (3 + num_blocks) * sizeof (uint64_t));
+  SC_FREE (header);
+
+  /* the compressed blocks follow in order */
+  for (zz = 0; zz < num_blocks; ++zz) {
+    memcpy (sc_array_push_count (app, job.lengths[zz]), job.blocks[zz],
+            job.lengths[zz]);
+    SC_FREE (job.blocks[zz]);
+  }
+  SC_FREE (job.blocks);
+  SC_FREE (job.lengths);
+}
+
+/** Write the data arrays of one section of a piece. */
+static void
+sc_vtk_put_section (sc_array_t *text, const char *section,
+                    sc_vtk_location_t location, size_t num_fields,
+                    const sc_vtk_field_t *fields, const long long *offsets)
+{
+  size_t              zz;
+  int                 any;
+
+  for (any = 0, zz = 0; zz < num_fields; ++zz) {
+    if (fields[zz].location != location) {
+      continue;
+    }
+    if (!any) {
+      sc_vtk_putf (text, "      <%s>\n", section);
+      any = 1;
+    }
+    SC_ASSERT (fields[zz].type != NULL && fields[zz].num_components >= 1);
+    sc_vtk_putf (text, "        <DataArray type=\"%s\"", fields[zz].type);
+    if (fields[zz].name != NULL) {
+      sc_vtk_putf (text, " Name=\"%s\"", fields[zz].name);
+    }
+    sc_vtk_putf (text, " NumberOfComponents=\"%d\" format=\"appended\""
+                 " offset=\"%lld\"/>\n", fields[zz].num_components,
+                 offsets[zz]);
+  }
+  if (any) {
+    sc_vtk_putf (text, "      </%s>\n", section);
+  }
+  else if (location == SC_VTK_POINTS || location == SC_VTK_CELLS) {
+    /* these sections are required even if empty */
+    sc_vtk_putf (text, "      <%s>\n      </%s>\n", section, section);
+  }
+}
+
+/** Add a segment at a local position if it is not empty. */
+static void
+sc_vtk_push_segment (sc_array_t *segs, long long pos, const void *data,
+                     size_t length)
+{
+  sc_io_segment_t    *seg;
+
+  if (length > 0) {
+    seg = (sc_io_segment_t *) sc_array_push (segs);
+    seg->offset = (sc_MPI_Offset) pos;
+    seg->data = (void *) data;
+    seg->length = length;
+  }
+}
+
+/** Write local segments collectively behind an offset and sync errors. */
+static int
+sc_vtk_write_part (sc_MPI_File file, sc_MPI_Comm mpicomm,
+                   long long offset, sc_array_t *segs)
+{
+  int                 mpiret, errcode, maxcode;
+  size_t              zz, total, obytes;
+  sc_io_segment_t    *seg;
+
+  for (total = 0, zz = 0; zz < segs->elem_count; ++zz) {
+    seg = (sc_io_segment_t *) sc_array_index (segs, zz);
+    seg->offset += (sc_MPI_Offset) offset;
+    total += seg->length;
+  }
+  errcode = sc_io_writev_at_all (file, (sc_io_segment_t *) segs->array,
+                                 segs->elem_count, &obytes);
+  if (errcode == sc_MPI_SUCCESS && obytes != total) {
+    errcode = sc_MPI_ERR_IO;
+  }
+
+  /* the error classes are positive and success is zero */
+  mpiret = sc_MPI_Allreduce (&errcode, &maxcode, 1, sc_MPI_INT,
+                             sc_MPI_MAX, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  return maxcode;
+}
+
+int
+sc_vtk_write_unstructured (sc_MPI_Comm mpicomm, const char *filename,
+                           size_t num_points, size_t num_cells,
+                           size_t num_fields, const sc_vtk_field_t *fields,
+                           int zlib_compression_level, int num_threads)
+{
+  const uint16_t      one = 1;
+  int                 mpiret, errcode, retval;
+  int                 mpisize, mpirank;
+  size_t              zz;
+  long long           local[2], before[2], xml_bytes;
+  long long          *offsets;
+  uint64_t           *sizes;
+  sc_array_t          text, app, text_segs, app_segs;
+  sc_MPI_File         file;
+  const char          epilog[] = "\n  </AppendedData>\n</VTKFile>\n";
+
+  SC_ASSERT (filename != NULL);
+  SC_ASSERT (num_fields == 0 || fields != NULL);
+  SC_ASSERT (-1 <= zlib_compression_level && zlib_compression_level <= 9);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* lay out the local appended data and get the offsets of the arrays */
+  sc_array_init (&app, 1);
+  sc_array_init (&app_segs, sizeof (sc_io_segment_t));
+  offsets = SC_ALLOC (long long, num_fields);
+  sizes = SC_ALLOC (uint64_t, num_fields);
+  local[1] = 0;
+  for (zz = 0; zz < num_fields; ++zz) {
+    offsets[zz] = local[1];
+    if (zlib_compression_level == 0) {
+      /* the byte count is followed by the array written from its memory */
+      sizes[zz] = (uint64_t) (fields[zz].data->elem_count *
+                              fields[zz].data->elem_size);
+      sc_vtk_push_segment (&app_segs, local[1], &sizes[zz], 8);
+      sc_vtk_push_segment (&app_segs, local[1] + 8,
+                           fields[zz].data->array, (size_t) sizes[zz]);
+      local[1] += 8 + (long long) sizes[zz];
+    }
+    else {
+      sc_vtk_compress_field (&app, &fields[zz], zlib_compression_level,
+                             num_threads);
+      local[1] = (long long) app.elem_count;
+    }
+  }
+  sc_vtk_push_segment (&app_segs, 0, app.array, app.elem_count);
+  mpiret = sc_MPI_Exscan (&local[1], &before[1], 1, sc_MPI_LONG_LONG_INT,
+                          sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    before[1] = 0;
+  }
+  for (zz = 0; zz < num_fields; ++zz) {
+    offsets[zz] += before[1];
+  }
+
+  /* the first process writes the file header before its piece */
+  sc_array_init (&text, 1);
+  if (mpirank == 0) {
+    sc_vtk_putf (&text, "<?xml version=\"1.0\"?>\n");
+    sc_vtk_putf (&text, "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\""
+                 " byte_order=\"%s\" header_type=\"UInt64\"%s>\n",
+                 *(const char *) &one ? "LittleEndian" : "BigEndian",
+                 zlib_compression_level != 0 ?
+                 " compressor=\"vtkZLibDataCompressor\"" : "");
+    sc_vtk_putf (&text, "  <UnstructuredGrid>\n");
+  }
+  sc_vtk_putf (&text, "    <Piece NumberOfPoints=\"%lld\""
+               " NumberOfCells=\"%lld\">\n",
+               (long long) num_points, (long long) num_cells);
+  sc_vtk_put_section (&text, "Points", SC_VTK_POINTS,
+                      num_fields, fields, offsets);
+  sc_vtk_put_section (&text, "Cells", SC_VTK_CELLS,
+                      num_fields, fields, offsets);
+  sc_vtk_put_section (&text, "PointData", SC_VTK_POINT_DATA,
+                      num_fields, fields, offsets);
+  sc_vtk_put_section (&text, "CellData", SC_VTK_CELL_DATA,
+                      num_fields, fields, offsets);
+  sc_vtk_putf (&text, "    </Piece>\n");
+  SC_FREE (offsets);
+
+  /* the last process opens the appended data after its piece and closes it */
+  if (mpirank == mpisize - 1) {
+    sc_vtk_putf (&text, "  </UnstructuredGrid>\n");
+    sc_vtk_putf (&text, "  <AppendedData encoding=\"raw\">\n    _");
+    sc_vtk_push_segment (&app_segs, local[1], epilog, sizeof (epilog) - 1);
+  }
+
+  /* file offsets of the local header text and appended data */
+  local[0] = (long long) text.elem_count;
+  mpiret = sc_MPI_Exscan (&local[0], &before[0], 1, sc_MPI_LONG_LONG_INT,
+                          sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&local[0], &xml_bytes, 1, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    before[0] = 0;
+  }
+
+  /* all text is written by one call and all binary data by another */
+  errcode = sc_io_open (mpicomm, filename, SC_IO_WRITE_CREATE,
+                        sc_MPI_INFO_NULL, &file);
+  if (errcode == sc_MPI_SUCCESS) {
+    sc_array_init (&text_segs, sizeof (sc_io_segment_t));
+    sc_vtk_push_segment (&text_segs, 0, text.array, text.elem_count);
+    errcode = sc_vtk_write_part (file, mpicomm, before[0], &text_segs);
+    if (errcode == sc_MPI_SUCCESS) {
+      errcode = sc_vtk_write_part (file, mpicomm,
+                                   xml_bytes + before[1], &app_segs);
+    }
+    sc_array_reset (&text_segs);
+    retval = sc_io_close (&file);
+    if (errcode == sc_MPI_SUCCESS) {
+      errcode = retval;
+    }
+  }
+
+  SC_FREE (sizes);
+  sc_array_reset (&app_segs);
+  sc_array_reset (&text);
+  sc_array_reset (&app);
+  return errcode;
+}
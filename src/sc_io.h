@@ -90,6 +90,12 @@ sc_io_mode_t;
 typedef enum
 {
   SC_IO_ENCODE_NONE,    /**< No encoding */
+  SC_IO_ENCODE_ZLIB,    /**< Streaming zlib format (RFC 1950).
+                             Data is deflated incrementally with bounded
+                             buffers.  Without zlib, the sink compresses
+                             by the builtin deflate in the same format and
+                             the source decodes all input at once by
+                             the builtin inflate. */
   SC_IO_ENCODE_LAST     /**< Invalid entry to close list */
 }
 sc_io_encode_t;
@@ -100,10 +106,35 @@ typedef enum
   SC_IO_TYPE_BUFFER,    /**< Write to a buffer */
   SC_IO_TYPE_FILENAME,  /**< Write to a file to be opened */
   SC_IO_TYPE_FILEFILE,  /**< Write to an already opened file */
+  SC_IO_TYPE_MMAP,      /**< Read from a file mapped into memory.
+                             Only supported by \ref sc_io_source. */
+  SC_IO_TYPE_FILEBLOCK, /**< Write to a file to be opened in large blocks.
+                             Only supported by \ref sc_io_sink. */
   SC_IO_TYPE_LAST       /**< Invalid entry to close list */
 }
 sc_io_type_t;
 
+/** Flags for a sink of type \ref SC_IO_TYPE_FILEBLOCK, may be or'ed. */
+typedef enum
+{
+  SC_IO_BLOCK_DEFAULT = 0,      /**< Write blocks through the page cache. */
+  SC_IO_BLOCK_DIRECT = 1,       /**< Bypass the page cache where the system
+                                     and file system support it. */
+  SC_IO_BLOCK_FSYNC = 2         /**< Synchronize the file to disk after the
+                                     blocks written by each complete. */
+}
+sc_io_block_flags_t;
+
+/** Access pattern hints for \ref sc_io_file_map. */
+typedef enum
+{
+  SC_IO_MAP_NORMAL,     /**< No particular access pattern */
+  SC_IO_MAP_SEQUENTIAL, /**< Read ahead aggressively */
+  SC_IO_MAP_RANDOM,     /**< Do not read ahead */
+  SC_IO_MAP_WILLNEED    /**< Begin to read the whole file now */
+}
+sc_io_map_advice_t;
+
 /** A generic data sink. */
 typedef struct sc_io_sink
 {
@@ -118,6 +149,9 @@ typedef struct sc_io_sink
   size_t              bytes_in;        /**< input bytes count */
   size_t              bytes_out;       /**< written bytes count */
   int                 is_eof;          /**< Have we reached the end of file? */
+  void               *encoder;         /**< state of the encoding, if any */
+  void               *writer;          /**< state of the block writer for
+                                            \ref SC_IO_TYPE_FILEBLOCK */
 }
 sc_io_sink_t;
 
@@ -138,6 +172,7 @@ typedef struct sc_io_source
                                             data */
   sc_array_t         *mirror_buffer;   /**< if activated, the buffer for the
                                             mirror */
+  void               *decoder;         /**< state of the decoding, if any */
 }
 sc_io_source_t;
 
@@ -160,9 +195,19 @@ sc_io_open_mode_t;
  *                              FILENAME: const char * (name of file to open).
  *                              FILEFILE: FILE * (file open for writing).
  *                              These buffers are only borrowed by the sink.
+ *                              FILEBLOCK: const char * (name of file to
+ *                              open), size_t (bytes per block, 0 for a
+ *                              default of 1 MiB), int (or'ed flags from
+ *                              \ref sc_io_block_flags_t).  Writes are
+ *                              copied into aligned blocks that a background
+ *                              thread writes to the file, if threads are
+ *                              enabled, with a few blocks in flight.
+ *                              MMAP is not supported and returns NULL.
  * \param [in] iomode           Mode must be a value from \ref sc_io_mode_t.
  *                              For type FILEFILE, data is always appended.
  * \param [in] ioencode         Must be a value from \ref sc_io_encode_t.
+ *                              With an encoding other than NONE, a BUFFER
+ *                              must have element size 1.
  * \return                      Newly allocated sink, or NULL on error.
  */
 sc_io_sink_t       *sc_io_sink_new (int iotype, int iomode,
@@ -192,6 +237,8 @@ int                 sc_io_sink_destroy_null (sc_io_sink_t ** sink);
 
 /** Write data to a sink.  Data may be buffered and sunk in a later call.
  * The internal counters sink->bytes_in and sink->bytes_out are updated.
+ * With an encoding, bytes_in counts the data passed in and bytes_out
+ * the encoded bytes written so far.
  * \param [in,out] sink         The sink object to write to.
  * \param [in] data             Data passed into sink must be non-NULL.
  * \param [in] bytes_avail      Number of data bytes passed in.
@@ -208,9 +255,14 @@ int                 sc_io_sink_write (sc_io_sink_t * sink,
  * been created.  In particular, the bytes counters are reset to zero.
  * The internal state of the sink is not changed otherwise.
  * It is legal to continue writing to the sink hereafter.
+ * With an encoding, the encoded stream is terminated and further
+ * writes begin a new stream, which a source reads as continuation.
  * The sink actions taken depend on its type.
  * BUFFER, FILEFILE: none.
  * FILENAME: call fclose on sink->file.
+ * FILEBLOCK: write the partial block and wait until all blocks are
+ * written.  With SC_IO_BLOCK_FSYNC, the file is synchronized to disk in
+ * the background; errors from that are returned by a later call.
  * \param [in,out] sink         The sink object to write to.
  * \param [in,out] bytes_in     Bytes received since the last new or complete
  *                              call.  May be NULL.
@@ -222,6 +274,8 @@ int                 sc_io_sink_complete (sc_io_sink_t * sink,
                                          size_t *bytes_in, size_t *bytes_out);
 
 /** Align sink to a byte boundary by writing zeros.
+ * The boundary refers to the bytes passed in, which differ from the
+ * bytes written if the sink has an encoding.
  * \param [in,out] sink         The sink object to align.
  * \param [in] bytes_align      Byte boundary.
  * \return                      0 on success, nonzero on error.
@@ -235,7 +289,14 @@ int                 sc_io_sink_align (sc_io_sink_t * sink,
  *                              BUFFER: sc_array_t * (existing array).
  *                              FILENAME: const char * (name of file to open).
  *                              FILEFILE: FILE * (file open for reading).
+ *                              MMAP: const char * (name of file to map).
+ *                              The file is mapped read-only as by
+ *                              \ref sc_io_file_map and read like a BUFFER.
+ *                              FILEBLOCK is not supported and returns NULL.
  * \param [in] ioencode         Encoding value from \ref sc_io_encode_t.
+ *                              With an encoding other than NONE, input is
+ *                              read ahead in blocks, and it must contain
+ *                              nothing but encoded streams.
  * \return                      Newly allocated source, or NULL on error.
  */
 sc_io_source_t     *sc_io_source_new (int iotype, int ioencode, ...);
@@ -311,6 +372,7 @@ int                 sc_io_source_align (sc_io_source_t * source,
                                         size_t bytes_align);
 
 /** Activate a buffer that mirrors (i.e., stores) the data that was read.
+ * This is not supported for sources of type BUFFER or with an encoding.
  * \param [in,out] source       The source object to activate mirror in.
  * \return                      0 on success, nonzero on error.
  */
@@ -353,17 +415,60 @@ int                 sc_io_file_save (const char *filename,
 int                 sc_io_file_load (const char *filename,
                                      sc_array_t * buffer);
 
+/** Map a file read-only into memory and return a view of its contents.
+ * The pages are loaded on demand and shared in the page cache by all
+ * processes that map the same file, so no copy of the file is made.
+ * Without mmap support the file is loaded by \ref sc_io_file_load.
+ * This function performs error checking and always returns cleanly.
+ * \param [in] filename     Name of the file to map.
+ * \param [in] advice       Hint on the access pattern to the contents.
+ * \return                  An array of element size 1 whose elements are
+ *                          the bytes of the file, which must not be
+ *                          modified.  The array must not be resized and
+ *                          is freed by \ref sc_io_file_unmap.
+ *                          NULL on error.
+ */
+sc_array_t         *sc_io_file_map (const char *filename,
+                                    sc_io_map_advice_t advice);
+
+/** Unmap a file mapped by \ref sc_io_file_map and free the array.
+ * \param [in,out] view     Array returned by \ref sc_io_file_map.
+ * \return                  0 on success, -1 on error.
+ */
+int                 sc_io_file_unmap (sc_array_t * view);
+
+/** Compute or update the CRC32C (Castagnoli) checksum of a buffer.
+ * The checksum is the one used by iSCSI and ext4 and is well suited to
+ * detect corruption of large buffers.  On x86-64 processors that support
+ * SSE4.2 it is computed by the crc32 instruction, which is selected at
+ * run time; otherwise a table-based implementation is used.  Both yield
+ * the same result, independent of the byte order of the host.
+ *
+ * The function can be called in a streaming fashion: start with a
+ * checksum of 0 and pass the result of each call to the next one.
+ * The final result is the same as for one call on all data.
+ *
+ * \param [in] crc          Checksum of the data so far, 0 at the start.
+ * \param [in] data         Data to add to the checksum.
+ *                          May be NULL if \a length is 0.
+ * \param [in] length       Number of bytes in \a data.
+ * \return                  The checksum updated by \a data.
+ */
+uint32_t            sc_io_crc32c (uint32_t crc, const void *data,
+                                  size_t length);
+
 /** Encode a block of arbitrary data with the default sc_io format.
  * The corresponding decoder function is \ref sc_io_decode.
  * This function cannot crash unless out of memory.
  *
  * Currently this function calls \ref sc_io_encode_zlib with
  * compression level Z_BEST_COMPRESSION (subject to change).
- * Without zlib configured that function works uncompressed.
+ * Without zlib configured that function uses a builtin compressor.
  *
  * The encoding method and input data size can be retrieved, optionally,
  * from the encoded data by \ref sc_io_decode_info.  This function decodes
- * the method as a character, which is 'z' for \ref sc_io_encode_zlib.
+ * the method as a character, which is 'z' for \ref sc_io_encode_zlib
+ * and 'Z' for \ref sc_io_encode_parallel.
  * We reserve the characters A-C, d-z indefinitely.
  *
  * \param [in,out] data     If \a out is NULL, we work in place.
@@ -388,7 +493,8 @@ void                sc_io_encode (sc_array_t *data, sc_array_t *out);
  * We first compress the data into the zlib deflate format (RFC 1951).
  * The compressor must use no preset dictionary (this is the default).
  * If zlib is detected on configuration, we compress with the given level.
- * If zlib is not detected, we write data equivalent to Z_NO_COMPRESSION.
+ * If zlib is not detected, we compress by a builtin fast deflate that
+ * ignores the level and writes fixed Huffman codes or stored blocks.
  * The status of zlib detection can be queried at compile time using
  * \#ifdef SC_HAVE_ZLIB or at run time using \ref sc_have_zlib.
  * Both types of result are readable by a standard zlib uncompress call.
@@ -427,6 +533,36 @@ void                sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
                                        int zlib_compression_level,
                                        int line_break_character);
 
+/** Encode a block of data like \ref sc_io_encode_zlib using threads.
+ * The input is split into blocks that are compressed independently
+ * into separate zlib streams, and the base 64 lines are coded
+ * independently as well, both by multiple threads if they are enabled.
+ *
+ * The output has the same line format and the same leading 8-byte
+ * big-endian original size as for \ref sc_io_encode_zlib, followed by
+ * the format character 'Z'.  Then follow the block size and the byte
+ * count of each compressed block, all as 8-byte big-endian numbers, and
+ * the concatenated compressed blocks.  The last block may be short.
+ * The output is decoded in parallel by \ref sc_io_decode.
+ *
+ * \param [in,out] data     As for \ref sc_io_encode_zlib.
+ * \param [in,out] out      As for \ref sc_io_encode_zlib.
+ * \param [in] zlib_compression_level     As for \ref sc_io_encode_zlib.
+ * \param [in] line_break_character       As for \ref sc_io_encode_zlib.
+ * \param [in] block_size   Uncompressed bytes per block, 0 for 1 MiB.
+ * \param [in] num_threads  Maximum number of threads to use.  If <= 0,
+ *                          use as many as processors are available to
+ *                          the process by its affinity mask, such that
+ *                          MPI processes bound to cores do not
+ *                          oversubscribe them.
+ */
+void                sc_io_encode_parallel (sc_array_t *data,
+                                           sc_array_t *out,
+                                           int zlib_compression_level,
+                                           int line_break_character,
+                                           size_t block_size,
+                                           int num_threads);
+
 /** Decode length and format of original input from encoded data.
  * We expect at least 12 bytes of the format produced by \ref sc_io_encode.
  * No matter how much data has been encoded by it, this much is available.
@@ -462,10 +598,15 @@ int                 sc_io_decode_info (sc_array_t *data,
  * This is a two-stage process: we decode the input from base 64 first.
  * Then we extract the 8-byte big-endian original data size, the character
  * 'z', and execute a zlib decompression on the remaining decoded data.
+ * With the character 'Z' written by \ref sc_io_encode_parallel, the
+ * blocks of compressed data are decompressed independently.
+ * Large input is decoded by multiple threads if they are enabled, but no
+ * more than processors are available to the process by its affinity mask.
+ * An MPI process bound to a single core thus decodes in the calling thread.
  * This function detects malformed input by erroring out.
  *
  * If we should add another format in the future, the format character
- * may be something else than 'z', as permitted by our specification.
+ * may be something else than 'z' or 'Z', as permitted by our specification.
  * To this end, we reserve the characters A-C and d-z indefinitely.
  *
  * Any error condition is indicated by a negative return value.
@@ -533,6 +674,74 @@ int                 sc_vtk_write_compressed (FILE * vtkfile,
                                              char *numeric_data,
                                              size_t byte_length);
 
+/** The section of an unstructured grid that a data array belongs to. */
+typedef enum sc_vtk_location
+{
+  SC_VTK_POINTS,            /**< Coordinates in the Points section. */
+  SC_VTK_CELLS,             /**< Connectivity, offsets, types of the Cells. */
+  SC_VTK_POINT_DATA,        /**< Data array in the PointData section. */
+  SC_VTK_CELL_DATA          /**< Data array in the CellData section. */
+}
+sc_vtk_location_t;
+
+/** Description of one process-local data array of an unstructured grid. */
+typedef struct sc_vtk_field
+{
+  sc_vtk_location_t   location; /**< Section to place the array into. */
+  const char         *name;     /**< Name attribute or NULL for none. */
+  const char         *type;     /**< VTK type such as "Float64" or "UInt8". */
+  int                 num_components;   /**< Components per tuple, >= 1. */
+  sc_array_t         *data;     /**< All of its bytes are written. */
+}
+sc_vtk_field_t;
+
+/** Collectively write one unstructured grid file in VTK XML format.
+ * Every process contributes its local grid as a separate Piece of the
+ * same .vtu file, which VTK readers combine into one grid.  Thus the
+ * connectivity and offsets refer to the points of the same process.
+ * The data arrays are stored in the AppendedData section in raw binary,
+ * uncompressed or as zlib-compressed blocks, in the byte order of the host.
+ * Without zlib, the blocks are written by a builtin compressor.
+ *
+ * The file offsets of the pieces are computed by prefix sums and all
+ * processes write their part by two collective calls to
+ * \ref sc_io_writev_at_all, one for the XML text and one for the appended
+ * data, which is efficient with MPI I/O.
+ *
+ * \param [in] mpicomm      This function is collective over the communicator.
+ * \param [in] filename     Name of the file to create or overwrite.
+ * \param [in] num_points   Number of points of the local piece.
+ * \param [in] num_cells    Number of cells of the local piece.
+ * \param [in] num_fields   Number of entries in \a fields, the same on
+ *                          all processes.
+ * \param [in] fields       Array descriptions with the same name, type,
+ *                          number of components and location on all
+ *                          processes.  The sections are written in the
+ *                          order of \ref sc_vtk_location_t and the arrays
+ *                          in each section in the order given.  There
+ *                          should be one array of points with three
+ *                          components and the three arrays named
+ *                          connectivity, offsets and types of the cells.
+ *                          The strings must not require XML escaping.
+ * \param [in] zlib_compression_level   If 0, write the arrays uncompressed.
+ *                          Otherwise compress blocks of 32 KiB with this
+ *                          level between 1 and 9 or -1 for the default.
+ * \param [in] num_threads  Maximum number of threads to compress blocks.
+ *                          If <= 0, use as many as processors are
+ *                          available to the process by its affinity.
+ * \return                  A sc_MPI_ERR_* as defined in \ref sc_mpi.h,
+ *                          the same on all processes.  The error code
+ *                          can be passed to \ref sc_MPI_Error_string.
+ */
+int                 sc_vtk_write_unstructured (sc_MPI_Comm mpicomm,
+                                               const char *filename,
+                                               size_t num_points,
+                                               size_t num_cells,
+                                               size_t num_fields,
+                                               const sc_vtk_field_t *fields,
+                                               int zlib_compression_level,
+                                               int num_threads);
+
 /** Wrapper for fopen(3).
  * We provide an additional argument that contains the error message.
  */
@@ -702,6 +911,66 @@ int                 sc_io_write_at_all (sc_MPI_File mpifile,
                                         const void *ptr, int count,
                                         sc_MPI_Datatype t, int *ocount);
 
+/** A contiguous piece of memory and its position in a file. */
+typedef struct sc_io_segment
+{
+  sc_MPI_Offset       offset;   /**< Byte offset in the file. */
+  void               *data;     /**< Memory of the segment, not
+                                     modified when writing. */
+  size_t              length;   /**< Number of bytes in the segment. */
+}
+sc_io_segment_t;
+
+/** Write scattered memory collectively to scattered file positions.
+ * With MPI I/O, the segments are described by a derived datatype in
+ * memory and a file view, such that all of them are written in one
+ * collective call without copying them into a contiguous buffer.
+ * This function does not update the file pointer that is part of mpifile.
+ *
+ * \param [in,out] mpifile      MPI file object opened for writing.
+ * \param [in] segments     The segments of this process.  Their file
+ *                          ranges must be ascending and non-overlapping.
+ *                          The lengths are not limited to INT_MAX.
+ * \param [in] num_segments Number of segments, may differ between
+ *                          processes and be zero.
+ * \param [out] obytes      The number of bytes written by this process.
+ * \return              A sc_MPI_ERR_* as defined in \ref sc_mpi.h.
+ *                      The error code can be passed to
+ *                      \ref sc_MPI_Error_string.
+ * \note                With MPI but without MPI I/O, the segments are
+ *                      copied into one buffer and written by
+ *                      \ref sc_io_write_at_all, whose fallback appends
+ *                      the data in the order of the ranks.  Thus the
+ *                      file ranges should be contiguous in this case.
+ */
+int                 sc_io_writev_at_all (sc_MPI_File mpifile,
+                                         const sc_io_segment_t * segments,
+                                         size_t num_segments,
+                                         size_t *obytes);
+
+/** Read scattered file positions collectively into scattered memory.
+ * With MPI I/O, the segments are described by a derived datatype in
+ * memory and a file view, such that all of them are read in one
+ * collective call without copying them out of a contiguous buffer.
+ * This function does not update the file pointer that is part of mpifile.
+ *
+ * \param [in,out] mpifile      MPI file object opened for reading.
+ * \param [in] segments     The segments of this process.  Their file
+ *                          ranges must be ascending and non-overlapping.
+ *                          The lengths are not limited to INT_MAX.
+ * \param [in] num_segments Number of segments, may differ between
+ *                          processes and be zero.
+ * \param [out] obytes      The number of bytes read by this process as
+ *                          reported by MPI.  It may be less than the total
+ *                          length if the end of the file is reached.
+ * \return              A sc_MPI_ERR_* as defined in \ref sc_mpi.h.
+ *                      The error code can be passed to
+ *                      \ref sc_MPI_Error_string.
+ */
+int                 sc_io_readv_at_all (sc_MPI_File mpifile,
+                                        const sc_io_segment_t * segments,
+                                        size_t num_segments, size_t *obytes);
+
 /** Close collectively a sc_MPI_File.
  *
  * \param[in] file  MPI file object that is closed.
@@ -108,6 +108,8 @@ typedef enum
   SC_TAG_REDUCE = SC_TAG_NOTIFY_NARY + 32,  /**< Used in MPI reduce replacement. */
   SC_TAG_PSORT_LO,              /**< Internal tag to \ref sc_psort. */
   SC_TAG_PSORT_HI,              /**< Internal tag to \ref sc_psort. */
+  SC_TAG_RANGES_SPARSE,         /**< Internal tag to \ref
+                                     sc_ranges_adaptive_sparse. */
   SC_TAG_LAST                   /**< End marker of tag enumeration. */
 }
 sc_tag_t;
@@ -0,0 +1,426 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_pqueue.h>
+
+/* position of an id that is not in the queue */
+#define SC_PQUEUE_ABSENT ((size_t) -1)
+
+/* alignment in bytes of the first child of the root */
+#define SC_PQUEUE_ALIGN 64
+
+typedef union sc_pqueue_key
+{
+  int64_t             i;
+  double              d;
+}
+sc_pqueue_key_t;
+
+typedef struct sc_pqueue_node
+{
+  sc_pqueue_key_t     key;      /**< Key of the item. */
+  size_t              id;       /**< Id of the item. */
+}
+sc_pqueue_node_t;
+
+struct sc_pqueue
+{
+  int                 arity;    /**< Number of children per node. */
+  sc_pqueue_type_t    type;     /**< Type of the keys. */
+  size_t              count;    /**< Number of items in the heap. */
+  size_t              capacity; /**< Number of allocated heap nodes. */
+  char               *raw;      /**< Memory allocated for the heap. */
+  sc_pqueue_node_t   *heap;     /**< Heap nodes within the raw memory. */
+  sc_array_t          position; /**< Heap position of each id. */
+};
+
+static inline int
+sc_pqueue_less (const sc_pqueue_node_t * a, const sc_pqueue_node_t * b,
+                int isdouble)
+{
+  return isdouble ? a->key.d < b->key.d : a->key.i < b->key.i;
+}
+
+/* Move the hole at position i up and place the node there. */
+static inline void
+sc_pqueue_sift_up (sc_pqueue_t * pq, size_t i, sc_pqueue_node_t node,
+                   int isdouble)
+{
+  const size_t        d = (size_t) pq->arity;
+  size_t              parent;
+  size_t             *pos = (size_t *) pq->position.array;
+  sc_pqueue_node_t   *heap = pq->heap;
+
+  while (i > 0) {
+    parent = (i - 1) / d;
+    if (!sc_pqueue_less (&node, &heap[parent], isdouble)) {
+      break;
+    }
+    heap[i] = heap[parent];
+    pos[heap[i].id] = i;
+    i = parent;
+  }
+  heap[i] = node;
+  pos[node.id] = i;
+}
+
+/* Move the hole at position i down and place the node there. */
+static inline void
+sc_pqueue_sift_down (sc_pqueue_t * pq, size_t i, sc_pqueue_node_t node,
+                     int isdouble)
+{
+  const size_t        d = (size_t) pq->arity;
+  const size_t        n = pq->count;
+  size_t              c, first, last, best;
+  size_t             *pos = (size_t *) pq->position.array;
+  sc_pqueue_node_t   *heap = pq->heap;
+
+  while ((first = d * i + 1) < n) {
+    /* the children of one node are contiguous and aligned */
+    last = SC_MIN (first + d, n);
+    best = first;
+    for (c = first + 1; c < last; ++c) {
+      if (sc_pqueue_less (&heap[c], &heap[best], isdouble)) {
+        best = c;
+      }
+    }
+    if (!sc_pqueue_less (&heap[best], &node, isdouble)) {
+      break;
+    }
+    heap[i] = heap[best];
+    pos[heap[i].id] = i;
+    i = best;
+  }
+  heap[i] = node;
+  pos[node.id] = i;
+}
+
+static void
+sc_pqueue_reserve (sc_pqueue_t * pq, size_t n)
+{
+  const size_t        pad = (size_t) pq->arity - 1;
+  size_t              newcap, shift;
+  char               *raw;
+  sc_pqueue_node_t   *heap;
+
+  if (n <= pq->capacity) {
+    return;
+  }
+  newcap = SC_MAX (n, 2 * pq->capacity);
+  newcap = SC_MAX (newcap, (size_t) 16);
+
+  /* with pad nodes in front the children of node i start at
+     position d * (i + 1) relative to the aligned address */
+  raw = SC_ALLOC (char, (newcap + pad) * sizeof (sc_pqueue_node_t) +
+                  SC_PQUEUE_ALIGN);
+  shift = (SC_PQUEUE_ALIGN -
+           (size_t) ((uintptr_t) raw % SC_PQUEUE_ALIGN)) % SC_PQUEUE_ALIGN;
+  heap = (sc_pqueue_node_t *) (raw + shift) + pad;
+  if (pq->count > 0) {
+    memcpy (heap, pq->heap, pq->count * sizeof (sc_pqueue_node_t));
+  }
+  SC_FREE (pq->raw);
+  pq->raw = raw;
+  pq->heap = heap;
+  pq->capacity = newcap;
+}
+
+static void
+sc_pqueue_reserve_id (sc_pqueue_t * pq, size_t id)
+{
+  size_t              zz, old_count;
+  size_t             *pos;
+
+  old_count = pq->position.elem_count;
+  if (id < old_count) {
+    return;
+  }
+  sc_array_resize (&pq->position, id + 1);
+  pos = (size_t *) pq->position.array;
+  for (zz = old_count; zz <= id; ++zz) {
+    pos[zz] = SC_PQUEUE_ABSENT;
+  }
+}
+
+sc_pqueue_t        *
+sc_pqueue_new (int arity, sc_pqueue_type_t type)
+{
+  sc_pqueue_t        *pq;
+
+  SC_ASSERT (arity == 4 || arity == 8);
+  SC_ASSERT (type == SC_PQUEUE_INT64 || type == SC_PQUEUE_DOUBLE);
+  SC_ASSERT (sizeof (sc_pqueue_key_t) == sizeof (int64_t));
+
+  pq = SC_ALLOC_ZERO (sc_pqueue_t, 1);
+  pq->arity = arity;
+  pq->type = type;
+  sc_array_init (&pq->position, sizeof (size_t));
+
+  return pq;
+}
+
+void
+sc_pqueue_destroy (sc_pqueue_t * pq)
+{
+  SC_FREE (pq->raw);
+  sc_array_reset (&pq->position);
+  SC_FREE (pq);
+}
+
+size_t
+sc_pqueue_memory_used (sc_pqueue_t * pq)
+{
+  return sizeof (sc_pqueue_t) + (pq->raw == NULL ? 0 :
+                                 (pq->capacity + pq->arity - 1) *
+                                 sizeof (sc_pqueue_node_t) +
+                                 SC_PQUEUE_ALIGN) +
+    sc_array_memory_used (&pq->position, 0);
+}
+
+void
+sc_pqueue_clear (sc_pqueue_t * pq)
+{
+  size_t              zz;
+  size_t             *pos = (size_t *) pq->position.array;
+
+  for (zz = 0; zz < pq->count; ++zz) {
+    pos[pq->heap[zz].id] = SC_PQUEUE_ABSENT;
+  }
+  pq->count = 0;
+}
+
+size_t
+sc_pqueue_count (sc_pqueue_t * pq)
+{
+  return pq->count;
+}
+
+int
+sc_pqueue_contains (sc_pqueue_t * pq, size_t id)
+{
+  return id < pq->position.elem_count &&
+    ((size_t *) pq->position.array)[id] != SC_PQUEUE_ABSENT;
+}
+
+static inline void
+sc_pqueue_push_ext (sc_pqueue_t * pq, size_t id, sc_pqueue_key_t key,
+                    int isdouble)
+{
+  sc_pqueue_node_t    node;
+
+  SC_ASSERT (id != SC_PQUEUE_ABSENT);
+  sc_pqueue_reserve_id (pq, id);
+  SC_ASSERT (!sc_pqueue_contains (pq, id));
+  sc_pqueue_reserve (pq, pq->count + 1);
+
+  node.key = key;
+  node.id = id;
+  sc_pqueue_sift_up (pq, pq->count++, node, isdouble);
+}
+
+void
+sc_pqueue_push_int (sc_pqueue_t * pq, size_t id, int64_t key)
+{
+  sc_pqueue_key_t     k;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_INT64);
+  k.i = key;
+  sc_pqueue_push_ext (pq, id, k, 0);
+}
+
+void
+sc_pqueue_push_double (sc_pqueue_t * pq, size_t id, double key)
+{
+  sc_pqueue_key_t     k;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_DOUBLE);
+  k.d = key;
+  sc_pqueue_push_ext (pq, id, k, 1);
+}
+
+static inline void
+sc_pqueue_update_ext (sc_pqueue_t * pq, size_t id, sc_pqueue_key_t key,
+                      int isdouble)
+{
+  size_t              p;
+  sc_pqueue_node_t    node;
+
+  SC_ASSERT (sc_pqueue_contains (pq, id));
+  p = ((size_t *) pq->position.array)[id];
+  SC_ASSERT (p < pq->count && pq->heap[p].id == id);
+
+  node.key = key;
+  node.id = id;
+  if (sc_pqueue_less (&node, &pq->heap[p], isdouble)) {
+    sc_pqueue_sift_up (pq, p, node, isdouble);
+  }
+  else {
+    sc_pqueue_sift_down (pq, p, node, isdouble);
+  }
+}
+
+void
+sc_pqueue_update_int (sc_pqueue_t * pq, size_t id, int64_t key)
+{
+  sc_pqueue_key_t     k;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_INT64);
+  k.i = key;
+  sc_pqueue_update_ext (pq, id, k, 0);
+}
+
+void
+sc_pqueue_update_double (sc_pqueue_t * pq, size_t id, double key)
+{
+  sc_pqueue_key_t     k;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_DOUBLE);
+  k.d = key;
+  sc_pqueue_update_ext (pq, id, k, 1);
+}
+
+int
+sc_pqueue_remove (sc_pqueue_t * pq, size_t id)
+{
+  const int           isdouble = (pq->type == SC_PQUEUE_DOUBLE);
+  size_t              p;
+  size_t             *pos;
+  sc_pqueue_node_t    last;
+
+  if (!sc_pqueue_contains (pq, id)) {
+    return 0;
+  }
+  pos = (size_t *) pq->position.array;
+  p = pos[id];
+  pos[id] = SC_PQUEUE_ABSENT;
+
+  /* fill the hole with the last node */
+  if (p < --pq->count) {
+    last = pq->heap[pq->count];
+    if (sc_pqueue_less (&last, &pq->heap[p], isdouble)) {
+      sc_pqueue_sift_up (pq, p, last, isdouble);
+    }
+    else {
+      sc_pqueue_sift_down (pq, p, last, isdouble);
+    }
+  }
+  return 1;
+}
+
+size_t
+sc_pqueue_top_int (sc_pqueue_t * pq, int64_t * key)
+{
+  SC_ASSERT (pq->type == SC_PQUEUE_INT64);
+  SC_ASSERT (pq->count > 0);
+
+  if (key != NULL) {
+    *key = pq->heap[0].key.i;
+  }
+  return pq->heap[0].id;
+}
+
+size_t
+sc_pqueue_top_double (sc_pqueue_t * pq, double *key)
+{
+  SC_ASSERT (pq->type == SC_PQUEUE_DOUBLE);
+  SC_ASSERT (pq->count > 0);
+
+  if (key != NULL) {
+    *key = pq->heap[0].key.d;
+  }
+  return pq->heap[0].id;
+}
+
+static inline sc_pqueue_node_t
+sc_pqueue_pop_ext (sc_pqueue_t * pq, int isdouble)
+{
+  sc_pqueue_node_t    top;
+
+  SC_ASSERT (pq->count > 0);
+
+  top = pq->heap[0];
+  ((size_t *) pq->position.array)[top.id] = SC_PQUEUE_ABSENT;
+  if (--pq->count > 0) {
+    sc_pqueue_sift_down (pq, 0, pq->heap[pq->count], isdouble);
+  }
+  return top;
+}
+
+size_t
+sc_pqueue_pop_int (sc_pqueue_t * pq, int64_t * key)
+{
+  sc_pqueue_node_t    top;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_INT64);
+
+  top = sc_pqueue_pop_ext (pq, 0);
+  if (key != NULL) {
+    *key = top.key.i;
+  }
+  return top.id;
+}
+
+size_t
+sc_pqueue_pop_double (sc_pqueue_t * pq, double *key)
+{
+  sc_pqueue_node_t    top;
+
+  SC_ASSERT (pq->type == SC_PQUEUE_DOUBLE);
+
+  top = sc_pqueue_pop_ext (pq, 1);
+  if (key != NULL) {
+    *key = top.key.d;
+  }
+  return top.id;
+}
+
+void
+sc_pqueue_heapify (sc_pqueue_t * pq, sc_array_t * keys)
+{
+  const int           isdouble = (pq->type == SC_PQUEUE_DOUBLE);
+  const size_t        n = keys->elem_count;
+  size_t              zz;
+  size_t             *pos;
+
+  SC_ASSERT (keys->elem_size == sizeof (sc_pqueue_key_t));
+
+  sc_pqueue_clear (pq);
+  if (n == 0) {
+    return;
+  }
+  sc_pqueue_reserve (pq, n);
+  sc_pqueue_reserve_id (pq, n - 1);
+
+  /* place the items in order and sift down the inner nodes */
+  pos = (size_t *) pq->position.array;
+  for (zz = 0; zz < n; ++zz) {
+    memcpy (&pq->heap[zz].key, keys->array + zz * keys->elem_size,
+            sizeof (sc_pqueue_key_t));
+    pq->heap[zz].id = zz;
+    pos[zz] = zz;
+  }
+  pq->count = n;
+  for (zz = (n - 1) / (size_t) pq->arity + 1; zz-- > 0;) {
+    sc_pqueue_sift_down (pq, zz, pq->heap[zz], isdouble);
+  }
+}
@@ -0,0 +1,173 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#ifndef SC_PQUEUE_H
+#define SC_PQUEUE_H
+
+/** \file sc_pqueue.h
+ * Indexed priority queue on a d-ary heap with integer or floating keys.
+ *
+ * The queue stores pairs of a key and an item id.  The ids are chosen by
+ * the caller from the nonnegative integers and serve as handles:
+ * an item that is in the queue can have its key changed or be removed.
+ * The item with the smallest key is at the top of the queue.
+ *
+ * The heap has 4 or 8 children per node.  Its nodes have 16 bytes and
+ * are laid out such that the children of one node share cache lines.
+ * Keys are compared inline without calling a comparison function.
+ * For generic elements see \ref sc_array_pqueue_add.
+ */
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** The type of the keys stored in a priority queue. */
+typedef enum sc_pqueue_type
+{
+  SC_PQUEUE_INT64,      /**< Keys are compared as int64_t. */
+  SC_PQUEUE_DOUBLE      /**< Keys are compared as double, must not be NaN. */
+}
+sc_pqueue_type_t;
+
+/** Opaque priority queue object. */
+typedef struct sc_pqueue sc_pqueue_t;
+
+/** Create a new empty priority queue.
+ * \param [in] arity    Number of children per heap node, 4 or 8.
+ * \param [in] type     Type of the keys.
+ * \return              A valid priority queue.
+ */
+sc_pqueue_t        *sc_pqueue_new (int arity, sc_pqueue_type_t type);
+
+/** Destroy a priority queue.
+ * \param [in,out] pq   This queue is freed.
+ */
+void                sc_pqueue_destroy (sc_pqueue_t * pq);
+
+/** Return the memory used by a priority queue in bytes.
+ * \param [in] pq       Valid priority queue.
+ * \return              Memory used in bytes.
+ */
+size_t              sc_pqueue_memory_used (sc_pqueue_t * pq);
+
+/** Remove all items from a priority queue without freeing memory.
+ * \param [in,out] pq   Valid priority queue.
+ */
+void                sc_pqueue_clear (sc_pqueue_t * pq);
+
+/** Return the number of items in a priority queue.
+ * \param [in] pq       Valid priority queue.
+ * \return              Number of items in the queue.
+ */
+size_t              sc_pqueue_count (sc_pqueue_t * pq);
+
+/** Query whether an item is in the priority queue.
+ * \param [in] pq       Valid priority queue.
+ * \param [in] id       Any item id.
+ * \return              True if the item is in the queue.
+ */
+int                 sc_pqueue_contains (sc_pqueue_t * pq, size_t id);
+
+/** Insert an item into a priority queue of type SC_PQUEUE_INT64.
+ * \param [in,out] pq   Valid priority queue.
+ * \param [in] id       Item id that must not be in the queue.
+ *                      Memory proportional to the largest id is used.
+ * \param [in] key      Key of the item.
+ */
+void                sc_pqueue_push_int (sc_pqueue_t * pq,
+                                        size_t id, int64_t key);
+
+/** Insert an item into a priority queue of type SC_PQUEUE_DOUBLE.
+ * \param [in,out] pq   Valid priority queue.
+ * \param [in] id       Item id that must not be in the queue.
+ *                      Memory proportional to the largest id is used.
+ * \param [in] key      Key of the item.
+ */
+void                sc_pqueue_push_double (sc_pqueue_t * pq,
+                                           size_t id, double key);
+
+/** Change the key of an item in a priority queue of type SC_PQUEUE_INT64.
+ * Decreasing the key is cheaper than increasing it.
+ * \param [in,out] pq   Valid priority queue.
+ * \param [in] id       Item id that must be in the queue.
+ * \param [in] key      New key of the item.
+ */
+void                sc_pqueue_update_int (sc_pqueue_t * pq,
+                                          size_t id, int64_t key);
+
+/** Change the key of an item in a priority queue of type SC_PQUEUE_DOUBLE.
+ * Decreasing the key is cheaper than increasing it.
+ * \param [in,out] pq   Valid priority queue.
+ * \param [in] id       Item id that must be in the queue.
+ * \param [in] key      New key of the item.
+ */
+void                sc_pqueue_update_double (sc_pqueue_t * pq,
+                                             size_t id, double key);
+
+/** Remove an item from a priority queue.
+ * \param [in,out] pq   Valid priority queue.
+ * \param [in] id       Any item id.
+ * \return              True if the item was in the queue and is removed.
+ */
+int                 sc_pqueue_remove (sc_pqueue_t * pq, size_t id);
+
+/** Return the item with the smallest key of a SC_PQUEUE_INT64 queue.
+ * \param [in] pq       Valid priority queue that is not empty.
+ * \param [out] key     If not NULL, the key of the item is stored here.
+ * \return              The id of the item at the top of the queue.
+ */
+size_t              sc_pqueue_top_int (sc_pqueue_t * pq, int64_t * key);
+
+/** Return the item with the smallest key of a SC_PQUEUE_DOUBLE queue.
+ * \param [in] pq       Valid priority queue that is not empty.
+ * \param [out] key     If not NULL, the key of the item is stored here.
+ * \return              The id of the item at the top of the queue.
+ */
+size_t              sc_pqueue_top_double (sc_pqueue_t * pq, double *key);
+
+/** Remove the item with the smallest key of a SC_PQUEUE_INT64 queue.
+ * \param [in,out] pq   Valid priority queue that is not empty.
+ * \param [out] key     If not NULL, the key of the item is stored here.
+ * \return              The id of the removed item.
+ */
+size_t              sc_pqueue_pop_int (sc_pqueue_t * pq, int64_t * key);
+
+/** Remove the item with the smallest key of a SC_PQUEUE_DOUBLE queue.
+ * \param [in,out] pq   Valid priority queue that is not empty.
+ * \param [out] key     If not NULL, the key of the item is stored here.
+ * \return              The id of the removed item.
+ */
+size_t              sc_pqueue_pop_double (sc_pqueue_t * pq, double *key);
+
+/** Replace the contents of a priority queue by an array of keys.
+ * Item i of the queue receives the key at position i of the array.
+ * The heap is built bottom-up in time linear in the number of keys.
+ * \param [in,out] pq   Valid priority queue.  Previous items are removed.
+ * \param [in] keys     Array of int64_t or double matching the queue type.
+ */
+void                sc_pqueue_heapify (sc_pqueue_t * pq, sc_array_t * keys);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_PQUEUE_H */
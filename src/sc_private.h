@@ -44,6 +44,17 @@ SC_EXTERN_C_BEGIN;
  */
 void                sc_package_rc_count_add (int package_id, int toadd);
 
+/** Create the MPI datatypes and operation used by \ref sc_stats_compute.
+ * This function is called by \ref sc_init when MPI is initialized and
+ * otherwise on first use.  It does nothing when they exist already.
+ */
+void                sc_stats_init_mpi (void);
+
+/** Free the cached MPI objects of the statistics.
+ * This function is called by \ref sc_finalize.
+ */
+void                sc_stats_finalize_mpi (void);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_PRIVATE_H */
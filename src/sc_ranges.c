@@ -30,94 +30,69 @@ sc_ranges_compare (const void *v1, const void *v2)
   return *(int *) v1 - *(int *) v2;
 }
 
-int
-sc_ranges_compute (int package_id, int num_procs, const int *procs,
-                   int rank, int first_peer, int last_peer,
-                   int num_ranges, int *ranges)
+/** Record the empty range between two consecutive peers.
+ * If all ranges are in use afterwards, the shortest one is dropped.
+ * \return             The number of empty ranges in use.
+ */
+static int
+sc_ranges_add_empty (int package_id, int num_ranges, int *ranges,
+                     int prev, int j)
 {
-  int                 i, j;
-  int                 lastw, prev, nwin, length;
+  int                 i;
+  int                 lastw, nwin, length;
   int                 shortest_range, shortest_length;
 
-  SC_ASSERT (rank >= 0 && rank < num_procs);
+  SC_ASSERT (prev < j - 1);
+  length = j - 1 - prev;
+  SC_GEN_LOGF (package_id, SC_LC_NORMAL, SC_LP_DEBUG,
+               "found empty range prev %d j %d length %d\n",
+               prev, j, length);
 
-  /* initialize ranges as empty */
-  nwin = 0;
+  /* claim unused range */
   for (i = 0; i < num_ranges; ++i) {
-    ranges[2 * i] = -1;
-    ranges[2 * i + 1] = -2;
-  }
-
-  /* if no peers are present there are no ranges */
-  if (first_peer > last_peer) {
-    SC_ASSERT (first_peer == num_procs && last_peer == -1);
-    return nwin;
-  }
-
-#ifdef SC_ENABLE_DEBUG
-  SC_ASSERT (0 <= first_peer && first_peer <= last_peer &&
-             last_peer < num_procs);
-  SC_ASSERT (first_peer != rank && last_peer != rank);
-  SC_ASSERT (procs[first_peer] && procs[last_peer]);
-  for (j = 0; j < first_peer; ++j) {
-    SC_ASSERT (j == rank || !procs[j]);
-  }
-  for (j = last_peer + 1; j < num_procs; ++j) {
-    SC_ASSERT (j == rank || !procs[j]);
+    if (ranges[2 * i] == -1) {
+      ranges[2 * i] = prev + 1;
+      ranges[2 * i + 1] = j - 1;
+      break;
+    }
   }
-#endif
+  SC_ASSERT (i < num_ranges);
+  nwin = i + 1;
 
-  /* find a maximum of num_ranges - 1 empty ranges with (start, end) */
+  /* if all ranges are used, remove the shortest */
   lastw = num_ranges - 1;
-  prev = -1;
-  for (j = 0; j < num_procs; ++j) {
-    if (!procs[j] || j == rank) {
-      continue;
-    }
-    if (prev == -1) {
-      prev = j;
-      continue;
-    }
-    if (prev < j - 1) {
-      length = j - 1 - prev;
-      SC_GEN_LOGF (package_id, SC_LC_NORMAL, SC_LP_DEBUG,
-                   "found empty range prev %d j %d length %d\n",
-                   prev, j, length);
-
-      /* claim unused range */
-      for (i = 0; i < num_ranges; ++i) {
-        if (ranges[2 * i] == -1) {
-          ranges[2 * i] = prev + 1;
-          ranges[2 * i + 1] = j - 1;
-          break;
-        }
-      }
-      SC_ASSERT (i < num_ranges);
-      nwin = i + 1;
-
-      /* if all ranges are used, remove the shortest */
-      if (nwin == num_ranges) {
-        nwin = lastw;
-        shortest_range = -1;
-        shortest_length = num_procs + 1;
-        for (i = 0; i < num_ranges; ++i) {
-          length = ranges[2 * i + 1] - ranges[2 * i] + 1;
-          if (length < shortest_length) {
-            shortest_range = i;
-            shortest_length = length;
-          }
-        }
-        SC_ASSERT (shortest_range >= 0 && shortest_range <= lastw);
-        if (shortest_range < lastw) {
-          ranges[2 * shortest_range] = ranges[2 * lastw];
-          ranges[2 * shortest_range + 1] = ranges[2 * lastw + 1];
-        }
-        ranges[2 * lastw] = -1;
-        ranges[2 * lastw + 1] = -2;
+  if (nwin == num_ranges) {
+    nwin = lastw;
+    shortest_range = -1;
+    shortest_length = INT_MAX;
+    for (i = 0; i < num_ranges; ++i) {
+      length = ranges[2 * i + 1] - ranges[2 * i] + 1;
+      if (length < shortest_length) {
+        shortest_range = i;
+        shortest_length = length;
       }
     }
-    prev = j;
+    SC_ASSERT (shortest_range >= 0 && shortest_range <= lastw);
+    if (shortest_range < lastw) {
+      ranges[2 * shortest_range] = ranges[2 * lastw];
+      ranges[2 * shortest_range + 1] = ranges[2 * lastw + 1];
+    }
+    ranges[2 * lastw] = -1;
+    ranges[2 * lastw + 1] = -2;
   }
+
+  return nwin;
+}
+
+/** Turn the empty ranges between peers into the ranges covering them.
+ * \return             The number of filled ranges.
+ */
+static int
+sc_ranges_finalize (int package_id, int num_ranges, int *ranges,
+                    int nwin, int first_peer, int last_peer)
+{
+  int                 i;
+
   SC_ASSERT (nwin >= 0 && nwin < num_ranges);
 
   /* sort empty ranges by start rank */
@@ -162,11 +137,6 @@ sc_ranges_compute (int package_id, int num_procs, const int *procs,
     SC_ASSERT (ranges[2 * i] == -1);
     SC_ASSERT (ranges[2 * i + 1] == -2);
   }
-  for (i = 0; i < nwin - 1; ++i) {
-    for (j = ranges[2 * i + 1] + 1; j < ranges[2 * (i + 1)]; ++j) {
-      SC_ASSERT (j == rank || !procs[j]);
-    }
-  }
   for (i = 0; i < nwin; ++i) {
     SC_GEN_LOGF (package_id, SC_LC_NORMAL, SC_LP_DEBUG,
                  "range %d from %d to %d\n", i,
@@ -177,6 +147,117 @@ sc_ranges_compute (int package_id, int num_procs, const int *procs,
   return nwin;
 }
 
+int
+sc_ranges_compute (int package_id, int num_procs, const int *procs,
+                   int rank, int first_peer, int last_peer,
+                   int num_ranges, int *ranges)
+{
+  int                 i, j;
+  int                 prev, nwin;
+
+  SC_ASSERT (rank >= 0 && rank < num_procs);
+
+  /* initialize ranges as empty */
+  nwin = 0;
+  for (i = 0; i < num_ranges; ++i) {
+    ranges[2 * i] = -1;
+    ranges[2 * i + 1] = -2;
+  }
+
+  /* if no peers are present there are no ranges */
+  if (first_peer > last_peer) {
+    SC_ASSERT (first_peer == num_procs && last_peer == -1);
+    return nwin;
+  }
+
+#ifdef SC_ENABLE_DEBUG
+  SC_ASSERT (0 <= first_peer && first_peer <= last_peer &&
+             last_peer < num_procs);
+  SC_ASSERT (first_peer != rank && last_peer != rank);
+  SC_ASSERT (procs[first_peer] && procs[last_peer]);
+  for (j = 0; j < first_peer; ++j) {
+    SC_ASSERT (j == rank || !procs[j]);
+  }
+  for (j = last_peer + 1; j < num_procs; ++j) {
+    SC_ASSERT (j == rank || !procs[j]);
+  }
+#endif
+
+  /* find a maximum of num_ranges - 1 empty ranges with (start, end) */
+  prev = -1;
+  for (j = 0; j < num_procs; ++j) {
+    if (!procs[j] || j == rank) {
+      continue;
+    }
+    if (prev == -1) {
+      prev = j;
+      continue;
+    }
+    if (prev < j - 1) {
+      nwin = sc_ranges_add_empty (package_id, num_ranges, ranges, prev, j);
+    }
+    prev = j;
+  }
+  nwin = sc_ranges_finalize (package_id, num_ranges, ranges,
+                             nwin, first_peer, last_peer);
+
+#ifdef SC_ENABLE_DEBUG
+  for (i = 0; i < nwin - 1; ++i) {
+    for (j = ranges[2 * i + 1] + 1; j < ranges[2 * (i + 1)]; ++j) {
+      SC_ASSERT (j == rank || !procs[j]);
+    }
+  }
+#endif
+
+  return nwin;
+}
+
+int
+sc_ranges_compute_sparse (int package_id, int num_procs,
+                          const int *receivers, int num_receivers,
+                          int rank, int num_ranges, int *ranges)
+{
+  int                 i, j, k;
+  int                 prev, nwin;
+  int                 first_peer;
+
+  SC_ASSERT (rank >= 0 && rank < num_procs);
+  SC_ASSERT (num_receivers >= 0);
+
+  /* initialize ranges as empty */
+  nwin = 0;
+  for (i = 0; i < num_ranges; ++i) {
+    ranges[2 * i] = -1;
+    ranges[2 * i + 1] = -2;
+  }
+
+  /* the gaps between consecutive receivers are the empty ranges */
+  first_peer = prev = -1;
+  for (k = 0; k < num_receivers; ++k) {
+    j = receivers[k];
+    SC_ASSERT (0 <= j && j < num_procs);
+    SC_ASSERT (k == 0 || receivers[k - 1] < j);
+    if (j == rank) {
+      continue;
+    }
+    if (prev == -1) {
+      first_peer = prev = j;
+      continue;
+    }
+    if (prev < j - 1) {
+      nwin = sc_ranges_add_empty (package_id, num_ranges, ranges, prev, j);
+    }
+    prev = j;
+  }
+
+  /* if no peers are present there are no ranges */
+  if (prev == -1) {
+    return nwin;
+  }
+  return sc_ranges_finalize (package_id, num_ranges, ranges,
+                             nwin, first_peer, prev);
+}
+
 int
 sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
                     const int *procs, int *inout1, int *inout2,
@@ -226,6 +307,191 @@ sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
   return nwin;
 }
 
+/** Restrict a strided set of ranks to one residue class.
+ * On input, the set contains the ranks in [*lo, *hi] that are congruent
+ * to *lo modulo a divisor of \a modulus.  On output, it contains those
+ * that are congruent to \a residue modulo \a modulus.
+ * \return             True if the restricted set is not empty.
+ */
+static int
+sc_ranges_residue (int *lo, int *hi, int residue, int modulus)
+{
+  SC_ASSERT (0 <= *lo && 0 <= residue && residue < modulus);
+
+  *lo += (residue - *lo % modulus + modulus) % modulus;
+  *hi -= (*hi % modulus - residue + modulus) % modulus;
+  return *lo <= *hi;
+}
+
+/** Find the processes whose ranges contain the calling process.
+ * Each range is routed as a strided set of ranks (sender, lo, hi) through
+ * the same recursive doubling as in \ref sc_notify.  A set is split by the
+ * next bit of its ranks at every level, so the work depends on the number
+ * of ranges and senders, and not on the number of processes they cover.
+ * \param [in,out] pieces      Integer triples of the local ranges on input.
+ *                             Destroyed on output.
+ * \param [in,out] senders     Resized to the sorted senders.
+ */
+static void
+sc_ranges_notify (sc_MPI_Comm mpicomm, int num_procs, int rank,
+                  sc_array_t * pieces, sc_array_t * senders)
+{
+  int                 mpiret;
+  int                 length, length2, pow2length;
+  int                 start, half, peer, peer2, source;
+  int                 count, lo, hi;
+  int                *pint, *pout;
+  size_t              zz;
+  sc_array_t         *keep, *sendbuf, *swap;
+  sc_MPI_Request      outrequest;
+  sc_MPI_Status       instatus;
+
+  pow2length = SC_ROUNDUP2_32 (num_procs);
+  sendbuf = sc_array_new (sizeof (int));
+  keep = sc_array_new (sizeof (int));
+  for (length = 2; length <= pow2length; length *= 2) {
+    length2 = length / 2;
+    start = rank - rank % length;
+    half = (rank % length >= length2);
+
+    /* determine communication pattern as in sc_notify_recursive */
+    peer = rank ^ length2;
+    if (peer >= num_procs) {
+      /* peer does not exist; send to a lower processor if nonnegative */
+      SC_ASSERT (!half);
+      peer -= length;
+    }
+    peer2 = rank + length2;
+    if (!(half && peer2 < num_procs && (peer2 ^ length2) >= num_procs)) {
+      peer2 = -1;
+    }
+
+    /* split every set into the ranks kept and the ranks of the peer */
+    sc_array_truncate (keep);
+    sc_array_truncate (sendbuf);
+    for (zz = 0; zz < pieces->elem_count; zz += 3) {
+      pint = (int *) sc_array_index (pieces, zz);
+      lo = pint[1];
+      hi = pint[2];
+      if (sc_ranges_residue (&lo, &hi, rank % length, length)) {
+        pout = (int *) sc_array_push_count (keep, 3);
+        pout[0] = pint[0];
+        pout[1] = lo;
+        pout[2] = hi;
+      }
+      lo = pint[1];
+      hi = pint[2];
+      if (sc_ranges_residue (&lo, &hi, (rank % length) ^ length2, length)) {
+        pout = (int *) sc_array_push_count (sendbuf, 3);
+        pout[0] = pint[0];
+        pout[1] = lo;
+        pout[2] = hi;
+      }
+    }
+    SC_ASSERT (peer >= 0 || sendbuf->elem_count == 0);
+
+    if (peer >= 0) {
+      mpiret = sc_MPI_Isend (sendbuf->array, (int) sendbuf->elem_count,
+                             sc_MPI_INT, peer, SC_TAG_RANGES_SPARSE,
+                             mpicomm, &outrequest);
+      SC_CHECK_MPI (mpiret);
+    }
+    for (source = (peer >= start ? peer : -1); source >= 0;
+         source = (source == peer ? peer2 : -1)) {
+      /* receive from the peer and possibly from a second one */
+      mpiret = sc_MPI_Probe (source, SC_TAG_RANGES_SPARSE, mpicomm,
+                             &instatus);
+      SC_CHECK_MPI (mpiret);
+      mpiret = sc_MPI_Get_count (&instatus, sc_MPI_INT, &count);
+      SC_CHECK_MPI (mpiret);
+      SC_ASSERT (count % 3 == 0);
+      pout = (int *) sc_array_push_count (keep, (size_t) count);
+      mpiret = sc_MPI_Recv (pout, count, sc_MPI_INT, source,
+                            SC_TAG_RANGES_SPARSE, mpicomm,
+                            sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+    if (peer >= 0) {
+      mpiret = sc_MPI_Wait (&outrequest, sc_MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+
+    swap = pieces;
+    pieces = keep;
+    keep = swap;
+  }
+
+  /* every remaining set consists of this rank only */
+  sc_array_truncate (senders);
+  for (zz = 0; zz < pieces->elem_count; zz += 3) {
+    pint = (int *) sc_array_index (pieces, zz);
+    SC_ASSERT (pint[1] == rank && pint[2] == rank);
+    if (pint[0] != rank) {
+      *(int *) sc_array_push (senders) = pint[0];
+    }
+  }
+  sc_array_sort (senders, sc_ranges_compare);
+
+  sc_array_destroy (pieces);
+  sc_array_destroy (keep);
+  sc_array_destroy (sendbuf);
+}
+
+int
+sc_ranges_adaptive_sparse (int package_id, sc_MPI_Comm mpicomm,
+                           const int *receivers, int num_receivers,
+                           int *max_peers, int *max_ranges,
+                           int num_ranges, int *ranges, sc_array_t * senders)
+{
+  int                 mpiret;
+  int                 i, num_procs, rank;
+  int                 local[2], global[2];
+  int                 nwin;
+  int                *pint;
+  sc_array_t         *pieces;
+
+  /* get processor related information */
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* count peers and compute the local ranges */
+  local[0] = num_receivers;
+  for (i = 0; i < num_receivers; ++i) {
+    if (receivers[i] >= rank) {
+      local[0] -= (receivers[i] == rank);
+      break;
+    }
+  }
+  local[1] = nwin =
+    sc_ranges_compute_sparse (package_id, num_procs, receivers,
+                              num_receivers, rank, num_ranges, ranges);
+
+  /* communicate the maximum number of peers and ranges */
+  mpiret =
+    sc_MPI_Allreduce (local, global, 2, sc_MPI_INT, sc_MPI_MAX, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  *max_peers = global[0];
+  *max_ranges = global[1];
+  SC_ASSERT (nwin <= *max_ranges && *max_ranges <= num_ranges);
+
+  /* route our ranges to the processes they cover instead of gathering */
+  if (senders != NULL) {
+    SC_ASSERT (senders->elem_size == sizeof (int));
+    pieces = sc_array_new_count (sizeof (int), 3 * (size_t) nwin);
+    for (i = 0; i < nwin; ++i) {
+      pint = (int *) sc_array_index_int (pieces, 3 * i);
+      pint[0] = rank;
+      pint[1] = ranges[2 * i];
+      pint[2] = ranges[2 * i + 1];
+    }
+    sc_ranges_notify (mpicomm, num_procs, rank, pieces, senders);
+  }
+
+  return nwin;
+}
+
 void
 sc_ranges_decode (int num_procs, int rank,
                   int max_ranges, const int *global_ranges,
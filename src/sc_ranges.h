@@ -24,7 +24,7 @@
 #ifndef SC_RANGES_H
 #define SC_RANGES_H
 
-#include <sc.h>
+#include <sc_containers.h>
 
 SC_EXTERN_C_BEGIN;
 
@@ -50,6 +50,29 @@ int                 sc_ranges_compute (int package_id, int num_procs,
                                        int first_peer, int last_peer,
                                        int num_ranges, int *ranges);
 
+/** Compute the optimal ranges of processors from a list of receivers.
+ * The result is identical to \ref sc_ranges_compute called with the
+ * corresponding boolean array and the first and last peer.  The time
+ * is linear in the number of receivers and does not depend on the
+ * number of processors.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] num_procs    Number of processors processed.
+ * \param [in] receivers    Array [num_receivers] of ranks to talk to,
+ *                          sorted ascending and unique.
+ *                          If rank is contained it is ignored.
+ * \param [in] num_receivers    Number of entries in receivers.
+ * \param [in] rank         The id of the calling process.
+ *                          Will be excluded from the ranges.
+ * \param [in] num_ranges   The maximum number of ranges to fill.
+ * \param [in,out] ranges   Array [2 * num_ranges] as in sc_ranges_compute.
+ * \return                  Returns the number of filled ranges.
+ */
+int                 sc_ranges_compute_sparse (int package_id, int num_procs,
+                                              const int *receivers,
+                                              int num_receivers, int rank,
+                                              int num_ranges, int *ranges);
+
 /** Compute the globally optimal ranges of processors.
  *
  * \param [in] package_id   Registered package id or -1.
@@ -77,6 +100,38 @@ int                 sc_ranges_adaptive (int package_id, sc_MPI_Comm mpicomm,
                                         int num_ranges, int *ranges,
                                         int **global_ranges);
 
+/** Compute the globally optimal ranges from a list of receivers.
+ * This function does not allocate or gather arrays of size num_procs.
+ * Instead of everybody's ranges, it optionally returns the processes
+ * whose ranges contain the calling process, which are the senders
+ * computed by \ref sc_ranges_decode.  They are found by routing the local
+ * ranges through a recursive doubling of the processes, splitting each
+ * range by rank bits on the way.  Ranges covering many processes are not
+ * expanded, such that the cost is logarithmic in the number of processes
+ * per range and linear in the number of senders.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] mpicomm      MPI Communicator for Allreduce and notify.
+ * \param [in] receivers    Same as in sc_ranges_compute_sparse ().
+ * \param [in] num_receivers    Same as in sc_ranges_compute_sparse ().
+ * \param [out] max_peers   Global maximum of peer counts.
+ * \param [out] max_ranges  Global maximum number of ranges.
+ * \param [in] num_ranges   The maximum number of ranges to fill.
+ * \param [in,out] ranges   Array [2 * num_ranges] that will be filled
+ *                          as in sc_ranges_adaptive ().
+ * \param [in,out] senders  If not NULL, array of type int resized to the
+ *                          sorted ranks whose ranges include this rank.
+ * \return                  Returns the number of locally filled ranges.
+ */
+int                 sc_ranges_adaptive_sparse (int package_id,
+                                               sc_MPI_Comm mpicomm,
+                                               const int *receivers,
+                                               int num_receivers,
+                                               int *max_peers,
+                                               int *max_ranges,
+                                               int num_ranges, int *ranges,
+                                               sc_array_t * senders);
+
 /** Determine an array of receivers and an array of senders from ranges.
  * This function is intended for compatibility and debugging only.
  * In particular, sc_ranges_adaptive may include non-receiving processors.
@@ -23,6 +23,13 @@
 
 #include <sc_scda.h>
 #include <sc_io.h>
+#if defined (SC_HAVE_FCNTL_H) && defined (SC_HAVE_UNISTD_H)
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef POSIX_FADV_WILLNEED
+#define SC_SCDA_HAVE_FADVISE
+#endif
+#endif
 
 /* file section header data */
 #define SC_SCDA_MAGIC "scdata0" /**< magic encoding format identifier and version */
@@ -50,6 +57,18 @@
 #define SC_SCDA_PADDING_MOD_MAX (6 + SC_SCDA_PADDING_MOD) /**< maximal count of
                                                               mod padding bytes */
 #define SC_SCDA_HEADER_ROOT 0 /**< root rank for header I/O operations */
+#define SC_SCDA_INDEX_USER_STRING "scda section index" /**< user string of the
+                                                           block section that
+                                                           lists all sections */
+#define SC_SCDA_INDEX_LOCATOR "scda section index locator" /**< user string
+                                                           of the inline section
+                                                           that ends the file */
+#define SC_SCDA_INDEX_ENTRY_BYTES (SC_SCDA_COMMON_FIELD + \
+                                   3 * SC_SCDA_COUNT_FIELD) /**< byte count of
+                                                           a section index
+                                                           entry */
+#define SC_SCDA_COLL_CHECKSUM_BYTES 64 /**< parameters of more bytes are
+                                            compared by their checksum */
 
 /** get a random double in the range [A,B) */
 #define SC_SCDA_RAND_RANGE(A, B, state) ((A) + sc_rand (state) * ((B) - (A)))
@@ -104,7 +123,7 @@
                                                                 user_msg);   \
                                     if (!sc_scda_ferror_is_success (*errcode)) {\
                                     sc_scda_file_error_cleanup (&fc->file);  \
-                                    SC_FREE (fc);                            \
+                                    sc_scda_fcontext_free (fc);              \
                                     return NULL;}} while (0)
 
 /* This macro is suitable to be called after a non-collective operation.
@@ -136,7 +155,7 @@
                                     sc_scda_fuzzy_sync_state (fc);             \
                                     if (!sc_scda_ferror_is_success (*errcode)) {\
                                     sc_scda_file_error_cleanup (&fc->file);    \
-                                    SC_FREE (fc);                              \
+                                    sc_scda_fcontext_free (fc);                \
                                     return NULL;}} while (0)
 
 /** Check for a count error of a collective I/O operation.
@@ -174,7 +193,7 @@
                                                 "collective I/O at %s:%d.\n",\
                                                 __FILE__, __LINE__);         \
                                     sc_scda_file_error_cleanup (&fc->file);  \
-                                    SC_FREE (fc);                            \
+                                    sc_scda_fcontext_free (fc);              \
                                     return NULL;                             \
                                     }} while (0)                             \
 
@@ -223,7 +242,7 @@
                                                     "Read/write count check"); \
                                     if (*cerror) {                             \
                                     sc_scda_file_error_cleanup (&fc->file);    \
-                                    SC_FREE (fc);                              \
+                                    sc_scda_fcontext_free (fc);                \
                                     return NULL;}} while (0)
 
 /** The opaque file context for for scda files. */
@@ -264,9 +283,48 @@ struct sc_scda_fcontext
   int                 log_level;      /**< The log level for the scda functions.
                                         The possible values are documented in
                                         \ref sc.h; cf. SC_LP_* macros. */
+  sc_array_t         *sections;       /**< If not NULL, the index of all file
+                                        section headers; cf. \ref
+                                        sc_scda_section_t. For a file opened
+                                        for reading it is built on opening and
+                                        for a file opened for writing with \b
+                                        index_footer true it records the
+                                        written sections. The index is equal on
+                                        all ranks. */
+  sc_MPI_Offset       sections_end;   /**< If \b sections is not NULL, the byte
+                                        offset after the last indexed file
+                                        section. */
+  int                 prefetch_fd;    /**< A read-only file descriptor that is
+                                        used to announce the upcoming reads of
+                                        an indexed file to the operating system
+                                        or -1. */
+  size_t              prefetch_count; /**< Global element count of the last
+                                        read array section. */
+  size_t              prefetch_first; /**< First local element of the partition
+                                        of the last read array section. */
+  size_t              prefetch_local; /**< Local element count of the partition
+                                        of the last read array section. */
+  int                 index_footer;   /**< True if the written file sections
+                                        are recorded in \b sections to append
+                                        the section index on closing. */
   /* *INDENT-ON* */
 };
 
+/** An entry of the file section index of a file opened for reading. */
+typedef struct sc_scda_section
+{
+  sc_MPI_Offset       offset;   /**< byte offset of the section header */
+  size_t              elem_count;       /**< as read by \ref
+                                             sc_scda_fread_section_header */
+  size_t              elem_size;        /**< as read by \ref
+                                             sc_scda_fread_section_header */
+  size_t              len;      /**< byte count of \b user_string */
+  char                type;     /**< file section type */
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1]; /**< user
+                                                                       string */
+}
+sc_scda_section_t;
+
 /** Copy \b src to \b dest.
  * \b dest must have at least \b n bytes.
  */
@@ -700,6 +758,8 @@ sc_scda_check_coll_params (sc_scda_fcontext_t *fc, const char *param1,
   int                 mismatch, collective_mismatch;
   char               *buffer, *recv_buf = NULL;
   size_t              len;
+  uint64_t            len64;
+  uint32_t            crc;
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (param1 != NULL);
@@ -714,12 +774,18 @@ sc_scda_check_coll_params (sc_scda_fcontext_t *fc, const char *param1,
   /* get buffer with parameter data */
   sc_scda_merge_data_to_buf (param1, len1, param2, len2, param3, len3, buffer);
 
+  /* large data is compared by its length and checksum */
+  if (len > SC_SCDA_COLL_CHECKSUM_BYTES) {
+    len64 = (uint64_t) len;
+    crc = sc_io_crc32c (0, buffer, len);
+    memcpy (buffer, &len64, sizeof (uint64_t));
+    memcpy (buffer + sizeof (uint64_t), &crc, sizeof (uint32_t));
+    len = sizeof (uint64_t) + sizeof (uint32_t);
+  }
+
   /* For the sake of simplicity, we use a Bcast followed by an Allreduce
   * instead of one Allreduce call with a custom reduction function.
   */
-  /* In the future we may want to use a checksum on the buffer data if the data
-  * is large.
-  */
   if (fc->mpirank == 0) {
     mpiret = sc_MPI_Bcast (buffer, (int) len, sc_MPI_BYTE, 0, fc->mpicomm);
   }
@@ -754,8 +820,9 @@ sc_scda_check_coll_params (sc_scda_fcontext_t *fc, const char *param1,
  * This function is for creating and reading a file.
  * The passed \b fc must have filled MPI information (cf. \ref
  * sc_scda_fill_mpi_data).
- * The function returns \ref SC_SCDA_FERR_ARG if everyn and/or seed in params
- * are not collective. Otherwise, the function returns \ref SC_SCDA_FERR_SUCCESS.
+ * The function returns \ref SC_SCDA_FERR_ARG if everyn, seed, log_level,
+ * build_index and/or write_index in params are not collective. Otherwise, the
+ * function returns \ref SC_SCDA_FERR_SUCCESS.
  */
 static sc_scda_ret_t
 sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
@@ -765,13 +832,19 @@ sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
 
   if (params != NULL) {
     sc_scda_ret_t       ret;
+    int                 flags[3];
 
-    /* check if fuzzy_everyn and fuzzy_seed are collective */
+    /* the index flags decide about collective calls */
+    flags[0] = params->log_level;
+    flags[1] = params->build_index != 0;
+    flags[2] = params->write_index != 0;
+
+    /* check if the fuzzy parameters, log level and flags are collective */
     ret = sc_scda_check_coll_params (fc, (const char *) &params->fuzzy_everyn,
                                      sizeof (unsigned),
                                      (const char *) &params->fuzzy_seed,
                                      sizeof (sc_rand_state_t),
-                                     (const char *) &params->log_level, sizeof (int));
+                                     (const char *) flags, sizeof (flags));
     SC_ASSERT (ret == SC_SCDA_FERR_SUCCESS || ret == SC_SCDA_FERR_ARG);
 
     if (ret == SC_SCDA_FERR_ARG) {
@@ -1198,6 +1271,26 @@ sc_scda_file_error_cleanup (sc_MPI_File * file)
   return -1;
 }
 
+/** Free a file context including the file section index.
+ * The file must already be closed.
+ * \param [in,out] fc      The file context that is freed.
+ */
+static void
+sc_scda_fcontext_free (sc_scda_fcontext_t *fc)
+{
+  SC_ASSERT (fc != NULL);
+
+  if (fc->sections != NULL) {
+    sc_array_destroy (fc->sections);
+  }
+#ifdef SC_SCDA_HAVE_FADVISE
+  if (fc->prefetch_fd >= 0) {
+    close (fc->prefetch_fd);
+  }
+#endif
+  SC_FREE (fc);
+}
+
 void
 sc_scda_params_init (sc_scda_params_t *params)
 {
@@ -1212,6 +1305,8 @@ sc_scda_params_init (sc_scda_params_t *params)
 #else
   params->log_level = SC_LP_SILENT;
 #endif
+  params->build_index = 0;
+  params->write_index = 0;
 }
 
 /** This function peforms the start up for both scda fopen functions.
@@ -1240,6 +1335,11 @@ sc_scda_fopen_start_up (sc_scda_params_t *params, sc_MPI_Comm mpicomm,
 
   /* allocate the file context */
   fc = SC_ALLOC (sc_scda_fcontext_t, 1);
+  fc->sections = NULL;
+  fc->sections_end = 0;
+  fc->prefetch_fd = -1;
+  fc->prefetch_count = fc->prefetch_first = fc->prefetch_local = 0;
+  fc->index_footer = 0;
 
   /* fill convenience MPI information */
   sc_scda_fill_mpi_data (fc, mpicomm);
@@ -1496,6 +1596,12 @@ sc_scda_fopen_write (sc_MPI_Comm mpicomm,
   fc->header_before = 0;
   fc->last_type = '\0';
 
+  if (params != NULL && params->write_index) {
+    /* record the file sections to append the section index on closing */
+    fc->sections = sc_array_new (sizeof (sc_scda_section_t));
+    fc->index_footer = 1;
+  }
+
   return fc;
 }
 
@@ -1595,12 +1701,49 @@ sc_scda_fwrite_inline_data_serial (sc_scda_fcontext_t *fc,
                                    count_err);
 }
 
+/** Record a written file section for the section index.
+ *
+ * The function does nothing unless the section index was requested by
+ * \b write_index in \ref sc_scda_params on opening the file.
+ * It must be called after the file section header was written successfully.
+ *
+ * \param [in,out] fc       The file context of a file opened for writing.
+ * \param [in] offset       The byte offset of the file section header.
+ * \param [in] type         The file section type.
+ * \param [in] user_string  The validated user string of the file section.
+ * \param [in] len          As passed to the writing function.
+ * \param [in] elem_count   The global element count of the file section.
+ * \param [in] elem_size    The element size of the file section.
+ */
+static void
+sc_scda_record_section (sc_scda_fcontext_t *fc, sc_MPI_Offset offset,
+                        char type, const char *user_string, size_t *len,
+                        size_t elem_count, size_t elem_size)
+{
+  sc_scda_section_t  *section;
+
+  if (!fc->index_footer) {
+    return;
+  }
+
+  section = (sc_scda_section_t *) sc_array_push (fc->sections);
+  section->offset = offset;
+  section->type = type;
+  SC_EXECUTE_ASSERT_FALSE (sc_scda_get_user_string_len
+                           (user_string, len, &section->len));
+  sc_scda_init_nul (section->user_string, SC_SCDA_USER_STRING_BYTES + 1);
+  sc_scda_copy_bytes (section->user_string, user_string, section->len);
+  section->elem_count = elem_count;
+  section->elem_size = elem_size;
+}
+
 sc_scda_fcontext_t *
 sc_scda_fwrite_inline (sc_scda_fcontext_t *fc, const char *user_string,
                        size_t *len, sc_array_t * inline_data, int root,
                        sc_scda_ferror_t * errcode)
 {
   int                 count_err;
+  sc_MPI_Offset       section_offset;
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (user_string != NULL);
@@ -1609,6 +1752,9 @@ sc_scda_fwrite_inline (sc_scda_fcontext_t *fc, const char *user_string,
   SC_ASSERT (fc->mpirank != root || inline_data != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* the file section begins at the current position */
+  section_offset = fc->accessed_bytes;
+
   /* The file header section is always written and read on rank 0. */
   if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
     sc_scda_fwrite_inline_header_serial (fc, user_string, len, &count_err,
@@ -1631,6 +1777,8 @@ sc_scda_fwrite_inline (sc_scda_fcontext_t *fc, const char *user_string,
 
   fc->accessed_bytes += SC_SCDA_INLINE_FIELD;
 
+  sc_scda_record_section (fc, section_offset, 'I', user_string, len, 0, 0);
+
   return fc;
 }
 
@@ -1854,6 +2002,7 @@ sc_scda_fwrite_block (sc_scda_fcontext_t *fc, const char *user_string,
 {
   int                 count_err;
   sc_scda_ret_t       ret;
+  sc_MPI_Offset       section_offset;
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (user_string != NULL);
@@ -1862,6 +2011,9 @@ sc_scda_fwrite_block (sc_scda_fcontext_t *fc, const char *user_string,
   SC_ASSERT (fc->mpirank != root || block_data != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* the file section begins at the current position */
+  section_offset = fc->accessed_bytes;
+
   /* check if block_size is collective */
   ret = sc_scda_check_coll_params (fc, (const char*) &block_size,
                                    sizeof (size_t), NULL, 0, NULL, 0);
@@ -1909,6 +2061,9 @@ sc_scda_fwrite_block (sc_scda_fcontext_t *fc, const char *user_string,
   /* get number of padding bytes to update internal file pointer */
   fc->accessed_bytes += (sc_MPI_Offset) sc_scda_pad_to_mod_len (block_size);
 
+  sc_scda_record_section (fc, section_offset, 'B', user_string, len, 0,
+                          block_size);
+
   return fc;
 }
 
@@ -2128,14 +2283,16 @@ sc_scda_check_array_params (sc_scda_fcontext_t *fc, sc_array_t *array_data,
   }
 
   /* compute the global element count */
-  /* TODO: Use a checksum for the colletivness test? */
   for (si = 0; si < elem_counts->elem_count; ++si) {
     *elem_count += *((size_t *) sc_array_index (elem_counts, si));
   }
 
-  /* check if elem_count, elem_size and indirect are collective */
-  ret = sc_scda_check_coll_params (fc, (const char *) elem_count,
-                                   sizeof (size_t), (const char *) &elem_size,
+  /* check if elem_counts, elem_size and indirect are collective;
+     for many processes the elem_counts are compared by their checksum */
+  ret = sc_scda_check_coll_params (fc, elem_counts->array,
+                                   elem_counts->elem_count *
+                                   sizeof (sc_scda_ulong),
+                                   (const char *) &elem_size,
                                    sizeof (size_t), (const char *) &indirect,
                                    sizeof (int));
   if (ret != SC_SCDA_FERR_SUCCESS) {
@@ -2340,6 +2497,7 @@ sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
   size_t              collective_byte_count;
   size_t              num_pad_bytes;
   sc_MPI_Offset       offset;
+  sc_MPI_Offset       section_offset;
 #ifndef SC_ENABLE_MPI
   sc_array_t          contig_arr;
 #else
@@ -2354,6 +2512,9 @@ sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
   SC_ASSERT (elem_counts != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* the file section begins at the current position */
+  section_offset = fc->accessed_bytes;
+
   /* TODO: respect encode parameter */
 
   /* check function parameters */
@@ -2472,6 +2633,9 @@ sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
   num_pad_bytes = sc_scda_pad_to_mod_len (collective_byte_count);
   fc->accessed_bytes += (sc_MPI_Offset) num_pad_bytes;
 
+  sc_scda_record_section (fc, section_offset, 'A', user_string, len,
+                          elem_count, elem_size);
+
   return fc;
 }
 
@@ -2603,6 +2767,574 @@ sc_scda_fopen_read_header_serial (sc_scda_fcontext_t * fc,
   SC_SCDA_CHECK_NONCOLL_ERR (fc->log_level, errcode, "Invalid file header");
 }
 
+/** Internal function to check a count entry in a section header.
+ *
+ * This function checks if the count entry is conforming to the scda format.
+ *
+ * \param [in] count_entry  A pointer to a count entry that was read from file.
+ *                          The count entry has exactly \ref SC_SCDA_COUNT_FIELD
+ *                          bytes.
+ * \param [in] expc_ident   The expected count entry identifier. If the read
+ *                          identifier is not as expected the function returns
+ *                          true. Note that the function also returns true if
+ *                          the count entry identifier coincides with
+ *                          \b expc_ident but is not in the list of supported
+ *                          count identifiers (currently 'E', 'N' and 'O'
+ *                          for offsets in the section index).
+ * \param [out] count_var   The count variable read from the count entry.
+ * \return                  False if the count entry is valid and has the
+ *                          expected identifier. True, otherwise.
+ */
+static int
+sc_scda_check_count_entry (const char *count_entry, char expc_ident,
+                           size_t *count_var)
+{
+  char                var_str[SC_SCDA_COUNT_MAX_DIGITS + 1];
+  char                ident;
+  int                 wrong_format, wrong_ident;
+  long long unsigned  read_count;
+  size_t              len = 0;
+
+  SC_ASSERT (count_var != NULL);
+
+  *count_var = 0;
+
+  wrong_format = 0;
+  /* check and get the count variable identifier */
+  switch (count_entry[0])
+  {
+  case 'E':
+    ident = 'E';
+    break;
+  case 'N':
+    ident = 'N';
+    break;
+  case 'O':
+    /* only used in the section index */
+    ident = 'O';
+    break;
+  default:
+    /* invalid/unsupported count identifier */
+    wrong_format = 1;
+    break;
+  }
+  if (wrong_format) {
+    /* invalid count identifier */
+    return -1;
+  }
+
+  /* compare read count identifier to the expected count identifier  */
+  wrong_ident = (ident != expc_ident);
+  if (wrong_ident) {
+    /* Wrong count identifier in count entry */
+    return -1;
+  }
+
+  /* check count entry format */
+  if (count_entry[1] != ' ') {
+    /* wrong format */
+    wrong_format = 1;
+  }
+  if (wrong_format) {
+    /* Missing space in count entry */
+    return -1;
+  }
+
+  /* check padding and extract count variable string */
+  sc_scda_init_nul (var_str, SC_SCDA_COUNT_MAX_DIGITS + 1);
+  if (sc_scda_get_pad_to_fix_len (&count_entry[2], SC_SCDA_COUNT_ENTRY, var_str,
+                                  &len)) {
+    wrong_format = 1;
+  }
+  if (wrong_format) {
+    /* Invalid count variable padding */
+    return -1;
+  }
+
+  /* If the padding to the length \ref SC_SCDA_COUNT_ENTRY was valid this
+   * assertion must hold.
+   */
+  SC_ASSERT (len <= SC_SCDA_COUNT_MAX_DIGITS);
+
+  /* get count variable value */
+  /* The initialization above guarantees that var_str is nul-terminated. */
+  if (len == 0 || sscanf (var_str, "%llu", &read_count) != 1) {
+    /* conversion failed or is not possible */
+    wrong_format = 1;
+  }
+  if (wrong_format) {
+    /* Extraction of count value failed */
+    return -1;
+  }
+
+  *count_var = (size_t) read_count;
+
+  return 0;
+}
+
+/** Get the byte count of a file section header.
+ *
+ * \param [in] type         A valid file section type.
+ * \return                  The number of header bytes of a file section of
+ *                          the type \b type.
+ */
+static size_t
+sc_scda_section_header_bytes (char type)
+{
+  size_t              header_bytes;
+
+  header_bytes = SC_SCDA_COMMON_FIELD;
+  switch (type) {
+  case 'I':
+    break;
+  case 'B':
+    header_bytes += SC_SCDA_COUNT_FIELD;
+    break;
+  case 'A':
+    header_bytes += 2 * SC_SCDA_COUNT_FIELD;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+
+  return header_bytes;
+}
+
+/** Get the byte count of a file section including its header and padding.
+ *
+ * \param [in]  section     A file section with a valid type and counts.
+ *                          The counts of 'I' sections and the element count
+ *                          of 'B' sections must be zero.
+ * \param [out] section_bytes On success the byte count of the file section.
+ * \return                  0 on success and -1 if the counts are invalid
+ *                          for the type or the byte count overflows.
+ */
+static int
+sc_scda_section_bytes (const sc_scda_section_t *section,
+                       size_t *section_bytes)
+{
+  size_t              data_bytes;
+
+  switch (section->type) {
+  case 'I':
+    if (section->elem_count != 0 || section->elem_size != 0) {
+      return -1;
+    }
+    data_bytes = SC_SCDA_INLINE_FIELD;
+    break;
+  case 'B':
+    if (section->elem_count != 0) {
+      return -1;
+    }
+    data_bytes = section->elem_size;
+    break;
+  case 'A':
+    if (section->elem_size > 0 &&
+        section->elem_count > SIZE_MAX / section->elem_size) {
+      return -1;
+    }
+    data_bytes = section->elem_count * section->elem_size;
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+  if (section->type != 'I') {
+    /* block and array data are padded */
+    if (data_bytes > SIZE_MAX - SC_SCDA_PADDING_MOD_MAX -
+        sc_scda_section_header_bytes (section->type)) {
+      return -1;
+    }
+    data_bytes += sc_scda_pad_to_mod_len (data_bytes);
+  }
+
+  *section_bytes = sc_scda_section_header_bytes (section->type) + data_bytes;
+  return 0;
+}
+
+/** Parse the common part of a file section header for the section index.
+ *
+ * \param [in]  common      \ref SC_SCDA_COMMON_FIELD bytes.
+ * \param [out] section     On success the type, the user string and its
+ *                          length are set.
+ * \return                  0 for a valid common part and -1 otherwise.
+ */
+static int
+sc_scda_parse_common_field (const char *common, sc_scda_section_t *section)
+{
+  if (common[1] != ' ' ||
+      (common[0] != 'I' && common[0] != 'B' && common[0] != 'A')) {
+    return -1;
+  }
+  section->type = common[0];
+
+  sc_scda_init_nul (section->user_string, SC_SCDA_USER_STRING_BYTES + 1);
+  return sc_scda_get_pad_to_fix_len (&common[2], SC_SCDA_USER_STRING_FIELD,
+                                     section->user_string, &section->len)
+    ? -1 : 0;
+}
+
+/** Parse a file section header that is read for the file section index.
+ *
+ * This function checks the same format conditions as \ref
+ * sc_scda_fread_section_header but does not output errors since an invalid
+ * file section header just ends the index.
+ *
+ * \param [in]  header      The file section header data.
+ * \param [in]  count       The number of available bytes in \b header.
+ * \param [out] section     On success filled with the file section type, the
+ *                          user string and the counts. The offset is not set.
+ * \param [out] section_bytes On success the byte count of the file section
+ *                          including its header and padding.
+ * \return                  0 for a valid file section header and -1 otherwise.
+ */
+static int
+sc_scda_parse_section_header (const char *header, int count,
+                              sc_scda_section_t *section,
+                              size_t *section_bytes)
+{
+  size_t              header_bytes;
+
+  if (count < SC_SCDA_COMMON_FIELD ||
+      sc_scda_parse_common_field (header, section)) {
+    return -1;
+  }
+  header_bytes = sc_scda_section_header_bytes (section->type);
+  if ((size_t) count < header_bytes) {
+    return -1;
+  }
+
+  section->elem_count = section->elem_size = 0;
+  switch (section->type) {
+  case 'I':
+    break;
+  case 'B':
+    if (sc_scda_check_count_entry (&header[SC_SCDA_COMMON_FIELD], 'E',
+                                   &section->elem_size)) {
+      return -1;
+    }
+    break;
+  case 'A':
+    if (sc_scda_check_count_entry (&header[SC_SCDA_COMMON_FIELD], 'N',
+                                   &section->elem_count) ||
+        sc_scda_check_count_entry (&header[SC_SCDA_COMMON_FIELD +
+                                           SC_SCDA_COUNT_FIELD], 'E',
+                                   &section->elem_size)) {
+      return -1;
+    }
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+
+  return sc_scda_section_bytes (section, section_bytes);
+}
+
+/** Scan all file section headers of a file opened for reading.
+ *
+ * This function is only valid to be called in serial.
+ * The scan starts after the file header and ends at the end of the file or at
+ * the first file section header that does not conform to the scda format.
+ * Such a header is reported as usual by \ref sc_scda_fread_section_header
+ * when it is reached.
+ * The data of the file sections is not read and not checked.
+ *
+ * \param [in]  fc          The file context as in \ref sc_scda_fopen_read
+ *                          after reading the file header.
+ * \param [out] sections    An array of \ref sc_scda_section_t that is
+ *                          filled with the indexed file sections.
+ * \return                  The byte offset after the last indexed section.
+ */
+static sc_MPI_Offset
+sc_scda_scan_sections_serial (sc_scda_fcontext_t *fc, sc_array_t *sections)
+{
+  char                header[SC_SCDA_COMMON_FIELD + 2 * SC_SCDA_COUNT_FIELD];
+  int                 mpiret;
+  int                 count;
+  size_t              section_bytes;
+  sc_MPI_Offset       offset;
+  sc_scda_section_t   section;
+
+  offset = SC_SCDA_HEADER_BYTES;
+  for (;;) {
+    /* read the longest possible section header at once */
+    mpiret = sc_io_read_at (fc->file, offset, header, sizeof (header),
+                            sc_MPI_BYTE, &count);
+    if (mpiret != sc_MPI_SUCCESS ||
+        sc_scda_parse_section_header (header, count, &section,
+                                      &section_bytes)) {
+      break;
+    }
+    section.offset = offset;
+    *(sc_scda_section_t *) sc_array_push (sections) = section;
+    offset += (sc_MPI_Offset) section_bytes;
+  }
+
+  return offset;
+}
+
+/** Get the size of a file opened for reading.
+ *
+ * This function is only valid to be called in serial.
+ *
+ * \param [in]  fc          A file context of a file opened for reading.
+ * \param [out] size        On success the byte count of the file.
+ * \return                  0 on success and -1 otherwise.
+ */
+static int
+sc_scda_file_size_serial (sc_scda_fcontext_t *fc, sc_MPI_Offset *size)
+{
+#ifdef SC_ENABLE_MPIIO
+  return MPI_File_get_size (fc->file, size) == MPI_SUCCESS ? 0 : -1;
+#else
+  long                pos, end;
+
+  /* the file position is restored as by sc_io_read_at */
+  pos = ftell (fc->file->file);
+  if (pos == -1 || fseek (fc->file->file, 0, SEEK_END)) {
+    return -1;
+  }
+  end = ftell (fc->file->file);
+  if (fseek (fc->file->file, pos, SEEK_SET) || end == -1) {
+    return -1;
+  }
+  *size = (sc_MPI_Offset) end;
+  return 0;
+#endif
+}
+
+/** Read the section index that is appended by \ref sc_scda_fclose.
+ *
+ * This function is only valid to be called in serial.
+ * Cf. \ref sc_scda_fwrite_index_footer for the format of the section index.
+ * The index is only used if it is consistent with the end of the file and
+ * its entries describe file sections that follow each other without gaps
+ * from the file header up to the index, with byte counts computed as in
+ * \ref sc_scda_parse_section_header.
+ *
+ * \param [in]  fc          The file context as in \ref sc_scda_fopen_read
+ *                          after reading the file header.
+ * \param [out] sections    An array of \ref sc_scda_section_t that is
+ *                          filled with the indexed file sections. It may
+ *                          contain partial data if the function fails.
+ * \param [out] sections_end On success the byte offset of the index, which
+ *                          is the end of the indexed file sections.
+ * \return                  0 if the file ends with a valid section index
+ *                          and -1 otherwise.
+ */
+static int
+sc_scda_read_index_footer_serial (sc_scda_fcontext_t *fc,
+                                  sc_array_t *sections,
+                                  sc_MPI_Offset *sections_end)
+{
+  const sc_MPI_Offset locator_bytes =
+    SC_SCDA_COMMON_FIELD + SC_SCDA_INLINE_FIELD;
+  char                header[SC_SCDA_COMMON_FIELD + SC_SCDA_INLINE_FIELD];
+  char               *entry;
+  int                 mpiret;
+  int                 count;
+  int                 valid;
+  size_t              zz, num_sections, section_bytes;
+  size_t              index_offset, section_offset, end_offset;
+  sc_MPI_Offset       size;
+  sc_array_t          block;
+  sc_scda_section_t   section;
+  sc_scda_section_t  *indexed;
+
+  /* read and check the locator section at the end of the file */
+  if (sc_scda_file_size_serial (fc, &size) ||
+      size < SC_SCDA_HEADER_BYTES + locator_bytes) {
+    return -1;
+  }
+  mpiret = sc_io_read_at (fc->file, size - locator_bytes, header,
+                          (int) locator_bytes, sc_MPI_BYTE, &count);
+  if (mpiret != sc_MPI_SUCCESS || count != (int) locator_bytes ||
+      sc_scda_parse_section_header (header, count, &section, &section_bytes)
+      || section.type != 'I' || strcmp (section.user_string,
+                                        SC_SCDA_INDEX_LOCATOR) ||
+      sc_scda_check_count_entry (&header[SC_SCDA_COMMON_FIELD], 'O',
+                                 &index_offset)) {
+    return -1;
+  }
+
+  /* read and check the header of the index block section */
+  if (index_offset < SC_SCDA_HEADER_BYTES ||
+      (sc_MPI_Offset) index_offset >= size - locator_bytes) {
+    return -1;
+  }
+  mpiret = sc_io_read_at (fc->file, (sc_MPI_Offset) index_offset, header,
+                          SC_SCDA_COMMON_FIELD + SC_SCDA_COUNT_FIELD,
+                          sc_MPI_BYTE, &count);
+  if (mpiret != sc_MPI_SUCCESS ||
+      sc_scda_parse_section_header (header, count, &section, &section_bytes)
+      || section.type != 'B' || strcmp (section.user_string,
+                                        SC_SCDA_INDEX_USER_STRING) ||
+      (sc_MPI_Offset) (index_offset + section_bytes) != size - locator_bytes ||
+      section.elem_size % SC_SCDA_INDEX_ENTRY_BYTES != 0 ||
+      section.elem_size > (size_t) INT_MAX) {
+    return -1;
+  }
+
+  /* read the index entries at once */
+  num_sections = section.elem_size / SC_SCDA_INDEX_ENTRY_BYTES;
+  sc_array_init_size (&block, SC_SCDA_INDEX_ENTRY_BYTES, num_sections);
+  mpiret = sc_io_read_at (fc->file, (sc_MPI_Offset) index_offset +
+                          SC_SCDA_COMMON_FIELD + SC_SCDA_COUNT_FIELD,
+                          block.array, (int) section.elem_size, sc_MPI_BYTE,
+                          &count);
+  if (mpiret != sc_MPI_SUCCESS || count != (int) section.elem_size) {
+    sc_array_reset (&block);
+    return -1;
+  }
+
+  /* the sections must follow each other up to the index */
+  valid = 1;
+  end_offset = SC_SCDA_HEADER_BYTES;
+  for (zz = 0; valid && zz < num_sections; ++zz) {
+    entry = (char *) sc_array_index (&block, zz);
+    indexed = (sc_scda_section_t *) sc_array_push (sections);
+    valid = !sc_scda_parse_common_field (entry, indexed) &&
+      !sc_scda_check_count_entry (&entry[SC_SCDA_COMMON_FIELD], 'O',
+                                  &section_offset) &&
+      !sc_scda_check_count_entry (&entry[SC_SCDA_COMMON_FIELD +
+                                         SC_SCDA_COUNT_FIELD], 'N',
+                                  &indexed->elem_count) &&
+      !sc_scda_check_count_entry (&entry[SC_SCDA_COMMON_FIELD +
+                                         2 * SC_SCDA_COUNT_FIELD], 'E',
+                                  &indexed->elem_size) &&
+      section_offset == end_offset &&
+      !sc_scda_section_bytes (indexed, &section_bytes) &&
+      section_bytes <= index_offset - end_offset;
+    if (valid) {
+      /* the counts are only set for a valid entry */
+      indexed->offset = (sc_MPI_Offset) section_offset;
+      end_offset += section_bytes;
+    }
+  }
+  sc_array_reset (&block);
+  if (!valid || end_offset != index_offset) {
+    return -1;
+  }
+
+  *sections_end = (sc_MPI_Offset) index_offset;
+  return 0;
+}
+
+/** Compare two file section index entries by their offset. */
+static int
+sc_scda_section_compare (const void *v1, const void *v2)
+{
+  const sc_MPI_Offset o1 = ((const sc_scda_section_t *) v1)->offset;
+  const sc_MPI_Offset o2 = ((const sc_scda_section_t *) v2)->offset;
+
+  return o1 < o2 ? -1 : o1 > o2;
+}
+
+/** Look up the file section that begins at a given byte offset.
+ *
+ * \param [in] fc           A file context with a file section index.
+ * \param [in] offset       A byte offset in the file.
+ * \return                  The index entry of the file section that begins
+ *                          at \b offset or NULL if there is none.
+ */
+static sc_scda_section_t *
+sc_scda_find_section_at (sc_scda_fcontext_t *fc, sc_MPI_Offset offset)
+{
+  ssize_t             pos;
+  sc_scda_section_t   key;
+
+  SC_ASSERT (fc->sections != NULL);
+
+  key.offset = offset;
+  pos = sc_array_bsearch (fc->sections, &key, sc_scda_section_compare);
+  return pos < 0 ? NULL :
+    (sc_scda_section_t *) sc_array_index_ssize_t (fc->sections, pos);
+}
+
+/** Build the file section index of a file opened for reading.
+ *
+ * This is a collective function. The section index appended by \ref
+ * sc_scda_fclose is read if it exists. Otherwise, the file section headers
+ * are read. Both happens on rank \ref SC_SCDA_HEADER_ROOT and the index
+ * is broadcast once.
+ * In addition, a read-only file descriptor is opened on every rank if
+ * the operating system supports announcing upcoming reads.
+ *
+ * \param [in,out] fc       The file context as in \ref sc_scda_fopen_read
+ *                          after reading the file header. On output the
+ *                          file section index is set.
+ * \param [in]     filename The path of the file.
+ */
+static void
+sc_scda_index_sections (sc_scda_fcontext_t *fc, const char *filename)
+{
+  int                 mpiret;
+  size_t              num_sections;
+
+  SC_ASSERT (fc->sections == NULL);
+
+  fc->sections = sc_array_new (sizeof (sc_scda_section_t));
+  if (fc->mpirank == SC_SCDA_HEADER_ROOT &&
+      sc_scda_read_index_footer_serial (fc, fc->sections,
+                                        &fc->sections_end)) {
+    /* there is no valid section index at the end of the file */
+    sc_array_truncate (fc->sections);
+    fc->sections_end = sc_scda_scan_sections_serial (fc, fc->sections);
+  }
+  num_sections = fc->sections->elem_count;
+  mpiret = sc_MPI_Bcast (&num_sections, sizeof (size_t), sc_MPI_BYTE,
+                         SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Bcast (&fc->sections_end, sizeof (sc_MPI_Offset),
+                         sc_MPI_BYTE, SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (num_sections > 0) {
+    sc_array_resize (fc->sections, num_sections);
+    SC_ASSERT (num_sections <= INT_MAX / sizeof (sc_scda_section_t));
+    mpiret = sc_MPI_Bcast (fc->sections->array,
+                           (int) (num_sections * sizeof (sc_scda_section_t)),
+                           sc_MPI_BYTE, SC_SCDA_HEADER_ROOT, fc->mpicomm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+#ifdef SC_SCDA_HAVE_FADVISE
+  /* failing to open the file just disables announcing reads */
+  fc->prefetch_fd = open (filename, O_RDONLY);
+#endif
+}
+
+/** Announce the local read of the file section at the current file position.
+ *
+ * Array sections are announced to the operating system if their global
+ * element count equals the one of the last read array section, assuming that
+ * they are read with the same partition. The operating system then reads the
+ * data in the background while the application processes the current
+ * section. Nothing is done for files without a file section index.
+ *
+ * \param [in] fc           A file context opened for reading.
+ */
+static void
+sc_scda_prefetch_section (sc_scda_fcontext_t *fc)
+{
+#ifdef SC_SCDA_HAVE_FADVISE
+  sc_scda_section_t  *section;
+  sc_MPI_Offset       offset;
+
+  if (fc->prefetch_fd < 0 || fc->prefetch_local == 0) {
+    return;
+  }
+  section = sc_scda_find_section_at (fc, fc->accessed_bytes);
+  if (section == NULL || section->type != 'A' ||
+      section->elem_count != fc->prefetch_count || section->elem_size == 0) {
+    return;
+  }
+  offset = section->offset + (sc_MPI_Offset) sc_scda_section_header_bytes ('A')
+    + (sc_MPI_Offset) (fc->prefetch_first * section->elem_size);
+  (void) posix_fadvise (fc->prefetch_fd, (off_t) offset,
+                        (off_t) (fc->prefetch_local * section->elem_size),
+                        POSIX_FADV_WILLNEED);
+#endif
+}
+
 sc_scda_fcontext_t *
 sc_scda_fopen_read (sc_MPI_Comm mpicomm,
                     const char *filename,
@@ -2683,6 +3415,11 @@ sc_scda_fopen_read (sc_MPI_Comm mpicomm,
   fc->header_before = 0;
   fc->last_type = '\0';
 
+  if (params != NULL && params->build_index) {
+    /* read all file section headers once */
+    sc_scda_index_sections (fc, filename);
+  }
+
   return fc;
 }
 
@@ -2770,106 +3507,6 @@ sc_scda_fread_section_header_common_serial (sc_scda_fcontext_t *fc,
                              "Invalid user string in section header");
 }
 
-/** Internal function to check a count entry in a section header.
- *
- * This function checks if the count entry is conforming to the scda format.
- *
- * \param [in] count_entry  A pointer to a count entry that was read from file.
- *                          The count entry has exactly \ref SC_SCDA_COUNT_FIELD
- *                          bytes.
- * \param [in] expc_ident   The expected count entry identifier. If the read
- *                          identifier is not as expected the function returns
- *                          true. Note that the function also returns true if
- *                          the count entry identifier coincides with
- *                          \b expc_ident but is not in the list of supported
- *                          count identifiers (currently 'E' and 'N').
- * \param [out] count_var   The count variable read from the count entry.
- * \return                  False if the count entry is valid and has the
- *                          expected identifier. True, otherwise.
- */
-static int
-sc_scda_check_count_entry (const char *count_entry, char expc_ident,
-                           size_t *count_var)
-{
-  char                var_str[SC_SCDA_COUNT_MAX_DIGITS + 1];
-  char                ident;
-  int                 wrong_format, wrong_ident;
-  long long unsigned  read_count;
-  size_t              len = 0;
-
-  SC_ASSERT (count_var != NULL);
-
-  *count_var = 0;
-
-  wrong_format = 0;
-  /* check and get the count variable identifier */
-  switch (count_entry[0])
-  {
-  case 'E':
-    ident = 'E';
-    break;
-  case 'N':
-    ident = 'N';
-    break;
-  default:
-    /* invalid/unsupported count identifier */
-    wrong_format = 1;
-    break;
-  }
-  if (wrong_format) {
-    /* invalid count identifier */
-    return -1;
-  }
-
-  /* compare read count identifier to the expected count identifier  */
-  wrong_ident = (ident != expc_ident);
-  if (wrong_ident) {
-    /* Wrong count identifier in count entry */
-    return -1;
-  }
-
-  /* check count entry format */
-  if (count_entry[1] != ' ') {
-    /* wrong format */
-    wrong_format = 1;
-  }
-  if (wrong_format) {
-    /* Missing space in count entry */
-    return -1;
-  }
-
-  /* check padding and extract count variable string */
-  sc_scda_init_nul (var_str, SC_SCDA_COUNT_MAX_DIGITS + 1);
-  if (sc_scda_get_pad_to_fix_len (&count_entry[2], SC_SCDA_COUNT_ENTRY, var_str,
-                                  &len)) {
-    wrong_format = 1;
-  }
-  if (wrong_format) {
-    /* Invalid count variable padding */
-    return -1;
-  }
-
-  /* If the padding to the length \ref SC_SCDA_COUNT_ENTRY was valid this
-   * assertion must hold.
-   */
-  SC_ASSERT (len <= SC_SCDA_COUNT_MAX_DIGITS);
-
-  /* get count variable value */
-  /* The initialization above guarantees that var_str is nul-terminated. */
-  if (len == 0 || sscanf (var_str, "%llu", &read_count) != 1) {
-    /* conversion failed or is not possible */
-    wrong_format = 1;
-  }
-  if (wrong_format) {
-    /* Extraction of count value failed */
-    return -1;
-  }
-
-  *count_var = (size_t) read_count;
-
-  return 0;
-}
-
 /** An internal function to read and check the block section header.
  *
  * This function is only valid to be called in serial.
@@ -3006,6 +3643,7 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
 {
   int                 count_err;
   int                 mpiret;
+  sc_scda_section_t  *section;
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (user_string != NULL);
@@ -3018,6 +3656,30 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
   *elem_count = 0;
   *elem_size = 0;
 
+  if (fc->sections != NULL &&
+      (section = sc_scda_find_section_at (fc, fc->accessed_bytes)) != NULL) {
+    /* the header was already read and checked while indexing the file;
+       there is no file access that could fail */
+    errcode->scdaret = SC_SCDA_FERR_SUCCESS;
+    errcode->mpiret = sc_MPI_SUCCESS;
+
+    /* the indexed section is read raw */
+    *decode = 0;
+    *type = section->type;
+    sc_scda_copy_bytes (user_string, section->user_string,
+                        SC_SCDA_USER_STRING_BYTES + 1);
+    *len = section->len;
+    *elem_count = section->elem_count;
+    *elem_size = section->elem_size;
+    fc->accessed_bytes +=
+      (sc_MPI_Offset) sc_scda_section_header_bytes (section->type);
+
+    fc->header_before = 1;
+    fc->last_type = *type;
+
+    return fc;
+  }
+
   /* read the common section header part first */
   if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
     sc_scda_fread_section_header_common_serial (fc, type, user_string, len,
@@ -3059,6 +3721,9 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
   mpiret = sc_MPI_Bcast (user_string, SC_SCDA_USER_STRING_BYTES + 1,
                          sc_MPI_BYTE, SC_SCDA_HEADER_ROOT, fc->mpicomm);
   SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Bcast (len, sizeof (size_t), sc_MPI_BYTE,
+                         SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
 
   /* set global outputs and Bcast the counts if it is necessary */
   switch (*type) {
@@ -3178,6 +3843,9 @@ sc_scda_fread_inline_data (sc_scda_fcontext_t *fc, sc_array_t *data, int root,
   /* last function call can not be \ref sc_scda_fread_section_header anymore */
   fc->header_before = 0;
 
+  /* announce the next file section if it is indexed */
+  sc_scda_prefetch_section (fc);
+
   return fc;
 }
 
@@ -3370,6 +4038,9 @@ sc_scda_fread_block_data (sc_scda_fcontext_t *fc, sc_array_t *block_data,
   /* last function call can not be \ref sc_scda_fread_section_header anymore */
   fc->header_before = 0;
 
+  /* announce the next file section if it is indexed */
+  sc_scda_prefetch_section (fc);
+
   return fc;
 }
 
@@ -3508,6 +4179,188 @@ sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
   /* last function call can not be \ref sc_scda_fread_section_header anymore */
   fc->header_before = 0;
 
+  if (fc->prefetch_fd >= 0) {
+    /* remember the partition to announce the next array section */
+    sc_scda_get_local_partition_index (fc, elem_counts, 1, &offset,
+                                       &bytes_to_read);
+    fc->prefetch_count = elem_count;
+    fc->prefetch_first = (size_t) offset;
+    fc->prefetch_local = array_data != NULL ? (size_t) bytes_to_read : 0;
+    sc_scda_prefetch_section (fc);
+  }
+
+  return fc;
+}
+
+/** Append the section index to a file opened for writing.
+ *
+ * This is a collective function.
+ * The index is written as a block section with the user string \ref
+ * SC_SCDA_INDEX_USER_STRING that contains one entry of \ref
+ * SC_SCDA_INDEX_ENTRY_BYTES bytes per file section: the common part of the
+ * section header followed by the count entries 'O' for the byte offset of
+ * the section header, 'N' for the element count and 'E' for the element
+ * size. It is followed by an inline section with the user string \ref
+ * SC_SCDA_INDEX_LOCATOR that contains the 'O' count entry of the byte offset
+ * of the index block section. Hence, the locator section forms the last 96
+ * bytes of the file. Nothing is appended if there are no file sections.
+ *
+ * \param [in,out] fc       The file context of a file opened for writing
+ *                          with the section index requested.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  \b fc on success. Otherwise, the file is closed,
+ *                          \b fc is freed and NULL is returned.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_index_footer (sc_scda_fcontext_t *fc,
+                             sc_scda_ferror_t *errcode)
+{
+  int                 is_root;
+  size_t              zz, num_sections;
+  char               *entry;
+  char                locator_data[SC_SCDA_INLINE_FIELD];
+  sc_MPI_Offset       index_offset;
+  sc_array_t          block, locator;
+  sc_scda_section_t  *section;
+
+  SC_ASSERT (fc->index_footer && fc->sections != NULL);
+
+  /* the sections of the index are not indexed themselves */
+  fc->index_footer = 0;
+  index_offset = fc->accessed_bytes;
+  num_sections = fc->sections->elem_count;
+  if (num_sections == 0) {
+    /* an empty file is indexed quickly without the footer */
+    return fc;
+  }
+
+  is_root = (fc->mpirank == SC_SCDA_HEADER_ROOT);
+  if (is_root) {
+    sc_array_init_size (&block, num_sections * SC_SCDA_INDEX_ENTRY_BYTES, 1);
+    for (zz = 0; zz < num_sections; ++zz) {
+      section = (sc_scda_section_t *) sc_array_index (fc->sections, zz);
+      entry = block.array + zz * SC_SCDA_INDEX_ENTRY_BYTES;
+      SC_EXECUTE_ASSERT_FALSE (sc_scda_get_common_section_header
+                               (section->type, section->user_string,
+                                &section->len, entry));
+      entry += SC_SCDA_COMMON_FIELD;
+      SC_EXECUTE_ASSERT_FALSE (sc_scda_get_section_header_entry
+                               ('O', (size_t) section->offset, entry));
+      entry += SC_SCDA_COUNT_FIELD;
+      SC_EXECUTE_ASSERT_FALSE (sc_scda_get_section_header_entry
+                               ('N', section->elem_count, entry));
+      entry += SC_SCDA_COUNT_FIELD;
+      SC_EXECUTE_ASSERT_FALSE (sc_scda_get_section_header_entry
+                               ('E', section->elem_size, entry));
+    }
+  }
+  fc = sc_scda_fwrite_block (fc, SC_SCDA_INDEX_USER_STRING, NULL,
+                             is_root ? &block : NULL,
+                             num_sections * SC_SCDA_INDEX_ENTRY_BYTES,
+                             SC_SCDA_HEADER_ROOT, 0, errcode);
+  if (is_root) {
+    sc_array_reset (&block);
+  }
+  if (fc == NULL) {
+    /* the file is closed and the context is freed */
+    return NULL;
+  }
+
+  SC_EXECUTE_ASSERT_FALSE (sc_scda_get_section_header_entry
+                           ('O', (size_t) index_offset, locator_data));
+  sc_array_init_data (&locator, locator_data, SC_SCDA_INLINE_FIELD, 1);
+  return sc_scda_fwrite_inline (fc, SC_SCDA_INDEX_LOCATOR, NULL, &locator,
+                                SC_SCDA_HEADER_ROOT, errcode);
+}
+
+/** Check if a file context was opened for reading with a section index.
+ *
+ * \param [in] fc           A file context.
+ * \return                  True if \b fc has a file section index that was
+ *                          built by \ref sc_scda_fopen_read and false
+ *                          otherwise, in particular for a file opened for
+ *                          writing that records its sections.
+ */
+static int
+sc_scda_has_read_index (sc_scda_fcontext_t *fc)
+{
+  return fc->sections != NULL && !fc->index_footer;
+}
+
+int
+sc_scda_fnum_sections (sc_scda_fcontext_t *fc, size_t *num_sections)
+{
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (num_sections != NULL);
+
+  if (!sc_scda_has_read_index (fc)) {
+    *num_sections = 0;
+    return -1;
+  }
+
+  *num_sections = fc->sections->elem_count;
+  return 0;
+}
+
+int
+sc_scda_ffind_section (sc_scda_fcontext_t *fc, const char *user_string,
+                       size_t start, size_t *isection)
+{
+  size_t              zz;
+  sc_scda_section_t  *section;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (user_string != NULL);
+  SC_ASSERT (isection != NULL);
+
+  if (sc_scda_has_read_index (fc)) {
+    for (zz = start; zz < fc->sections->elem_count; ++zz) {
+      section = (sc_scda_section_t *) sc_array_index (fc->sections, zz);
+      if (!strcmp (section->user_string, user_string)) {
+        *isection = zz;
+        return 0;
+      }
+    }
+  }
+
+  return -1;
+}
+
+sc_scda_fcontext_t *
+sc_scda_fseek_section (sc_scda_fcontext_t *fc, size_t isection,
+                       sc_scda_ferror_t *errcode)
+{
+  int                 wrong_usage;
+  int                 invalid_arg;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (errcode != NULL);
+
+  /* seeking requires a file section index of a file opened for reading */
+  wrong_usage = !sc_scda_has_read_index (fc);
+  sc_scda_scdaret_to_errcode (wrong_usage ? SC_SCDA_FERR_USAGE :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Seek without file section index");
+
+  invalid_arg = (isection > fc->sections->elem_count);
+  sc_scda_scdaret_to_errcode (invalid_arg ? SC_SCDA_FERR_ARG :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid file section to seek");
+
+  /* the next file section header is the one of the given section */
+  if (isection < fc->sections->elem_count) {
+    fc->accessed_bytes =
+      ((sc_scda_section_t *) sc_array_index (fc->sections, isection))->offset;
+  }
+  else {
+    fc->accessed_bytes = fc->sections_end;
+  }
+  fc->header_before = 0;
+
+  sc_scda_prefetch_section (fc);
+
   return fc;
 }
 
@@ -3519,6 +4372,15 @@ sc_scda_fclose (sc_scda_fcontext_t * fc, sc_scda_ferror_t * errcode)
   SC_ASSERT (fc != NULL);
   SC_ASSERT (errcode != NULL);
 
+  if (fc->index_footer) {
+    /* append the section index to the file opened for writing */
+    fc = sc_scda_fwrite_index_footer (fc, errcode);
+    if (fc == NULL) {
+      /* the file is already closed and the context is freed */
+      return -1;
+    }
+  }
+
   mpiret = sc_io_close (&fc->file);
   sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
   /* Since this function does not return NULL in case of an error, closes the
@@ -3528,7 +4390,7 @@ sc_scda_fclose (sc_scda_fcontext_t * fc, sc_scda_ferror_t * errcode)
    */
   SC_SCDA_CHECK_VERBOSE_COLL (fc->log_level, *errcode, "File close");
 
-  SC_FREE (fc);
+  sc_scda_fcontext_free (fc);
 
   return sc_scda_ferror_is_success (*errcode) ? 0 : -1;
 }
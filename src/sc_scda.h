@@ -129,6 +129,27 @@
  * If \b decode is false, the data is read raw even if it was written according
  * to the compression convention.
  *
+ * ### Section Index
+ *
+ * A file can be closed with an appended section index by passing
+ * \b write_index true in \ref sc_scda_params to \ref sc_scda_fopen_write.
+ * The index consists of two regular file sections such that every reader
+ * can still parse the file sequentially. The first is a block section with
+ * the user string "scda section index". It contains 160 bytes per preceding
+ * file section: the 64 bytes of the common section header part, i.e. the
+ * type character and the padded user string, followed by the count entries
+ * 'O' for the byte offset of the section header, 'N' for the element count
+ * and 'E' for the element size. The second is an inline section with the user
+ * string "scda section index locator" that contains the 'O' count entry of
+ * the byte offset of the index block section. Hence, the index is found from
+ * the last 96 bytes of the file.
+ *
+ * A file opened by \ref sc_scda_fopen_read with \b build_index true in
+ * \ref sc_scda_params uses this index if it exists and otherwise reads
+ * all file section headers once. Then the sections can be accessed by their
+ * position or user string in any order; cf. \ref sc_scda_ffind_section and
+ * \ref sc_scda_fseek_section. The index sections are not indexed themselves.
+ *
  * ### Error management
  *
  * All \b scda functions that receive a file context have an output parameter
@@ -317,6 +338,27 @@ typedef struct sc_scda_params
   int                 log_level;  /**< The log level for the scda functions.
                                        The possible values are documented in
                                        \ref sc.h; cf. SC_LP_* macros. */
+  int                 build_index; /**< Only used by \ref sc_scda_fopen_read.
+                                       If true, all file section headers are
+                                       read once on opening and broadcast as
+                                       one index. Then \ref
+                                       sc_scda_fread_section_header does not
+                                       access the file, and the functions
+                                       \ref sc_scda_ffind_section and \ref
+                                       sc_scda_fseek_section allow to access
+                                       the sections in any order. In addition,
+                                       upcoming array data is announced to the
+                                       operating system to be read in the
+                                       background. The index is taken from
+                                       the end of the file if it was written
+                                       with \b write_index. Must be
+                                       collective. */
+  int                 write_index; /**< Only used by \ref sc_scda_fopen_write.
+                                       If true, \ref sc_scda_fclose appends
+                                       a section index to the file; cf. the
+                                       'Section Index' section in the detailed
+                                       description in this file.
+                                       Must be collective. */
 }
 sc_scda_params_t; /**< type for \ref sc_scda_params */
 
@@ -1124,6 +1166,83 @@ sc_scda_fcontext_t *sc_scda_fread_varray_data (sc_scda_fcontext_t * fc,
                                                int indirect,
                                                sc_scda_ferror_t * errcode);
 
+/** Get the number of file sections in the file section index.
+ *
+ * This is a non-collective function. The file section index is built by
+ * \ref sc_scda_fopen_read if \b build_index is set in \ref sc_scda_params.
+ * It is equal on all ranks.
+ *
+ * \param [in]      fc          File context previously opened by \ref
+ *                              sc_scda_fopen_read.
+ * \param [out]     num_sections On output the number of indexed file
+ *                              sections or 0 if there is no index.
+ * \return                      0 on success and -1 if \b fc has no file
+ *                              section index, which includes any file
+ *                              context opened for writing.
+ */
+int                 sc_scda_fnum_sections (sc_scda_fcontext_t * fc,
+                                           size_t *num_sections);
+
+/** Find a file section by its user string in the file section index.
+ *
+ * This is a non-collective function that does not access the file.
+ * Since the index is equal on all ranks, the result is so, too.
+ *
+ * \param [in]      fc          File context previously opened by \ref
+ *                              sc_scda_fopen_read.
+ * \param [in]      user_string A nul-terminated user string.
+ * \param [in]      start       The index of the first file section that is
+ *                              compared. Pass 0 to search all sections and
+ *                              the last found index + 1 to find the next one.
+ * \param [out]     isection    On success the index of the first file
+ *                              section at or after \b start with the user
+ *                              string \b user_string.
+ * \return                      0 if such a section was found and -1 if
+ *                              there is none or \b fc has no file section
+ *                              index, which includes any file context
+ *                              opened for writing.
+ */
+int                 sc_scda_ffind_section (sc_scda_fcontext_t * fc,
+                                           const char *user_string,
+                                           size_t start, size_t *isection);
+
+/** Move to a file section of an indexed file.
+ *
+ * This is a collective function.
+ * The next call of \ref sc_scda_fread_section_header reads the header of
+ * the file section \b isection. This allows to skip file sections and to
+ * read them in any order. If the next file section is a fixed-size array
+ * with the same element count as the last read one, its local data is
+ * announced to the operating system assuming the same partition.
+ * \note
+ * All parameters are collective.
+ *
+ * This function returns NULL on I/O errors.
+ *
+ * \param [in,out]  fc          File context previously opened by \ref
+ *                              sc_scda_fopen_read with \b build_index set.
+ *                              Otherwise, the function returns an error
+ *                              of the class \ref SC_SCDA_FERR_USAGE.
+ * \param [in]      isection    The index of the file section between 0 and
+ *                              the number of sections as output by \ref
+ *                              sc_scda_fnum_sections inclusive. The latter
+ *                              moves behind the last indexed section.
+ * \param [out]     errcode     An errcode that can be interpreted by \ref
+ *                              sc_scda_ferror_string or mapped to an error class
+ *                              by \ref sc_scda_ferror_class. \b errcode encodes
+ *                              success if and only if the function does not
+ *                              return NULL.
+ * \return                      Return a pointer to the input
+ *                              context \b fc on success.
+ *                              The context is used to continue
+ *                              reading and eventually closing the file.
+ *                              In case of any error, attempt to close the
+ *                              file and deallocate the context \b fc.
+ */
+sc_scda_fcontext_t *sc_scda_fseek_section (sc_scda_fcontext_t * fc,
+                                           size_t isection,
+                                           sc_scda_ferror_t * errcode);
+
 /** Translate a sc_scda error code to an error class.
  *
  * The semantic of error class and error code is the same as in the MPI standard,
@@ -1177,6 +1296,9 @@ int                 sc_scda_ferror_string (sc_scda_ferror_t errcode,
  * \note
  * All parameters are collective.
  *
+ * If the file was opened by \ref sc_scda_fopen_write with \b write_index
+ * true, the section index is appended before closing the file.
+ *
  * This function returns -1 on I/O errors.
  * This function always frees the file context -- also in case of an error.
  * \param [in,out]  fc        File context previously created by
@@ -141,3 +141,177 @@ sc_bsearch_range (const void *key, const void *base, size_t nmemb,
   SC_ASSERT (compar (ckey, cbase + (guess + 1) * size) < 0);
   return guess;
 }
+
+/* Branchless lower bound: base advances by half if the probe is too small.
+ * Written as a macro to instantiate it for each key type without a
+ * comparison callback; less (a, t) must be an expression without branches.
+ */
+#define SC_SEARCH_LOWER_BOUND(T,less,target,array,nmemb)        \
+  do {                                                          \
+    const T            *base = (array);                         \
+    size_t              n = (nmemb), half;                      \
+    if (n == 0) {                                               \
+      return 0;                                                 \
+    }                                                           \
+    while (n > 1) {                                             \
+      half = n / 2;                                             \
+      base += less (base[half - 1], target) ? half : 0;         \
+      n -= half;                                                \
+    }                                                           \
+    return (size_t) (base - (array)) +                          \
+      (less (base[0], target) ? 1 : 0);                         \
+  } while (0)
+
+#define SC_SEARCH_LESS(a,b) ((a) < (b))
+
+/* compare two 128bit integers without branches */
+#define SC_SEARCH_LESS_UINT128(a,b)                             \
+  (((a).high_bits < (b).high_bits) |                            \
+   (((a).high_bits == (b).high_bits) & ((a).low_bits < (b).low_bits)))
+
+size_t
+sc_search_lower_bound_int32 (int32_t target, const int32_t * array,
+                             size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (int32_t, SC_SEARCH_LESS, target, array, nmemb);
+}
+
+size_t
+sc_search_lower_bound_int64 (int64_t target, const int64_t * array,
+                             size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (int64_t, SC_SEARCH_LESS, target, array, nmemb);
+}
+
+size_t
+sc_search_lower_bound_uint128 (const sc_uint128_t * target,
+                               const sc_uint128_t * array, size_t nmemb)
+{
+  const sc_uint128_t  t = *target;
+
+  SC_SEARCH_LOWER_BOUND (sc_uint128_t, SC_SEARCH_LESS_UINT128,
+                         t, array, nmemb);
+}
+
+size_t
+sc_search_lower_bound_double (double target, const double *array,
+                              size_t nmemb)
+{
+  SC_SEARCH_LOWER_BOUND (double, SC_SEARCH_LESS, target, array, nmemb);
+}
+
+void
+sc_search_lower_bound_int64_batch (const int64_t * targets, size_t ntargets,
+                                   const int64_t * array, size_t nmemb,
+                                   size_t * positions)
+{
+  size_t              i, pos, step;
+
+  pos = 0;
+  for (i = 0; i < ntargets; ++i) {
+    SC_ASSERT (i == 0 || targets[i - 1] <= targets[i]);
+
+    /* gallop forward from the previous result */
+    if (pos < nmemb && array[pos] < targets[i]) {
+      step = 1;
+      while (pos + step < nmemb && array[pos + step] < targets[i]) {
+        pos += step;
+        step *= 2;
+      }
+      /* now array[pos] < target and the bound is in (pos, pos + step] */
+      ++pos;
+      pos += sc_search_lower_bound_int64
+        (targets[i], array + pos, SC_MIN (step, nmemb - pos));
+    }
+    positions[i] = pos;
+  }
+}
+
+/* number of tree entries that fit into one cache line */
+#define SC_SEARCH_INDEX_LINE 8
+
+/* byte alignment of the tree to the start of a cache line */
+#define SC_SEARCH_INDEX_ALIGN (SC_SEARCH_INDEX_LINE * sizeof (int64_t))
+
+struct sc_search_index
+{
+  size_t              nmemb;    /**< Number of indexed entries. */
+  char               *raw;      /**< Memory allocated for the tree. */
+  int64_t            *tree;     /**< Entries in breadth-first order,
+                                     1-based with tree[0] unused,
+                                     aligned to a cache line. */
+  size_t             *rank;     /**< Sorted position of each tree entry. */
+};
+
+/* fill the subtree rooted at k in order from the sorted array */
+static size_t
+sc_search_index_fill (sc_search_index_t * index, const int64_t * array,
+                      size_t i, size_t k)
+{
+  if (k <= index->nmemb) {
+    i = sc_search_index_fill (index, array, i, 2 * k);
+    index->tree[k] = array[i];
+    index->rank[k] = i++;
+    i = sc_search_index_fill (index, array, i, 2 * k + 1);
+  }
+  return i;
+}
+
+sc_search_index_t  *
+sc_search_index_new (const int64_t * array, size_t nmemb)
+{
+  size_t              shift;
+  sc_search_index_t  *index;
+
+  index = SC_ALLOC (sc_search_index_t, 1);
+  index->nmemb = nmemb;
+
+  /* the entries 1 to 7 and the descendants 8k to 8k + 7 of entry k
+     each occupy one cache line */
+  index->raw = SC_ALLOC (char, (nmemb + 1) * sizeof (int64_t) +
+                         SC_SEARCH_INDEX_ALIGN);
+  shift = (SC_SEARCH_INDEX_ALIGN - (size_t) ((uintptr_t) index->raw %
+                                             SC_SEARCH_INDEX_ALIGN)) %
+    SC_SEARCH_INDEX_ALIGN;
+  index->tree = (int64_t *) (index->raw + shift);
+  index->rank = SC_ALLOC (size_t, nmemb + 1);
+
+  /* the root's position 0 encodes "all entries are less than target" */
+  index->tree[0] = 0;
+  index->rank[0] = nmemb;
+  SC_EXECUTE_ASSERT_TRUE (sc_search_index_fill (index, array, 0, 1) == nmemb);
+
+  return index;
+}
+
+void
+sc_search_index_destroy (sc_search_index_t * index)
+{
+  SC_FREE (index->raw);
+  SC_FREE (index->rank);
+  SC_FREE (index);
+}
+
+size_t
+sc_search_index_lower_bound (const sc_search_index_t * index,
+                             int64_t target)
+{
+  const int64_t      *tree = index->tree;
+  const size_t        n = index->nmemb;
+  size_t              k = 1;
+
+  while (k <= n) {
+#ifdef __GNUC__
+    /* the descendants three levels down share one cache line */
+    __builtin_prefetch (tree + SC_SEARCH_INDEX_LINE * k);
+#endif
+    k = 2 * k + (tree[k] < target ? 1 : 0);
+  }
+
+  /* undo the right turns taken after the last left turn */
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+  return index->rank[k];
+}
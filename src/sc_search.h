@@ -24,7 +24,7 @@
 #ifndef SC_SEARCH_H
 #define SC_SEARCH_H
 
-#include <sc.h>
+#include <sc_uint128.h>
 
 SC_EXTERN_C_BEGIN;
 
@@ -67,6 +67,104 @@ size_t              sc_bsearch_range (const void *key, const void *base,
                                       int (*compar) (const void *,
                                                      const void *));
 
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * The search is branchless: the loop runs log2 (nmemb) times regardless of
+ * the data and the comparison result only selects the next position, which
+ * compilers translate to conditional moves.  This is faster than a branchy
+ * binary search for random targets that cause branch mispredictions.
+ * \param [in]  target  The target lower bound to search for.
+ * \param [in]  array   Sorted array of 32bit integers.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return  Returns the matching position, or nmemb if all entries
+ *          are less than target, including the case nmemb == 0.
+ */
+size_t              sc_search_lower_bound_int32 (int32_t target,
+                                                 const int32_t * array,
+                                                 size_t nmemb);
+
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * Branchless variant; see \ref sc_search_lower_bound_int32.
+ * \param [in]  target  The target lower bound to search for.
+ * \param [in]  array   Sorted array of 64bit integers.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return  Returns the matching position, or nmemb if there is none.
+ */
+size_t              sc_search_lower_bound_int64 (int64_t target,
+                                                 const int64_t * array,
+                                                 size_t nmemb);
+
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * Branchless variant; see \ref sc_search_lower_bound_int32.
+ * \param [in]  target  The target lower bound to search for.
+ * \param [in]  array   Sorted array of 128bit unsigned integers.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return  Returns the matching position, or nmemb if there is none.
+ */
+size_t              sc_search_lower_bound_uint128 (const sc_uint128_t *
+                                                   target,
+                                                   const sc_uint128_t *
+                                                   array, size_t nmemb);
+
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * Branchless variant; see \ref sc_search_lower_bound_int32.
+ * \param [in]  target  The target lower bound to search for, not NaN.
+ * \param [in]  array   Sorted array of doubles without NaN.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return  Returns the matching position, or nmemb if there is none.
+ */
+size_t              sc_search_lower_bound_double (double target,
+                                                  const double *array,
+                                                  size_t nmemb);
+
+/** Compute the lower bounds of many sorted targets in one sweep.
+ * For each target i we find the lowest position k in the sorted array
+ * such that array[k] >= targets[i], or nmemb if there is none.
+ * Since the targets are sorted, each search starts at the previous result
+ * and gallops forward, such that the total cost is linear in the number
+ * of targets and at most logarithmic in the distance between results.
+ * \param [in]  targets     Sorted array of ntargets targets.
+ * \param [in]  ntargets    Number of targets.
+ * \param [in]  array       Sorted array to search in.
+ * \param [in]  nmemb       The number of entries in the array.
+ * \param [out] positions   Array of ntargets positions.
+ */
+void                sc_search_lower_bound_int64_batch (const int64_t *
+                                                       targets,
+                                                       size_t ntargets,
+                                                       const int64_t * array,
+                                                       size_t nmemb,
+                                                       size_t * positions);
+
+/** Opaque search index for a static sorted array of 64bit integers. */
+typedef struct sc_search_index sc_search_index_t;
+
+/** Create a search index for a sorted array in Eytzinger layout.
+ * The entries are copied into the breadth-first order of an implicit
+ * binary search tree, such that the first levels of a search share cache
+ * lines and the next lines to visit can be prefetched.
+ * Use this for arrays that are searched many times after construction.
+ * \param [in]  array   Sorted array of 64bit integers.
+ *                      It is copied and may be changed afterwards.
+ * \param [in]  nmemb   The number of entries in the array.
+ * \return              A new search index.
+ */
+sc_search_index_t  *sc_search_index_new (const int64_t * array,
+                                         size_t nmemb);
+
+/** Destroy a search index.
+ * \param [in,out] index        This index is freed.
+ */
+void                sc_search_index_destroy (sc_search_index_t * index);
+
+/** Find lowest position k in the indexed array such that array[k] >= target.
+ * \param [in]  index   Valid search index.
+ * \param [in]  target  The target lower bound to search for.
+ * \return  Returns the position in the original sorted array,
+ *          or nmemb if all entries are less than target.
+ */
+size_t              sc_search_index_lower_bound (const sc_search_index_t *
+                                                 index, int64_t target);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_SEARCH_H */
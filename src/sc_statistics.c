@@ -22,6 +22,26 @@
 */
 
 #include <sc_statistics.h>
+#include <sc_private.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/** Per-thread accumulation buffers of a statistics container. */
+struct sc_stats_threads
+{
+#ifdef SC_ENABLE_PTHREAD
+  pthread_key_t       key;      /**< Maps a thread to its buffer. */
+  pthread_mutex_t     mutex;    /**< Protects the array of buffers. */
+#endif
+  sc_array_t          buffers;  /**< Array of (sc_array_t *) buffers. */
+};
+
+/* lowest power of two resolved by the histogram bins */
+#define SC_STATS_HISTOGRAM_EMIN (-40)
+
+/* number of bins per power of two */
+#define SC_STATS_HISTOGRAM_SUB 4
 
 #ifdef SC_ENABLE_MPI
 
@@ -29,10 +49,17 @@ static void
 sc_stats_mpifunc (void *invec, void *inoutvec, int *len,
                   sc_MPI_Datatype * datatype)
 {
-  int                 i;
+  int                 i, b;
+  int                 mpiret;
+  int                 size, rec;
   double             *in = (double *) invec;
   double             *inout = (double *) inoutvec;
 
+  /* the records carry the histogram bins if any variable has them */
+  mpiret = MPI_Type_size (*datatype, &size);
+  SC_CHECK_MPI (mpiret);
+  rec = size / (int) sizeof (double);
+
   for (i = 0; i < *len; ++i) {
     /* sum count, values and their squares */
     inout[0] += in[0];
@@ -57,11 +84,16 @@ sc_stats_mpifunc (void *invec, void *inoutvec, int *len,
       else if (in[4] == inout[4]) {     /* ignore the comparison warning */
         inout[6] = SC_MIN (in[6], inout[6]);
       }
+
+      /* sum histogram bins */
+      for (b = 7; b < rec; ++b) {
+        inout[b] += in[b];
+      }
     }
 
     /* advance to next data set */
-    in += 7;
-    inout += 7;
+    in += rec;
+    inout += rec;
   }
 }
 
@@ -70,6 +102,21 @@ sc_stats_mpifunc (void *invec, void *inoutvec, int *len,
 const int           sc_stats_group_all = -2;
 const int           sc_stats_prio_all = -3;
 
+static int
+sc_stats_histogram_bin (double value)
+{
+  int                 e, b;
+
+  if (!(value > 0.)) {
+    return 0;
+  }
+
+  /* value = m * 2^e with m in [1/2, 1) */
+  b = (int) floor (SC_STATS_HISTOGRAM_SUB * log2 (2. * frexp (value, &e)));
+  b += SC_STATS_HISTOGRAM_SUB * (e - 1 - SC_STATS_HISTOGRAM_EMIN);
+  return SC_MAX (0, SC_MIN (b, SC_STATS_HISTOGRAM_BINS - 1));
+}
+
 void
 sc_stats_set1 (sc_statinfo_t * stats, double value, const char *variable)
 {
@@ -101,6 +148,7 @@ sc_stats_set1_ext (sc_statinfo_t * stats, double value, const char *variable,
   }
   stats->group = stats_group;
   stats->prio = stats_prio;
+  stats->histogram = NULL;
 }
 
 void
@@ -132,6 +180,7 @@ sc_stats_init_ext (sc_statinfo_t * stats, const char *variable,
   }
   stats->group = stats_group;
   stats->prio = stats_prio;
+  stats->histogram = NULL;
 }
 
 void
@@ -142,6 +191,10 @@ sc_stats_reset (sc_statinfo_t * stats, int reset_vgp)
   stats->count = 0;
   stats->sum_values = stats->sum_squares = 0.;
   stats->min = stats->max = 0.;
+  if (stats->histogram != NULL) {
+    memset (stats->histogram, 0,
+            SC_STATS_HISTOGRAM_BINS * sizeof (*stats->histogram));
+  }
   if (reset_vgp) {
     stats->variable = NULL;
     if (stats->variable_owned != NULL) {
@@ -164,6 +217,51 @@ sc_stats_set_group_prio (sc_statinfo_t * stats,
   stats->prio = stats_prio;
 }
 
+void
+sc_stats_set_histogram (sc_statinfo_t * stats, int enable)
+{
+  if (enable && stats->histogram == NULL) {
+    SC_ASSERT (stats->count == 0 || stats->count == 1);
+    stats->histogram = SC_ALLOC_ZERO (double, SC_STATS_HISTOGRAM_BINS);
+    if (stats->count == 1) {
+      stats->histogram[sc_stats_histogram_bin (stats->sum_values)] = 1.;
+    }
+  }
+  else if (!enable && stats->histogram != NULL) {
+    SC_FREE (stats->histogram);
+    stats->histogram = NULL;
+  }
+}
+
+double
+sc_stats_quantile (sc_statinfo_t * stats, double q)
+{
+  int                 b;
+  double              target, sum, frac, value;
+
+  SC_ASSERT (stats->histogram != NULL);
+  SC_ASSERT (stats->count > 0);
+  SC_ASSERT (0. <= q && q <= 1.);
+
+  target = q * (double) stats->count;
+  for (sum = 0., b = 0; b < SC_STATS_HISTOGRAM_BINS - 1; ++b) {
+    sum += stats->histogram[b];
+    if (sum >= target && sum > 0.) {
+      break;
+    }
+  }
+
+  /* interpolate logarithmically inside the bin */
+  frac = .5;
+  if (stats->histogram[b] > 0.) {
+    frac = 1. - (sum - target) / stats->histogram[b];
+    frac = SC_MAX (0., SC_MIN (frac, 1.));
+  }
+  value = exp2 (SC_STATS_HISTOGRAM_EMIN +
+                (b + frac) / SC_STATS_HISTOGRAM_SUB);
+  return SC_MAX (stats->min, SC_MIN (value, stats->max));
+}
+
 void
 sc_stats_accumulate (sc_statinfo_t * stats, double value)
 {
@@ -182,71 +280,69 @@ sc_stats_accumulate (sc_statinfo_t * stats, double value)
     stats->min = value;
     stats->max = value;
   }
+  if (stats->histogram != NULL) {
+    stats->histogram[sc_stats_histogram_bin (value)] += 1.;
+  }
 }
 
-void
-sc_stats_compute (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
+/** Return the number of doubles reduced per variable. */
+static int
+sc_stats_record (int nvars, sc_statinfo_t * stats)
 {
   int                 i;
-  int                 mpiret;
-  int                 rank;
-  double              cnt, avg;
-  double             *flat;
-  double             *flatin;
-  double             *flatout;
-#ifdef SC_ENABLE_MPI
-  sc_MPI_Op           op;
-  sc_MPI_Datatype     ctype;
-#endif
 
-  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
-  SC_CHECK_MPI (mpiret);
+  /* histograms are enabled identically on all processes */
+  for (i = 0; i < nvars; ++i) {
+    if (stats[i].histogram != NULL) {
+      return 7 + SC_STATS_HISTOGRAM_BINS;
+    }
+  }
+  return 7;
+}
 
-  flat = SC_ALLOC (double, 2 * 7 * nvars);
-  flatin = flat;
-  flatout = flat + 7 * nvars;
+static void
+sc_stats_pack (int rank, int rec, int nvars, sc_statinfo_t * stats,
+               double *flatin)
+{
+  int                 i;
 
   for (i = 0; i < nvars; ++i) {
     if (!stats[i].dirty) {
-      memset (flatin + 7 * i, 0, 7 * sizeof (*flatin));
+      memset (flatin + rec * i, 0, rec * sizeof (*flatin));
       continue;
     }
-    flatin[7 * i + 0] = (double) stats[i].count;
-    flatin[7 * i + 1] = stats[i].sum_values;
-    flatin[7 * i + 2] = stats[i].sum_squares;
-    flatin[7 * i + 3] = stats[i].min;
-    flatin[7 * i + 4] = stats[i].max;
-    flatin[7 * i + 5] = (double) rank;  /* rank that attains minimum */
-    flatin[7 * i + 6] = (double) rank;  /* rank that attains maximum */
+    flatin[rec * i + 0] = (double) stats[i].count;
+    flatin[rec * i + 1] = stats[i].sum_values;
+    flatin[rec * i + 2] = stats[i].sum_squares;
+    flatin[rec * i + 3] = stats[i].min;
+    flatin[rec * i + 4] = stats[i].max;
+    flatin[rec * i + 5] = (double) rank;        /* rank that attains minimum */
+    flatin[rec * i + 6] = (double) rank;        /* rank that attains maximum */
+    if (rec > 7) {
+      if (stats[i].histogram != NULL) {
+        memcpy (flatin + rec * i + 7, stats[i].histogram,
+                SC_STATS_HISTOGRAM_BINS * sizeof (*flatin));
+      }
+      else {
+        memset (flatin + rec * i + 7, 0,
+                SC_STATS_HISTOGRAM_BINS * sizeof (*flatin));
+      }
+    }
   }
+}
 
-#ifndef SC_ENABLE_MPI
-  memcpy (flatout, flatin, 7 * nvars * sizeof (*flatout));
-#else
-  mpiret = MPI_Type_contiguous (7, MPI_DOUBLE, &ctype);
-  SC_CHECK_MPI (mpiret);
-
-  mpiret = MPI_Type_commit (&ctype);
-  SC_CHECK_MPI (mpiret);
-
-  mpiret = MPI_Op_create ((MPI_User_function *) sc_stats_mpifunc, 1, &op);
-  SC_CHECK_MPI (mpiret);
-
-  mpiret = MPI_Allreduce (flatin, flatout, nvars, ctype, op, mpicomm);
-  SC_CHECK_MPI (mpiret);
-
-  mpiret = MPI_Op_free (&op);
-  SC_CHECK_MPI (mpiret);
-
-  mpiret = MPI_Type_free (&ctype);
-  SC_CHECK_MPI (mpiret);
-#endif /* SC_ENABLE_MPI */
+static void
+sc_stats_unpack (int rec, int nvars, sc_statinfo_t * stats,
+                 const double *flatout)
+{
+  int                 i;
+  double              cnt, avg;
 
   for (i = 0; i < nvars; ++i) {
     if (!stats[i].dirty) {
       continue;
     }
-    cnt = flatout[7 * i + 0];
+    cnt = flatout[rec * i + 0];
     stats[i].count = (long) cnt;
     if (!cnt) {
       /* initialize output variables */
@@ -255,24 +351,195 @@ sc_stats_compute (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
     }
     else {
       stats[i].dirty = 0;
-      stats[i].sum_values = flatout[7 * i + 1];
-      stats[i].sum_squares = flatout[7 * i + 2];
-      stats[i].min = flatout[7 * i + 3];
-      stats[i].max = flatout[7 * i + 4];
-      stats[i].min_at_rank = (int) flatout[7 * i + 5];
-      stats[i].max_at_rank = (int) flatout[7 * i + 6];
+      stats[i].sum_values = flatout[rec * i + 1];
+      stats[i].sum_squares = flatout[rec * i + 2];
+      stats[i].min = flatout[rec * i + 3];
+      stats[i].max = flatout[rec * i + 4];
+      stats[i].min_at_rank = (int) flatout[rec * i + 5];
+      stats[i].max_at_rank = (int) flatout[rec * i + 6];
       stats[i].average = avg = stats[i].sum_values / cnt;
       stats[i].variance = stats[i].sum_squares / cnt - avg * avg;
       stats[i].variance = SC_MAX (stats[i].variance, 0.);
       stats[i].variance_mean = stats[i].variance / cnt;
+      if (stats[i].histogram != NULL) {
+        memcpy (stats[i].histogram, flatout + rec * i + 7,
+                SC_STATS_HISTOGRAM_BINS * sizeof (*flatout));
+      }
     }
     stats[i].standev = sqrt (stats[i].variance);
     stats[i].standev_mean = sqrt (stats[i].variance_mean);
   }
+}
+
+#ifdef SC_ENABLE_MPI
+
+/* the datatypes for records without and with histogram and the operation
+   are created once and freed by sc_finalize */
+static int          sc_stats_mpi_created = 0;
+static sc_MPI_Datatype sc_stats_ctype[2];
+static sc_MPI_Op    sc_stats_op;
+
+static              sc_MPI_Datatype
+sc_stats_mpi_type (int rec)
+{
+  sc_stats_init_mpi ();
+  return sc_stats_ctype[rec > 7];
+}
+
+#endif /* SC_ENABLE_MPI */
+
+void
+sc_stats_init_mpi (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  if (sc_stats_mpi_created) {
+    return;
+  }
+
+  mpiret = MPI_Type_contiguous (7, MPI_DOUBLE, &sc_stats_ctype[0]);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_commit (&sc_stats_ctype[0]);
+  SC_CHECK_MPI (mpiret);
+
+  mpiret = MPI_Type_contiguous (7 + SC_STATS_HISTOGRAM_BINS, MPI_DOUBLE,
+                                &sc_stats_ctype[1]);
+  SC_CHECK_MPI (mpiret);
+  mpiret = MPI_Type_commit (&sc_stats_ctype[1]);
+  SC_CHECK_MPI (mpiret);
+
+  mpiret = MPI_Op_create ((MPI_User_function *) sc_stats_mpifunc, 1,
+                          &sc_stats_op);
+  SC_CHECK_MPI (mpiret);
+
+  sc_stats_mpi_created = 1;
+#endif
+}
+
+void
+sc_stats_finalize_mpi (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+  int                 finalized;
+
+  if (sc_stats_mpi_created) {
+    /* after MPI_Finalize the objects are gone anyway */
+    mpiret = MPI_Finalized (&finalized);
+    SC_CHECK_MPI (mpiret);
+    if (!finalized) {
+      mpiret = MPI_Op_free (&sc_stats_op);
+      SC_CHECK_MPI (mpiret);
+      mpiret = MPI_Type_free (&sc_stats_ctype[1]);
+      SC_CHECK_MPI (mpiret);
+      mpiret = MPI_Type_free (&sc_stats_ctype[0]);
+      SC_CHECK_MPI (mpiret);
+    }
+    sc_stats_mpi_created = 0;
+  }
+#endif
+}
+
+void
+sc_stats_compute (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
+{
+  int                 mpiret;
+  int                 rank;
+  int                 rec;
+  double             *flat;
+  double             *flatin;
+  double             *flatout;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  rec = sc_stats_record (nvars, stats);
+  flat = SC_ALLOC (double, 2 * rec * nvars);
+  flatin = flat;
+  flatout = flat + rec * nvars;
+
+  sc_stats_pack (rank, rec, nvars, stats, flatin);
+
+#ifndef SC_ENABLE_MPI
+  memcpy (flatout, flatin, rec * nvars * sizeof (*flatout));
+#else
+  mpiret = MPI_Allreduce (flatin, flatout, nvars, sc_stats_mpi_type (rec),
+                          sc_stats_op, mpicomm);
+  SC_CHECK_MPI (mpiret);
+#endif /* SC_ENABLE_MPI */
+
+  sc_stats_unpack (rec, nvars, stats, flatout);
 
   SC_FREE (flat);
 }
 
+struct sc_stats_request
+{
+  int                 nvars;
+  int                 rec;
+  sc_statinfo_t      *stats;
+  double             *flat;
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+  MPI_Request         request;
+#endif
+};
+
+sc_stats_request_t *
+sc_stats_icompute (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
+{
+  int                 mpiret;
+  int                 rank;
+  sc_stats_request_t *req;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* every pending computation needs its own buffers */
+  req = SC_ALLOC (sc_stats_request_t, 1);
+  req->nvars = nvars;
+  req->rec = sc_stats_record (nvars, stats);
+  req->stats = stats;
+  req->flat = SC_ALLOC (double, 2 * req->rec * nvars);
+
+  sc_stats_pack (rank, req->rec, nvars, stats, req->flat);
+
+#ifndef SC_ENABLE_MPI
+  memcpy (req->flat + req->rec * nvars, req->flat,
+          req->rec * nvars * sizeof (double));
+#elif MPI_VERSION >= 3
+  mpiret = MPI_Iallreduce (req->flat, req->flat + req->rec * nvars, nvars,
+                           sc_stats_mpi_type (req->rec), sc_stats_op,
+                           mpicomm, &req->request);
+  SC_CHECK_MPI (mpiret);
+#else
+  /* without non-blocking collectives the reduction is done right away */
+  mpiret = MPI_Allreduce (req->flat, req->flat + req->rec * nvars, nvars,
+                          sc_stats_mpi_type (req->rec), sc_stats_op,
+                          mpicomm);
+  SC_CHECK_MPI (mpiret);
+#endif
+
+  return req;
+}
+
+void
+sc_stats_icompute_wait (sc_stats_request_t * req)
+{
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+  int                 mpiret;
+
+  mpiret = MPI_Wait (&req->request, MPI_STATUS_IGNORE);
+  SC_CHECK_MPI (mpiret);
+#endif
+
+  sc_stats_unpack (req->rec, req->nvars, req->stats,
+                   req->flat + req->rec * req->nvars);
+
+  SC_FREE (req->flat);
+  SC_FREE (req);
+}
+
 void
 sc_stats_compute1 (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
 {
@@ -286,6 +553,7 @@ sc_stats_compute1 (sc_MPI_Comm mpicomm, int nvars, sc_statinfo_t * stats)
     stats[i].sum_squares = value * value;
     stats[i].min = value;
     stats[i].max = value;
+    stats[i].histogram = NULL;
   }
 
   sc_stats_compute (mpicomm, nvars, stats);
@@ -366,6 +634,12 @@ sc_stats_print_ext (int package_id, int log_priority,
       SC_GEN_LOGF (package_id, SC_LC_GLOBAL, log_priority,
                    "   Maximum attained at rank %7d: %g\n",
                    si->max_at_rank, si->max);
+      if (si->histogram != NULL) {
+        SC_GEN_LOGF (package_id, SC_LC_GLOBAL, log_priority,
+                     "   Percentiles 50/90/99:             %g %g %g\n",
+                     sc_stats_quantile (si, .5), sc_stats_quantile (si, .9),
+                     sc_stats_quantile (si, .99));
+      }
     }
   }
   else {
@@ -433,13 +707,35 @@ sc_stats_print_ext (int package_id, int log_priority,
 
 sc_statistics_t    *
 sc_statistics_new (sc_MPI_Comm mpicomm)
+{
+  return sc_statistics_new_ext (mpicomm, 0);
+}
+
+sc_statistics_t    *
+sc_statistics_new_ext (sc_MPI_Comm mpicomm, int thread_local)
 {
   sc_statistics_t    *stats;
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+#endif
 
   stats = SC_ALLOC (sc_statistics_t, 1);
   stats->mpicomm = mpicomm;
   stats->kv = sc_keyvalue_new ();
   stats->sarray = sc_array_new (sizeof (sc_statinfo_t));
+  stats->threads = NULL;
+
+#ifdef SC_ENABLE_PTHREAD
+  if (thread_local) {
+    /* the buffers outlive their threads until the container is destroyed */
+    stats->threads = SC_ALLOC (sc_stats_threads_t, 1);
+    pth = pthread_key_create (&stats->threads->key, NULL);
+    SC_CHECK_ABORT (pth == 0, "Statistics thread key");
+    pth = pthread_mutex_init (&stats->threads->mutex, NULL);
+    SC_CHECK_ABORT (pth == 0, "Statistics thread mutex");
+    sc_array_init (&stats->threads->buffers, sizeof (sc_array_t *));
+  }
+#endif
 
   return stats;
 }
@@ -447,13 +743,37 @@ sc_statistics_new (sc_MPI_Comm mpicomm)
 void
 sc_statistics_destroy (sc_statistics_t * stats)
 {
+  size_t              zz, iz;
+  sc_array_t         *buffer;
+  sc_stats_threads_t *st = stats->threads;
+
+  if (st != NULL) {
+#ifdef SC_ENABLE_PTHREAD
+    pthread_key_delete (st->key);
+    pthread_mutex_destroy (&st->mutex);
+#endif
+    for (zz = 0; zz < st->buffers.elem_count; ++zz) {
+      buffer = *(sc_array_t **) sc_array_index (&st->buffers, zz);
+      for (iz = 0; iz < buffer->elem_count; ++iz) {
+        sc_stats_set_histogram ((sc_statinfo_t *)
+                                sc_array_index (buffer, iz), 0);
+      }
+      sc_array_destroy (buffer);
+    }
+    sc_array_reset (&st->buffers);
+    SC_FREE (st);
+  }
+  for (zz = 0; zz < stats->sarray->elem_count; ++zz) {
+    sc_stats_set_histogram ((sc_statinfo_t *)
+                            sc_array_index (stats->sarray, zz), 0);
+  }
   sc_keyvalue_destroy (stats->kv);
   sc_array_destroy (stats->sarray);
 
   SC_FREE (stats);
 }
 
-void
+int
 sc_statistics_add (sc_statistics_t * stats, const char *name)
 {
   int                 i;
@@ -468,25 +788,50 @@ sc_statistics_add (sc_statistics_t * stats, const char *name)
   sc_stats_set1 (si, 0, name);
 
   sc_keyvalue_set_int (stats->kv, name, i);
+  return i;
 }
 
 void
 sc_statistics_set (sc_statistics_t * stats, const char *name, double value)
 {
   int                 i;
-  sc_statinfo_t      *si;
 
   i = sc_keyvalue_get_int (stats->kv, name, -1);
 
   /* always check for wrong usage and output adequate error message */
   SC_CHECK_ABORTF (i >= 0, "Statistics variable \"%s\" does not exist", name);
 
-  si = (sc_statinfo_t *) sc_array_index_int (stats->sarray, i);
+  sc_statistics_set_id (stats, i, value);
+}
 
-  sc_stats_set1 (si, value, name);
+void
+sc_statistics_set_id (sc_statistics_t * stats, int handle, double value)
+{
+  double             *histogram;
+  sc_statinfo_t      *si;
+
+  si = (sc_statinfo_t *) sc_array_index_int (stats->sarray, handle);
+
+  /* set1 does not know the histogram, so we restart it here */
+  histogram = si->histogram;
+  sc_stats_set1 (si, value, si->variable);
+  if (histogram != NULL) {
+    memset (histogram, 0, SC_STATS_HISTOGRAM_BINS * sizeof (*histogram));
+    histogram[sc_stats_histogram_bin (value)] = 1.;
+    si->histogram = histogram;
+  }
 }
 
 void
+sc_statistics_set_histogram (sc_statistics_t * stats, int handle,
+                             int enable)
+{
+  sc_stats_set_histogram ((sc_statinfo_t *)
+                          sc_array_index_int (stats->sarray, handle),
+                          enable);
+}
+
+int
 sc_statistics_add_empty (sc_statistics_t * stats, const char *name)
 {
   int                 i;
@@ -501,6 +846,7 @@ sc_statistics_add_empty (sc_statistics_t * stats, const char *name)
   sc_stats_init (si, name);
 
   sc_keyvalue_set_int (stats->kv, name, i);
+  return i;
 }
 
 int
@@ -509,26 +855,129 @@ sc_statistics_has (sc_statistics_t * stats, const char *name)
   return sc_keyvalue_exists (stats->kv, name);
 }
 
+int
+sc_statistics_handle (sc_statistics_t * stats, const char *name)
+{
+  return sc_keyvalue_get_int (stats->kv, name, -1);
+}
+
 void
 sc_statistics_accumulate (sc_statistics_t * stats, const char *name,
                           double value)
 {
   int                 i;
-  sc_statinfo_t      *si;
 
   i = sc_keyvalue_get_int (stats->kv, name, -1);
 
   /* always check for wrong usage and output adequate error message */
   SC_CHECK_ABORTF (i >= 0, "Statistics variable \"%s\" does not exist", name);
 
-  si = (sc_statinfo_t *) sc_array_index_int (stats->sarray, i);
+  sc_statistics_accumulate_id (stats, i, value);
+}
+
+#ifdef SC_ENABLE_PTHREAD
 
-  sc_stats_accumulate (si, value);
+/** Return the calling thread's buffer, large enough for the handle. */
+static sc_array_t  *
+sc_statistics_thread_buffer (sc_statistics_t * stats, int handle)
+{
+  size_t              zz, old_count;
+  sc_array_t         *buffer;
+  sc_stats_threads_t *st = stats->threads;
+
+  buffer = (sc_array_t *) pthread_getspecific (st->key);
+  if (buffer == NULL) {
+    buffer = sc_array_new (sizeof (sc_statinfo_t));
+    pthread_mutex_lock (&st->mutex);
+    *(sc_array_t **) sc_array_push (&st->buffers) = buffer;
+    pthread_mutex_unlock (&st->mutex);
+    pthread_setspecific (st->key, buffer);
+  }
+  if ((size_t) handle >= buffer->elem_count) {
+    old_count = buffer->elem_count;
+    sc_array_resize (buffer, (size_t) handle + 1);
+    for (zz = old_count; zz < buffer->elem_count; ++zz) {
+      sc_stats_init ((sc_statinfo_t *) sc_array_index (buffer, zz), NULL);
+    }
+  }
+  return buffer;
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+void
+sc_statistics_accumulate_id (sc_statistics_t * stats, int handle,
+                             double value)
+{
+  sc_array_t         *buffer = stats->sarray;
+#ifdef SC_ENABLE_PTHREAD
+  sc_statinfo_t      *si;
+#endif
+
+  SC_ASSERT (0 <= handle && (size_t) handle < stats->sarray->elem_count);
+
+#ifdef SC_ENABLE_PTHREAD
+  if (stats->threads != NULL) {
+    buffer = sc_statistics_thread_buffer (stats, handle);
+    si = (sc_statinfo_t *) buffer->array + handle;
+    if (si->histogram == NULL && ((sc_statinfo_t *) stats->sarray->array
+                                  + handle)->histogram != NULL) {
+      sc_stats_set_histogram (si, 1);
+    }
+  }
+#endif
+
+  sc_stats_accumulate ((sc_statinfo_t *) buffer->array + handle, value);
+}
+
+/** Add the local samples of one statinfo into another and reset it. */
+static void
+sc_stats_merge (sc_statinfo_t * stats, sc_statinfo_t * from)
+{
+  int                 b;
+
+  if (!from->count) {
+    return;
+  }
+  SC_ASSERT (stats->dirty);
+  if (stats->count) {
+    stats->count += from->count;
+    stats->sum_values += from->sum_values;
+    stats->sum_squares += from->sum_squares;
+    stats->min = SC_MIN (stats->min, from->min);
+    stats->max = SC_MAX (stats->max, from->max);
+  }
+  else {
+    stats->count = from->count;
+    stats->sum_values = from->sum_values;
+    stats->sum_squares = from->sum_squares;
+    stats->min = from->min;
+    stats->max = from->max;
+  }
+  if (stats->histogram != NULL && from->histogram != NULL) {
+    for (b = 0; b < SC_STATS_HISTOGRAM_BINS; ++b) {
+      stats->histogram[b] += from->histogram[b];
+    }
+  }
+  sc_stats_reset (from, 0);
 }
 
 void
 sc_statistics_compute (sc_statistics_t * stats)
 {
+  size_t              zz, iz;
+  sc_array_t         *buffer;
+
+  if (stats->threads != NULL) {
+    for (zz = 0; zz < stats->threads->buffers.elem_count; ++zz) {
+      buffer = *(sc_array_t **) sc_array_index (&stats->threads->buffers, zz);
+      for (iz = 0; iz < buffer->elem_count; ++iz) {
+        sc_stats_merge ((sc_statinfo_t *) sc_array_index (stats->sarray, iz),
+                        (sc_statinfo_t *) sc_array_index (buffer, iz));
+      }
+    }
+  }
+
   sc_stats_compute (stats->mpicomm, (int) stats->sarray->elem_count,
                     (sc_statinfo_t *) stats->sarray->array);
 }
@@ -39,6 +39,14 @@ extern const int    sc_stats_group_all;
 /** This special group number (negative) will refer to any priority. */
 extern const int    sc_stats_prio_all;
 
+/** Number of bins of the optional histogram of a random variable.
+ * The bins subdivide every power of two into four logarithmic intervals,
+ * covering positive values from 2^-40 to 2^24.  Smaller and non-positive
+ * values are counted in the first bin, larger ones in the last bin.
+ * Thus, quantiles are resolved to a relative accuracy of about 9%.
+ */
+#define SC_STATS_HISTOGRAM_BINS 256
+
 /** Store information of one random variable. */
 typedef struct sc_statinfo
 {
@@ -55,19 +63,28 @@ typedef struct sc_statinfo
   char               *variable_owned;   /**< NULL or deep copy of variable. */
   int                 group;            /**< Grouping identifier. */
   int                 prio;             /**< Priority identifier. */
+  double             *histogram;        /**< Inout; NULL or bin counts. */
 }
 sc_statinfo_t;
 
+/** Opaque per-thread accumulation buffers of a statistics container. */
+typedef struct sc_stats_threads sc_stats_threads_t;
+
 /** The statistics container allows dynamically adding random variables. */
 typedef struct sc_stats
 {
   sc_MPI_Comm         mpicomm;
   sc_keyvalue_t      *kv;
   sc_array_t         *sarray;
+  sc_stats_threads_t *threads;  /**< NULL or per-thread buffers. */
 }
 sc_statistics_t;
 
 /** Populate a sc_statinfo_t structure assuming count=1 and mark it dirty.
+ * The set1 and init functions treat \a stats as uninitialized memory.
+ * They set the histogram to NULL without reading it.  Thus, a histogram
+ * must be freed by \ref sc_stats_set_histogram before \a stats is set
+ * again, or the variable is restarted by \ref sc_stats_reset instead.
  * We set \ref sc_stats_group_all and \ref sc_stats_prio_all internally.
  * \param [out] stats          Will be filled with count=1 and the value.
  * \param [in] value           Value used to fill statistics information.
@@ -121,6 +138,7 @@ void                sc_stats_init_ext (sc_statinfo_t * stats,
                                        int stats_group, int stats_prio);
 
 /** Reset all values to zero, optionally unassign name, group, and priority.
+ * A histogram is kept allocated and its bins are zeroed.
  * \param [in,out] stats       Variables are zeroed.
  *                             They can be set again by set1 or accumulate.
  * \param [in] reset_vgp       If true, the variable name string is zeroed
@@ -139,6 +157,29 @@ void                sc_stats_reset (sc_statinfo_t * stats, int reset_vgp);
 void                sc_stats_set_group_prio (sc_statinfo_t * stats,
                                              int stats_group, int stats_prio);
 
+/** Allocate or free a histogram for an initialized random variable.
+ * With a histogram, \ref sc_stats_compute merges the bin counts of all
+ * processes and \ref sc_stats_quantile estimates arbitrary quantiles.
+ * The histogram must be enabled for the same variables on all processes.
+ * \param [in,out] stats       Initialized by set1 or init functions.
+ *                             If a new histogram is allocated, the current
+ *                             count must be zero or one.  With count one,
+ *                             the current value is entered.
+ * \param [in] enable          If true, allocate a histogram if none exists.
+ *                             If false, free the histogram if it exists.
+ */
+void                sc_stats_set_histogram (sc_statinfo_t * stats,
+                                            int enable);
+
+/** Estimate a quantile of the random variable from its histogram.
+ * The result is interpolated logarithmically inside the bin containing
+ * the quantile and clamped to the minimum and maximum of the values.
+ * \param [in] stats           Variable with histogram and positive count.
+ * \param [in] q               Quantile in [0, 1], such as 0.99.
+ * \return                     Estimate of the quantile.
+ */
+double              sc_stats_quantile (sc_statinfo_t * stats, double q);
+
 /** Add an instance of the random variable.
  * The counter of the variable is increased by one.
  * The value is added into the present values of the variable.
@@ -150,6 +191,8 @@ void                sc_stats_accumulate (sc_statinfo_t * stats, double value);
 /**
  * Compute global average and standard deviation.
  * Only updates dirty variables. Then removes the dirty flag.
+ * The MPI datatypes and operation are created once and cached until
+ * \ref sc_finalize.  The function is reentrant.
  * \param [in]     mpicomm   MPI communicator to use.
  * \param [in]     nvars     Number of variables to be examined.
  * \param [in,out] stats     Set of statisics items for each variable.
@@ -159,6 +202,8 @@ void                sc_stats_accumulate (sc_statinfo_t * stats, double value);
  *    sum_squares   Sum of squares for each process.
  *    min, max      Minimum and maximum of values for each process.
  *    variable      String describing the variable, or NULL.
+ *    histogram     NULL or enabled by \ref sc_stats_set_histogram.
+ *                  The set1 and init functions set it to NULL.
  * On output, the fields have the following meaning.
  *    count                        Global number of values.
  *    sum_values                   Global sum of values.
@@ -167,14 +212,38 @@ void                sc_stats_accumulate (sc_statinfo_t * stats, double value);
  *    min_at_rank, max_at_rank     The ranks that attain min and max.
  *    average, variance, standev   Global statistical measures.
  *    variance_mean, standev_mean  Statistical measures of the mean.
+ *    histogram                    If not NULL, global bin counts.
  */
 void                sc_stats_compute (sc_MPI_Comm mpicomm, int nvars,
                                       sc_statinfo_t * stats);
 
+/** Opaque handle of a pending \ref sc_stats_icompute. */
+typedef struct sc_stats_request sc_stats_request_t;
+
+/** Begin computing the global statistics without blocking.
+ * The reduction overlaps with work done before \ref sc_stats_icompute_wait.
+ * The local values of \a stats are read in this function; the array must
+ * remain valid until the request is completed.
+ * \param [in]     mpicomm   MPI communicator to use.
+ * \param [in]     nvars     Number of variables to be examined.
+ * \param [in]     stats     Set of statisics items as in \ref sc_stats_compute.
+ * \return                   Request to be completed by
+ *                           \ref sc_stats_icompute_wait.
+ */
+sc_stats_request_t *sc_stats_icompute (sc_MPI_Comm mpicomm, int nvars,
+                                       sc_statinfo_t * stats);
+
+/** Complete a request begun with \ref sc_stats_icompute.
+ * On output, the stats fields are set as with \ref sc_stats_compute.
+ * \param [in] request       Request is completed and freed.
+ */
+void                sc_stats_icompute_wait (sc_stats_request_t * request);
+
 /**
  * Version of sc_statistics_statistics that assumes count=1.
  * On input, the field sum_values needs to be set to the value
  * and the field variable must contain a valid string or NULL.
+ * No histograms are computed; the field histogram is set to NULL.
  * Only updates dirty variables. Then removes the dirty flag.
  */
 void                sc_stats_compute1 (sc_MPI_Comm mpicomm, int nvars,
@@ -216,7 +285,8 @@ void                sc_stats_print (int package_id, int log_priority,
  *                              and if the item's prio is less than this.
  * \param [in] full             Print full information for every variable.
  *                              This produces multiple lines including
- *                              minimum, maximum, and standard deviation.
+ *                              minimum, maximum, and standard deviation,
+ *                              and percentiles for histogram variables.
  *                              If this is false, print one line per variable.
  * \param [in] summary          Print summary information all on 1 line.
  *                              This always contains all variables.
@@ -231,6 +301,20 @@ void                sc_stats_print_ext (int package_id, int log_priority,
  */
 sc_statistics_t    *sc_statistics_new (sc_MPI_Comm mpicomm);
 
+/** Create a new statistics structure with optional per-thread buffers.
+ * \param [in] mpicomm         MPI communicator used for computing.
+ * \param [in] thread_local    If true and libsc is configured with pthreads,
+ *                             \ref sc_statistics_accumulate_id adds values
+ *                             into a buffer private to the calling thread.
+ *                             The buffers are merged by
+ *                             \ref sc_statistics_compute, which must not
+ *                             run concurrently with accumulation.
+ *                             Otherwise, accumulation is not thread safe.
+ * \return                     A statistics structure without variables.
+ */
+sc_statistics_t    *sc_statistics_new_ext (sc_MPI_Comm mpicomm,
+                                           int thread_local);
+
 /** Destroy a statistics structure.
  * \param [in,out] stats    Valid object is invalidated.
  */
@@ -238,19 +322,27 @@ void                sc_statistics_destroy (sc_statistics_t * stats);
 
 /** Register a statistics variable by name and set its value to 0.
  * This variable must not exist already.
+ * \return                     Handle for \ref sc_statistics_set_id.
  */
-void                sc_statistics_add (sc_statistics_t * stats,
+int                 sc_statistics_add (sc_statistics_t * stats,
                                        const char *name);
 
 /** Register a statistics variable by name and set its count to 0.
  * This variable must not exist already.
+ * \return                     Handle for \ref sc_statistics_accumulate_id.
  */
-void                sc_statistics_add_empty (sc_statistics_t * stats,
+int                 sc_statistics_add_empty (sc_statistics_t * stats,
                                              const char *name);
 
 /** Returns true if the stats include a variable with the given name */
 int                 sc_statistics_has (sc_statistics_t * stats,
                                        const char *name);
+
+/** Return the handle of a variable, which is its position in the container.
+ * \return                     Non-negative handle or -1 if not found.
+ */
+int                 sc_statistics_handle (sc_statistics_t * stats,
+                                          const char *name);
 /** Set the value of a statistics variable, see sc_stats_set1.
  * The variable must previously be added with sc_statistics_add.
  * This assumes count=1 as in the sc_stats_set1 function above.
@@ -258,13 +350,37 @@ int                 sc_statistics_has (sc_statistics_t * stats,
 void                sc_statistics_set (sc_statistics_t * stats,
                                        const char *name, double value);
 
+/** Allocate or free the histogram of a statistics variable.
+ * See \ref sc_stats_set_histogram.
+ * \param [in] handle          Returned by \ref sc_statistics_add_empty.
+ */
+void                sc_statistics_set_histogram (sc_statistics_t * stats,
+                                                 int handle, int enable);
+
+/** Set the value of a statistics variable given by its handle.
+ * This function avoids the name lookup of \ref sc_statistics_set.
+ * \param [in] handle          Returned by \ref sc_statistics_add.
+ */
+void                sc_statistics_set_id (sc_statistics_t * stats,
+                                          int handle, double value);
+
 /** Add an instance of a statistics variable, see sc_stats_accumulate
  * The variable must previously be added with sc_statistics_add_empty.
  */
 void                sc_statistics_accumulate (sc_statistics_t * stats,
                                               const char *name, double value);
 
+/** Add an instance of a statistics variable given by its handle.
+ * This function avoids the name lookup of \ref sc_statistics_accumulate.
+ * If the container was created with per-thread buffers, the value is
+ * added to the calling thread's buffer until \ref sc_statistics_compute.
+ * \param [in] handle          Returned by \ref sc_statistics_add_empty.
+ */
+void                sc_statistics_accumulate_id (sc_statistics_t * stats,
+                                                 int handle, double value);
+
 /** Compute statistics for all variables, see sc_stats_compute.
+ * Per-thread buffers are merged into the variables first and emptied.
  */
 void                sc_statistics_compute (sc_statistics_t * stats);
 
@@ -0,0 +1,173 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_amr.h>
+
+#define TEST_NUM_ELEMENTS 10000
+
+typedef struct test_amr
+{
+  long                num_elements;
+  long                num_calls;
+}
+test_amr_t;
+
+/* coarsening a family of eight removes seven elements */
+static long
+test_count_coarsen (sc_amr_control_t * amr, void *user_data)
+{
+  test_amr_t         *t = (test_amr_t *) user_data;
+  long                i, n = 0;
+
+  ++t->num_calls;
+  for (i = 0; i < t->num_elements; ++i) {
+    n += (amr->errors[i] < amr->coarsen_threshold);
+  }
+  return n * 7 / 8;
+}
+
+/* refining an element adds seven elements */
+static long
+test_count_refine (sc_amr_control_t * amr, void *user_data)
+{
+  test_amr_t         *t = (test_amr_t *) user_data;
+  long                i, n = 0;
+
+  ++t->num_calls;
+  for (i = 0; i < t->num_elements; ++i) {
+    n += (amr->errors[i] > amr->refine_threshold);
+  }
+  return 7 * n;
+}
+
+/* refine to about twice the number of elements */
+static void
+test_refine (sc_amr_control_t * amr, test_amr_t * t, double window)
+{
+  const long          num_total = amr->num_total_elements;
+  const long          high = 2 * num_total;
+  const long          low = (long) (high * window);
+
+  t->num_calls = 0;
+  amr->num_total_coarsen = 0;
+  sc_amr_refine_histogram (sc_package_id, amr, high, window,
+                           test_count_refine, t);
+  SC_CHECK_ABORT (t->num_calls <= 2, "Refine rounds");
+  SC_CHECK_ABORT (low <= amr->num_total_estimated &&
+                  amr->num_total_estimated <= high, "Refine window");
+  SC_CHECK_ABORT (amr->num_total_estimated ==
+                  num_total + amr->num_total_refine, "Refine estimate");
+}
+
+int
+main (int argc, char **argv)
+{
+  const double        window = .9;
+  int                 mpiret;
+  int                 mpirank;
+  long                i, num_total, low, high;
+  double             *errors, *scaled;
+  sc_amr_control_t    amr, ref;
+  test_amr_t          t;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* errors spread over several orders of magnitude */
+  srand (17 + mpirank);
+  t.num_elements = TEST_NUM_ELEMENTS;
+  errors = SC_ALLOC (double, t.num_elements);
+  for (i = 0; i < t.num_elements; ++i) {
+    errors[i] = exp (-10. * rand () / (double) RAND_MAX);
+  }
+
+  /* the histogram does not change the statistics */
+  sc_amr_error_stats (sc_MPI_COMM_WORLD, t.num_elements, errors, &ref);
+  SC_CHECK_ABORT (ref.histogram == NULL, "No histogram");
+  sc_amr_error_histogram (sc_MPI_COMM_WORLD, t.num_elements, errors, &amr);
+  SC_CHECK_ABORT (amr.histogram != NULL, "Histogram");
+  SC_CHECK_ABORT (amr.num_total_elements == ref.num_total_elements &&
+                  amr.estats.min == ref.estats.min &&
+                  amr.estats.max == ref.estats.max, "Statistics");
+  sc_amr_reset (&ref);
+  num_total = amr.num_total_elements;
+
+  /* the structure is computed again after freeing the histogram */
+  sc_amr_reset (&amr);
+  SC_CHECK_ABORT (amr.histogram == NULL, "Reset");
+  sc_amr_error_histogram (sc_MPI_COMM_WORLD, t.num_elements, errors, &amr);
+  SC_CHECK_ABORT (amr.histogram != NULL &&
+                  amr.num_total_elements == num_total, "Histogram again");
+  test_refine (&amr, &t, window);
+
+  /* coarsen to about half the number of elements without refinement */
+  amr.num_total_refine = 0;
+  low = num_total / 2;
+  high = (long) (low / window);
+  t.num_calls = 0;
+  sc_amr_coarsen_histogram (sc_package_id, &amr, low, window,
+                            test_count_coarsen, &t);
+  SC_CHECK_ABORT (t.num_calls <= 2, "Coarsen rounds");
+  SC_CHECK_ABORT (low <= amr.num_total_estimated &&
+                  amr.num_total_estimated <= high, "Coarsen window");
+  SC_CHECK_ABORT (amr.num_total_estimated ==
+                  num_total - amr.num_total_coarsen, "Coarsen estimate");
+
+  /* nothing to do if the mesh is small enough already */
+  t.num_calls = 0;
+  amr.num_total_refine = amr.num_total_coarsen = 0;
+  sc_amr_coarsen_histogram (sc_package_id, &amr, 2 * num_total, window,
+                            test_count_coarsen, &t);
+  SC_CHECK_ABORT (t.num_calls == 0 && amr.num_total_coarsen == 0 &&
+                  amr.num_total_estimated == num_total, "Coarsen skip");
+  sc_amr_reset (&amr);
+
+  /* the bins follow errors of any magnitude and sign */
+  scaled = SC_ALLOC (double, t.num_elements);
+  for (i = 0; i < t.num_elements; ++i) {
+    scaled[i] = 1e30 * errors[i];
+  }
+  sc_amr_error_histogram (sc_MPI_COMM_WORLD, t.num_elements, scaled, &amr);
+  test_refine (&amr, &t, window);
+  sc_amr_reset (&amr);
+  for (i = 0; i < t.num_elements; ++i) {
+    scaled[i] = log (errors[i]);
+  }
+  sc_amr_error_histogram (sc_MPI_COMM_WORLD, t.num_elements, scaled, &amr);
+  SC_CHECK_ABORT (amr.estats.min < 0., "Negative errors");
+  test_refine (&amr, &t, window);
+  sc_amr_reset (&amr);
+  SC_FREE (scaled);
+  SC_FREE (errors);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
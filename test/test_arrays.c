@@ -22,6 +22,10 @@
 */
 
 #include <sc_containers.h>
+#include <sc_uint128.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
 
 static              ssize_t
 sc_array_bsearch_range (sc_array_t * array, size_t begin, size_t end,
@@ -144,6 +148,289 @@ test_mstamp (void)
   }
 }
 
+#ifdef SC_ENABLE_PTHREAD
+
+static void        *
+test_mempool_thread (void *v)
+{
+  sc_mempool_t       *mempool = (sc_mempool_t *) v;
+  int                 i, j;
+  int                *pi[100];
+
+  for (j = 0; j < 50; ++j) {
+    for (i = 0; i < 100; ++i) {
+      pi[i] = (int *) sc_mempool_alloc (mempool);
+      *pi[i] = i;
+    }
+    for (i = 0; i < 100; ++i) {
+      SC_CHECK_ABORT (*pi[i] == i, "Mempool thread element");
+      sc_mempool_free (mempool, pi[i]);
+    }
+  }
+  return NULL;
+}
+
+#endif
+
+static void
+test_mempool (void)
+{
+  int                 i, j;
+  char               *pc[10];
+  double             *pd;
+  sc_mempool_t       *mempool;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_t           threads[4];
+#endif
+
+  /* elements smaller than a pointer are recycled through the free list */
+  mempool = sc_mempool_new (2);
+  for (i = 0; i < 10; ++i) {
+    pc[i] = (char *) sc_mempool_alloc (mempool);
+  }
+  for (i = 0; i < 10; ++i) {
+    sc_mempool_free (mempool, pc[i]);
+  }
+  SC_CHECK_ABORT (mempool->elem_count == 0, "Mempool count");
+  SC_CHECK_ABORT (mempool->freed.elem_count == 0, "Mempool free list");
+  for (i = 9; i >= 0; --i) {
+    SC_CHECK_ABORT (sc_mempool_alloc (mempool) == pc[i], "Mempool reuse");
+  }
+  sc_mempool_truncate (mempool);
+  SC_CHECK_ABORT (sc_mempool_alloc (mempool) != NULL, "Mempool truncate");
+  sc_mempool_destroy (mempool);
+
+  /* concurrent allocation through per-thread magazines */
+  mempool = sc_mempool_new_threadsafe (sizeof (int));
+#ifdef SC_ENABLE_PTHREAD
+  for (i = 0; i < 4; ++i) {
+    SC_CHECK_ABORT (pthread_create (&threads[i], NULL,
+                                    test_mempool_thread, mempool) == 0,
+                    "Mempool thread create");
+  }
+  for (i = 0; i < 4; ++i) {
+    SC_CHECK_ABORT (pthread_join (threads[i], NULL) == 0,
+                    "Mempool thread join");
+  }
+#endif
+  sc_mempool_flush (mempool);
+  SC_CHECK_ABORT (mempool->elem_count == 0, "Mempool flush");
+  SC_GLOBAL_INFOF ("Memory used D %lld\n",
+                   (long long) sc_mempool_memory_used (mempool));
+  sc_mempool_destroy (mempool);
+
+  /* large stamps on huge pages that are released on truncate */
+  for (j = 0; j < 2; ++j) {
+    mempool = sc_mempool_new_stamp (sizeof (double), j, 3 << 20,
+                                    SC_MSTAMP_HUGEPAGE |
+                                    (j ? SC_MSTAMP_FIRST_TOUCH : 0));
+    for (i = 0; i < 500000; ++i) {
+      pd = (double *) sc_mempool_alloc (mempool);
+      SC_CHECK_ABORT (!j || *pd == 0., "Mempool stamp zero");
+      *pd = (double) i;
+    }
+    SC_CHECK_ABORT (sc_mempool_memory_resident (mempool) <=
+                    sc_mempool_memory_used (mempool), "Mempool resident");
+    SC_GLOBAL_INFOF ("Memory used E %lld resident %lld\n",
+                     (long long) sc_mempool_memory_used (mempool),
+                     (long long) sc_mempool_memory_resident (mempool));
+    sc_mempool_truncate (mempool);
+    pd = (double *) sc_mempool_alloc (mempool);
+    SC_CHECK_ABORT (!j || *pd == 0., "Mempool truncate zero");
+    SC_GLOBAL_INFOF ("Memory used F %lld resident %lld\n",
+                     (long long) sc_mempool_memory_used (mempool),
+                     (long long) sc_mempool_memory_resident (mempool));
+    sc_mempool_destroy (mempool);
+  }
+}
+
+typedef struct test_split_data
+{
+  int                 shift;
+  size_t              mask;
+}
+test_split_data_t;
+
+/* reference type function for keys stored as 12-byte elements */
+static              size_t
+test_split_type (sc_array_t * array, size_t index, void *data)
+{
+  test_split_data_t  *sd = (test_split_data_t *) data;
+  sc_uint128_t        key;
+
+  memcpy (&key, sc_array_index (array, index), sizeof (sc_uint128_t));
+  if (sd->shift >= 64) {
+    return (size_t) (key.high_bits >> (sd->shift - 64)) & sd->mask;
+  }
+  return (size_t) ((key.low_bits >> sd->shift) |
+                   (sd->shift > 0 ? key.high_bits << (64 - sd->shift) : 0))
+    & sd->mask;
+}
+
+static void
+test_split_key (void)
+{
+  const int           shifts[4] = { 0, 62, 63, 70 };
+  const size_t        N = 3000;
+  int                 i;
+  size_t              zz, zs;
+  uint32_t            u32;
+  sc_uint128_t        key;
+  sc_array_t         *a, *b, *o1, *o2, *bounds;
+  test_split_data_t   sd;
+
+  /* 128bit keys sorted by all bits, followed by 8 bytes padding */
+  a = sc_array_new_count (sizeof (sc_uint128_t) + 8, N);
+  for (zz = 0; zz < N; ++zz) {
+    sc_uint128_init (&key, (uint64_t) (zz / 500),
+                     (uint64_t) (zz % 500) << 55 | (uint64_t) zz << 18);
+    memcpy (sc_array_index (a, zz), &key, sizeof (sc_uint128_t));
+  }
+  o1 = sc_array_new (sizeof (size_t));
+  o2 = sc_array_new (sizeof (size_t));
+  bounds = sc_array_new (sizeof (size_t));
+
+  for (i = 0; i < 4; ++i) {
+    /* the keys are sorted by type within each subarray of 500 entries */
+    sd.shift = shifts[i];
+    sd.mask = 7;
+    for (zs = 0; zs <= N; zs += 500) {
+      *(size_t *) sc_array_push (bounds) = zs;
+    }
+    sc_array_split_key_multi (a, bounds, o1, 8, SC_ARRAY_KEY_UINT128, 0,
+                              sd.shift);
+    SC_CHECK_ABORT (o1->elem_count == 6 * 8 + 1, "Split multi count");
+    for (zs = 0; zs < 6; ++zs) {
+      b = sc_array_new_view (a, 500 * zs, 500);
+      sc_array_split (b, o2, 8, test_split_type, &sd);
+      for (zz = 0; zz <= 8; ++zz) {
+        SC_CHECK_ABORT (*(size_t *) sc_array_index (o1, 8 * zs + zz) ==
+                        500 * zs + *(size_t *) sc_array_index (o2, zz),
+                        "Split multi");
+      }
+      sc_array_split_key (b, o2, 8, SC_ARRAY_KEY_UINT128, 0, sd.shift);
+      for (zz = 0; zz <= 8; ++zz) {
+        SC_CHECK_ABORT (*(size_t *) sc_array_index (o1, 8 * zs + zz) ==
+                        500 * zs + *(size_t *) sc_array_index (o2, zz),
+                        "Split key");
+      }
+      sc_array_destroy (b);
+    }
+    sc_array_reset (bounds);
+  }
+
+  /* the whole array is sorted by the high bits */
+  sd.shift = 64;
+  sd.mask = 7;
+  sc_array_split (a, o2, 8, test_split_type, &sd);
+  sc_array_split_key (a, o1, 8, SC_ARRAY_KEY_UINT128, 0, 64);
+  SC_CHECK_ABORT (sc_array_is_equal (o1, o2), "Split key high");
+  sc_array_split_key (a, o1, 8, SC_ARRAY_KEY_UINT64,
+                      offsetof (sc_uint128_t, high_bits), 0);
+  for (zz = 0; zz <= 8; ++zz) {
+    SC_CHECK_ABORT (*(size_t *) sc_array_index (o1, zz) ==
+                    SC_MIN (500 * zz, N), "Split key uint64");
+  }
+
+  /* 32bit keys at an unaligned offset */
+  b = sc_array_new_count (7, N);
+  for (zz = 0; zz < N; ++zz) {
+    u32 = (uint32_t) zz << 2;
+    memcpy ((char *) sc_array_index (b, zz) + 3, &u32, sizeof (uint32_t));
+  }
+  sc_array_split_key (b, o1, 16, SC_ARRAY_KEY_UINT32, 3, 10);
+  for (zz = 0; zz <= 16; ++zz) {
+    SC_CHECK_ABORT (*(size_t *) sc_array_index (o1, zz) ==
+                    SC_MIN (256 * zz, N), "Split key uint32");
+  }
+  sc_array_destroy (b);
+
+  sc_array_destroy (a);
+  sc_array_destroy (o1);
+  sc_array_destroy (o2);
+  sc_array_destroy (bounds);
+}
+
+static void
+test_permute_multi (void)
+{
+  const size_t        N = 2500;
+  size_t              zz, zj, t;
+  size_t             *perm;
+  char                cbuf[3 * 2500];
+  sc_array_t         *newind, *d, *c, *v, *ids, *g;
+  sc_array_t         *arrays[3];
+
+  /* a random permutation */
+  newind = sc_array_new_count (sizeof (size_t), N);
+  perm = (size_t *) newind->array;
+  for (zz = 0; zz < N; ++zz) {
+    perm[zz] = zz;
+  }
+  for (zz = N - 1; zz > 0; --zz) {
+    zj = (size_t) rand () % (zz + 1);
+    t = perm[zz];
+    perm[zz] = perm[zj];
+    perm[zj] = t;
+  }
+
+  /* owned arrays and a view of different element sizes */
+  d = sc_array_new_count (sizeof (double), N);
+  c = sc_array_new_count (3, N);
+  v = sc_array_new_data (cbuf, 3, N);
+  for (zz = 0; zz < N; ++zz) {
+    *(double *) sc_array_index (d, zz) = (double) zz;
+    memset (sc_array_index (c, zz), (int) (zz % 251), 3);
+    memset (sc_array_index (v, zz), (int) (zz % 241), 3);
+  }
+  arrays[0] = d;
+  arrays[1] = c;
+  arrays[2] = v;
+  sc_array_permute_multi (arrays, 3, newind);
+  for (zz = 0; zz < N; ++zz) {
+    zj = perm[zz];
+    SC_CHECK_ABORT (*(double *) sc_array_index (d, zj) == (double) zz,
+                    "Permute multi double");
+    SC_CHECK_ABORT (((char *) sc_array_index (c, zj))[2] ==
+                    (char) (zz % 251), "Permute multi owned");
+    SC_CHECK_ABORT (((char *) sc_array_index (v, zj))[1] ==
+                    (char) (zz % 241), "Permute multi view");
+  }
+  SC_CHECK_ABORT (sc_array_is_permutation (newind), "Permute multi keep");
+
+  /* gather through the permutation undoes it, scatter repeats it */
+  ids = sc_array_new (sizeof (double));
+  sc_array_gather (ids, d, newind);
+  for (zz = 0; zz < N; ++zz) {
+    SC_CHECK_ABORT (*(double *) sc_array_index (ids, zz) == (double) zz,
+                    "Gather");
+  }
+  g = sc_array_new_count (sizeof (double), N);
+  sc_array_scatter (g, ids, newind);
+  SC_CHECK_ABORT (!memcmp (g->array, d->array, N * sizeof (double)),
+                  "Scatter");
+
+  /* gather a few elements as for a halo */
+  sc_array_resize (newind, 3);
+  perm = (size_t *) newind->array;
+  perm[0] = N - 1;
+  perm[1] = 0;
+  perm[2] = N / 2;
+  sc_array_gather (g, ids, newind);
+  SC_CHECK_ABORT (g->elem_count == 3 &&
+                  *(double *) sc_array_index (g, 0) == (double) (N - 1) &&
+                  *(double *) sc_array_index (g, 1) == 0. &&
+                  *(double *) sc_array_index (g, 2) == (double) (N / 2),
+                  "Gather halo");
+
+  sc_array_destroy (newind);
+  sc_array_destroy (d);
+  sc_array_destroy (c);
+  sc_array_destroy (v);
+  sc_array_destroy (ids);
+  sc_array_destroy (g);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -272,6 +559,9 @@ main (int argc, char **argv)
   SC_FREE (data);
 
   test_mstamp ();
+  test_mempool ();
+  test_split_key ();
+  test_permute_multi ();
 
   sc_finalize ();
 
@@ -0,0 +1,98 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_avl.h>
+
+static int
+test_compare (const void *v1, const void *v2)
+{
+  return sc_int_compare (v1, v2);
+}
+
+int
+main (int argc, char **argv)
+{
+  const int           N = 1000;
+  int                 i;
+  int                *data, key;
+  unsigned int        r;
+  avl_node_t         *node;
+  avl_tree_t         *tree;
+  sc_array_t         *items;
+  sc_mempool_t       *pool;
+
+  sc_init (sc_MPI_COMM_NULL, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* even numbers as sorted items */
+  data = SC_ALLOC (int, N);
+  items = sc_array_new_count (sizeof (void *), (size_t) N);
+  for (i = 0; i < N; ++i) {
+    data[i] = 2 * i;
+    *(void **) sc_array_index_int (items, i) = &data[i];
+  }
+
+  /* bulk build into pooled nodes and check order statistics */
+  pool = sc_mempool_new (sizeof (avl_node_t));
+  tree = avl_alloc_tree (test_compare, NULL);
+  avl_set_allocator (tree, pool);
+  avl_from_array (tree, items);
+  SC_CHECK_ABORT (avl_count (tree) == (unsigned int) N, "Bulk count");
+  SC_CHECK_ABORT (pool->elem_count == (size_t) N, "Pool count");
+  for (i = 0; i < N; ++i) {
+    node = avl_at (tree, (unsigned int) i);
+    SC_CHECK_ABORT (node != NULL && node->item == &data[i], "Select");
+    SC_CHECK_ABORT (avl_index (node) == (unsigned int) i, "Index");
+    key = 2 * i + 1;
+    r = avl_rank (tree, &key);
+    SC_CHECK_ABORT (r == (unsigned int) i + 1, "Rank odd");
+    r = avl_rank (tree, &data[i]);
+    SC_CHECK_ABORT (r == (unsigned int) i, "Rank even");
+  }
+
+  /* the tree built in bulk stays balanced under updates */
+  for (i = 0; i < N; i += 3) {
+    SC_CHECK_ABORT (avl_delete (tree, &data[i]) == &data[i], "Delete");
+  }
+  for (i = 0; i < N; i += 3) {
+    SC_CHECK_ABORT (avl_insert (tree, &data[i]) != NULL, "Insert");
+  }
+  SC_CHECK_ABORT (avl_search (tree, &data[N / 2]) != NULL, "Search");
+
+  /* extracting in order empties the tree and returns all nodes */
+  avl_extract_array (tree, items);
+  SC_CHECK_ABORT (avl_count (tree) == 0, "Extract count");
+  SC_CHECK_ABORT (pool->elem_count == 0, "Extract pool");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (*(int **) sc_array_index_int (items, i) == &data[i],
+                    "Extract order");
+  }
+
+  avl_free_tree (tree);
+  sc_mempool_destroy (pool);
+  sc_array_destroy (items);
+  SC_FREE (data);
+
+  sc_finalize ();
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_base64.h>
+
+static const char   test_alphabet[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* straightforward encoder to compare against */
+static size_t
+test_reference (const unsigned char *in, size_t n, char *out)
+{
+  size_t              zz, k;
+  unsigned long       w;
+
+  for (zz = 0, k = 0; zz < n; zz += 3) {
+    w = (unsigned long) in[zz] << 16;
+    if (zz + 1 < n) {
+      w |= (unsigned long) in[zz + 1] << 8;
+    }
+    if (zz + 2 < n) {
+      w |= (unsigned long) in[zz + 2];
+    }
+    out[k++] = test_alphabet[(w >> 18) & 63];
+    out[k++] = test_alphabet[(w >> 12) & 63];
+    out[k++] = zz + 1 < n ? test_alphabet[(w >> 6) & 63] : '=';
+    out[k++] = zz + 2 < n ? test_alphabet[w & 63] : '=';
+  }
+  return k;
+}
+
+/* encode, compare with the reference, decode and compare with the input */
+static void
+test_roundtrip (const unsigned char *in, size_t n)
+{
+  size_t              elen, dlen, rlen;
+  char               *enc, *ref;
+  unsigned char      *dec;
+
+  enc = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n) + 1);
+  ref = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n) + 1);
+  dec = SC_ALLOC (unsigned char, n + 3);
+
+  elen = sc_base64_encode (in, n, enc);
+  rlen = test_reference (in, n, ref);
+  SC_CHECK_ABORT (elen == rlen && elen == SC_BASE64_ENCODED_LENGTH (n),
+                  "Encode length");
+  SC_CHECK_ABORT (!memcmp (enc, ref, elen), "Encode mismatch");
+
+  SC_CHECK_ABORT (!sc_base64_decode (enc, elen, dec, &dlen), "Decode");
+  SC_CHECK_ABORT (dlen == n && !memcmp (dec, in, n), "Decode mismatch");
+
+  /* the same code without padding decodes identically */
+  while (elen > 0 && enc[elen - 1] == '=') {
+    --elen;
+  }
+  SC_CHECK_ABORT (!sc_base64_decode (enc, elen, dec, &dlen), "Unpadded");
+  SC_CHECK_ABORT (dlen == n && !memcmp (dec, in, n), "Unpadded mismatch");
+
+  SC_FREE (dec);
+  SC_FREE (ref);
+  SC_FREE (enc);
+}
+
+/* streaming in random pieces must match the one-shot encoding */
+static void
+test_stream (const unsigned char *in, size_t n)
+{
+  size_t              zz, piece, elen, slen;
+  char               *enc, *str;
+  sc_base64_state_t   state;
+
+  enc = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n));
+  str = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n) + 4);
+  elen = sc_base64_encode (in, n, enc);
+
+  sc_base64_encode_init (&state);
+  for (zz = 0, slen = 0; zz < n; zz += piece) {
+    piece = (size_t) (rand () % 200);
+    piece = SC_MIN (piece, n - zz);
+    slen += sc_base64_encode_block (&state, in + zz, piece, str + slen);
+  }
+  slen += sc_base64_encode_blockend (&state, str + slen);
+  SC_CHECK_ABORT (slen == elen && !memcmp (enc, str, elen), "Stream");
+
+  SC_FREE (str);
+  SC_FREE (enc);
+}
+
+/* a single bad character anywhere must be reported */
+static void
+test_invalid (const unsigned char *in, size_t n)
+{
+  const char          bad[] = { '!', '-', '_', '\n', '\0', (char) 0x80 };
+  size_t              elen, dlen, pos;
+  char               *enc, save;
+  unsigned char      *dec;
+  int                 i;
+
+  enc = SC_ALLOC (char, SC_BASE64_ENCODED_LENGTH (n));
+  dec = SC_ALLOC (unsigned char, n + 3);
+  elen = sc_base64_encode (in, n, enc);
+  SC_ASSERT (elen >= 8);
+
+  for (i = 0; i < (int) sizeof (bad); ++i) {
+    pos = (size_t) rand () % (elen - 4);
+    save = enc[pos];
+    enc[pos] = bad[i];
+    SC_CHECK_ABORT (sc_base64_decode (enc, elen, dec, &dlen) == -1,
+                    "Invalid character");
+    enc[pos] = save;
+  }
+
+  /* padding in the middle and a dangling character are errors */
+  save = enc[0];
+  enc[0] = '=';
+  SC_CHECK_ABORT (sc_base64_decode (enc, elen, dec, &dlen) == -1,
+                  "Early padding");
+  enc[0] = save;
+  SC_CHECK_ABORT (sc_base64_decode (enc, 5, dec, &dlen) == -1, "Dangling");
+
+  SC_FREE (dec);
+  SC_FREE (enc);
+}
+
+int
+main (int argc, char **argv)
+{
+  const size_t        big = 100003;
+  size_t              zz, n;
+  unsigned char      *data;
+
+  sc_init (sc_MPI_COMM_NULL, 1, 1, NULL, SC_LP_DEFAULT);
+
+  data = SC_ALLOC (unsigned char, big);
+  srand (4711);
+  for (zz = 0; zz < big; ++zz) {
+    data[zz] = (unsigned char) rand ();
+  }
+
+  /* every short length covers all vector block and tail combinations */
+  for (n = 0; n <= 300; ++n) {
+    test_roundtrip (data, n);
+    test_stream (data, n);
+  }
+  for (n = big - 2; n <= big; ++n) {
+    test_roundtrip (data + (big - n), n);
+    test_stream (data, n);
+  }
+  for (n = 6; n <= 300; n += 7) {
+    test_invalid (data, n);
+  }
+  test_invalid (data, big);
+
+  SC_FREE (data);
+
+  sc_finalize ();
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_deflate.h>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* fill a buffer with data of varying compressibility */
+static void
+test_fill (unsigned char *data, size_t n, int kind)
+{
+  static const char   words[] = "the quick brown fox jumps over a lazy dog ";
+  size_t              zz;
+
+  for (zz = 0; zz < n; ++zz) {
+    switch (kind) {
+    case 0:
+      data[zz] = (unsigned char) rand ();
+      break;
+    case 1:
+      data[zz] = (unsigned char) words[(zz * 7 + zz / 50) %
+                                       (sizeof (words) - 1)];
+      break;
+    case 2:
+      data[zz] = 0;
+      break;
+    default:
+      data[zz] = (unsigned char) (rand () % 4 == 0 ? rand () :
+                                  (int) (zz / 1000));
+    }
+  }
+}
+
+/* compress in one call or in pieces and decompress both ways */
+static void
+test_roundtrip (const unsigned char *data, size_t n, int pieces)
+{
+  size_t              zz, piece, clen, in_bytes, out_bytes;
+  char               *comp;
+  unsigned char      *dec;
+  sc_array_t         *arr;
+
+  comp = SC_ALLOC (char, SC_DEFLATE_BOUND (n) + 2 * pieces *
+                   SC_DEFLATE_BOUND (0));
+  clen = 0;
+  for (zz = 0; pieces > 1 && zz < n; zz += piece) {
+    piece = 1 + (size_t) rand () % (2 * n / pieces + 1);
+    piece = SC_MIN (piece, n - zz);
+    clen += sc_deflate (data + zz, piece, 0, comp + clen);
+  }
+  SC_ASSERT (pieces > 1 || zz == 0);
+  clen += sc_deflate (data + zz, n - zz, 1, comp + clen);
+  SC_CHECK_ABORT (pieces > 1 || clen <= SC_DEFLATE_BOUND (n), "Bound");
+
+  /* the input may continue after the stream */
+  dec = SC_ALLOC (unsigned char, n + 1);
+  in_bytes = clen + 1;
+  out_bytes = n;
+  SC_CHECK_ABORT (!sc_inflate (comp, &in_bytes, dec, &out_bytes), "Inflate");
+  SC_CHECK_ABORT (in_bytes == clen && out_bytes == n &&
+                  !memcmp (dec, data, n), "Inflate mismatch");
+
+  /* decoding to an array appends */
+  arr = sc_array_new_count (1, 3);
+  in_bytes = clen;
+  SC_CHECK_ABORT (!sc_inflate_array (comp, &in_bytes, arr), "Array");
+  SC_CHECK_ABORT (in_bytes == clen && arr->elem_count == n + 3 &&
+                  !memcmp (arr->array + 3, data, n), "Array mismatch");
+
+  /* too little room and truncated input are errors */
+  if (n > 0) {
+    out_bytes = n - 1;
+    in_bytes = clen;
+    SC_CHECK_ABORT (sc_inflate (comp, &in_bytes, dec, &out_bytes) == -1,
+                    "Room");
+  }
+  in_bytes = clen - 1;
+  out_bytes = n;
+  SC_CHECK_ABORT (sc_inflate (comp, &in_bytes, dec, &out_bytes) == -1,
+                  "Truncated");
+  in_bytes = clen - 1;
+  SC_CHECK_ABORT (sc_inflate_array (comp, &in_bytes, arr) == -1 &&
+                  arr->elem_count == n + 3, "Array truncated");
+
+  sc_array_destroy (arr);
+  SC_FREE (dec);
+  SC_FREE (comp);
+}
+
+#ifdef SC_HAVE_ZLIB
+
+/* streams compressed by zlib use dynamic codes that we must decode */
+static void
+test_zlib (const unsigned char *data, size_t n)
+{
+  int                 level;
+  size_t              in_bytes, out_bytes, clen;
+  uLongf              zlen;
+  uLong               adler;
+  unsigned char      *comp, *dec;
+
+  zlen = compressBound ((uLong) n);
+  clen = SC_MAX ((size_t) zlen, 2 + SC_DEFLATE_BOUND (n) + 4);
+  comp = SC_ALLOC (unsigned char, clen);
+  dec = SC_ALLOC (unsigned char, n + 1);
+  for (level = 1; level <= 9; level += 4) {
+    zlen = (uLongf) clen;
+    SC_CHECK_ABORT (compress2 (comp, &zlen, data, (uLong) n, level) == Z_OK,
+                    "Compress");
+    in_bytes = (size_t) zlen - 6;
+    out_bytes = n;
+    SC_CHECK_ABORT (!sc_inflate (comp + 2, &in_bytes, dec, &out_bytes) &&
+                    in_bytes == (size_t) zlen - 6 && out_bytes == n &&
+                    !memcmp (dec, data, n), "Inflate zlib");
+  }
+
+  /* our output with the zlib header and checksum is read by zlib */
+  comp[0] = 0x78;
+  comp[1] = 0x01;
+  in_bytes = sc_deflate (data, n, 1, comp + 2);
+  adler = adler32 (adler32 (0, Z_NULL, 0), data, (uInt) n);
+  comp[2 + in_bytes] = (unsigned char) (adler >> 24);
+  comp[3 + in_bytes] = (unsigned char) (adler >> 16);
+  comp[4 + in_bytes] = (unsigned char) (adler >> 8);
+  comp[5 + in_bytes] = (unsigned char) adler;
+  zlen = (uLongf) n;
+  SC_CHECK_ABORT (uncompress (dec, &zlen, comp, (uLong) in_bytes + 6) ==
+                  Z_OK && zlen == (uLongf) n && !memcmp (dec, data, n),
+                  "Uncompress");
+
+  SC_FREE (dec);
+  SC_FREE (comp);
+}
+
+#endif /* SC_HAVE_ZLIB */
+
+int
+main (int argc, char **argv)
+{
+  const size_t        sizes[7] = { 0, 1, 2, 100, 65535, 65536, 300001 };
+  int                 kind, i;
+  size_t              n, clen;
+  unsigned char      *data;
+  char               *comp;
+
+  sc_init (sc_MPI_COMM_NULL, 1, 1, NULL, SC_LP_DEFAULT);
+
+  data = SC_ALLOC (unsigned char, sizes[6]);
+  comp = SC_ALLOC (char, SC_DEFLATE_BOUND (sizes[6]));
+  srand (4711);
+  for (kind = 0; kind < 4; ++kind) {
+    for (i = 0; i < 7; ++i) {
+      n = sizes[i];
+      test_fill (data, n, kind);
+      test_roundtrip (data, n, 1);
+      test_roundtrip (data, n, 5);
+#ifdef SC_HAVE_ZLIB
+      test_zlib (data, n);
+#endif
+    }
+
+    /* repetitive data must shrink */
+    clen = sc_deflate (data, n, 1, comp);
+    SC_GLOBAL_INFOF ("Kind %d compresses %lld to %lld bytes\n", kind,
+                     (long long) n, (long long) clen);
+    SC_CHECK_ABORT ((kind != 1 && kind != 2) || clen < n / 10, "Ratio");
+  }
+
+  SC_FREE (comp);
+  SC_FREE (data);
+
+  sc_finalize ();
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_flops.h>
+
+static void
+test_regions_inner (sc_flops_regions_t * fr)
+{
+  SC_FUNC_REGION_ENTER (fr);
+  SC_FLOPS_REGION_ENTER (fr, "inner loop");
+  SC_FLOPS_REGION_LEAVE (fr);
+  SC_FUNC_REGION_LEAVE (fr);
+}
+
+static void
+test_regions (sc_MPI_Comm mpicomm, int mpirank)
+{
+  int                 i, outer, solve;
+  FILE               *file;
+  sc_flops_regions_t *fr, *other;
+
+  fr = sc_flops_regions_new (mpicomm);
+  outer = sc_flops_regions_intern (fr, "outer");
+  solve = sc_flops_regions_intern (fr, "solve");
+  SC_CHECK_ABORT (sc_flops_regions_intern (fr, "outer") == outer,
+                  "Region interning");
+
+  for (i = 0; i < 5; ++i) {
+    sc_flops_regions_enter (fr, outer);
+    test_regions_inner (fr);
+    if (i % 2 == mpirank % 2) {
+      sc_flops_regions_enter (fr, solve);
+      test_regions_inner (fr);
+      sc_flops_regions_leave (fr);
+    }
+    sc_flops_regions_leave (fr);
+  }
+  test_regions_inner (fr);
+
+  /* the process-dependent paths are merged */
+  sc_flops_regions_compute (fr);
+  sc_flops_regions_print (fr, sc_package_id, SC_LP_INFO, 0);
+
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  SC_CHECK_ABORT (!sc_flops_regions_write_folded (fr, file),
+                  "Write folded");
+  fclose (file);
+
+  /* a profiler with differently ordered names does not reuse cached ids */
+  other = sc_flops_regions_new (mpicomm);
+  SC_CHECK_ABORT (sc_flops_regions_intern (other, "unrelated") == 0,
+                  "Region interning of other profiler");
+  test_regions_inner (other);
+  test_regions_inner (fr);
+  test_regions_inner (other);
+  SC_CHECK_ABORT (sc_flops_regions_intern (other, "inner loop") == 2 &&
+                  sc_flops_regions_intern (other, "last") == 3,
+                  "Region names of other profiler");
+  sc_flops_regions_destroy (other);
+
+  /* a new profiler may be allocated where a destroyed one was */
+  for (i = 0; i < 3; ++i) {
+    other = sc_flops_regions_new (mpicomm);
+    SC_CHECK_ABORT (sc_flops_regions_intern (other, "first") == 0,
+                    "Region interning of new profiler");
+    test_regions_inner (other);
+    sc_flops_regions_destroy (other);
+  }
+
+  /* results are replaced by a second computation */
+  sc_flops_regions_compute (fr);
+  sc_flops_regions_destroy (fr);
+}
+
+static void
+test_counters (void)
+{
+  int                 i, k;
+  double              sum;
+  sc_flopinfo_t       fi, snapshot;
+
+  sc_flops_start (&fi);
+  sc_flops_snap (&fi, &snapshot);
+  for (sum = 0., k = 0; k < 100000; ++k) {
+    sum += sqrt ((double) k);
+  }
+  sc_flops_shot (&fi, &snapshot);
+  SC_GLOBAL_INFOF ("Sum %g time %g process time %g Mflop/s %g\n", sum,
+                   snapshot.iwtime, snapshot.iptime, snapshot.mflops);
+
+  for (i = 0; i < SC_FLOPS_NUM_COUNTERS; ++i) {
+    SC_CHECK_ABORT (fi.ccounters[i] == snapshot.ccounters[i],
+                    "Cumulative counters");
+    SC_CHECK_ABORT ((fi.ccounters[i] < 0) == (snapshot.icounters[i] < 0),
+                    "Interval counters");
+  }
+  if (snapshot.icounters[SC_FLOPS_CYCLES] > 0 &&
+      snapshot.icounters[SC_FLOPS_INSTRUCTIONS] >= 0) {
+    SC_GLOBAL_INFOF ("Instructions per cycle %g\n",
+                     (double) snapshot.icounters[SC_FLOPS_INSTRUCTIONS] /
+                     snapshot.icounters[SC_FLOPS_CYCLES]);
+  }
+
+  sc_flops_start_nopapi (&fi);
+  sc_flops_count (&fi);
+  for (i = 0; i < SC_FLOPS_NUM_COUNTERS; ++i) {
+    SC_CHECK_ABORT (fi.ccounters[i] == -1 && fi.icounters[i] == -1,
+                    "Counters without PAPI");
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 mpirank;
+  sc_MPI_Comm         mpicomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  mpicomm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_regions (mpicomm, mpirank);
+  test_counters ();
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
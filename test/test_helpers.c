@@ -312,6 +312,74 @@ test_encode_decode (void)
   return num_failed_tests;
 }
 
+static int
+test_encode_parallel (void)
+{
+  const size_t        N = 100000;
+  const size_t        bsizes[3] = { 0, 1000, 65536 };
+  int                 i;
+  int                 num_failed_tests = 0;
+  char                fc;
+  size_t              zz, original_size;
+  uint32_t            r;
+  sc_array_t          src, dest, ref, comp;
+
+  /* data that hardly compresses to get many base 64 lines */
+  sc_array_init_count (&src, sizeof (uint32_t), N);
+  r = 1;
+  for (zz = 0; zz < N; ++zz) {
+    r = r * 1664525u + 1013904223u;
+    *(uint32_t *) sc_array_index (&src, zz) = r ^ (r >> 16);
+  }
+  sc_array_init (&dest, 1);
+  sc_array_init (&ref, 1);
+  sc_array_init (&comp, sizeof (uint32_t));
+
+  for (i = 0; i < 3; ++i) {
+    /* the output does not depend on the number of threads */
+    sc_io_encode_parallel (&src, &ref, -1, '=', bsizes[i], 1);
+    sc_io_encode_parallel (&src, &dest, -1, '=', bsizes[i], 4);
+    if (dest.elem_count != ref.elem_count ||
+        memcmp (dest.array, ref.array, dest.elem_count)) {
+      SC_LERRORF ("parallel encode differs with threads %d\n", i);
+      ++num_failed_tests;
+    }
+    if (sc_io_decode_info (&dest, &original_size, &fc, NULL) || fc != 'Z' ||
+        original_size != N * sizeof (uint32_t)) {
+      SC_LERRORF ("parallel decode info error %d\n", i);
+      ++num_failed_tests;
+    }
+    if (sc_io_decode (&dest, &comp, 0, NULL) || comp.elem_count != N ||
+        memcmp (comp.array, src.array, N * sizeof (uint32_t))) {
+      SC_LERRORF ("parallel decode error %d\n", i);
+      ++num_failed_tests;
+    }
+  }
+
+  /* corrupt compressed data is detected */
+  dest.array[dest.elem_count / 2] =
+    dest.array[dest.elem_count / 2] == 'A' ? 'B' : 'A';
+  if (!sc_io_decode (&dest, &comp, 0, NULL) &&
+      !memcmp (comp.array, src.array, N * sizeof (uint32_t))) {
+    SC_LERROR ("parallel decode corruption undetected\n");
+    ++num_failed_tests;
+  }
+
+  /* the single stream format decodes the same way */
+  sc_io_encode (&src, &dest);
+  if (sc_io_decode (&dest, &comp, 0, NULL) || comp.elem_count != N ||
+      memcmp (comp.array, src.array, N * sizeof (uint32_t))) {
+    SC_LERROR ("large decode error\n");
+    ++num_failed_tests;
+  }
+
+  sc_array_reset (&src);
+  sc_array_reset (&dest);
+  sc_array_reset (&ref);
+  sc_array_reset (&comp);
+  return num_failed_tests;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -344,6 +412,7 @@ main (int argc, char **argv)
 
   /* test encode and decode functions */
   num_failed_tests += test_encode_decode ();
+  num_failed_tests += test_encode_parallel ();
 
   /* clean up and exit */
   sc_finalize ();
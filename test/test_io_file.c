@@ -64,6 +64,28 @@ test_return (int retval, sc_array_t * buffer)
   return retval;
 }
 
+static int
+test_source (const char *filename, const char *string, size_t length)
+{
+  int                 retval;
+  size_t              bytes_out;
+  char                head[8], rest[BUFSIZ];
+  sc_io_source_t     *source;
+
+  source = sc_io_source_new (SC_IO_TYPE_MMAP, SC_IO_ENCODE_NONE, filename);
+  if (source == NULL) {
+    return -1;
+  }
+  retval = sc_io_source_read (source, head, sizeof (head), NULL) ||
+    memcmp (head, string, sizeof (head));
+  retval = retval || sc_io_source_read (source, rest, BUFSIZ, &bytes_out) ||
+    bytes_out != length - sizeof (head) ||
+    memcmp (rest, string + sizeof (head), bytes_out);
+  retval = sc_io_source_destroy (source) || retval;
+
+  return retval;
+}
+
 int
 test_file (const char *filename)
 {
@@ -102,6 +124,28 @@ test_file (const char *filename)
   }
   sc_array_destroy_null (&buffer);
 
+  /* map file contents without copying */
+  if ((buffer = sc_io_file_map (filename, SC_IO_MAP_SEQUENTIAL)) == NULL) {
+    SC_LERRORF ("Error mapping file %s\n", filename);
+    return test_return (-1, buffer);
+  }
+  if (buffer->elem_count != length ||
+      strncmp (buffer->array, string, length)) {
+    SC_LERRORF ("Content error mapping file %s\n", filename);
+    return test_return (-1, buffer);
+  }
+  if (sc_io_file_unmap (buffer)) {
+    SC_LERRORF ("Error unmapping file %s\n", filename);
+    return -1;
+  }
+  buffer = NULL;
+
+  /* read file contents through a mapped source */
+  if (test_source (filename, string, length)) {
+    SC_LERRORF ("Error reading mapped file %s\n", filename);
+    return test_return (-1, buffer);
+  }
+
   /* clean up and return using the same convention as above */
   return test_return (0, buffer);
 }
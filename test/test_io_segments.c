@@ -0,0 +1,164 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#include <sc_io.h>
+
+#if defined SC_ENABLE_MPI && !defined SC_ENABLE_MPIIO
+/* the fallback without MPI I/O writes contiguously by rank */
+#define TEST_SEGMENTS 1
+#else
+#define TEST_SEGMENTS 7
+#endif
+
+/* the segments of all processes alternate in the file */
+static size_t
+test_length (int b, int rank)
+{
+  return 1000 + 37 * (size_t) b + (size_t) rank;
+}
+
+static          sc_MPI_Offset
+test_offset (int b, int rank, int mpisize)
+{
+  int                 bb, rr;
+  sc_MPI_Offset       offset = 0;
+
+  for (bb = 0; bb < TEST_SEGMENTS; ++bb) {
+    for (rr = 0; rr < mpisize; ++rr) {
+      if (bb == b && rr == rank) {
+        return offset;
+      }
+      offset += (sc_MPI_Offset) test_length (bb, rr);
+    }
+  }
+  return offset;
+}
+
+static char
+test_byte (int b, int rank, size_t i)
+{
+  return (char) (31 * b + 7 * rank + (int) (i % 251));
+}
+
+/* place the segments of a rank backwards in memory with gaps */
+static size_t
+test_segments (int rank, int mpisize, char *memory, sc_io_segment_t * seg)
+{
+  int                 b;
+  size_t              pos, total;
+
+  for (pos = 0, total = 0, b = TEST_SEGMENTS - 1; b >= 0; --b) {
+    seg[b].offset = test_offset (b, rank, mpisize);
+    seg[b].data = memory + pos;
+    seg[b].length = test_length (b, rank);
+    pos += seg[b].length + 5;
+    total += seg[b].length;
+  }
+  return total;
+}
+
+int
+main (int argc, char **argv)
+{
+  const char         *filename = "sc_test_io_segments.dat";
+  int                 mpiret, mpisize, mpirank, other;
+  int                 b;
+  size_t              zz, total, obytes;
+  sc_MPI_Offset       size;
+  char               *memory;
+  sc_MPI_File         file;
+  sc_io_segment_t     seg[TEST_SEGMENTS];
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  memory = SC_ALLOC (char, TEST_SEGMENTS * (test_length (TEST_SEGMENTS,
+                                                         mpisize) + 5));
+
+  /* write the scattered segments of all processes at once */
+  total = test_segments (mpirank, mpisize, memory, seg);
+  for (b = 0; b < TEST_SEGMENTS; ++b) {
+    for (zz = 0; zz < seg[b].length; ++zz) {
+      ((char *) seg[b].data)[zz] = test_byte (b, mpirank, zz);
+    }
+  }
+  SC_CHECK_ABORT (sc_io_open (sc_MPI_COMM_WORLD, filename,
+                              SC_IO_WRITE_CREATE, sc_MPI_INFO_NULL,
+                              &file) == sc_MPI_SUCCESS, "Open for writing");
+  SC_CHECK_ABORT (sc_io_writev_at_all (file, seg, TEST_SEGMENTS, &obytes)
+                  == sc_MPI_SUCCESS && obytes == total, "Write segments");
+  SC_CHECK_ABORT (sc_io_close (&file) == sc_MPI_SUCCESS, "Close");
+
+  /* read the segments of another process into different memory */
+  other = (mpirank + 1) % mpisize;
+  memset (memory, 0, TEST_SEGMENTS * (test_length (TEST_SEGMENTS,
+                                                   mpisize) + 5));
+  total = test_segments (other, mpisize, memory, seg);
+  SC_CHECK_ABORT (sc_io_open (sc_MPI_COMM_WORLD, filename, SC_IO_READ,
+                              sc_MPI_INFO_NULL, &file) == sc_MPI_SUCCESS,
+                  "Open for reading");
+  SC_CHECK_ABORT (sc_io_readv_at_all (file, seg, TEST_SEGMENTS, &obytes)
+                  == sc_MPI_SUCCESS && obytes == total, "Read segments");
+  for (b = 0; b < TEST_SEGMENTS; ++b) {
+    for (zz = 0; zz < seg[b].length; ++zz) {
+      SC_CHECK_ABORT (((char *) seg[b].data)[zz] == test_byte (b, other, zz),
+                      "Read data");
+    }
+  }
+
+  /* only the last process reads, beyond the end of the file */
+  size = test_offset (TEST_SEGMENTS, 0, mpisize);
+  seg[0].offset = size - 10;
+  seg[0].data = memory;
+  seg[0].length = 100;
+  SC_CHECK_ABORT (sc_io_readv_at_all (file, seg, mpirank == mpisize - 1,
+                                      &obytes) == sc_MPI_SUCCESS,
+                  "Read at end");
+  if (mpirank == mpisize - 1) {
+    /* some MPI implementations do not count short collective reads */
+    SC_CHECK_ABORT (10 <= obytes && obytes <= 100, "Short read");
+    zz = test_length (TEST_SEGMENTS - 1, mpirank) - 1;
+    SC_CHECK_ABORT (memory[9] == test_byte (TEST_SEGMENTS - 1, mpirank, zz),
+                    "End data");
+  }
+  else {
+    SC_CHECK_ABORT (obytes == 0, "Empty read");
+  }
+  SC_CHECK_ABORT (sc_io_close (&file) == sc_MPI_SUCCESS, "Close");
+
+  SC_FREE (memory);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
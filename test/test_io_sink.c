@@ -62,6 +62,175 @@ the_test (const char *filename)
   }
 }
 
+static void
+test_crc32c (void)
+{
+  const char          check[] = "123456789";
+  char                zeros[32];
+  size_t              zz, split;
+  uint32_t            crc, part;
+  sc_array_t         *data;
+
+  /* standard check values of CRC32C */
+  SC_CHECK_ABORT (sc_io_crc32c (0, NULL, 0) == 0, "CRC32C empty");
+  SC_CHECK_ABORT (sc_io_crc32c (0, check, strlen (check)) == 0xE3069283U,
+                  "CRC32C check");
+  memset (zeros, 0, sizeof (zeros));
+  SC_CHECK_ABORT (sc_io_crc32c (0, zeros, sizeof (zeros)) == 0x8A9136AAU,
+                  "CRC32C zeros");
+
+  /* streaming at arbitrary splits and offsets agrees with one call */
+  data = sc_array_new_count (1, 1000);
+  for (zz = 0; zz < data->elem_count; ++zz) {
+    *(char *) sc_array_index (data, zz) = (char) (zz * 7 + zz / 13);
+  }
+  crc = sc_array_checksum_ext (data, SC_ARRAY_CHECKSUM_CRC32C);
+  for (split = 0; split <= 37; ++split) {
+    part = sc_io_crc32c (0, data->array, split);
+    part = sc_io_crc32c (part, data->array + split,
+                         data->elem_count - split);
+    SC_CHECK_ABORT (part == crc, "CRC32C streaming");
+  }
+  sc_array_destroy (data);
+}
+
+static void
+test_encode (void)
+{
+  const size_t        N = 300000;
+  int                 retval;
+  size_t              zz, pos, chunk, bytes_in, bytes_out;
+  char               *input, *output;
+  sc_array_t         *buffer;
+  sc_io_sink_t       *sink;
+  sc_io_source_t     *source;
+
+  input = SC_ALLOC (char, N);
+  output = SC_ALLOC (char, N);
+  for (zz = 0; zz < N; ++zz) {
+    input[zz] = (char) ((zz / 97) % 26 + 'a');
+  }
+
+  /* write in pieces with a complete in between, making two streams */
+  buffer = sc_array_new (sizeof (char));
+  sink = sc_io_sink_new (SC_IO_TYPE_BUFFER, SC_IO_MODE_WRITE,
+                         SC_IO_ENCODE_ZLIB, buffer);
+  SC_CHECK_ABORT (sink != NULL, "Encode sink create");
+  for (pos = 0; pos < N; pos += chunk) {
+    chunk = SC_MIN (N - pos, 7000 + pos % 13);
+    retval = sc_io_sink_write (sink, input + pos, chunk);
+    SC_CHECK_ABORT (retval == 0, "Encode sink write");
+    if (pos < N / 2 && pos + chunk >= N / 2) {
+      retval = sc_io_sink_complete (sink, &bytes_in, &bytes_out);
+      SC_CHECK_ABORT (retval == 0 && bytes_in == pos + chunk &&
+                      bytes_out == buffer->elem_count, "Encode complete");
+    }
+  }
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Encode sink destroy");
+  SC_GLOBAL_INFOF ("Encoded %lld bytes into %lld\n", (long long) N,
+                   (long long) buffer->elem_count);
+
+  /* read back in odd pieces and skip some data */
+  source = sc_io_source_new (SC_IO_TYPE_BUFFER, SC_IO_ENCODE_ZLIB, buffer);
+  SC_CHECK_ABORT (source != NULL, "Decode source create");
+  for (pos = 0; pos < N; pos += chunk) {
+    chunk = SC_MIN (N - pos, 5001 + pos % 17);
+    if (pos % 3 == 0) {
+      retval = sc_io_source_read (source, NULL, chunk, NULL);
+      memcpy (output + pos, input + pos, chunk);
+    }
+    else {
+      retval = sc_io_source_read (source, output + pos, chunk, NULL);
+    }
+    SC_CHECK_ABORT (retval == 0, "Decode source read");
+  }
+  SC_CHECK_ABORT (!memcmp (input, output, N), "Decode data");
+  retval = sc_io_source_read (source, output, 1, &bytes_out);
+  SC_CHECK_ABORT (retval == 0 && bytes_out == 0, "Decode end");
+  retval = sc_io_source_destroy (source);
+  SC_CHECK_ABORT (retval == 0, "Decode source destroy");
+
+  /* corrupt input is reported as an error */
+  buffer->array[buffer->elem_count / 4] ^= 0x55;
+  source = sc_io_source_new (SC_IO_TYPE_BUFFER, SC_IO_ENCODE_ZLIB, buffer);
+  retval = sc_io_source_read (source, output, N, &bytes_out);
+  SC_CHECK_ABORT (retval != 0 || bytes_out < N ||
+                  memcmp (input, output, N), "Decode corrupt");
+  (void) sc_io_source_destroy (source);
+
+  /* once an error is found, no partial data is returned later */
+  buffer->array[buffer->elem_count / 4] ^= 0x55;
+  buffer->array[buffer->elem_count - 1] ^= 0x55;
+  source = sc_io_source_new (SC_IO_TYPE_BUFFER, SC_IO_ENCODE_ZLIB, buffer);
+  do {
+    retval = sc_io_source_read (source, output, N / 3, &bytes_out);
+  }
+  while (!retval && bytes_out > 0);
+  SC_CHECK_ABORT (retval != 0, "Decode checksum");
+  retval = sc_io_source_read (source, output, N / 3, &bytes_out);
+  SC_CHECK_ABORT (retval != 0, "Decode after error");
+  (void) sc_io_source_destroy (source);
+
+  sc_array_destroy (buffer);
+  SC_FREE (input);
+  SC_FREE (output);
+}
+
+static void
+test_fileblock (int flags)
+{
+  const char         *filename = "sc_test_io_block.out";
+  const size_t        N = 100000;
+  int                 retval;
+  size_t              zz, pos, chunk, bytes_in, bytes_out;
+  char               *input;
+  sc_array_t         *buffer;
+  sc_io_sink_t       *sink;
+
+  input = SC_ALLOC (char, 2 * N);
+  for (zz = 0; zz < 2 * N; ++zz) {
+    input[zz] = (char) ((zz / 89) % 26 + 'A');
+  }
+
+  /* write many small records with a complete in between */
+  sink = sc_io_sink_new (SC_IO_TYPE_FILEBLOCK, SC_IO_MODE_WRITE,
+                         SC_IO_ENCODE_NONE, filename, (size_t) 5000, flags);
+  SC_CHECK_ABORT (sink != NULL, "Block sink create");
+  for (pos = 0; pos < N; pos += chunk) {
+    chunk = SC_MIN (N - pos, 1 + pos % 113);
+    retval = sc_io_sink_write (sink, input + pos, chunk);
+    SC_CHECK_ABORT (retval == 0, "Block sink write");
+    if (pos < N / 3 && pos + chunk >= N / 3) {
+      retval = sc_io_sink_complete (sink, &bytes_in, &bytes_out);
+      SC_CHECK_ABORT (retval == 0 && bytes_in == pos + chunk &&
+                      bytes_out == bytes_in, "Block complete");
+    }
+  }
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Block sink destroy");
+
+  /* append the rest in one large write */
+  sink = sc_io_sink_new (SC_IO_TYPE_FILEBLOCK, SC_IO_MODE_APPEND,
+                         SC_IO_ENCODE_NONE, filename, (size_t) 0, flags);
+  SC_CHECK_ABORT (sink != NULL, "Block sink append");
+  retval = sc_io_sink_write (sink, input + N, N);
+  SC_CHECK_ABORT (retval == 0, "Block sink append write");
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Block sink append destroy");
+
+  buffer = sc_array_new (1);
+  retval = sc_io_file_load (filename, buffer);
+  SC_CHECK_ABORT (retval == 0 && buffer->elem_count == 2 * N &&
+                  !memcmp (buffer->array, input, 2 * N), "Block data");
+  sc_array_destroy (buffer);
+
+  SC_CHECK_ABORT (sc_io_source_new (SC_IO_TYPE_FILEBLOCK, SC_IO_ENCODE_NONE,
+                                    filename) == NULL, "Block source");
+  (void) remove (filename);
+  SC_FREE (input);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -85,6 +254,10 @@ main (int argc, char **argv)
 
   if (sc_is_root ()) {
     the_test (filename);
+    test_crc32c ();
+    test_encode ();
+    test_fileblock (SC_IO_BLOCK_DEFAULT);
+    test_fileblock (SC_IO_BLOCK_DIRECT | SC_IO_BLOCK_FSYNC);
   }
 
   sc_options_destroy (opt);
@@ -0,0 +1,164 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_pqueue.h>
+
+#define TEST_NUM_IDS 1000
+
+/* compare random operations on the queue with a brute force search */
+static void
+test_random (int arity, sc_pqueue_type_t type)
+{
+  const int           isdouble = (type == SC_PQUEUE_DOUBLE);
+  int                 i, op;
+  int                 inq[TEST_NUM_IDS];
+  int64_t             keys[TEST_NUM_IDS];
+  int64_t             ki, kmin;
+  double              kd;
+  size_t              id, zz;
+  size_t              count;
+  sc_pqueue_t        *pq;
+
+  pq = sc_pqueue_new (arity, type);
+  memset (inq, 0, sizeof (inq));
+  count = 0;
+
+  for (i = 0; i < 20 * TEST_NUM_IDS; ++i) {
+    id = (size_t) (rand () % TEST_NUM_IDS);
+    ki = (int64_t) (rand () % 5000) - 2500;
+    op = rand () % 4;
+    if (op <= 1 && !inq[id]) {
+      if (isdouble) {
+        sc_pqueue_push_double (pq, id, (double) ki);
+      }
+      else {
+        sc_pqueue_push_int (pq, id, ki);
+      }
+      keys[id] = ki;
+      inq[id] = 1;
+      ++count;
+    }
+    else if (op == 1 || (op == 0 && inq[id])) {
+      /* change the key of an item in the queue */
+      if (isdouble) {
+        sc_pqueue_update_double (pq, id, (double) ki);
+      }
+      else {
+        sc_pqueue_update_int (pq, id, ki);
+      }
+      keys[id] = ki;
+    }
+    else if (op == 2) {
+      SC_CHECK_ABORT (sc_pqueue_remove (pq, id) == inq[id], "Remove");
+      count -= inq[id];
+      inq[id] = 0;
+    }
+    else if (count > 0) {
+      /* the popped key must be the minimum over all queued items */
+      kmin = INT64_MAX;
+      for (zz = 0; zz < TEST_NUM_IDS; ++zz) {
+        if (inq[zz] && keys[zz] < kmin) {
+          kmin = keys[zz];
+        }
+      }
+      if (isdouble) {
+        id = sc_pqueue_pop_double (pq, &kd);
+        ki = (int64_t) kd;
+      }
+      else {
+        id = sc_pqueue_pop_int (pq, &ki);
+      }
+      SC_CHECK_ABORT (inq[id] && keys[id] == ki && ki == kmin, "Pop");
+      inq[id] = 0;
+      --count;
+    }
+    SC_CHECK_ABORT (sc_pqueue_count (pq) == count, "Count");
+    SC_CHECK_ABORT (sc_pqueue_contains (pq, id) == inq[id], "Contains");
+  }
+  SC_GLOBAL_INFOF ("Arity %d type %d count %lld memory %lld\n", arity,
+                   (int) type, (long long) count,
+                   (long long) sc_pqueue_memory_used (pq));
+
+  sc_pqueue_destroy (pq);
+}
+
+/* build a queue from an array of keys and drain it in order */
+static void
+test_heapify (int arity)
+{
+  const int           n = 5 * TEST_NUM_IDS + 3;
+  int                 i;
+  int64_t             key, prev;
+  size_t              id;
+  sc_array_t         *keys;
+  sc_pqueue_t        *pq;
+
+  keys = sc_array_new_count (sizeof (int64_t), (size_t) n);
+  for (i = 0; i < n; ++i) {
+    *(int64_t *) sc_array_index_int (keys, i) = (int64_t) ((7 * i) % 113);
+  }
+
+  pq = sc_pqueue_new (arity, SC_PQUEUE_INT64);
+  sc_pqueue_push_int (pq, (size_t) n + 10, -1);
+  sc_pqueue_heapify (pq, keys);
+  SC_CHECK_ABORT (sc_pqueue_count (pq) == (size_t) n, "Heapify count");
+  SC_CHECK_ABORT (!sc_pqueue_contains (pq, (size_t) n + 10), "Heapify");
+
+  prev = -1;
+  for (i = 0; i < n; ++i) {
+    id = sc_pqueue_pop_int (pq, &key);
+    SC_CHECK_ABORT (key >= prev, "Heapify order");
+    SC_CHECK_ABORT (key == *(int64_t *) sc_array_index (keys, id),
+                    "Heapify key");
+    prev = key;
+  }
+  SC_CHECK_ABORT (sc_pqueue_count (pq) == 0, "Heapify empty");
+
+  sc_pqueue_destroy (pq);
+  sc_array_destroy (keys);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_random (4, SC_PQUEUE_INT64);
+  test_random (8, SC_PQUEUE_INT64);
+  test_random (4, SC_PQUEUE_DOUBLE);
+  test_random (8, SC_PQUEUE_DOUBLE);
+  test_heapify (4);
+  test_heapify (8);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
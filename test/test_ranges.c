@@ -0,0 +1,139 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#include <sc_ranges.h>
+
+#define TEST_NUM_RANGES 5
+
+/* compare the sparse ranges with the dense ones for random receivers */
+static void
+test_ranges (sc_MPI_Comm mpicomm, int num_peers)
+{
+  int                 mpiret;
+  int                 mpisize, rank;
+  int                 i, j, num_receivers;
+  int                 first_peer, last_peer;
+  int                 maxpeers, maxwin, maxpeers_sparse, maxwin_sparse;
+  int                 nwin, nwin_sparse;
+  int                 nr, ns;
+  int                *procs, *receivers, *rranks, *sranks;
+  int                *global_ranges;
+  int                 ranges[2 * TEST_NUM_RANGES];
+  int                 ranges_sparse[2 * TEST_NUM_RANGES];
+  sc_array_t         *senders;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* choose random receivers that may include the own rank */
+  procs = SC_ALLOC_ZERO (int, mpisize);
+  receivers = SC_ALLOC (int, mpisize);
+  for (i = 0; i < num_peers; ++i) {
+    procs[rand () % mpisize] = 1;
+  }
+  num_receivers = 0;
+  first_peer = mpisize;
+  last_peer = -1;
+  for (j = 0; j < mpisize; ++j) {
+    if (procs[j]) {
+      receivers[num_receivers++] = j;
+      if (j != rank) {
+        first_peer = SC_MIN (first_peer, j);
+        last_peer = SC_MAX (last_peer, j);
+      }
+    }
+  }
+
+  /* the local ranges agree */
+  nwin = sc_ranges_compute (sc_package_id, mpisize, procs, rank,
+                            first_peer, last_peer, TEST_NUM_RANGES, ranges);
+  nwin_sparse = sc_ranges_compute_sparse (sc_package_id, mpisize, receivers,
+                                          num_receivers, rank,
+                                          TEST_NUM_RANGES, ranges_sparse);
+  SC_CHECK_ABORT (nwin == nwin_sparse &&
+                  !memcmp (ranges, ranges_sparse, sizeof (ranges)),
+                  "Sparse ranges");
+
+  /* the senders agree with the decoded global ranges */
+  maxpeers = first_peer;
+  maxwin = last_peer;
+  nwin = sc_ranges_adaptive (sc_package_id, mpicomm, procs, &maxpeers,
+                             &maxwin, TEST_NUM_RANGES, ranges,
+                             &global_ranges);
+  senders = sc_array_new (sizeof (int));
+  nwin_sparse = sc_ranges_adaptive_sparse (sc_package_id, mpicomm,
+                                           receivers, num_receivers,
+                                           &maxpeers_sparse, &maxwin_sparse,
+                                           TEST_NUM_RANGES, ranges_sparse,
+                                           senders);
+  SC_CHECK_ABORT (nwin == nwin_sparse && maxpeers == maxpeers_sparse &&
+                  maxwin == maxwin_sparse &&
+                  !memcmp (ranges, ranges_sparse, sizeof (ranges)),
+                  "Sparse adaptive");
+
+  rranks = SC_ALLOC (int, mpisize);
+  sranks = SC_ALLOC (int, mpisize);
+  sc_ranges_decode (mpisize, rank, maxwin, global_ranges,
+                    &nr, rranks, &ns, sranks);
+  SC_CHECK_ABORT ((size_t) ns == senders->elem_count &&
+                  (ns == 0 || !memcmp (sranks, senders->array,
+                                       ns * sizeof (int))),
+                  "Sparse senders");
+
+  sc_array_destroy (senders);
+  SC_FREE (global_ranges);
+  SC_FREE (rranks);
+  SC_FREE (sranks);
+  SC_FREE (receivers);
+  SC_FREE (procs);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 rank;
+  int                 i;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  srand (29 + rank);
+  for (i = 0; i < 20; ++i) {
+    test_ranges (sc_MPI_COMM_WORLD, i % 7);
+  }
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,542 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_scda.h>
+
+#define TEST_SCDA_INDEX_FILE "sc_test_scda_index.scd"
+#define TEST_SCDA_INDEX_FOOTER_FILE "sc_test_scda_index_footer.scd"
+#define TEST_SCDA_INDEX_PATCH_FILE "sc_test_scda_index_patch.scd"
+#define TEST_SCDA_INDEX_COUNT 23
+
+/* fill the element counts of a partition; a negative owner means uniform */
+static void
+test_partition (sc_array_t *elem_counts, int mpisize, int owner)
+{
+  int                 i;
+  sc_scda_ulong      *count;
+
+  sc_array_resize (elem_counts, (size_t) mpisize);
+  for (i = 0; i < mpisize; ++i) {
+    count = (sc_scda_ulong *) sc_array_index_int (elem_counts, i);
+    if (owner < 0) {
+      *count = (sc_scda_ulong)
+        (((i + 1) * TEST_SCDA_INDEX_COUNT) / mpisize -
+         (i * TEST_SCDA_INDEX_COUNT) / mpisize);
+    }
+    else {
+      *count = (i == owner) ? TEST_SCDA_INDEX_COUNT : 0;
+    }
+  }
+}
+
+/* the first global element index of a rank */
+static size_t
+test_first (sc_array_t *elem_counts, int mpirank)
+{
+  int                 i;
+  size_t              first;
+
+  for (first = 0, i = 0; i < mpirank; ++i) {
+    first += (size_t) *(sc_scda_ulong *) sc_array_index_int (elem_counts, i);
+  }
+  return first;
+}
+
+static void
+test_write (sc_MPI_Comm mpicomm, const char *filename, int write_index,
+            int mpirank, int mpisize)
+{
+  const uint64_t      base[3] = { 0, 1000, 2000 };
+  const char         *names[3] = { "field a", "field b", "field a" };
+  size_t              zz, first, local;
+  char                block[20];
+  sc_array_t          elem_counts, data, inline_data, block_data;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+  int                 k;
+
+  sc_scda_params_init (&params);
+  params.write_index = write_index;
+  fc = sc_scda_fopen_write (mpicomm, filename, "index test", NULL, &params,
+                            &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for writing");
+
+  sc_array_init_data (&inline_data, "0123456789abcdef0123456789abcde\n",
+                      SC_SCDA_INLINE_FIELD, 1);
+  fc = sc_scda_fwrite_inline (fc, "inline", NULL, &inline_data, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Write inline");
+
+  sc_array_init (&elem_counts, sizeof (sc_scda_ulong));
+  test_partition (&elem_counts, mpisize, -1);
+  first = test_first (&elem_counts, mpirank);
+  local = (size_t) *(sc_scda_ulong *)
+    sc_array_index_int (&elem_counts, mpirank);
+  sc_array_init_size (&data, sizeof (uint64_t), local);
+
+  for (k = 0; k < 3; ++k) {
+    for (zz = 0; zz < local; ++zz) {
+      *(uint64_t *) sc_array_index (&data, zz) = base[k] + first + zz;
+    }
+    fc = sc_scda_fwrite_array (fc, names[k], NULL, &data, &elem_counts,
+                               sizeof (uint64_t), 0, 0, &errcode);
+    SC_CHECK_ABORT (fc != NULL, "Write array");
+
+    if (k == 0) {
+      memset (block, 'b', sizeof (block));
+      sc_array_init_data (&block_data, block, sizeof (block), 1);
+      fc = sc_scda_fwrite_block (fc, "block", NULL, &block_data,
+                                 sizeof (block), mpisize - 1, 0, &errcode);
+      SC_CHECK_ABORT (fc != NULL, "Write block");
+    }
+  }
+
+  SC_CHECK_ABORT (!sc_scda_fclose (fc, &errcode), "Close after writing");
+  sc_array_reset (&data);
+  sc_array_reset (&elem_counts);
+}
+
+/* the section index of a file opened for writing is not accessible */
+static void
+test_write_no_seek (sc_MPI_Comm mpicomm, const char *filename)
+{
+  size_t              num_sections, isection;
+  sc_array_t          inline_data;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  sc_scda_params_init (&params);
+  params.write_index = 1;
+  fc = sc_scda_fopen_write (mpicomm, filename, "index test", NULL, &params,
+                            &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for writing");
+  sc_array_init_data (&inline_data, "0123456789abcdef0123456789abcde\n",
+                      SC_SCDA_INLINE_FIELD, 1);
+  fc = sc_scda_fwrite_inline (fc, "inline", NULL, &inline_data, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Write inline");
+
+  SC_CHECK_ABORT (sc_scda_fnum_sections (fc, &num_sections) &&
+                  num_sections == 0, "No index for writing");
+  SC_CHECK_ABORT (sc_scda_ffind_section (fc, "inline", 0, &isection),
+                  "Find for writing");
+
+  /* the error closes the file */
+  fc = sc_scda_fseek_section (fc, 0, &errcode);
+  SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_USAGE,
+                  "Seek for writing");
+}
+
+/* the index flags must be collective since they imply collective calls */
+static void
+test_noncollective_flags (sc_MPI_Comm mpicomm, int mpirank, int mpisize)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  if (mpisize == 1) {
+    /* we can not provoke non-collective parameter errors in serial */
+    return;
+  }
+
+  sc_scda_params_init (&params);
+  params.write_index = (mpirank == 0);
+  fc = sc_scda_fopen_write (mpicomm, TEST_SCDA_INDEX_PATCH_FILE,
+                            "index test", NULL, &params, &errcode);
+  SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_ARG,
+                  "Non-collective write_index");
+
+  sc_scda_params_init (&params);
+  params.build_index = (mpirank == 0);
+  fc = sc_scda_fopen_read (mpicomm, TEST_SCDA_INDEX_FOOTER_FILE, user_string,
+                           &len, &params, &errcode);
+  SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_ARG,
+                  "Non-collective build_index");
+}
+
+/* read the header of an array section and its data with a given partition */
+static sc_scda_fcontext_t *
+test_read_array (sc_scda_fcontext_t *fc, const char *name, uint64_t base,
+                 int mpirank, int mpisize, int owner)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                type;
+  size_t              len, elem_count, elem_size;
+  size_t              zz, first, local;
+  int                 decode = 0;
+  sc_array_t          elem_counts, data;
+  sc_scda_ferror_t    errcode;
+
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Read array header");
+  SC_CHECK_ABORT (type == 'A' && !strcmp (user_string, name) &&
+                  len == strlen (name), "Array header");
+  SC_CHECK_ABORT (elem_count == TEST_SCDA_INDEX_COUNT &&
+                  elem_size == sizeof (uint64_t), "Array counts");
+
+  sc_array_init (&elem_counts, sizeof (sc_scda_ulong));
+  test_partition (&elem_counts, mpisize, owner);
+  first = test_first (&elem_counts, mpirank);
+  local = (size_t) *(sc_scda_ulong *)
+    sc_array_index_int (&elem_counts, mpirank);
+  sc_array_init_size (&data, sizeof (uint64_t), local);
+
+  fc = sc_scda_fread_array_data (fc, &data, &elem_counts, elem_size, 0,
+                                 &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Read array data");
+  for (zz = 0; zz < local; ++zz) {
+    SC_CHECK_ABORT (*(uint64_t *) sc_array_index (&data, zz) ==
+                    base + first + zz, "Array data");
+  }
+
+  sc_array_reset (&data);
+  sc_array_reset (&elem_counts);
+  return fc;
+}
+
+static void
+test_read_indexed (sc_MPI_Comm mpicomm, const char *filename, int mpirank,
+                   int mpisize)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                type;
+  char                block[20];
+  size_t              len, elem_count, elem_size;
+  size_t              num_sections, isection;
+  int                 decode = 0;
+  sc_array_t          block_data;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  sc_scda_params_init (&params);
+  params.build_index = 1;
+  fc = sc_scda_fopen_read (mpicomm, filename, user_string, &len, &params,
+                           &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for reading");
+  SC_CHECK_ABORT (!strcmp (user_string, "index test"), "File user string");
+
+  /* the index is complete without the sections of an appended index
+   * and allows to look up sections by name */
+  SC_CHECK_ABORT (!sc_scda_fnum_sections (fc, &num_sections) &&
+                  num_sections == 5, "Number of sections");
+  SC_CHECK_ABORT (!sc_scda_ffind_section (fc, "field b", 0, &isection) &&
+                  isection == 3, "Find section");
+  SC_CHECK_ABORT (!sc_scda_ffind_section (fc, "field a", 2, &isection) &&
+                  isection == 4, "Find repeated section");
+  SC_CHECK_ABORT (sc_scda_ffind_section (fc, "missing", 0, &isection),
+                  "Find missing section");
+
+  /* random access with a partition different from the written one */
+  fc = sc_scda_fseek_section (fc, 3, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Seek section 3");
+  fc = test_read_array (fc, "field b", 1000, mpirank, mpisize, mpisize - 1);
+  fc = test_read_array (fc, "field a", 2000, mpirank, mpisize, 0);
+
+  /* go back and continue sequentially from there */
+  fc = sc_scda_fseek_section (fc, 1, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Seek section 1");
+  fc = test_read_array (fc, "field a", 0, mpirank, mpisize, -1);
+
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && type == 'B' && elem_size == sizeof (block)
+                  && !strcmp (user_string, "block"), "Block header");
+  sc_array_init_data (&block_data, block, sizeof (block), 1);
+  fc = sc_scda_fread_block_data (fc, &block_data, elem_size, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Read block data");
+  SC_CHECK_ABORT (mpirank != 0 || block[0] == 'b', "Block data");
+
+  /* skip the data of a section after reading its header */
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && !strcmp (user_string, "field b"),
+                  "Skipped header");
+  fc = sc_scda_fseek_section (fc, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Seek section 0");
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && type == 'I' && !strcmp (user_string,
+                                                         "inline"),
+                  "Inline header");
+
+  /* seeking to the end is valid but beyond it is not */
+  fc = sc_scda_fseek_section (fc, num_sections, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Seek end");
+  fc = sc_scda_fseek_section (fc, num_sections + 1, &errcode);
+  SC_CHECK_ABORT (fc == NULL, "Seek beyond end");
+}
+
+static void
+test_read_unindexed (sc_MPI_Comm mpicomm, const char *filename, int mpirank,
+                     int mpisize)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                type;
+  size_t              len, num_sections, isection;
+  size_t              elem_count, elem_size;
+  int                 decode = 0;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  fc = sc_scda_fopen_read (mpicomm, filename, user_string, &len, NULL,
+                           &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for reading");
+  SC_CHECK_ABORT (sc_scda_fnum_sections (fc, &num_sections) &&
+                  num_sections == 0, "No index");
+  SC_CHECK_ABORT (sc_scda_ffind_section (fc, "field b", 0, &isection),
+                  "Find without index");
+
+  /* the usual sequential reading is unchanged */
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && type == 'I', "Inline header");
+  fc = sc_scda_fread_inline_data (fc, NULL, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Skip inline data");
+  fc = test_read_array (fc, "field a", 0, mpirank, mpisize, 0);
+  fc = sc_scda_fseek_section (fc, 0, &errcode);
+  SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_USAGE,
+                  "Seek without index");
+}
+
+/* an appended index consists of regular sections for sequential readers */
+static void
+test_read_footer (sc_MPI_Comm mpicomm, int mpirank, int mpisize)
+{
+  const char         *names[5] =
+    { "inline", "field a", "block", "field b", "field a" };
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                type;
+  char                locator[SC_SCDA_INLINE_FIELD];
+  size_t              len, elem_count, elem_size;
+  int                 i;
+  int                 decode = 0;
+  sc_array_t          elem_counts, block_data, inline_data;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  fc = sc_scda_fopen_read (mpicomm, TEST_SCDA_INDEX_FOOTER_FILE, user_string,
+                           &len, NULL, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for reading");
+
+  sc_array_init (&elem_counts, sizeof (sc_scda_ulong));
+  test_partition (&elem_counts, mpisize, -1);
+  for (i = 0; i < 5; ++i) {
+    fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                       &elem_count, &elem_size, &decode,
+                                       &errcode);
+    SC_CHECK_ABORT (fc != NULL && !strcmp (user_string, names[i]),
+                    "Sequential header");
+    if (type == 'I') {
+      fc = sc_scda_fread_inline_data (fc, NULL, 0, &errcode);
+    }
+    else if (type == 'B') {
+      fc = sc_scda_fread_block_data (fc, NULL, elem_size, 0, &errcode);
+    }
+    else {
+      fc = sc_scda_fread_array_data (fc, NULL, &elem_counts, elem_size, 0,
+                                     &errcode);
+    }
+    SC_CHECK_ABORT (fc != NULL, "Sequential data");
+  }
+  sc_array_reset (&elem_counts);
+
+  /* the index lists the five sections */
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && type == 'B' && elem_size == 5 * 160 &&
+                  !strcmp (user_string, "scda section index"),
+                  "Index header");
+  sc_array_init_size (&block_data, elem_size, 1);
+  fc = sc_scda_fread_block_data (fc, &block_data, elem_size, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Index data");
+  SC_CHECK_ABORT (mpirank != 0 || !strncmp (block_data.array + 160,
+                                            "A field a ", 10),
+                  "Index entry");
+  sc_array_reset (&block_data);
+
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     &errcode);
+  SC_CHECK_ABORT (fc != NULL && type == 'I' &&
+                  !strcmp (user_string, "scda section index locator"),
+                  "Locator header");
+  sc_array_init_data (&inline_data, locator, SC_SCDA_INLINE_FIELD, 1);
+  fc = sc_scda_fread_inline_data (fc, &inline_data, 0, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Locator data");
+  SC_CHECK_ABORT (mpirank != 0 || !strncmp (locator, "O ", 2),
+                  "Locator entry");
+
+  SC_CHECK_ABORT (!sc_scda_fclose (fc, &errcode), "Close after reading");
+}
+
+/* replace the given occurrence of a string in a file on rank 0 */
+static void
+test_patch (sc_MPI_Comm mpicomm, int mpirank, const char *filename,
+            int occurrence, const char *find, const char *replace)
+{
+  const size_t        len = strlen (find);
+  int                 mpiret;
+  long                size;
+  size_t              zz;
+  char               *contents;
+  FILE               *file;
+
+  SC_ASSERT (strlen (replace) == len);
+  if (mpirank == 0) {
+    file = fopen (filename, "r+b");
+    SC_CHECK_ABORT (file != NULL, "Open for patching");
+    SC_CHECK_ABORT (!fseek (file, 0, SEEK_END) &&
+                    (size = ftell (file)) > 0 &&
+                    !fseek (file, 0, SEEK_SET), "Patch file size");
+    contents = SC_ALLOC (char, size);
+    SC_CHECK_ABORT (fread (contents, 1, (size_t) size, file) ==
+                    (size_t) size, "Read for patching");
+    for (zz = 0; zz + len <= (size_t) size; ++zz) {
+      if (!memcmp (&contents[zz], find, len) && --occurrence == 0) {
+        break;
+      }
+    }
+    SC_CHECK_ABORT (occurrence == 0, "Patch string not found");
+    SC_CHECK_ABORT (!fseek (file, (long) zz, SEEK_SET) &&
+                    fwrite (replace, 1, len, file) == len &&
+                    !fclose (file), "Write patch");
+    SC_FREE (contents);
+  }
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+}
+
+/* open a file with an index and return its number of sections */
+static size_t
+test_num_sections (sc_MPI_Comm mpicomm, const char *filename)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len, num_sections;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  sc_scda_params_init (&params);
+  params.build_index = 1;
+  fc = sc_scda_fopen_read (mpicomm, filename, user_string, &len, &params,
+                           &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for reading");
+  SC_CHECK_ABORT (!sc_scda_fnum_sections (fc, &num_sections),
+                  "Number of sections");
+  SC_CHECK_ABORT (!sc_scda_fclose (fc, &errcode), "Close after reading");
+  return num_sections;
+}
+
+/* the index is read from the footer if it is consistent with the file */
+static void
+test_read_patched (sc_MPI_Comm mpicomm, int mpirank, int mpisize)
+{
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len;
+  sc_scda_params_t    params;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+
+  /* a broken section header ends a scan after two arrays */
+  test_write (mpicomm, TEST_SCDA_INDEX_PATCH_FILE, 1, mpirank, mpisize);
+  test_patch (mpicomm, mpirank, TEST_SCDA_INDEX_PATCH_FILE, 1,
+              "A field b ", "X field b ");
+  SC_CHECK_ABORT (test_num_sections (mpicomm, TEST_SCDA_INDEX_PATCH_FILE)
+                  == 5, "Index from footer");
+
+  /* with the footer the sections behind the broken header are read */
+  sc_scda_params_init (&params);
+  params.build_index = 1;
+  fc = sc_scda_fopen_read (mpicomm, TEST_SCDA_INDEX_PATCH_FILE, user_string,
+                           &len, &params, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Open for reading");
+  fc = sc_scda_fseek_section (fc, 3, &errcode);
+  SC_CHECK_ABORT (fc != NULL, "Seek section 3");
+  fc = test_read_array (fc, "field b", 1000, mpirank, mpisize, -1);
+  fc = test_read_array (fc, "field a", 2000, mpirank, mpisize, 0);
+  SC_CHECK_ABORT (!sc_scda_fclose (fc, &errcode), "Close after reading");
+
+  /* a well-formed entry with a wrong block size is inconsistent */
+  test_patch (mpicomm, mpirank, TEST_SCDA_INDEX_PATCH_FILE, 2,
+              "E 20 -", "E 52 -");
+  SC_CHECK_ABORT (test_num_sections (mpicomm, TEST_SCDA_INDEX_PATCH_FILE)
+                  == 3, "Inconsistent footer");
+
+  /* a broken locator is not followed either */
+  test_write (mpicomm, TEST_SCDA_INDEX_PATCH_FILE, 1, mpirank, mpisize);
+  test_patch (mpicomm, mpirank, TEST_SCDA_INDEX_PATCH_FILE, 1,
+              "A field b ", "X field b ");
+  test_patch (mpicomm, mpirank, TEST_SCDA_INDEX_PATCH_FILE, 1,
+              "index locator", "index lokator");
+  SC_CHECK_ABORT (test_num_sections (mpicomm, TEST_SCDA_INDEX_PATCH_FILE)
+                  == 3, "Broken locator");
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 mpirank, mpisize;
+  sc_MPI_Comm         mpicomm = sc_MPI_COMM_WORLD;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_write (mpicomm, TEST_SCDA_INDEX_FILE, 0, mpirank, mpisize);
+  test_read_indexed (mpicomm, TEST_SCDA_INDEX_FILE, mpirank, mpisize);
+  test_read_unindexed (mpicomm, TEST_SCDA_INDEX_FILE, mpirank, mpisize);
+
+  /* the same with the section index appended on closing */
+  test_write (mpicomm, TEST_SCDA_INDEX_FOOTER_FILE, 1, mpirank, mpisize);
+  test_read_indexed (mpicomm, TEST_SCDA_INDEX_FOOTER_FILE, mpirank, mpisize);
+  test_read_unindexed (mpicomm, TEST_SCDA_INDEX_FOOTER_FILE, mpirank,
+                       mpisize);
+  test_read_footer (mpicomm, mpirank, mpisize);
+  test_read_patched (mpicomm, mpirank, mpisize);
+  test_write_no_seek (mpicomm, TEST_SCDA_INDEX_PATCH_FILE);
+  test_noncollective_flags (mpicomm, mpirank, mpisize);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -23,6 +23,79 @@
 
 #include <sc_search.h>
 
+/* compare the lower bound variants to a linear search */
+static void
+test_lower_bound (int n)
+{
+  int                 i, j, k, nq;
+  int32_t            *a32, t32;
+  int64_t            *a64, t64, *q64;
+  double             *ad;
+  size_t              expect, *pos;
+  sc_uint128_t       *a128, t128;
+  sc_search_index_t  *index;
+
+  a32 = SC_ALLOC (int32_t, n);
+  a64 = SC_ALLOC (int64_t, n);
+  ad = SC_ALLOC (double, n);
+  a128 = SC_ALLOC (sc_uint128_t, n);
+  nq = 3 * n + 7;
+  q64 = SC_ALLOC (int64_t, nq);
+  pos = SC_ALLOC (size_t, nq);
+
+  /* sorted with duplicates */
+  for (i = 0; i < n; ++i) {
+    a64[i] = 2 * (i / 2) + 1;
+    a32[i] = (int32_t) a64[i];
+    ad[i] = (double) a64[i];
+    sc_uint128_init (&a128[i], 0, (uint64_t) a64[i]);
+  }
+  index = sc_search_index_new (a64, (size_t) n);
+
+  for (j = -2; j < n + 3; ++j) {
+    expect = 0;
+    while (expect < (size_t) n && a64[expect] < j) {
+      ++expect;
+    }
+    t32 = (int32_t) j;
+    t64 = (int64_t) j;
+    SC_CHECK_ABORT (sc_search_lower_bound_int32 (t32, a32, (size_t) n)
+                    == expect, "Lower bound int32");
+    SC_CHECK_ABORT (sc_search_lower_bound_int64 (t64, a64, (size_t) n)
+                    == expect, "Lower bound int64");
+    SC_CHECK_ABORT (sc_search_lower_bound_double ((double) j, ad, (size_t) n)
+                    == expect, "Lower bound double");
+    SC_CHECK_ABORT (sc_search_index_lower_bound (index, t64) == expect,
+                    "Lower bound index");
+    if (j >= 0) {
+      sc_uint128_init (&t128, 0, (uint64_t) j);
+      SC_CHECK_ABORT (sc_search_lower_bound_uint128 (&t128, a128, (size_t) n)
+                      == expect, "Lower bound uint128");
+    }
+  }
+  sc_uint128_init (&t128, 1, 0);
+  SC_CHECK_ABORT (sc_search_lower_bound_uint128 (&t128, a128, (size_t) n)
+                  == (size_t) n, "Lower bound uint128 high");
+
+  /* batched search of sorted targets */
+  for (k = 0; k < nq; ++k) {
+    q64[k] = (int64_t) (k / 3) - 2;
+  }
+  sc_search_lower_bound_int64_batch (q64, (size_t) nq, a64, (size_t) n, pos);
+  for (k = 0; k < nq; ++k) {
+    SC_CHECK_ABORT (pos[k] == sc_search_lower_bound_int64
+                    (q64[k], a64, (size_t) n), "Lower bound batch");
+  }
+
+  sc_search_index_destroy (index);
+  SC_FREE (a32);
+  SC_FREE (a64);
+  SC_FREE (ad);
+  SC_FREE (a128);
+  SC_FREE (q64);
+  SC_FREE (pos);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -56,6 +129,11 @@ main (int argc, char **argv)
     }
   }
 
+  for (i = 0; i < 40; ++i) {
+    test_lower_bound (i);
+  }
+  test_lower_bound (1000);
+
   mpiret = sc_MPI_Finalize ();
   SC_CHECK_MPI (mpiret);
 
@@ -0,0 +1,292 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_statistics.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+#define TEST_STATISTICS_THREADS 4
+#define TEST_STATISTICS_VALUES 100
+
+typedef struct test_statistics_thread
+{
+  sc_statistics_t    *stats;
+  int                 handle;
+  int                 t;
+}
+test_statistics_thread_t;
+
+/* every thread adds a distinct range of values */
+static void        *
+test_statistics_thread (void *v)
+{
+  test_statistics_thread_t *tt = (test_statistics_thread_t *) v;
+  int                 k;
+
+  for (k = 0; k < TEST_STATISTICS_VALUES; ++k) {
+    sc_statistics_accumulate_id (tt->stats, tt->handle,
+                                 (double) (tt->t * TEST_STATISTICS_VALUES +
+                                           k));
+  }
+  return NULL;
+}
+
+static void
+test_statistics_handles (sc_MPI_Comm mpicomm, int mpisize, int thread_local)
+{
+  int                 t;
+  int                 hset, hsum;
+  const int           n = TEST_STATISTICS_THREADS * TEST_STATISTICS_VALUES;
+  sc_statinfo_t      *si;
+  sc_statistics_t    *stats;
+  test_statistics_thread_t tt[TEST_STATISTICS_THREADS];
+#ifdef SC_ENABLE_PTHREAD
+  pthread_t           threads[TEST_STATISTICS_THREADS];
+#endif
+
+  stats = sc_statistics_new_ext (mpicomm, thread_local);
+  hset = sc_statistics_add (stats, "set");
+  hsum = sc_statistics_add_empty (stats, "sum");
+  SC_CHECK_ABORT (sc_statistics_handle (stats, "set") == hset &&
+                  sc_statistics_handle (stats, "sum") == hsum &&
+                  sc_statistics_handle (stats, "none") == -1,
+                  "Statistics handles");
+  sc_statistics_set_id (stats, hset, 3.);
+
+  for (t = 0; t < TEST_STATISTICS_THREADS; ++t) {
+    tt[t].stats = stats;
+    tt[t].handle = hsum;
+    tt[t].t = t;
+  }
+#ifdef SC_ENABLE_PTHREAD
+  if (thread_local) {
+    for (t = 0; t < TEST_STATISTICS_THREADS; ++t) {
+      SC_CHECK_ABORT (pthread_create (&threads[t], NULL,
+                                      test_statistics_thread, &tt[t]) == 0,
+                      "Statistics thread create");
+    }
+    for (t = 0; t < TEST_STATISTICS_THREADS; ++t) {
+      SC_CHECK_ABORT (pthread_join (threads[t], NULL) == 0,
+                      "Statistics thread join");
+    }
+  }
+  else
+#endif
+  {
+    for (t = 0; t < TEST_STATISTICS_THREADS; ++t) {
+      test_statistics_thread (&tt[t]);
+    }
+  }
+  sc_statistics_compute (stats);
+
+  /* the values 0, ..., n - 1 are added on every process */
+  si = (sc_statinfo_t *) sc_array_index_int (stats->sarray, hsum);
+  SC_CHECK_ABORT (si->count == (long) n * mpisize, "Merged count");
+  SC_CHECK_ABORT (si->sum_values == .5 * n * (n - 1) * mpisize,
+                  "Merged sum");
+  SC_CHECK_ABORT (si->min == 0. && si->max == n - 1., "Merged min/max");
+  SC_CHECK_ABORT (si->average == .5 * (n - 1), "Merged average");
+
+  si = (sc_statinfo_t *) sc_array_index_int (stats->sarray, hset);
+  SC_CHECK_ABORT (si->count == mpisize && si->average == 3.,
+                  "Set statistics");
+
+  sc_statistics_print (stats, sc_package_id, SC_LP_INFO, 1, 0);
+  sc_statistics_destroy (stats);
+}
+
+static void
+test_statistics_histogram (sc_MPI_Comm mpicomm, int mpisize)
+{
+  int                 i, b;
+  const int           bin_one = 160;
+  double              sum, q, *histogram;
+  sc_statinfo_t       si[2];
+
+  /* powers of two start a bin each, four bins per power */
+  sc_stats_init (&si[0], "powers");
+  sc_stats_set_histogram (&si[0], 1);
+  sc_stats_accumulate (&si[0], 1.);
+  sc_stats_accumulate (&si[0], 1.);
+  sc_stats_accumulate (&si[0], 2.);
+  for (i = 0; i < 3; ++i) {
+    sc_stats_accumulate (&si[0], 4.);
+  }
+
+  /* a uniform distribution on 1, ..., 1000 */
+  sc_stats_set1 (&si[1], 1., "uniform");
+  sc_stats_set_histogram (&si[1], 1);
+  for (i = 2; i <= 1000; ++i) {
+    sc_stats_accumulate (&si[1], (double) i);
+  }
+  sc_stats_compute (mpicomm, 2, si);
+
+  /* the bins of all processes are added */
+  for (sum = 0., b = 0; b < SC_STATS_HISTOGRAM_BINS; ++b) {
+    sum += si[0].histogram[b];
+  }
+  SC_CHECK_ABORT (sum == 6. * mpisize, "Histogram total");
+  SC_CHECK_ABORT (si[0].histogram[bin_one] == 2. * mpisize &&
+                  si[0].histogram[bin_one + 4] == 1. * mpisize &&
+                  si[0].histogram[bin_one + 8] == 3. * mpisize,
+                  "Histogram bins");
+
+  /* quantiles are accurate to the width of a bin */
+  SC_CHECK_ABORT (sc_stats_quantile (&si[1], 0.) == 1. &&
+                  sc_stats_quantile (&si[1], 1.) == 1000., "Quantile range");
+  for (i = 1; i < 10; ++i) {
+    q = sc_stats_quantile (&si[1], .1 * i);
+    SC_CHECK_ABORT (fabs (q - 100. * i) <= .1 * 100. * i, "Quantile");
+  }
+  q = sc_stats_quantile (&si[1], .99);
+  SC_CHECK_ABORT (fabs (q - 990.) <= 99., "Quantile 0.99");
+  sc_stats_print (sc_package_id, SC_LP_INFO, 2, si, 1, 0);
+
+  /* resetting keeps the histogram and restarts its bins */
+  histogram = si[0].histogram;
+  sc_stats_reset (&si[0], 0);
+  sc_stats_accumulate (&si[0], 2.);
+  SC_CHECK_ABORT (si[0].histogram == histogram &&
+                  histogram[bin_one + 4] == 1. && histogram[bin_one] == 0.,
+                  "Histogram reset");
+
+  sc_stats_set_histogram (&si[0], 0);
+  sc_stats_set_histogram (&si[1], 0);
+  SC_CHECK_ABORT (si[0].histogram == NULL, "Histogram freed");
+}
+
+/* set1, init and compute1 do not read the fields they fill */
+static void
+test_statistics_uninitialized (sc_MPI_Comm mpicomm, int mpirank,
+                               int mpisize)
+{
+  const int           bin_one = 160;
+  sc_statinfo_t       si[3];
+
+  memset (si, -1, sizeof (si));
+  sc_stats_set1 (&si[0], 1., "set1");
+  sc_stats_init (&si[1], "init");
+  si[2].sum_values = (double) mpirank;
+  si[2].variable = "compute1";
+  sc_stats_compute1 (mpicomm, 1, &si[2]);
+  SC_CHECK_ABORT (si[0].histogram == NULL && si[1].histogram == NULL &&
+                  si[2].histogram == NULL, "Histogram not read");
+  SC_CHECK_ABORT (si[2].count == mpisize && si[2].max == mpisize - 1.,
+                  "Compute1 results");
+
+  /* the histogram is enabled on initialized variables only */
+  sc_stats_set_histogram (&si[0], 1);
+  sc_stats_compute (mpicomm, 2, si);
+  SC_CHECK_ABORT (si[0].histogram[bin_one] == mpisize, "Histogram enabled");
+  sc_stats_set_histogram (&si[0], 0);
+}
+
+/* set values depending on the rank, with a histogram for the second */
+static void
+test_statistics_values (sc_statinfo_t * si, int mpirank)
+{
+  int                 k;
+
+  sc_stats_set1 (&si[0], (double) (mpirank + 1), "rank");
+  sc_stats_init (&si[1], "squares");
+  sc_stats_set_histogram (&si[1], 1);
+  for (k = 0; k <= mpirank; ++k) {
+    sc_stats_accumulate (&si[1], (double) (k * k));
+  }
+}
+
+static void
+test_statistics_icompute (sc_MPI_Comm mpicomm, int mpirank, int mpisize)
+{
+  int                 i, b;
+  sc_statinfo_t       si[2], sj[2], sk[1];
+  sc_stats_request_t *ri, *rk;
+
+  /* two pending computations completed in reverse order */
+  test_statistics_values (si, mpirank);
+  test_statistics_values (sj, mpirank);
+  sc_stats_set1 (&sk[0], -1. * mpirank, "negative");
+  ri = sc_stats_icompute (mpicomm, 2, si);
+  rk = sc_stats_icompute (mpicomm, 1, sk);
+  sc_stats_icompute_wait (rk);
+  sc_stats_icompute_wait (ri);
+
+  /* the results equal those of the blocking computation */
+  sc_stats_compute (mpicomm, 2, sj);
+  SC_CHECK_ABORT (si[0].count == mpisize &&
+                  si[0].sum_values == .5 * mpisize * (mpisize + 1) &&
+                  si[0].min == 1. && si[0].min_at_rank == 0 &&
+                  si[0].max == mpisize && si[0].max_at_rank == mpisize - 1,
+                  "Icompute results");
+  for (i = 0; i < 2; ++i) {
+    SC_CHECK_ABORT (!si[i].dirty && si[i].count == sj[i].count &&
+                    si[i].sum_values == sj[i].sum_values &&
+                    si[i].sum_squares == sj[i].sum_squares &&
+                    si[i].min == sj[i].min && si[i].max == sj[i].max &&
+                    si[i].average == sj[i].average &&
+                    si[i].variance == sj[i].variance,
+                    "Icompute equals compute");
+  }
+  for (b = 0; b < SC_STATS_HISTOGRAM_BINS; ++b) {
+    SC_CHECK_ABORT (si[1].histogram[b] == sj[1].histogram[b],
+                    "Icompute histogram");
+  }
+  SC_CHECK_ABORT (sk[0].max == 0. && sk[0].min == 1. - mpisize,
+                  "Icompute second request");
+
+  sc_stats_set_histogram (&si[1], 0);
+  sc_stats_set_histogram (&sj[1], 0);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 mpirank, mpisize;
+  sc_MPI_Comm         mpicomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  mpicomm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_statistics_handles (mpicomm, mpisize, 0);
+  test_statistics_handles (mpicomm, mpisize, 1);
+  test_statistics_histogram (mpicomm, mpisize);
+  test_statistics_uninitialized (mpicomm, mpirank, mpisize);
+  test_statistics_icompute (mpicomm, mpirank, mpisize);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,244 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+#include <sc_io.h>
+#include <sc_deflate.h>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define TEST_VTK_FIELDS 5
+
+/* the local grid of a process is a chain of line cells */
+static void
+test_fields (int rank, sc_array_t *arrays, sc_vtk_field_t *fields,
+             size_t *num_points, size_t *num_cells)
+{
+  size_t              zz, np, nc;
+  double             *xyz;
+  int64_t            *conn, *offs;
+  uint8_t            *types;
+  double             *value;
+
+  np = 2 + 3000 * (size_t) rank;
+  nc = np - 1;
+  sc_array_init_count (&arrays[0], 3 * sizeof (double), np);
+  sc_array_init_count (&arrays[1], 2 * sizeof (int64_t), nc);
+  sc_array_init_count (&arrays[2], sizeof (int64_t), nc);
+  sc_array_init_count (&arrays[3], sizeof (uint8_t), nc);
+  sc_array_init_count (&arrays[4], sizeof (double), nc);
+  xyz = (double *) arrays[0].array;
+  for (zz = 0; zz < np; ++zz) {
+    xyz[3 * zz] = (double) zz;
+    xyz[3 * zz + 1] = (double) rank;
+    xyz[3 * zz + 2] = 0.;
+  }
+  conn = (int64_t *) arrays[1].array;
+  offs = (int64_t *) arrays[2].array;
+  types = (uint8_t *) arrays[3].array;
+  value = (double *) arrays[4].array;
+  for (zz = 0; zz < nc; ++zz) {
+    conn[2 * zz] = (int64_t) zz;
+    conn[2 * zz + 1] = (int64_t) zz + 1;
+    offs[zz] = 2 * (int64_t) (zz + 1);
+    types[zz] = 3;
+    value[zz] = rank + .5 * (double) zz;
+  }
+
+  /* pass the cell data first to check the ordering of sections */
+  fields[0].location = SC_VTK_CELL_DATA;
+  fields[0].name = "value";
+  fields[0].type = "Float64";
+  fields[0].num_components = 1;
+  fields[0].data = &arrays[4];
+  fields[1].location = SC_VTK_POINTS;
+  fields[1].name = NULL;
+  fields[1].type = "Float64";
+  fields[1].num_components = 3;
+  fields[1].data = &arrays[0];
+  fields[2].location = SC_VTK_CELLS;
+  fields[2].name = "connectivity";
+  fields[2].type = "Int64";
+  fields[2].num_components = 1;
+  fields[2].data = &arrays[1];
+  fields[3].location = SC_VTK_CELLS;
+  fields[3].name = "offsets";
+  fields[3].type = "Int64";
+  fields[3].num_components = 1;
+  fields[3].data = &arrays[2];
+  fields[4].location = SC_VTK_CELLS;
+  fields[4].name = "types";
+  fields[4].type = "UInt8";
+  fields[4].num_components = 1;
+  fields[4].data = &arrays[3];
+
+  *num_points = np;
+  *num_cells = nc;
+}
+
+/* decode one appended data array and compare it with the expected bytes */
+static void
+test_array (const char *app, long long offset, int compressed,
+            const sc_array_t *expect)
+{
+  size_t              zz, bytes, pos, len;
+  uint64_t            head[3], clen;
+  char               *out;
+  const char         *block;
+#ifdef SC_HAVE_ZLIB
+  uLongf              ulen;
+#endif
+
+  bytes = expect->elem_count * expect->elem_size;
+  app += offset;
+  if (!compressed) {
+    memcpy (head, app, sizeof (uint64_t));
+    SC_CHECK_ABORT (head[0] == (uint64_t) bytes, "Raw size");
+    SC_CHECK_ABORT (!memcmp (app + 8, expect->array, bytes), "Raw data");
+    return;
+  }
+
+  memcpy (head, app, 3 * sizeof (uint64_t));
+  SC_CHECK_ABORT (head[0] == (bytes + head[1] - 1) / head[1], "Blocks");
+  SC_CHECK_ABORT (head[0] == 0 ||
+                  head[2] == bytes - (head[0] - 1) * head[1], "Last size");
+  out = SC_ALLOC (char, bytes);
+  block = app + (3 + head[0]) * sizeof (uint64_t);
+  for (pos = 0, zz = 0; zz < (size_t) head[0]; ++zz) {
+    memcpy (&clen, app + (3 + zz) * sizeof (uint64_t), sizeof (uint64_t));
+    len = SC_MIN (bytes - pos, (size_t) head[1]);
+#ifdef SC_HAVE_ZLIB
+    ulen = (uLongf) len;
+    SC_CHECK_ABORT (uncompress ((Bytef *) out + pos, &ulen,
+                                (const Bytef *) block, (uLong) clen) == Z_OK
+                    && ulen == (uLongf) len, "Uncompress");
+#else
+    {
+      size_t              in_bytes = (size_t) clen - 6, out_bytes = len;
+
+      SC_CHECK_ABORT (!sc_inflate (block + 2, &in_bytes, out + pos,
+                                   &out_bytes) && out_bytes == len,
+                      "Inflate");
+    }
+#endif
+    block += clen;
+    pos += len;
+  }
+  SC_CHECK_ABORT (!memcmp (out, expect->array, bytes), "Compressed data");
+  SC_FREE (out);
+}
+
+/* parse the pieces of the file and check all arrays of all processes */
+static void
+test_check (const char *filename, int mpisize, int compressed)
+{
+  const int           order[TEST_VTK_FIELDS] = { 1, 2, 3, 4, 0 };
+  int                 rank, i;
+  long long           offset;
+  size_t              num_points, num_cells;
+  unsigned long long  np, nc;
+  const char         *pos, *app;
+  sc_array_t         *buffer;
+  sc_array_t          arrays[TEST_VTK_FIELDS];
+  sc_vtk_field_t      fields[TEST_VTK_FIELDS];
+
+  buffer = sc_array_new (1);
+  SC_CHECK_ABORT (!sc_io_file_load (filename, buffer), "Load");
+  *(char *) sc_array_push (buffer) = '\0';
+  pos = (const char *) buffer->array;
+  SC_CHECK_ABORT (!strncmp (pos, "<?xml", 5), "XML header");
+  SC_CHECK_ABORT ((strstr (pos, "vtkZLibDataCompressor") != NULL) ==
+                  compressed, "Compressor");
+  app = strstr (pos, "<AppendedData encoding=\"raw\">");
+  SC_CHECK_ABORT (app != NULL, "Appended data");
+  app = strchr (app, '_') + 1;
+  SC_CHECK_ABORT (!strcmp (buffer->array + buffer->elem_count - 31,
+                           "\n  </AppendedData>\n</VTKFile>\n"), "Epilog");
+
+  for (rank = 0; rank < mpisize; ++rank) {
+    test_fields (rank, arrays, fields, &num_points, &num_cells);
+    pos = strstr (pos, "<Piece ");
+    SC_CHECK_ABORT (pos != NULL && pos < app, "Piece");
+    SC_CHECK_ABORT (sscanf (pos, "<Piece NumberOfPoints=\"%llu\" "
+                            "NumberOfCells=\"%llu\">", &np, &nc) == 2 &&
+                    np == num_points && nc == num_cells, "Piece sizes");
+    for (i = 0; i < TEST_VTK_FIELDS; ++i) {
+      pos = strstr (pos, "offset=\"");
+      SC_CHECK_ABORT (pos != NULL && pos < app, "Offset");
+      SC_CHECK_ABORT (sscanf (pos, "offset=\"%lld\"", &offset) == 1,
+                      "Parse offset");
+      test_array (app, offset, compressed, fields[order[i]].data);
+      ++pos;
+    }
+    for (i = 0; i < TEST_VTK_FIELDS; ++i) {
+      sc_array_reset (&arrays[i]);
+    }
+  }
+  pos = strstr (pos, "<Piece ");
+  SC_CHECK_ABORT (pos == NULL || pos > app, "Piece count");
+  sc_array_destroy (buffer);
+}
+
+int
+main (int argc, char **argv)
+{
+  const char         *filename = "sc_test_vtk.vtu";
+  int                 mpiret, mpisize, mpirank;
+  int                 i, level;
+  size_t              num_points, num_cells;
+  sc_array_t          arrays[TEST_VTK_FIELDS];
+  sc_vtk_field_t      fields[TEST_VTK_FIELDS];
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_fields (mpirank, arrays, fields, &num_points, &num_cells);
+  for (level = 0; level <= 6; level += 6) {
+    SC_CHECK_ABORT (sc_vtk_write_unstructured
+                    (sc_MPI_COMM_WORLD, filename, num_points, num_cells,
+                     TEST_VTK_FIELDS, fields, level, 2) == sc_MPI_SUCCESS,
+                    "Write unstructured");
+    if (mpirank == 0) {
+      test_check (filename, mpisize, level != 0);
+    }
+    mpiret = sc_MPI_Barrier (sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+  }
+  for (i = 0; i < TEST_VTK_FIELDS; ++i) {
+    sc_array_reset (&arrays[i]);
+  }
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}